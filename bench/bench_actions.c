@@ -0,0 +1,297 @@
+/*
+ * TJUH host bench — action map
+ *
+ * Binds sixteen actions' worth of chords, d-pad directions and stick
+ * thresholds with hysteresis, and plays random reports from several
+ * devices, with sticks jittering around the thresholds and a quarter of
+ * the reports repeating the previous one, against both the compiled map
+ * and the same bindings written as a chain of if tests on the packed
+ * report, as an application would. The active actions must agree on
+ * every report, and the edges read at random intervals must be those of
+ * the reports in between; a disconnect must release what was active,
+ * and a new map must apply to a repeated report. Counts how often a
+ * stick action toggled with and without hysteresis, then times both per
+ * report, and the map on repeated reports.
+ *
+ *   bench_actions [reports]
+ *
+ * `reports` is the timing run length (default 2000000). Exits non-zero
+ * if the map and the if-chain disagree. Times are host CPU time.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SEED 0xBB67AE85u
+#include "bench_util.h"
+#include "tjuh_actions.h"
+#include "tjuh_buttons.h"
+
+#define DEVICES        3
+#define SCRIPT_REPORTS 300000
+#define POOL_SIZE      4096
+
+#define A(x) (1u << (x))
+
+enum {
+    ACT_JUMP, ACT_MENU, ACT_RESET, ACT_SCROLL_UP, ACT_SCROLL_DOWN, ACT_MOVE_UP,
+    ACT_MOVE_DOWN, ACT_MOVE_LEFT, ACT_MOVE_RIGHT, ACT_AIM, ACT_FIRE, ACT_CONFIRM,
+    ACT_RIGHT_RAW, ACT_DIAGONAL,
+};
+
+static const tjuh_binding_t s_map[] = {
+    { .action = ACT_JUMP,        .buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_CROSS) },
+    { .action = ACT_MENU,        .buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_START) },
+    { .action = ACT_RESET,       .buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_L1) |
+                                            TJUH_BUTTON_MASK(TJUH_BUTTON_R1) |
+                                            TJUH_BUTTON_MASK(TJUH_BUTTON_SELECT) },
+    { .action = ACT_SCROLL_UP,   .buttons = TJUH_BUTTON_MASK(TJUH_EVENT_DPAD_UP) },
+    { .action = ACT_SCROLL_DOWN, .buttons = TJUH_BUTTON_MASK(TJUH_EVENT_DPAD_DOWN) },
+    { .action = ACT_MOVE_UP,     .axis = TJUH_AXIS_Y, .below = true, .on = 40,  .off = 70 },
+    { .action = ACT_MOVE_DOWN,   .axis = TJUH_AXIS_Y,                .on = 215, .off = 185 },
+    { .action = ACT_MOVE_LEFT,   .axis = TJUH_AXIS_X, .below = true, .on = 40,  .off = 70 },
+    { .action = ACT_MOVE_RIGHT,  .axis = TJUH_AXIS_X,                .on = 215, .off = 185 },
+    { .action = ACT_AIM,         .buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_L2),
+                                 .axis = TJUH_AXIS_RZ, .below = true, .on = 60, .off = 90 },
+    { .action = ACT_FIRE,        .buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_R2) },
+    { .action = ACT_FIRE,        .axis = TJUH_AXIS_Z,                .on = 230, .off = 200 },
+    { .action = ACT_CONFIRM,     .buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_CROSS) },
+    { .action = ACT_CONFIRM,     .buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_START) },
+    { .action = ACT_RIGHT_RAW,   .axis = TJUH_AXIS_X,                .on = 215, .off = 215 },
+    { .action = ACT_DIAGONAL,    .buttons = TJUH_BUTTON_MASK(TJUH_EVENT_DPAD_UP) |
+                                            TJUH_BUTTON_MASK(TJUH_EVENT_DPAD_RIGHT) },
+};
+
+/* ---------------------------------------------------------------------- */
+/*  The same bindings as an if-chain                                      */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    bool up, down, left, right, aim, fire_z;
+} chain_t;
+
+static uint32_t chain_actions(const tjuh_gamepad_report_t *rpt, chain_t *c)
+{
+    uint8_t  h = rpt->dpad;
+    bool     up    = h == 7 || h == 0 || h == 1;
+    bool     down  = h >= 3 && h <= 5;
+    bool     right = h >= 1 && h <= 3;
+    uint32_t a = 0;
+
+    if (rpt->cross)
+        a |= A(ACT_JUMP) | A(ACT_CONFIRM);
+    if (rpt->start)
+        a |= A(ACT_MENU) | A(ACT_CONFIRM);
+    if (rpt->l1 && rpt->r1 && rpt->select)
+        a |= A(ACT_RESET);
+    if (up)
+        a |= A(ACT_SCROLL_UP);
+    if (down)
+        a |= A(ACT_SCROLL_DOWN);
+    if (up && right)
+        a |= A(ACT_DIAGONAL);
+
+    c->up     = rpt->y <= (c->up ? 70 : 40);
+    c->down   = rpt->y >= (c->down ? 185 : 215);
+    c->left   = rpt->x <= (c->left ? 70 : 40);
+    c->right  = rpt->x >= (c->right ? 185 : 215);
+    c->aim    = rpt->l2 && rpt->rz <= (c->aim ? 90 : 60);
+    c->fire_z = rpt->z >= (c->fire_z ? 200 : 230);
+
+    if (c->up)
+        a |= A(ACT_MOVE_UP);
+    if (c->down)
+        a |= A(ACT_MOVE_DOWN);
+    if (c->left)
+        a |= A(ACT_MOVE_LEFT);
+    if (c->right)
+        a |= A(ACT_MOVE_RIGHT);
+    if (c->aim)
+        a |= A(ACT_AIM);
+    if (rpt->r2 || c->fire_z)
+        a |= A(ACT_FIRE);
+    if (rpt->x >= 215)
+        a |= A(ACT_RIGHT_RAW);
+    return a;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Script                                                                */
+/* ---------------------------------------------------------------------- */
+
+/* Sticks rest at a target, jittering by a few counts, now and then near a threshold */
+typedef struct {
+    tjuh_gamepad_state_t st;
+    uint8_t target[4];
+} pad_t;
+
+static void step_pad(pad_t *p)
+{
+    static const uint8_t near[] = { 40, 60, 70, 90, 185, 200, 215, 230 };
+    uint32_t r = rnd32();
+
+    if ((r & 15) == 0)
+        p->st.buttons ^= TJUH_BUTTON_MASK((r >> 8) % 14);  /* ids in the packed report */
+    else if ((r & 63) == 1)
+        p->st.hat = (uint8_t)((r >> 8) % 9);
+    else if ((r & 127) == 2)
+        p->target[(r >> 8) & 3] = (r >> 12 & 1) ? near[(r >> 16) % ARRAY_SIZE(near)]
+                                                : (uint8_t)(r >> 16);
+
+    for (int a = 0; a < 4; a++) {
+        int v = p->target[a] + (int)(rnd32() % 13) - 6;
+        v = v < 0 ? 0 : v > 255 ? 255 : v;
+        p->st.axes = (p->st.axes & ~(0xFFu << (8 * a))) | ((uint32_t)v << (8 * a));
+    }
+}
+
+static int run_script(void)
+{
+    static pad_t pad[DEVICES];
+    chain_t  chain[DEVICES];
+    uint32_t chain_active[DEVICES], want_pressed[DEVICES], want_released[DEVICES];
+    long     bad = 0, polls = 0, toggles = 0, toggles_raw = 0;
+    tjuh_actions_t got;
+
+    tjuh_actions_reset();
+    bench_delta_reset();
+    bool ok = tjuh_set_action_map(s_map, (uint8_t)ARRAY_SIZE(s_map));
+
+    memset(chain, 0, sizeof(chain));
+    memset(chain_active, 0, sizeof(chain_active));
+    memset(want_pressed, 0, sizeof(want_pressed));
+    memset(want_released, 0, sizeof(want_released));
+    for (int i = 0; i < DEVICES; i++) {
+        pad[i].st = (tjuh_gamepad_state_t){ .axes = 0x80808080u, .hat = TJUH_HAT_RELEASED };
+        memset(pad[i].target, 0x80, sizeof(pad[i].target));
+    }
+
+    for (long n = 0; n < SCRIPT_REPORTS; n++) {
+        uint8_t dev = (uint8_t)(1 + rnd32() % DEVICES);
+        uint8_t i   = dev - 1;
+        tjuh_gamepad_report_t rpt;
+
+        if (rnd32() & 3)
+            step_pad(&pad[i]);
+        tjuh_report_delta_t delta = bench_delta(dev, &pad[i].st);
+        tjuh_actions_update(dev, &pad[i].st, &delta);
+
+        tjuh_state_to_report(&pad[i].st, &rpt);
+        uint32_t want = chain_actions(&rpt, &chain[i]);
+        uint32_t flip = want ^ chain_active[i];
+
+        toggles       += (flip >> ACT_MOVE_RIGHT) & 1u;
+        toggles_raw   += (flip >> ACT_RIGHT_RAW) & 1u;
+        want_pressed[i]  |= want & ~chain_active[i];
+        want_released[i] |= chain_active[i] & ~want;
+        chain_active[i]   = want;
+
+        if ((rnd32() & 7) == 0) {
+            tjuh_get_actions(dev, &got);
+            bad += got.active != want || got.pressed != want_pressed[i] ||
+                   got.released != want_released[i];
+            want_pressed[i]  = 0;
+            want_released[i] = 0;
+            polls++;
+        }
+    }
+
+    /* A disconnect releases the active actions */
+    tjuh_get_actions(1, &got);
+    tjuh_actions_release(1);
+    bool reported = tjuh_get_actions(1, &got);
+    ok &= !reported && got.active == 0 && got.released == chain_active[0] && got.pressed == 0;
+
+    /* Invalid maps are refused and leave the map as it was */
+    tjuh_binding_t wrong = { .action = 0, .axis = TJUH_AXIS_X, .on = 100, .off = 120 };
+    ok &= !tjuh_set_action_map(&wrong, 1);
+    wrong = (tjuh_binding_t){ .action = 32 };
+    ok &= !tjuh_set_action_map(&wrong, 1);
+    wrong = (tjuh_binding_t){ .action = 0, .axis = TJUH_AXIS_X | TJUH_AXIS_Y };
+    ok &= !tjuh_set_action_map(&wrong, 1);
+    tjuh_gamepad_state_t cross = { .buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_CROSS),
+                                   .axes = 0x80808080u, .hat = TJUH_HAT_RELEASED };
+    tjuh_report_delta_t delta = bench_delta(2, &cross);
+    tjuh_actions_update(2, &cross, &delta);
+    tjuh_get_actions(2, &got);
+    ok &= got.active == (A(ACT_JUMP) | A(ACT_CONFIRM));
+
+    /* A new map applies to the next report, even one that did not change */
+    const tjuh_binding_t only = { .buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_CROSS),
+                                  .action = ACT_MOVE_RIGHT };
+    ok &= tjuh_set_action_map(&only, 1);
+    delta = bench_delta(2, &cross);
+    tjuh_actions_update(2, &cross, &delta);
+    tjuh_get_actions(2, &got);
+    ok &= delta.fields == 0 && got.active == A(ACT_MOVE_RIGHT);
+
+    printf("%-28s %8ld reports, %6ld polls, %ld mismatching: %s\n", "random script",
+           (long)SCRIPT_REPORTS, polls, bad, ok && bad == 0 ? "ok" : "FAIL");
+    printf("%-28s %8ld with hysteresis, %ld without\n", "stick right toggles", toggles,
+           toggles_raw);
+    return !ok || bad != 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static void run_timing(long reports)
+{
+    static tjuh_gamepad_state_t  pool[POOL_SIZE];
+    static tjuh_report_delta_t   delta[POOL_SIZE];
+    static tjuh_gamepad_report_t rpool[POOL_SIZE];
+    static pad_t pad;
+    chain_t chain = {0};
+    tjuh_actions_t got;
+    uint32_t acc = 0;
+
+    pad.st = (tjuh_gamepad_state_t){ .axes = 0x80808080u, .hat = TJUH_HAT_RELEASED };
+    memset(pad.target, 0x80, sizeof(pad.target));
+    for (unsigned i = 0; i < POOL_SIZE; i++) {
+        step_pad(&pad);
+        pool[i] = pad.st;
+        tjuh_state_to_report(&pool[i], &rpool[i]);
+    }
+    bench_pool_deltas(pool, delta, POOL_SIZE);
+
+    tjuh_actions_reset();
+    tjuh_set_action_map(s_map, (uint8_t)ARRAY_SIZE(s_map));
+
+    printf("\n%u bindings\n", (unsigned)ARRAY_SIZE(s_map));
+    printf("%-28s %10s\n", "per report", "[ns]");
+
+    double t0 = now_s();
+    for (long i = 0; i < reports; i++)
+        tjuh_actions_update(1, &pool[i % POOL_SIZE], &delta[i % POOL_SIZE]);
+    double t1 = now_s();
+    tjuh_get_actions(1, &got);
+    acc += got.active;
+    bench_row("action map", t0, t1, reports);
+
+    tjuh_report_delta_t still = { .held = delta[0].held };
+    t0 = now_s();
+    for (long i = 0; i < reports; i++)
+        tjuh_actions_update(1, &pool[0], &still);
+    t1 = now_s();
+    bench_row("action map, repeated report", t0, t1, reports);
+
+    t0 = now_s();
+    for (long i = 0; i < reports; i++)
+        acc += chain_actions(&rpool[i % POOL_SIZE], &chain);
+    t1 = now_s();
+    bench_row("if-chain", t0, t1, reports);
+
+    bench_sink(acc);
+}
+
+int main(int argc, char **argv)
+{
+    long reports = bench_count(argc, argv, 2000000L);
+    int failures = 0;
+
+    failures += run_script();
+    run_timing(reports);
+
+    return bench_exit(stdout, failures);
+}
@@ -0,0 +1,131 @@
+/*
+ * TJUH host bench — batch report delivery
+ *
+ * Streams several simulated controllers twice over the same bus
+ * schedule: once with on_state per report and once with on_report_batch,
+ * unplugging one controller halfway. The batches, concatenated, must
+ * equal the per-report sequence, and every batch must hold between 1 and
+ * TJUH_BATCH_MAX entries. Prints how many reports a batch carried on
+ * average, i.e. how many callbacks batching saves.
+ *
+ *   bench_batch
+ *
+ * Exits non-zero if the sequences differ or a batch is out of bounds.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "tjuh.h"
+#include "sim_usb.h"
+
+#define RUN_US        2000000
+#define UNPLUG_AT_US  1000000
+#define MAX_REPORTS   100000
+
+typedef struct {
+    tjuh_report_entry_t entry[MAX_REPORTS];
+    long                n;
+    long                calls;
+    long                largest;
+    bool                bad_size;
+} trace_t;
+
+static trace_t s_single;
+static trace_t s_batched;
+
+static void record(trace_t *t, uint8_t dev_addr, const tjuh_gamepad_state_t *state)
+{
+    if (t->n < MAX_REPORTS) {
+        t->entry[t->n].state    = *state;
+        t->entry[t->n].dev_addr = dev_addr;
+    }
+    t->n++;
+}
+
+static void on_state(uint8_t dev_addr, const tjuh_gamepad_state_t *state)
+{
+    record(&s_single, dev_addr, state);
+    s_single.calls++;
+}
+
+static void on_batch(const tjuh_report_entry_t *entries, size_t n)
+{
+    if (n < 1 || n > TJUH_BATCH_MAX)
+        s_batched.bad_size = true;
+    if ((long)n > s_batched.largest)
+        s_batched.largest = (long)n;
+
+    for (size_t i = 0; i < n; i++)
+        record(&s_batched, entries[i].dev_addr, &entries[i].state);
+    s_batched.calls++;
+}
+
+static void on_report(uint8_t dev_addr, const tjuh_gamepad_report_t *report)
+{
+    (void)dev_addr;
+    (void)report;
+}
+
+static void run(bool batch)
+{
+    static const sim_device_spec_t *const mix[] = {
+        &sim_dev_ds4, &sim_dev_xbox360, &sim_dev_dualsense,
+        &sim_dev_generic8, &sim_dev_ds4, &sim_dev_xbox360,
+    };
+    uint8_t addr[ARRAY_SIZE(mix)];
+
+    sim_reset();
+    tjuh_config_t config = {
+        .on_report       = on_report,
+        .on_state        = batch ? NULL : on_state,
+        .on_report_batch = batch ? on_batch : NULL,
+    };
+    tjuh_init(&config);
+
+    for (size_t i = 0; i < ARRAY_SIZE(mix); i++)
+        addr[i] = sim_plug(mix[i], 0);
+
+    sim_run_until(UNPLUG_AT_US, tjuh_task);
+    sim_unplug(addr[2]);
+    sim_run_until(RUN_US, tjuh_task);
+}
+
+static bool same_entry(const tjuh_report_entry_t *a, const tjuh_report_entry_t *b)
+{
+    return a->dev_addr == b->dev_addr && a->state.buttons == b->state.buttons &&
+           a->state.axes == b->state.axes && a->state.hat == b->state.hat;
+}
+
+int main(void)
+{
+    /* Keep the results, drop the library's diagnostic output */
+    FILE *out = fdopen(dup(fileno(stdout)), "w");
+    if (!out || !freopen("/dev/null", "w", stdout))
+        return 1;
+
+    run(false);
+    run(true);
+
+    long mismatches = s_single.n != s_batched.n;
+    long n = s_single.n < MAX_REPORTS ? s_single.n : MAX_REPORTS;
+    for (long i = 0; i < n && !mismatches; i++)
+        mismatches += !same_entry(&s_single.entry[i], &s_batched.entry[i]);
+
+    fprintf(out, "%-16s %10s %10s %10s %10s\n", "delivery", "reports", "calls", "per call",
+            "largest");
+    fprintf(out, "%-16s %10ld %10ld %10.2f %10d\n", "per report", s_single.n, s_single.calls,
+            1.0, 1);
+    fprintf(out, "%-16s %10ld %10ld %10.2f %10ld\n", "batched", s_batched.n, s_batched.calls,
+            s_batched.calls ? (double)s_batched.n / s_batched.calls : 0.0, s_batched.largest);
+    fprintf(out, "sequence mismatches: %ld, batch size out of range: %s\n", mismatches,
+            s_batched.bad_size ? "yes" : "no");
+
+    int failures = mismatches != 0 || s_batched.bad_size || s_single.n == 0;
+    fprintf(out, "failures: %d\n", failures);
+    fclose(out);
+    return failures;
+}
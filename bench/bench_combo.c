@@ -0,0 +1,419 @@
+/*
+ * TJUH host bench — combo matching and input history
+ *
+ * Registers 100 random button sequences, some overlapping themselves,
+ * with and without a time window, and plays 1000 Hz reports from several
+ * devices in which players type combos (at times too slowly for the
+ * window) between random presses, some of them in the same report.
+ * Every report must complete exactly the combos that rescanning a press
+ * history finds, in the same order; combos are also removed and added
+ * along the way. The input history must hold each device's latest
+ * edges. Then times both per report with 100 combos.
+ *
+ *   bench_combo [reports]
+ *
+ * `reports` is the timing run length (default 2000000). Exits non-zero
+ * if the matcher and the rescan disagree. Times are host CPU time; the
+ * script runs on the simulated bus clock.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SEED 0x6A09E667u
+#include "bench_util.h"
+#include "tjuh_combo.h"
+#include "tjuh_buttons.h"
+#include "sim_usb.h"
+
+#define DEVICES       3
+#define COMBOS        TJUH_MAX_COMBOS
+#define SCRIPT_MS     60000
+#define POOL_SIZE     4096
+#define MAX_FIRES     64
+
+/* Few distinct buttons, so combos share prefixes and repeat steps */
+static const uint8_t s_alphabet[] = {
+    TJUH_BUTTON_CROSS, TJUH_BUTTON_CIRCLE, TJUH_BUTTON_SQUARE, TJUH_BUTTON_TRIANGLE,
+    TJUH_EVENT_DPAD_UP, TJUH_EVENT_DPAD_DOWN, TJUH_EVENT_DPAD_LEFT, TJUH_EVENT_DPAD_RIGHT,
+};
+
+typedef struct {
+    uint8_t  steps[TJUH_COMBO_MAX_STEPS];
+    uint8_t  length;
+    uint16_t window_ms;
+    int8_t   handle;    /* -1 = not registered */
+    uint32_t from[DEVICES]; /* presses before it was registered */
+} combo_def_t;
+
+static combo_def_t  s_def[COMBOS];
+static combo_def_t *s_by_handle[COMBOS];
+
+static void make_combos(void)
+{
+    static const uint8_t konami[] = {
+        TJUH_EVENT_DPAD_UP, TJUH_EVENT_DPAD_UP, TJUH_EVENT_DPAD_DOWN, TJUH_EVENT_DPAD_DOWN,
+        TJUH_EVENT_DPAD_LEFT, TJUH_EVENT_DPAD_RIGHT, TJUH_EVENT_DPAD_LEFT,
+        TJUH_EVENT_DPAD_RIGHT, TJUH_BUTTON_CIRCLE, TJUH_BUTTON_CROSS,
+    };
+
+    for (int c = 0; c < COMBOS; c++) {
+        combo_def_t *d = &s_def[c];
+        uint32_t r = rnd32();
+
+        d->length    = (uint8_t)(2 + r % 7);
+        d->window_ms = (r >> 8) & 1 ? 0 : (uint16_t)(300 + (r >> 9) % 1500);
+        for (int i = 0; i < d->length; i++)
+            d->steps[i] = s_alphabet[rnd32() % ARRAY_SIZE(s_alphabet)];
+
+        /* Self-overlapping: ABAB..., AAA */
+        if (c % 10 == 1) {
+            for (int i = 2; i < d->length; i++)
+                d->steps[i] = d->steps[i - 2];
+        } else if (c % 10 == 2) {
+            memset(d->steps, d->steps[0], d->length);
+        }
+    }
+    memcpy(s_def[0].steps, konami, sizeof(konami));
+    s_def[0].length    = sizeof(konami);
+    s_def[0].window_ms = 3000;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Rescan: keep the presses, compare every combo against their tail      */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    uint32_t held;
+    uint8_t  button[TJUH_COMBO_MAX_STEPS];  /* latest presses, newest last */
+    uint32_t time_ms[TJUH_COMBO_MAX_STEPS];
+    uint8_t  n;
+    uint32_t presses;
+} rescan_t;
+
+static rescan_t s_rescan[DEVICES];
+
+typedef struct {
+    uint8_t dev_addr;
+    int8_t  combo;
+} fire_t;
+
+static void rescan_press(rescan_t *r, uint8_t b, uint32_t now)
+{
+    if (r->n == TJUH_COMBO_MAX_STEPS) {
+        memmove(r->button, r->button + 1, TJUH_COMBO_MAX_STEPS - 1);
+        memmove(r->time_ms, r->time_ms + 1, (TJUH_COMBO_MAX_STEPS - 1) * sizeof(uint32_t));
+        r->n--;
+    }
+    r->button[r->n]  = b;
+    r->time_ms[r->n] = now;
+    r->n++;
+    r->presses++;
+}
+
+/* Returns the number of fires written */
+static int rescan_update(uint8_t dev_addr, const tjuh_gamepad_state_t *st, uint32_t now,
+                         fire_t *fires)
+{
+    rescan_t *r     = &s_rescan[dev_addr - 1];
+    uint32_t  word  = tjuh_buttons_with_dpad(st);
+    uint32_t  press = word & ~r->held;
+    int       n     = 0;
+
+    r->held = word;
+    for (uint8_t b = 0; b < 32; b++) {
+        if (!(press >> b & 1u))
+            continue;
+        rescan_press(r, b, now);
+
+        /* Handle order, as the matcher runs its slots */
+        for (int h = 0; h < COMBOS; h++) {
+            const combo_def_t *d = s_by_handle[h];
+            if (!d || d->length > r->n || r->presses - d->from[dev_addr - 1] < d->length)
+                continue;
+
+            const uint8_t *tail = &r->button[r->n - d->length];
+            if (memcmp(tail, d->steps, d->length) != 0)
+                continue;
+            if (d->window_ms && now - r->time_ms[r->n - d->length] > d->window_ms)
+                continue;
+            if (n < MAX_FIRES)
+                fires[n] = (fire_t){ dev_addr, d->handle };
+            n++;
+        }
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Script                                                                */
+/* ---------------------------------------------------------------------- */
+
+static fire_t s_fired[MAX_FIRES];
+static int    s_nfired;
+
+static void on_combo(uint8_t dev_addr, int8_t combo, void *ctx)
+{
+    (void)ctx;
+    if (s_nfired < MAX_FIRES)
+        s_fired[s_nfired] = (fire_t){ dev_addr, combo };
+    s_nfired++;
+}
+
+static bool add(int c)
+{
+    tjuh_combo_t combo = {
+        .steps     = s_def[c].steps,
+        .length    = s_def[c].length,
+        .window_ms = s_def[c].window_ms,
+        .callback  = on_combo,
+    };
+    s_def[c].handle = tjuh_combo_register(&combo);
+    if (s_def[c].handle < 0)
+        return false;
+
+    s_by_handle[s_def[c].handle] = &s_def[c];
+    for (int i = 0; i < DEVICES; i++)
+        s_def[c].from[i] = s_rescan[i].presses;
+    return true;
+}
+
+static void drop(int c)
+{
+    tjuh_combo_unregister(s_def[c].handle);
+    s_by_handle[s_def[c].handle] = NULL;
+    s_def[c].handle = -1;
+}
+
+/* A player: presses buttons, sometimes typing one of the combos */
+typedef struct {
+    tjuh_gamepad_state_t st;
+    uint16_t up_at[32];         /* ms the button is released, 0 = up */
+    uint32_t next_ms;
+    const combo_def_t *typing;
+    uint8_t  typed;
+} player_t;
+
+static void press_button(player_t *p, uint8_t b, uint32_t ms)
+{
+    p->up_at[b] = (uint16_t)(ms + 5 + rnd32() % 40);
+    if (b < TJUH_BUTTON_COUNT) {
+        p->st.buttons |= TJUH_BUTTON_MASK(b);
+    } else {
+        static const uint8_t hat[4] = { 0, 2, 4, 6 };
+        p->st.hat = hat[b - TJUH_EVENT_DPAD_UP];
+    }
+}
+
+static void step_player(player_t *p, uint32_t ms)
+{
+    for (uint8_t b = 0; b < 32; b++) {
+        if (p->up_at[b] && p->up_at[b] == (uint16_t)ms) {
+            p->up_at[b] = 0;
+            if (b < TJUH_BUTTON_COUNT)
+                p->st.buttons &= ~TJUH_BUTTON_MASK(b);
+            else if (p->st.hat == (uint8_t)((b - TJUH_EVENT_DPAD_UP) * 2))
+                p->st.hat = TJUH_HAT_RELEASED;
+        }
+    }
+
+    if (ms < p->next_ms)
+        return;
+
+    uint32_t r = rnd32();
+    if (!p->typing && (r & 3) == 0) {
+        p->typing = &s_def[(r >> 8) % COMBOS];
+        p->typed  = 0;
+    }
+
+    if (p->typing) {
+        press_button(p, p->typing->steps[p->typed++], ms);
+        if (p->typed == p->typing->length)
+            p->typing = NULL;
+        /* Mostly in time for a window, sometimes not */
+        p->next_ms = ms + 60 + ((r >> 4) & 7 ? rnd32() % 150 : rnd32() % 900);
+    } else {
+        press_button(p, s_alphabet[(r >> 4) % ARRAY_SIZE(s_alphabet)], ms);
+        if ((r >> 12 & 7) == 0)
+            press_button(p, s_alphabet[(r >> 16) % ARRAY_SIZE(s_alphabet)], ms);
+        p->next_ms = ms + 50 + rnd32() % 400;
+    }
+}
+
+static int run_script(void)
+{
+    static player_t player[DEVICES];
+    fire_t want[MAX_FIRES];
+    long reports = 0, fires = 0, bad = 0;
+    bool ok = true;
+
+    sim_reset();
+    tjuh_combo_reset();
+    bench_delta_reset();
+    memset(s_rescan, 0, sizeof(s_rescan));
+    memset(player, 0, sizeof(player));
+    make_combos();
+    for (int i = 0; i < DEVICES; i++)
+        player[i].st = (tjuh_gamepad_state_t){ .axes = 0x80808080u, .hat = TJUH_HAT_RELEASED };
+    for (int c = 0; c < COMBOS; c++)
+        ok &= add(c);
+
+    for (uint32_t ms = 1; ms <= SCRIPT_MS; ms++) {
+        sim_run_until((uint64_t)ms * 1000, tuh_task);
+        uint32_t now = (uint32_t)(sim_now_us() / 1000);
+
+        /* Combos come and go */
+        if (ms == SCRIPT_MS / 3) {
+            drop(5);
+            drop(COMBOS - 1);
+        }
+        if (ms == 2 * SCRIPT_MS / 3) {
+            ok &= add(COMBOS - 1);
+            ok &= add(5);
+        }
+
+        for (uint8_t dev = 1; dev <= DEVICES; dev++) {
+            player_t *p = &player[dev - 1];
+            step_player(p, ms);
+
+            s_nfired = 0;
+            tjuh_report_delta_t delta = bench_delta(dev, &p->st);
+            tjuh_combo_update(dev, &delta);
+            int n = rescan_update(dev, &p->st, now, want);
+
+            bool same = n == s_nfired && n <= MAX_FIRES;
+            for (int i = 0; same && i < n; i++)
+                same = want[i].dev_addr == s_fired[i].dev_addr &&
+                       want[i].combo == s_fired[i].combo;
+            bad   += !same;
+            fires += n;
+            reports++;
+        }
+    }
+
+    printf("%-28s %8ld reports, %6ld combos completed, %ld mismatching: %s\n",
+           "random script", reports, fires, bad, ok && bad == 0 ? "ok" : "FAIL");
+    return !ok || bad != 0 || fires == 0;
+}
+
+/* The history against the edges of a few reports, and a disconnect */
+static int run_history(void)
+{
+    tjuh_gamepad_state_t st = { .axes = 0x80808080u, .hat = TJUH_HAT_RELEASED };
+    tjuh_button_event_t  e[TJUH_INPUT_HISTORY + 1];
+    uint8_t  want_button[64];
+    uint8_t  want_edge[64];
+    int      n = 0;
+
+    tjuh_combo_reset();
+    bench_delta_reset();
+    for (int i = 0; i < 24; i++) {
+        uint32_t before = tjuh_buttons_with_dpad(&st);
+        st.buttons ^= TJUH_BUTTON_MASK(rnd32() % TJUH_BUTTON_COUNT);
+        if (i % 5 == 0)
+            st.hat = (uint8_t)(rnd32() % 9);
+        uint32_t after = tjuh_buttons_with_dpad(&st);
+
+        for (uint8_t b = 0; b < 32; b++) {
+            if ((before ^ after) >> b & 1u) {
+                want_button[n] = b;
+                want_edge[n]   = (uint8_t)(after >> b & 1u);
+                n++;
+            }
+        }
+        tjuh_report_delta_t delta = bench_delta(1, &st);
+        tjuh_combo_update(1, &delta);
+    }
+
+    uint8_t got = tjuh_get_input_history(1, e, (uint8_t)ARRAY_SIZE(e));
+    bool ok = got == (n < TJUH_INPUT_HISTORY ? n : TJUH_INPUT_HISTORY);
+    for (int i = 0; ok && i < got; i++)
+        ok = e[i].dev_addr == 1 && e[i].button == want_button[n - 1 - i] &&
+             e[i].edge == want_edge[n - 1 - i];
+
+    tjuh_combo_release(1);
+    ok &= tjuh_get_input_history(1, e, (uint8_t)ARRAY_SIZE(e)) == 0;
+
+    printf("%-28s %s\n", "input history", ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static void run_timing(long reports)
+{
+    static tjuh_gamepad_state_t pool[POOL_SIZE];
+    static tjuh_report_delta_t  delta[POOL_SIZE];
+    static player_t p;
+    fire_t fires[MAX_FIRES];
+    uint32_t acc = 0;
+    long presses = 0;
+
+    /* One player's reports at 1000 Hz */
+    memset(&p, 0, sizeof(p));
+    p.st = (tjuh_gamepad_state_t){ .axes = 0x80808080u, .hat = TJUH_HAT_RELEASED };
+    for (unsigned i = 0; i < POOL_SIZE; i++) {
+        uint32_t before = tjuh_buttons_with_dpad(&p.st);
+        step_player(&p, i + 1);
+        pool[i] = p.st;
+        presses += __builtin_popcount(tjuh_buttons_with_dpad(&p.st) & ~before);
+    }
+    bench_pool_deltas(pool, delta, POOL_SIZE);
+
+    sim_reset();
+    tjuh_combo_reset();
+    memset(s_rescan, 0, sizeof(s_rescan));
+    for (int c = 0; c < COMBOS; c++)
+        add(c);
+
+    printf("\n%d combos, %.1f presses per 1000 reports\n", COMBOS,
+           presses * 1000.0 / POOL_SIZE);
+    printf("%-28s %10s %10s\n", "per report", "[ns]", "per press");
+
+    tjuh_report_delta_t still = { .held = delta[0].held };
+    double t0 = now_s();
+    for (long i = 0; i < reports; i++)
+        tjuh_combo_update(1, &still);
+    double t1 = now_s();
+    bench_row("matcher, no edge", t0, t1, reports);
+
+    long rounds = reports / POOL_SIZE + 1;
+    double per_press = 1e9 / ((double)presses * rounds);
+
+    s_nfired = 0;
+    t0 = now_s();
+    for (long k = 0; k < rounds; k++) {
+        for (unsigned i = 0; i < POOL_SIZE; i++)
+            tjuh_combo_update(1, &delta[i]);
+    }
+    t1 = now_s();
+    acc += (uint32_t)s_nfired;
+    printf("%-28s %10.2f %10.2f\n", "matcher", (t1 - t0) * 1e9 / (rounds * POOL_SIZE),
+           (t1 - t0) * per_press);
+
+    uint32_t now = (uint32_t)(sim_now_us() / 1000);
+    t0 = now_s();
+    for (long k = 0; k < rounds; k++) {
+        for (unsigned i = 0; i < POOL_SIZE; i++)
+            acc += (uint32_t)rescan_update(1, &pool[i], now, fires);
+    }
+    t1 = now_s();
+    printf("%-28s %10.2f %10.2f\n", "rescan", (t1 - t0) * 1e9 / (rounds * POOL_SIZE),
+           (t1 - t0) * per_press);
+
+    bench_sink(acc);
+}
+
+int main(int argc, char **argv)
+{
+    long reports = bench_count(argc, argv, 2000000L);
+    int failures = 0;
+
+    failures += run_script();
+    failures += run_history();
+    run_timing(reports);
+
+    return bench_exit(stdout, failures);
+}
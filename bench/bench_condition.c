@@ -0,0 +1,286 @@
+/*
+ * TJUH host bench — stick and trigger conditioning
+ *
+ * Runs a set of conditioning profiles (identity, centre offsets, radial
+ * deadzones, outer limits, each response curve) over a grid of stick
+ * positions and every trigger value, and compares the table-driven
+ * integer path with a naive single-precision one (sqrtf, divide, powf)
+ * working from the profile directly. Then times both per report.
+ *
+ *   bench_condition [reports]
+ *
+ * `reports` is the timing run length (default 2000000). Exits non-zero if
+ * an extended axis is more than MAX_ERR_LSB off the float result, a state
+ * axis more than 1 off, or the identity profile changes any value. Times
+ * are host CPU time. The host has an FPU, the RP2040 does not: there the
+ * float path is soft-float, and the integer one costs the same as here
+ * relative to the rest of the report path.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "tjuh_condition.h"
+#include "tjuh_parse.h"
+
+#define DEV             1
+#define MAX_ERR_LSB     16      /* 16-bit units: a sixteenth of an 8-bit step */
+#define GRID_STEP       97
+
+typedef struct {
+    const char              *name;
+    tjuh_condition_profile_t profile;
+} profile_case_t;
+
+static profile_case_t s_cases[] = {
+    { "identity", {
+        .stick   = { { { 0, 0 }, 0, 0x8000, TJUH_CURVE_LINEAR },
+                     { { 0, 0 }, 0, 0x8000, TJUH_CURVE_LINEAR } },
+        .trigger = { { 0, 0xFFFF, TJUH_CURVE_LINEAR }, { 0, 0xFFFF, TJUH_CURVE_LINEAR } } } },
+    { "deadzone", {
+        .stick   = { { { 0, 0 }, 0x1000, 0x8000, TJUH_CURVE_LINEAR },
+                     { { 0, 0 }, 0x0800, 0x7800, TJUH_CURVE_LINEAR } },
+        .trigger = { { 0x0800, 0xFFFF, TJUH_CURVE_LINEAR }, { 0x1000, 0xF000, TJUH_CURVE_LINEAR } } } },
+    { "calibrated", {
+        .stick   = { { { 0x0300, -0x0280 }, 0x0C00, 0x7000, TJUH_CURVE_LINEAR },
+                     { { -0x0200, 0x0180 }, 0x0C00, 0x6800, TJUH_CURVE_QUADRATIC } },
+        .trigger = { { 0x0400, 0xE000, TJUH_CURVE_QUADRATIC }, { 0x0400, 0xE000, TJUH_CURVE_LINEAR } } } },
+    { "quadratic", {
+        .stick   = { { { 0, 0 }, 0x0A00, 0x7C00, TJUH_CURVE_QUADRATIC },
+                     { { 0, 0 }, 0, 0x8000, TJUH_CURVE_QUADRATIC } },
+        .trigger = { { 0, 0xFFFF, TJUH_CURVE_QUADRATIC }, { 0x0800, 0xF800, TJUH_CURVE_QUADRATIC } } } },
+    { "cubic", {
+        .stick   = { { { 0x0100, 0x0100 }, 0x1800, 0x7000, TJUH_CURVE_CUBIC },
+                     { { 0, 0 }, 0x0400, 0x4000, TJUH_CURVE_CUBIC } },
+        .trigger = { { 0x2000, 0xC000, TJUH_CURVE_CUBIC }, { 0, 0xFFFF, TJUH_CURVE_CUBIC } } } },
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Float reference                                                       */
+/* ---------------------------------------------------------------------- */
+
+static const float s_exponent[TJUH_CURVE_COUNT] = { 1.0f, 2.0f, 3.0f };
+
+static float clampf(float v, float lo, float hi)
+{
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+static void float_stick(const tjuh_stick_condition_t *p, uint16_t *ax, uint16_t *ay)
+{
+    float dx = clampf((float)*ax - (32768.0f + p->center[0]), -32768.0f, 32767.0f);
+    float dy = clampf((float)*ay - (32768.0f + p->center[1]), -32768.0f, 32767.0f);
+    float r  = sqrtf(dx * dx + dy * dy);
+
+    if (r <= p->deadzone) {
+        *ax = *ay = 0x8000;
+        return;
+    }
+
+    /* Past the outer limit the scale stays as it is there */
+    float rr = r < p->outer ? r : (float)p->outer;
+    float t  = (rr - p->deadzone) / (float)(p->outer - p->deadzone);
+    float s  = powf(t, s_exponent[p->curve]) * 32768.0f / rr;
+
+    *ax = (uint16_t)(32768.0f + clampf(roundf(dx * s), -32768.0f, 32767.0f));
+    *ay = (uint16_t)(32768.0f + clampf(roundf(dy * s), -32768.0f, 32767.0f));
+}
+
+static uint16_t float_trigger(const tjuh_trigger_condition_t *p, uint16_t v)
+{
+    if (v <= p->deadzone)
+        return 0;
+    if (v >= p->outer)
+        return 0xFFFF;
+
+    float t = (float)(v - p->deadzone) / (float)(p->outer - p->deadzone);
+    return (uint16_t)clampf(roundf(powf(t, s_exponent[p->curve]) * 65536.0f), 0.0f, 65535.0f);
+}
+
+static void float_apply(const tjuh_condition_profile_t *p, tjuh_gamepad_state_t *st,
+                        tjuh_gamepad_ext_t *ext)
+{
+    float_stick(&p->stick[0], &ext->x, &ext->y);
+    float_stick(&p->stick[1], &ext->z, &ext->rz);
+    ext->l2 = float_trigger(&p->trigger[0], ext->l2);
+    ext->r2 = float_trigger(&p->trigger[1], ext->r2);
+
+    st->x  = (uint8_t)(ext->x >> 8);
+    st->y  = (uint8_t)(ext->y >> 8);
+    st->z  = (uint8_t)(ext->z >> 8);
+    st->rz = (uint8_t)(ext->rz >> 8);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Accuracy                                                              */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    int  ext;           /* worst extended-axis difference */
+    int  state;         /* worst state-axis difference */
+    long changed;       /* values altered by the identity profile */
+} errors_t;
+
+static void compare(const tjuh_gamepad_state_t *is, const tjuh_gamepad_ext_t *ie,
+                    const tjuh_gamepad_state_t *fs, const tjuh_gamepad_ext_t *fe,
+                    const tjuh_gamepad_ext_t *in, errors_t *e)
+{
+    const uint16_t *a = &ie->x;
+    const uint16_t *b = &fe->x;
+    const uint16_t *c = &in->x;
+    const uint8_t   sa[4] = { is->x, is->y, is->z, is->rz };
+    const uint8_t   sb[4] = { fs->x, fs->y, fs->z, fs->rz };
+
+    for (int i = 0; i < 6; i++) {
+        int d = abs((int)a[i] - (int)b[i]);
+        if (d > e->ext)
+            e->ext = d;
+        if (a[i] != c[i])
+            e->changed++;
+    }
+    for (int i = 0; i < 4; i++) {
+        int d = abs((int)sa[i] - (int)sb[i]);
+        if (d > e->state)
+            e->state = d;
+    }
+}
+
+static int run_accuracy(const profile_case_t *pc)
+{
+    errors_t e = {0};
+
+    if (!tjuh_set_condition_profile(DEV, &pc->profile)) {
+        printf("%-12s rejected\n", pc->name);
+        return 1;
+    }
+    const tjuh_condition_t *c = tjuh_condition_get(DEV);
+
+    /* Both sticks over the grid, the triggers sweeping their range */
+    long points = 0;
+    for (uint32_t x = 0; x <= 0xFFFF; x += GRID_STEP) {
+        for (uint32_t y = 0; y <= 0xFFFF; y += GRID_STEP, points++) {
+            tjuh_gamepad_ext_t in = {
+                (uint16_t)x, (uint16_t)y, (uint16_t)y, (uint16_t)(0xFFFF - x),
+                (uint16_t)((x * 0x10001u + y) & 0xFFFF), (uint16_t)((y * 0x10001u + x) & 0xFFFF)
+            };
+            tjuh_gamepad_ext_t   ie = in, fe = in;
+            tjuh_gamepad_state_t is = {0}, fs = {0};
+
+            tjuh_condition_apply(c, &is, &ie);
+            float_apply(&pc->profile, &fs, &fe);
+            compare(&is, &ie, &fs, &fe, &in, &e);
+        }
+    }
+
+    bool identity = (pc == &s_cases[0]);
+    int  fail     = e.ext > MAX_ERR_LSB || e.state > 1 || (identity && e.changed);
+
+    printf("%-12s %8ld %14d %14d %10s\n", pc->name, points, e.ext, e.state,
+           fail ? "FAIL" : "ok");
+    return fail;
+}
+
+/* Limits the tables cannot represent are refused */
+static int run_validation(void)
+{
+    tjuh_condition_profile_t p;
+    int fail = 0;
+
+    tjuh_condition_profile_init(&p);
+    p.stick[0].outer = 0x3C00;
+    fail |= tjuh_set_condition_profile(DEV, &p);
+
+    tjuh_condition_profile_init(&p);
+    p.stick[1].deadzone = 0x8000;
+    fail |= tjuh_set_condition_profile(DEV, &p);
+
+    tjuh_condition_profile_init(&p);
+    p.trigger[0].curve = TJUH_CURVE_COUNT;
+    fail |= tjuh_set_condition_profile(DEV, &p);
+
+    tjuh_condition_profile_init(&p);
+    fail |= !tjuh_set_condition_profile(DEV, &p);
+    fail |= tjuh_set_condition_profile(DEV + 1, &p);
+
+    fail |= !tjuh_set_condition_profile(DEV, NULL);
+    fail |= tjuh_condition_get(DEV) != NULL;
+
+    printf("profile validation: %s\n", fail ? "FAIL" : "ok");
+    return fail;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static void run_timing(long reports)
+{
+    static tjuh_gamepad_ext_t pool[1024];
+    const profile_case_t *pc = &s_cases[ARRAY_SIZE(s_cases) - 1];
+    volatile uint32_t sink = 0;
+
+    srand(1);
+    for (unsigned i = 0; i < ARRAY_SIZE(pool); i++) {
+        uint16_t *v = &pool[i].x;
+        for (int k = 0; k < 6; k++)
+            v[k] = (uint16_t)(rand() & 0xFFFF);
+    }
+
+    printf("\n%-28s %10s\n", "per report", "[ns]");
+
+    for (size_t p = 0; p < ARRAY_SIZE(s_cases); p += ARRAY_SIZE(s_cases) - 1) {
+        tjuh_set_condition_profile(DEV, &s_cases[p].profile);
+        const tjuh_condition_t *c = tjuh_condition_get(DEV);
+
+        double t0 = now_s();
+        for (long i = 0; i < reports; i++) {
+            tjuh_gamepad_ext_t   ext = pool[i % ARRAY_SIZE(pool)];
+            tjuh_gamepad_state_t st;
+            tjuh_condition_apply(c, &st, &ext);
+            sink += ext.x ^ ext.rz ^ ext.l2 ^ st.y;
+        }
+        double t1 = now_s();
+
+        char label[40];
+        snprintf(label, sizeof(label), "tables (%s)", s_cases[p].name);
+        printf("%-28s %10.2f\n", label, (t1 - t0) * 1e9 / reports);
+    }
+
+    double t0 = now_s();
+    for (long i = 0; i < reports; i++) {
+        tjuh_gamepad_ext_t   ext = pool[i % ARRAY_SIZE(pool)];
+        tjuh_gamepad_state_t st;
+        float_apply(&pc->profile, &st, &ext);
+        sink += ext.x ^ ext.rz ^ ext.l2 ^ st.y;
+    }
+    double t1 = now_s();
+
+    char label[40];
+    snprintf(label, sizeof(label), "float (%s)", pc->name);
+    printf("%-28s %10.2f\n", label, (t1 - t0) * 1e9 / reports);
+    (void)sink;
+}
+
+int main(int argc, char **argv)
+{
+    long reports = (argc > 1) ? atol(argv[1]) : 2000000L;
+    int failures = 0;
+
+    if (reports < 1)
+        reports = 1;
+
+    tjuh_parse_init_device(DEV, 0x054C, 0x09CC);
+
+    printf("%-12s %8s %14s %14s\n", "profile", "points", "ext err [lsb]", "state err");
+    for (size_t i = 0; i < ARRAY_SIZE(s_cases); i++)
+        failures += run_accuracy(&s_cases[i]);
+
+    failures += run_validation();
+    run_timing(reports);
+
+    printf("failures: %d\n", failures);
+    return failures ? 1 : 0;
+}
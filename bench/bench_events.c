@@ -0,0 +1,184 @@
+/*
+ * TJUH host bench — button press/release events
+ *
+ * Feeds random button and hat changes from several devices into the
+ * event queue while a consumer polls it at random intervals, with a
+ * queue small enough to fill. The consumer rebuilds each device's held
+ * buttons from the events alone and checks that presses and releases
+ * alternate, that nothing is reported that the reports did not show, and
+ * that once the queue drains it agrees with the last report. Also checks
+ * that a tap between two polls leaves both events and that a disconnect
+ * releases held buttons. Then times the per-report update.
+ *
+ *   bench_events [reports]
+ *
+ * `reports` is the timing run length (default 2000000). Exits non-zero
+ * if a check fails. Times are host CPU time.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SEED 0x1F2E3D4Cu
+#include "bench_util.h"
+#include "tjuh_events.h"
+
+#define DEVICES       3
+#define SCRIPT_REPORTS 200000
+
+/* What the events say is held, per device */
+static uint32_t s_seen[DEVICES + 1];
+
+/* Drain the queue into s_seen; false on an event that does not alternate */
+static bool drain(void)
+{
+    tjuh_button_event_t e;
+    bool ok = true;
+
+    while (tjuh_get_button_event(&e)) {
+        uint32_t bit  = 1u << e.button;
+        bool     held = (s_seen[e.dev_addr] & bit) != 0;
+
+        if (e.dev_addr == 0 || e.dev_addr > DEVICES || held == (e.edge == TJUH_EDGE_PRESS))
+            ok = false;
+        s_seen[e.dev_addr] ^= bit;
+    }
+    return ok;
+}
+
+static uint32_t state_word(const tjuh_gamepad_state_t *st)
+{
+    static const uint8_t dirs[9] = { 0x1, 0x3, 0x2, 0x6, 0x4, 0xC, 0x8, 0x9, 0x0 };
+    return st->buttons | ((uint32_t)dirs[st->hat < 8 ? st->hat : 8] << TJUH_EVENT_DPAD_UP);
+}
+
+static void update(uint8_t dev_addr, const tjuh_gamepad_state_t *st)
+{
+    tjuh_report_delta_t delta = bench_delta(dev_addr, st);
+    tjuh_events_update(dev_addr, &delta);
+}
+
+/* Random reports from several devices, random poll intervals */
+static int run_script(void)
+{
+    tjuh_gamepad_state_t st[DEVICES + 1] = {0};
+    bool ok = true;
+
+    tjuh_events_reset();
+    bench_delta_reset();
+    memset(s_seen, 0, sizeof(s_seen));
+
+    for (long i = 0; i < SCRIPT_REPORTS; i++) {
+        uint8_t  dev = (uint8_t)(1 + rnd32() % DEVICES);
+        uint32_t r   = rnd32();
+
+        /* Mostly nothing changes; sometimes a button or the hat, or many */
+        if ((r & 7) == 0)
+            st[dev].buttons ^= TJUH_BUTTON_MASK((r >> 8) % TJUH_BUTTON_COUNT);
+        else if ((r & 7) == 1)
+            st[dev].hat = (uint8_t)((r >> 8) % 9);
+        else if ((r & 63) == 2)
+            st[dev].buttons = (r >> 8) & ((1u << TJUH_BUTTON_COUNT) - 1);
+
+        update(dev, &st[dev]);
+
+        if ((rnd32() & 31) == 0)
+            ok &= drain();
+    }
+
+    /* Deferred edges go out with the next reports */
+    for (int round = 0; round < 8; round++) {
+        for (uint8_t dev = 1; dev <= DEVICES; dev++)
+            update(dev, &st[dev]);
+        ok &= drain();
+    }
+
+    for (uint8_t dev = 1; dev <= DEVICES; dev++)
+        ok &= s_seen[dev] == state_word(&st[dev]);
+
+    printf("%-28s %8ld reports, %6u deferred: %s\n", "random script", (long)SCRIPT_REPORTS,
+           (unsigned)tjuh_get_button_events_deferred(), ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+/* Press and release between two polls, then a disconnect while held */
+static int run_tap(void)
+{
+    tjuh_gamepad_state_t st = { .hat = 8 };
+    tjuh_button_event_t  e[4];
+    int n = 0;
+
+    tjuh_events_reset();
+    bench_delta_reset();
+
+    st.buttons = TJUH_BUTTON_MASK(TJUH_BUTTON_CROSS);
+    update(1, &st);
+    st.buttons = 0;
+    update(1, &st);
+    st.hat = 2;
+    update(1, &st);
+    tjuh_events_release(1);
+
+    while (n < 4 && tjuh_get_button_event(&e[n]))
+        n++;
+
+    bool ok = n == 4 &&
+              e[0].button == TJUH_BUTTON_CROSS && e[0].edge == TJUH_EDGE_PRESS &&
+              e[1].button == TJUH_BUTTON_CROSS && e[1].edge == TJUH_EDGE_RELEASE &&
+              e[2].button == TJUH_EVENT_DPAD_RIGHT && e[2].edge == TJUH_EDGE_PRESS &&
+              e[3].button == TJUH_EVENT_DPAD_RIGHT && e[3].edge == TJUH_EDGE_RELEASE &&
+              !tjuh_get_button_event(&e[0]);
+
+    printf("%-28s %s\n", "tap and disconnect", ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static void run_timing(long reports)
+{
+    static tjuh_gamepad_state_t pool[1024];
+    static tjuh_report_delta_t  delta[1024];
+    tjuh_button_event_t e;
+    uint32_t acc = 0;
+
+    bench_random_states(pool, ARRAY_SIZE(pool), (1u << TJUH_BUTTON_COUNT) - 1);
+    bench_pool_deltas(pool, delta, ARRAY_SIZE(pool));
+    tjuh_report_delta_t still = bench_delta(1, &pool[0]);
+    still = bench_delta(1, &pool[0]);
+
+    printf("\n%-28s %10s\n", "per report", "[ns]");
+
+    tjuh_events_reset();
+    double t0 = now_s();
+    for (long i = 0; i < reports; i++)
+        tjuh_events_update(1, &still);
+    double t1 = now_s();
+    bench_row("update, unchanged", t0, t1, reports);
+
+    /* About nine edges a report, drained as they come */
+    t0 = now_s();
+    for (long i = 0; i < reports; i++) {
+        tjuh_events_update(1, &delta[i % ARRAY_SIZE(pool)]);
+        while (tjuh_get_button_event(&e))
+            acc += e.button;
+    }
+    t1 = now_s();
+    bench_row("update + drain, random", t0, t1, reports);
+
+    bench_sink(acc);
+}
+
+int main(int argc, char **argv)
+{
+    long reports = bench_count(argc, argv, 2000000L);
+    int failures = 0;
+
+    failures += run_script();
+    failures += run_tap();
+    run_timing(reports);
+
+    return bench_exit(stdout, failures);
+}
@@ -0,0 +1,170 @@
+/*
+ * TJUH host bench — frame-synchronised sampling
+ *
+ * Plays 1000 Hz reports with short taps (1 to 5 ms) and longer holds
+ * from several devices into the frame accumulators and samples them at
+ * 60 Hz. Each sampled frame is checked against the reports it covered:
+ * `pressed` must be every button seen down (plus those held coming in),
+ * `released` every button that went up, `state` the last report. Counts
+ * the taps that start and end within one frame, which reading the latest
+ * state once per frame would lose, and checks each is in both masks.
+ * Then times the per-report update and the per-frame sample.
+ *
+ *   bench_frame [reports]
+ *
+ * `reports` is the timing run length (default 2000000). Exits non-zero
+ * if a frame disagrees with its reports or a tap is missed. Times are
+ * host CPU time.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SEED 0x51ED270Bu
+#include "bench_util.h"
+#include "tjuh_frame.h"
+#include "tjuh_buttons.h"
+
+#define DEVICES        3
+#define REPORT_HZ      1000
+#define FRAME_HZ       60
+#define SCRIPT_SECONDS 120
+
+typedef struct {
+    tjuh_gamepad_state_t st;
+    uint16_t until[TJUH_BUTTON_COUNT];  /* ms left of each press, 0 = up */
+    uint32_t want_pressed;              /* expected frame masks */
+    uint32_t want_released;
+    uint32_t held;
+    uint32_t down_in_frame;             /* went down since the last sample */
+} script_device_t;
+
+static void step(script_device_t *d)
+{
+    for (int b = 0; b < TJUH_BUTTON_COUNT; b++) {
+        if (d->until[b] && --d->until[b] == 0)
+            d->st.buttons &= ~TJUH_BUTTON_MASK(b);
+    }
+
+    uint32_t r = rnd32();
+    if ((r & 63) == 0) {
+        int b = (int)((r >> 8) % TJUH_BUTTON_COUNT);
+        if (!d->until[b]) {
+            d->until[b]    = (uint16_t)((r & 0x40000000u) ? 1 + (r >> 16) % 5 : 20 + (r >> 16) % 300);
+            d->st.buttons |= TJUH_BUTTON_MASK(b);
+        }
+    } else if ((r & 511) == 1) {
+        d->st.hat = (uint8_t)((r >> 12) % 9);
+    }
+    d->st.x = (uint8_t)(r >> 24);
+
+    uint32_t now = tjuh_buttons_with_dpad(&d->st);
+    d->want_pressed  |= now;
+    d->want_released |= d->held & ~now;
+    d->down_in_frame |= now & ~d->held;
+    d->held           = now;
+}
+
+static int run_script(void)
+{
+    static script_device_t dev[DEVICES];
+    tjuh_frame_t frame[TJUH_MAX_DEVICES];
+    long frames = 0, bad = 0, taps_within = 0, taps_missed = 0;
+
+    memset(dev, 0, sizeof(dev));
+    for (int i = 0; i < DEVICES; i++)
+        dev[i].st.hat = TJUH_HAT_RELEASED;
+    tjuh_frame_reset();
+    bench_delta_reset();
+
+    for (long ms = 1; ms <= (long)SCRIPT_SECONDS * REPORT_HZ; ms++) {
+        for (int i = 0; i < DEVICES; i++) {
+            step(&dev[i]);
+            tjuh_report_delta_t delta = bench_delta((uint8_t)(i + 1), &dev[i].st);
+            tjuh_frame_update((uint8_t)(i + 1), &dev[i].st, &delta);
+        }
+
+        /* Frame boundaries every 16 or 17 reports */
+        if (ms * FRAME_HZ / REPORT_HZ == (ms - 1) * FRAME_HZ / REPORT_HZ)
+            continue;
+        frames++;
+
+        if (tjuh_sample_frame(frame) != DEVICES)
+            bad++;
+
+        for (int i = 0; i < DEVICES; i++) {
+            script_device_t    *d = &dev[i];
+            const tjuh_frame_t *f = &frame[i];
+
+            if (f->pressed != d->want_pressed || f->released != d->want_released ||
+                f->state.buttons != d->st.buttons || f->state.axes != d->st.axes ||
+                f->state.hat != d->st.hat || !f->connected)
+                bad++;
+
+            /* Down and up again within the frame: gone from the latest state */
+            uint32_t taps = d->down_in_frame & d->want_released & ~d->held;
+            taps_within  += __builtin_popcount(taps);
+            taps_missed  += __builtin_popcount(taps & ~(f->pressed & f->released));
+
+            d->want_pressed  = d->held;
+            d->want_released = 0;
+            d->down_in_frame = 0;
+        }
+    }
+
+    /* A disconnect releases what was held */
+    tjuh_frame_release(1);
+    tjuh_sample_frame(frame);
+    if (frame[0].connected || frame[0].released != dev[0].held)
+        bad++;
+
+    printf("%ld frames, %ld taps within a frame (lost to reading the latest state), "
+           "%ld not latched, %ld mismatching frames\n", frames, taps_within, taps_missed, bad);
+    return bad != 0 || taps_missed != 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static void run_timing(long reports)
+{
+    static tjuh_gamepad_state_t pool[1024];
+    static tjuh_report_delta_t  delta[1024];
+    tjuh_frame_t frame[TJUH_MAX_DEVICES];
+    uint32_t acc = 0;
+
+    bench_random_states(pool, ARRAY_SIZE(pool), TJUH_BTN_BUTTON_MASK);
+    bench_pool_deltas(pool, delta, ARRAY_SIZE(pool));
+
+    printf("\n%-28s %10s\n", "per call", "[ns]");
+
+    double t0 = now_s();
+    for (long i = 0; i < reports; i++)
+        tjuh_frame_update((uint8_t)(1 + (i & 1)), &pool[i % ARRAY_SIZE(pool)],
+                          &delta[i % ARRAY_SIZE(pool)]);
+    double t1 = now_s();
+    bench_row("update, per report", t0, t1, reports);
+
+    long frames = reports / 16 + 1;
+    t0 = now_s();
+    for (long i = 0; i < frames; i++) {
+        acc += tjuh_sample_frame(frame);
+        acc += frame[0].pressed;
+    }
+    t1 = now_s();
+    bench_row("sample, per frame", t0, t1, frames);
+
+    bench_sink(acc);
+}
+
+int main(int argc, char **argv)
+{
+    long reports = bench_count(argc, argv, 2000000L);
+    int failures = 0;
+
+    failures += run_script();
+    run_timing(reports);
+
+    return bench_exit(stdout, failures);
+}
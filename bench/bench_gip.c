@@ -0,0 +1,164 @@
+/*
+ * TJUH host bench — Xbox One GIP session
+ *
+ * Runs a simulated Xbox One S (sim/sim_devices.c) next to a DS4 and
+ * checks the protocol side of the GIP support: the pad must be powered
+ * on, every guide packet it sends must be acknowledged before it would
+ * have to repeat it, and input must keep flowing through the same
+ * callbacks as every other controller, guide included as
+ * TJUH_BTN_SYSTEM.
+ *
+ *   bench_gip [seconds]
+ *
+ * Exits non-zero if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "tjuh.h"
+#include "sim_usb.h"
+
+#define SYSTEM_MASK TJUH_BUTTON_MASK(TJUH_BUTTON_SYSTEM)
+
+typedef struct {
+    uint32_t reports;
+    uint32_t guide_edges;
+    uint32_t cross_edges;
+    uint32_t l2_reports;
+    uint32_t buttons;
+    uint64_t first_report_us;
+    uint64_t last_report_us;
+    uint64_t last_input_us;     /* last report with new stick data */
+    uint64_t max_gap_us;        /* between reports with new stick data */
+    uint16_t lx_last;
+    uint16_t lx_min;
+    uint16_t lx_max;
+} bench_dev_t;
+
+static bench_dev_t s_bench[SIM_MAX_DEVICES + 1];
+
+static void on_state(uint8_t dev_addr, const tjuh_gamepad_state_t *st)
+{
+    bench_dev_t *d = &s_bench[dev_addr];
+    uint64_t now = sim_now_us();
+
+    if (d->reports == 0) {
+        d->first_report_us = now;
+        d->last_input_us   = now;
+        d->lx_min = 0xFFFF;
+    }
+
+    uint32_t pressed = st->buttons & ~d->buttons;
+    if (pressed & SYSTEM_MASK)
+        d->guide_edges++;
+    if (pressed & TJUH_BUTTON_MASK(TJUH_BUTTON_CROSS))
+        d->cross_edges++;
+
+    d->buttons        = st->buttons;
+    d->last_report_us = now;
+    d->reports++;
+}
+
+static void on_ext(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                   const tjuh_gamepad_ext_t *ext)
+{
+    bench_dev_t *d = &s_bench[dev_addr];
+    uint64_t now = sim_now_us();
+
+    /* The model's stick moves on every input packet: a repeated value
+     * means the report was not fresh input (e.g. a repeated guide packet) */
+    if (ext->x != d->lx_last) {
+        if (now - d->last_input_us > d->max_gap_us)
+            d->max_gap_us = now - d->last_input_us;
+        d->last_input_us = now;
+        d->lx_last       = ext->x;
+    }
+
+    if (ext->x < d->lx_min)
+        d->lx_min = ext->x;
+    if (ext->x > d->lx_max)
+        d->lx_max = ext->x;
+
+    /* Digital L2 must agree with the analog trigger crossing half travel */
+    bool l2 = (st->buttons & TJUH_BUTTON_MASK(TJUH_BUTTON_L2)) != 0;
+    if (l2 != (ext->l2 >= 0x8000))
+        d->l2_reports = UINT32_MAX;
+    else if (l2 && d->l2_reports != UINT32_MAX)
+        d->l2_reports++;
+}
+
+static int check(FILE *out, bool ok, const char *what)
+{
+    fprintf(out, "  %-44s %s\n", what, ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = (argc > 1) ? atoi(argv[1]) : 5;
+    if (seconds < 1) {
+        fprintf(stderr, "seconds must be >= 1\n");
+        return 1;
+    }
+
+    /* Keep the results, drop the library's diagnostic output */
+    FILE *out = fdopen(dup(fileno(stdout)), "w");
+    if (!out || !freopen("/dev/null", "w", stdout))
+        return 1;
+
+    sim_reset();
+
+    tjuh_config_t config = {
+        .on_state = on_state,
+        .on_ext   = on_ext,
+    };
+    tjuh_init(&config);
+
+    uint8_t xb  = sim_plug(&sim_dev_xbox_one, 0);
+    uint8_t ds4 = sim_plug(&sim_dev_ds4, 0);
+
+    uint64_t end_us = (uint64_t)seconds * 1000000u;
+    sim_run_until(end_us, tjuh_task);
+
+    const bench_dev_t *b = &s_bench[xb];
+    sim_xbox_one_stats_t gip = sim_xbox_one_stats(xb);
+
+    /* The last guide packet may still be on the wire when the run stops */
+    uint32_t acked = gip.acks + (gip.ack_outstanding ? 1u : 0u);
+    uint64_t streamed_us = b->reports ? b->last_report_us - b->first_report_us : 0;
+
+    fprintf(out, "Xbox One GIP session, %d s simulated\n", seconds);
+    fprintf(out, "  reports:          %u (%.0f/s), DS4 alongside: %u\n",
+            (unsigned)b->reports,
+            streamed_us ? b->reports * 1e6 / (double)streamed_us : 0.0,
+            (unsigned)s_bench[ds4].reports);
+    fprintf(out, "  first report:     %.1f ms after plug\n", (double)b->first_report_us / 1000.0);
+    fprintf(out, "  max input gap:    %.1f ms\n", (double)b->max_gap_us / 1000.0);
+    fprintf(out, "  guide presses:    %u sent, %u seen\n",
+            (unsigned)gip.guide_presses, (unsigned)b->guide_edges);
+    fprintf(out, "  guide packets:    %u acked, %u repeated\n",
+            (unsigned)gip.acks, (unsigned)gip.resends);
+    fprintf(out, "  lx range:         0x%04X..0x%04X\n", b->lx_min, b->lx_max);
+
+    int fail = 0;
+    fprintf(out, "checks:\n");
+    fail += check(out, gip.powered, "powered on");
+    fail += check(out, b->reports > (uint32_t)seconds * 200u, "input keeps streaming");
+    /* A guide packet takes one 4 ms polling slot from input */
+    fail += check(out, b->max_gap_us <= 12000 && end_us - b->last_input_us <= 12000,
+                  "no stall waiting for an ack");
+    fail += check(out, gip.guide_presses > 0 && b->guide_edges + 1 >= gip.guide_presses &&
+                       b->guide_edges <= gip.guide_presses, "every guide press delivered");
+    fail += check(out, acked == 2 * gip.guide_presses ||
+                       acked + 1 == 2 * gip.guide_presses, "every guide packet acked");
+    fail += check(out, gip.resends == 0, "no guide packet repeated");
+    fail += check(out, b->cross_edges > 0 && b->lx_max > b->lx_min, "buttons and sticks parsed");
+    fail += check(out, b->l2_reports != UINT32_MAX && b->l2_reports > 0,
+                  "digital L2 matches analog trigger");
+    fail += check(out, s_bench[ds4].reports > 0, "DS4 unaffected");
+
+    fprintf(out, "%s\n", fail ? "FAILED" : "all checks passed");
+    return fail ? 1 : 0;
+}
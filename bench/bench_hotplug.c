@@ -0,0 +1,252 @@
+/*
+ * TJUH host bench — hot-plug storm
+ *
+ * One controller is streaming when a powered hub comes up with a keyboard
+ * and N more controllers behind it, all plugged at the same instant.
+ * Reports, per device, the time from plug to connect and to first parsed
+ * report, plus the longest report gap the already-running controller saw
+ * while the others enumerated.
+ *
+ *   bench_hotplug [N] [step_us]
+ *
+ *   N        controllers behind the hub
+ *   step_us  duration of each of the stack's own enumeration steps; smaller
+ *            values make devices mount faster than TJUH can enumerate them
+ *
+ * Times are simulated bus time (see sim/sim_usb.h). The library is built
+ * with logging on so enumeration does its full work, including the string
+ * descriptor fetches; its console output is discarded. Builds with
+ * TJUH_ENABLE_REPORT_TIMING also print the library's host CPU time per
+ * report (tjuh_get_report_timing).
+ *
+ * Then, on a fresh bus, a clone that only its report descriptor
+ * fingerprint identifies (sim_dev_clone8: unknown VID/PID, a 64-byte
+ * endpoint no size rule covers) must have its parser before its first
+ * report, deliver reports and never be reclassified. A DInput pad known
+ * to neither table (sim_dev_dinput) then runs its script alone: its
+ * parser must be committed on the TJUH_CLASSIFY_PROBATION_REPORTS-th
+ * agreeing report although its stick is pushed at plug-in and again
+ * later, go back on probation after as many rejected reports, and be
+ * committed again, counting one reclassification. Exits non-zero if
+ * either device does otherwise.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "tjuh_parse.h"
+#include "sim_usb.h"
+
+#define STORM_AT_US   500000u
+#define RUN_UNTIL_US  3000000u
+#define ALONE_US      500000u
+
+/* sim_dev_dinput's script (see sim_devices.c) is written for 16 */
+_Static_assert(TJUH_CLASSIFY_PROBATION_REPORTS == 16,
+               "sim_dev_dinput's script assumes TJUH_CLASSIFY_PROBATION_REPORTS == 16");
+
+/* Delivered reports (1-based) at which its parser should change: the 16th
+ * agreeing one commits; reports 24..59 follow committed; 60..75 are
+ * rejected and revert it; 76..79 are not delivered; 80..95 commit again */
+static const uint32_t s_dinput_changes[] = { 16, 16 + 36 + 1, 16 + 36 + 16 };
+
+typedef struct {
+    const sim_device_spec_t *spec;
+    uint64_t plug_us;
+    uint64_t connect_us;
+    uint64_t first_report_us;
+    uint64_t last_report_us;
+    uint64_t max_gap_us;
+    uint32_t reports;
+    uint8_t  first_parser;      /* tjuh_parse_get_parser() at the first report */
+    uint8_t  parser;            /* ... at the latest one */
+    uint8_t  changes;
+    uint32_t change_at[4];      /* reports (1-based) whose parser differs from the previous */
+} bench_dev_t;
+
+static bench_dev_t s_bench[SIM_MAX_DEVICES + 1];
+
+static const sim_device_spec_t *const s_mix[] = {
+    &sim_dev_dualsense,
+    &sim_dev_generic8,
+    &sim_dev_switch_pro,
+    &sim_dev_xbox360,
+    &sim_dev_ds4,
+};
+
+static void on_report(uint8_t dev_addr, const tjuh_gamepad_report_t *rpt)
+{
+    (void)rpt;
+    bench_dev_t *d = &s_bench[dev_addr];
+    uint64_t now = sim_now_us();
+
+    uint8_t parser = tjuh_parse_get_parser(dev_addr);
+    if (d->reports == 0) {
+        d->first_report_us = now;
+        d->first_parser    = parser;
+    } else if (now - d->last_report_us > d->max_gap_us) {
+        d->max_gap_us = now - d->last_report_us;
+    }
+
+    if (parser != d->parser && d->changes < TU_ARRAY_SIZE(d->change_at))
+        d->change_at[d->changes++] = d->reports + 1;
+    d->parser = parser;
+
+    d->last_report_us = now;
+    d->reports++;
+}
+
+static void on_connect(uint8_t dev_addr, uint16_t vid, uint16_t pid)
+{
+    (void)vid;
+    (void)pid;
+    s_bench[dev_addr].connect_us = sim_now_us();
+}
+
+static void print_ms(FILE *out, uint64_t t_us, uint64_t from_us)
+{
+    if (t_us == 0)
+        fprintf(out, "%10s", "-");
+    else
+        fprintf(out, "%10.1f", (double)(t_us - from_us) / 1000.0);
+}
+
+/* One device on a fresh bus; its address */
+static uint8_t run_alone(const tjuh_config_t *config, const sim_device_spec_t *spec)
+{
+    sim_reset();
+    memset(s_bench, 0, sizeof(s_bench));
+    tjuh_init(config);
+
+    uint8_t a = sim_plug(spec, 0);
+    s_bench[a].spec = spec;
+    sim_run_until(ALONE_US, tjuh_task);
+    return a;
+}
+
+static int check_fingerprint(FILE *out, const tjuh_config_t *config)
+{
+    uint8_t a = run_alone(config, &sim_dev_clone8);
+    const bench_dev_t *b = &s_bench[a];
+    bool ok = b->reports > 0 && b->first_parser == TJUH_PARSER_GENERIC_8BYTE &&
+              tjuh_get_reclassify_count(a) == 0;
+
+    fprintf(out, "fingerprint: %s parser %u at first report, %u reports, reclass %u%s\n",
+            b->spec->name, (unsigned)b->first_parser, (unsigned)b->reports,
+            (unsigned)tjuh_get_reclassify_count(a), ok ? "" : "  FAILED");
+    return ok ? 0 : 1;
+}
+
+static int check_probation(FILE *out, const tjuh_config_t *config)
+{
+    uint8_t a = run_alone(config, &sim_dev_dinput);
+    const bench_dev_t *b = &s_bench[a];
+    bool ok = b->changes == TU_ARRAY_SIZE(s_dinput_changes) &&
+              b->parser == TJUH_PARSER_DINPUT && tjuh_get_reclassify_count(a) == 1;
+
+    fprintf(out, "probation: %s parser changes at report", b->spec->name);
+    for (uint8_t i = 0; i < b->changes; i++) {
+        fprintf(out, " %u", (unsigned)b->change_at[i]);
+        if (i < TU_ARRAY_SIZE(s_dinput_changes) && b->change_at[i] != s_dinput_changes[i])
+            ok = false;
+    }
+    fprintf(out, " (want %u %u %u), %u reports, reclass %u%s\n",
+            (unsigned)s_dinput_changes[0], (unsigned)s_dinput_changes[1],
+            (unsigned)s_dinput_changes[2], (unsigned)b->reports,
+            (unsigned)tjuh_get_reclassify_count(a), ok ? "" : "  FAILED");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    int n       = (argc > 1) ? atoi(argv[1]) : TJUH_MAX_DEVICES - 2;
+    int step_us = (argc > 2) ? atoi(argv[2]) : 2000;
+    if (n < 1 || n > TJUH_MAX_DEVICES - 2) {
+        fprintf(stderr, "N must be 1..%d\n", TJUH_MAX_DEVICES - 2);
+        return 1;
+    }
+
+    /* Keep the results, drop the library's diagnostic output */
+    FILE *out = fdopen(dup(fileno(stdout)), "w");
+    if (!out || !freopen("/dev/null", "w", stdout))
+        return 1;
+
+    sim_reset();
+    sim_set_stack_enum_us((uint32_t)step_us, 4);
+
+    tjuh_config_t config = {
+        .on_report  = on_report,
+        .on_connect = on_connect,
+    };
+    tjuh_init(&config);
+
+    /* One controller already streaming before the hub comes up */
+    uint8_t a = sim_plug(&sim_dev_ds4, 0);
+    s_bench[a].spec = &sim_dev_ds4;
+    uint8_t first = a;
+
+    a = sim_plug(&sim_dev_keyboard, STORM_AT_US);
+    s_bench[a].spec    = &sim_dev_keyboard;
+    s_bench[a].plug_us = STORM_AT_US;
+
+    for (int i = 0; i < n; i++) {
+        const sim_device_spec_t *spec = s_mix[i % TU_ARRAY_SIZE(s_mix)];
+        a = sim_plug(spec, STORM_AT_US);
+        s_bench[a].spec    = spec;
+        s_bench[a].plug_us = STORM_AT_US;
+    }
+
+    /* Track the running controller's worst gap only across the storm */
+    sim_run_until(STORM_AT_US, tjuh_task);
+    s_bench[first].max_gap_us = 0;
+
+    sim_run_until(RUN_UNTIL_US, tjuh_task);
+
+    fprintf(out, "hot-plug storm: %d controllers + keyboard, stack step %d us, "
+                 "TJUH_ENUM_MAX_CONCURRENT=%d\n", n, step_us, TJUH_ENUM_MAX_CONCURRENT);
+    fprintf(out, "%-4s %-16s %10s %10s %10s %8s\n", "dev", "device", "connect", "ttfr", "reports",
+            "reclass");
+    fprintf(out, "%-4s %-16s %10s %10s %10s %8s\n", "", "", "[ms]", "[ms]", "", "");
+
+    uint64_t worst_ttfr = 0;
+    for (uint8_t d = 1; d <= SIM_MAX_DEVICES; d++) {
+        const bench_dev_t *b = &s_bench[d];
+        if (!b->spec)
+            continue;
+
+        fprintf(out, "%-4u %-16s", d, b->spec->name);
+        print_ms(out, b->connect_us, b->plug_us);
+        print_ms(out, b->first_report_us, b->plug_us);
+        fprintf(out, "%10u %8u\n", (unsigned)b->reports, (unsigned)tjuh_get_reclassify_count(d));
+
+        if (d != first && b->spec != &sim_dev_keyboard && b->first_report_us) {
+            uint64_t ttfr = b->first_report_us - b->plug_us;
+            if (ttfr > worst_ttfr)
+                worst_ttfr = ttfr;
+        }
+    }
+
+    fprintf(out, "last controller ttfr:      %.1f ms\n", (double)worst_ttfr / 1000.0);
+    fprintf(out, "running pad max gap:       %.1f ms\n", (double)s_bench[first].max_gap_us / 1000.0);
+    fprintf(out, "control pipe busy rejects: %u\n", (unsigned)sim_control_busy_rejects());
+
+#if TJUH_ENABLE_REPORT_TIMING
+    tjuh_report_timing_t timing;
+    if (tjuh_get_report_timing(&timing, false)) {
+        double per_us = timing.ticks_per_us;
+        fprintf(out, "library time per report:   min %.2f / mean %.2f / max %.2f us (host, %u reports)\n",
+                timing.min / per_us, timing.mean / per_us, timing.max / per_us,
+                (unsigned)timing.count);
+    }
+#endif
+
+    int failures = check_fingerprint(out, &config);
+    failures += check_probation(out, &config);
+
+    int rc = bench_exit(out, failures);
+    fclose(out);
+    return rc;
+}
@@ -0,0 +1,530 @@
+/*
+ * TJUH host bench — fixed-point IMU fusion
+ *
+ * Synthesises DS4, DualSense and Switch Pro reports for a known motion
+ * (tilted at rest, rotations about each axis and all three, at rest
+ * again), runs them through tjuh_imu_process() and compares the
+ * orientation with the true one and with the same filter in double
+ * precision fed the same calibrated samples. A DS4 calibration feature
+ * report with known bias and gain is checked against the samples it
+ * should produce. Finally times tjuh_imu_process() and tjuh_imu_fuse()
+ * per sample.
+ *
+ *   bench_imu [samples]
+ *
+ * `samples` is the timing run length (default 2000000). Exits non-zero
+ * if the fixed-point estimate strays more than MAX_VS_FLOAT_DEG from the
+ * double-precision one, the tilt is more than MAX_TILT_DEG off once at
+ * rest, or a calibrated sample is off by more than 2 LSB. Times are host
+ * CPU time; the TSC column is host timestamp-counter ticks.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#include "bench_util.h"
+#include "tjuh_imu.h"
+#include "tjuh_parse.h"
+
+#define REPORT_LEN       64
+#define MAX_VS_FLOAT_DEG 0.5
+#define MAX_TILT_DEG     0.5
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* ---------------------------------------------------------------------- */
+/*  Motion script                                                         */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    double seconds;
+    double rate_dps[3];     /* body rate, controller frame */
+} segment_t;
+
+static const segment_t s_script[] = {
+    { 1.0, {   0,   0,   0 } },
+    { 2.0, {   0,  90,   0 } },
+    { 1.0, {  60,   0,   0 } },
+    { 1.0, {   0,   0, -45 } },
+    { 2.0, {  30, -45,  60 } },
+    { 3.0, {   0,   0,   0 } },
+};
+
+/* The final segment is at rest; tilt is checked after this long in it */
+#define REST_SETTLE_S 1.5
+
+typedef struct {
+    const char *name;
+    uint8_t     parser;
+    uint8_t     dev_addr;
+    uint32_t    period_us;          /* between samples */
+    uint8_t     samples_per_report;
+    double      gyro_lsb_per_dps;   /* raw, at the nominal calibration */
+    double      accel_lsb_per_g;
+} imu_case_t;
+
+static const imu_case_t s_cases[] = {
+    { "DS4",        TJUH_PARSER_DS4,       1, 4000, 1, 16.0,   8192.0 },
+    { "DualSense",  TJUH_PARSER_DUALSENSE, 2, 4000, 1, 16.0,   8192.0 },
+    { "Switch Pro", TJUH_PARSER_SWITCH,    3, 5000, 3, 16.384, 4096.0 },
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Quaternion helpers (double)                                           */
+/* ---------------------------------------------------------------------- */
+
+typedef struct { double w, x, y, z; } quat_t;
+
+static quat_t quat_mul(quat_t a, quat_t b)
+{
+    quat_t r = {
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+    };
+    return r;
+}
+
+static quat_t quat_norm(quat_t q)
+{
+    double n = sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    quat_t r = { q.w / n, q.x / n, q.y / n, q.z / n };
+    return r;
+}
+
+/* World +y seen from the controller frame: R(q)^T (0, 1, 0) */
+static void quat_up(quat_t q, double v[3])
+{
+    v[0] = 2 * (q.x * q.y + q.w * q.z);
+    v[1] = q.w * q.w - q.x * q.x + q.y * q.y - q.z * q.z;
+    v[2] = 2 * (q.y * q.z - q.w * q.x);
+}
+
+/* Rotation between a and b, from conj(a) * b (well conditioned near 0) */
+static double quat_angle_deg(quat_t a, quat_t b)
+{
+    quat_t ca = { a.w, -a.x, -a.y, -a.z };
+    quat_t d  = quat_mul(ca, b);
+    double v  = sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+    return 2 * atan2(v, fabs(d.w)) * 180 / M_PI;
+}
+
+static double tilt_angle_deg(quat_t a, quat_t b)
+{
+    double va[3];
+    double vb[3];
+
+    quat_up(a, va);
+    quat_up(b, vb);
+    double cx = va[1] * vb[2] - va[2] * vb[1];
+    double cy = va[2] * vb[0] - va[0] * vb[2];
+    double cz = va[0] * vb[1] - va[1] * vb[0];
+    double d  = va[0] * vb[0] + va[1] * vb[1] + va[2] * vb[2];
+    return atan2(sqrt(cx * cx + cy * cy + cz * cz), d) * 180 / M_PI;
+}
+
+static quat_t quat_from_q14(const int16_t q[4])
+{
+    quat_t r = { q[0] / 16384.0, q[1] / 16384.0, q[2] / 16384.0, q[3] / 16384.0 };
+    return quat_norm(r);
+}
+
+/* Shortest rotation taking the controller-frame direction u onto +y */
+static quat_t quat_tilt(const double u[3])
+{
+    double n = sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+    quat_t q = { 1 + u[1] / n, -u[2] / n, 0, u[0] / n };
+
+    if (q.w < 1.0 / 64) {
+        quat_t flip = { 0, 1, 0, 0 };
+        return flip;
+    }
+    return quat_norm(q);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Reference filter: the same Mahony update in double precision          */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    quat_t q;
+    int    seeded;
+} ref_fusion_t;
+
+static void ref_fuse(ref_fusion_t *f, const int16_t gyro[3], const int16_t accel[3], double dt)
+{
+    double a[3] = { accel[0] / 4096.0, accel[1] / 4096.0, accel[2] / 4096.0 };
+
+    if (!f->seeded) {
+        f->q = quat_tilt(a);
+        f->seeded = 1;
+        return;
+    }
+
+    double k = M_PI / 180 / TJUH_IMU_GYRO_LSB_PER_DPS;
+    double w[3] = { gyro[0] * k, gyro[1] * k, gyro[2] * k };
+    double an = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+
+    if (an > 0.75 && an < 1.25) {
+        double v[3];
+        double kp = TJUH_IMU_FUSION_GAIN / 256.0;
+
+        quat_up(f->q, v);
+        for (int i = 0; i < 3; i++)
+            a[i] /= an;
+        w[0] += kp * (a[1] * v[2] - a[2] * v[1]);
+        w[1] += kp * (a[2] * v[0] - a[0] * v[2]);
+        w[2] += kp * (a[0] * v[1] - a[1] * v[0]);
+    }
+
+    quat_t h  = { 0, w[0] * dt / 2, w[1] * dt / 2, w[2] * dt / 2 };
+    quat_t dq = quat_mul(f->q, h);
+    f->q.w += dq.w;
+    f->q.x += dq.x;
+    f->q.y += dq.y;
+    f->q.z += dq.z;
+    f->q = quat_norm(f->q);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Report synthesis                                                      */
+/* ---------------------------------------------------------------------- */
+
+static uint32_t s_rng = 0x2468ACE1u;
+
+static int noise(int amplitude)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return (int)((s_rng >> 16) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+static int16_t raw16(double v)
+{
+    long r = lround(v) + noise(2);
+    if (r > 32767)
+        r = 32767;
+    if (r < -32768)
+        r = -32768;
+    return (int16_t)r;
+}
+
+static void put16(uint8_t *p, int16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)((uint16_t)v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+/* One sample (controller-frame rate in deg/s, accel in g) into a report */
+static void put_sample(const imu_case_t *c, uint8_t *r, uint8_t slot, uint32_t t_us,
+                       const double rate_dps[3], const double accel_g[3])
+{
+    int16_t g[3];
+    int16_t a[3];
+
+    for (int i = 0; i < 3; i++) {
+        g[i] = raw16(rate_dps[i] * c->gyro_lsb_per_dps);
+        a[i] = raw16(accel_g[i] * c->accel_lsb_per_g);
+    }
+
+    switch (c->parser) {
+        case TJUH_PARSER_DS4:
+            r[0] = 0x01;
+            r[10] = (uint8_t)(t_us * 3 / 16);
+            r[11] = (uint8_t)((t_us * 3 / 16) >> 8);
+            for (int i = 0; i < 3; i++) {
+                put16(&r[13 + 2 * i], g[i]);
+                put16(&r[19 + 2 * i], a[i]);
+            }
+            break;
+
+        case TJUH_PARSER_DUALSENSE:
+            r[0] = 0x01;
+            for (int i = 0; i < 3; i++) {
+                put16(&r[16 + 2 * i], g[i]);
+                put16(&r[22 + 2 * i], a[i]);
+            }
+            put32(&r[28], t_us * 3);
+            break;
+
+        case TJUH_PARSER_SWITCH: {
+            /* Sensor axes: x' = -z, y' = -x, z' = y */
+            uint8_t *p = &r[13 + 12 * slot];
+            r[0] = 0x30;
+            put16(&p[0],  (int16_t)-a[2]);
+            put16(&p[2],  (int16_t)-a[0]);
+            put16(&p[4],  a[1]);
+            put16(&p[6],  (int16_t)-g[2]);
+            put16(&p[8],  (int16_t)-g[0]);
+            put16(&p[10], g[1]);
+            break;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Accuracy                                                              */
+/* ---------------------------------------------------------------------- */
+
+static double script_seconds(void)
+{
+    double t = 0;
+    for (size_t i = 0; i < ARRAY_SIZE(s_script); i++)
+        t += s_script[i].seconds;
+    return t;
+}
+
+static const segment_t *script_at(double t)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(s_script); i++) {
+        if (t < s_script[i].seconds)
+            return &s_script[i];
+        t -= s_script[i].seconds;
+    }
+    return &s_script[ARRAY_SIZE(s_script) - 1];
+}
+
+static int run_accuracy(const imu_case_t *c)
+{
+    static const double initial_up[3] = { 0.30, 0.85, -0.40 };
+    const double dt = c->period_us * 1e-6;
+    const double total = script_seconds();
+    const double rest_from = total - s_script[ARRAY_SIZE(s_script) - 1].seconds + REST_SETTLE_S;
+
+    quat_t truth = quat_tilt(initial_up);
+    quat_t truth_pending[TJUH_IMU_MAX_SAMPLES];
+    ref_fusion_t ref = { { 1, 0, 0, 0 }, 0 };
+    uint8_t report[REPORT_LEN];
+    uint8_t slot = 0;
+    uint32_t t_us = 0;
+    long samples = 0;
+
+    double max_vs_float = 0;
+    double max_vs_truth = 0;
+    double max_rest_tilt = 0;
+
+    tjuh_imu_release(c->dev_addr);
+    memset(report, 0, sizeof(report));
+
+    for (double t = 0; t < total; t += dt) {
+        const segment_t *seg = script_at(t);
+        double w = sqrt(seg->rate_dps[0] * seg->rate_dps[0] +
+                        seg->rate_dps[1] * seg->rate_dps[1] +
+                        seg->rate_dps[2] * seg->rate_dps[2]) * M_PI / 180;
+
+        /* The sample reports the rate over the step that ends at it */
+        if (samples > 0 && w > 0) {
+            double s = sin(w * dt / 2) / w * M_PI / 180;
+            quat_t step = { cos(w * dt / 2), seg->rate_dps[0] * s,
+                            seg->rate_dps[1] * s, seg->rate_dps[2] * s };
+            truth = quat_norm(quat_mul(truth, step));
+        }
+
+        double up[3];
+        quat_up(truth, up);
+        put_sample(c, report, slot, t_us, samples > 0 ? seg->rate_dps : (const double[3]){0, 0, 0},
+                   up);
+        truth_pending[slot++] = truth;
+        t_us += c->period_us;
+        samples++;
+
+        if (slot < c->samples_per_report)
+            continue;
+
+        tjuh_imu_sample_t out[TJUH_IMU_MAX_SAMPLES];
+        uint8_t n = tjuh_imu_process(c->dev_addr, c->parser, report, REPORT_LEN, out);
+        if (n != c->samples_per_report) {
+            printf("%s: %u samples from a report, expected %u\n", c->name, n,
+                   c->samples_per_report);
+            return 1;
+        }
+
+        for (uint8_t i = 0; i < n; i++) {
+            ref_fuse(&ref, out[i].gyro, out[i].accel, ref.seeded ? dt : 0);
+
+            quat_t est = quat_from_q14(out[i].quat);
+            double vs_float = quat_angle_deg(est, ref.q);
+            double vs_truth = quat_angle_deg(est, truth_pending[i]);
+
+            if (vs_float > max_vs_float)
+                max_vs_float = vs_float;
+            if (vs_truth > max_vs_truth)
+                max_vs_truth = vs_truth;
+
+            double ts = (samples - n + i) * dt;
+            if (ts >= rest_from) {
+                double tilt = tilt_angle_deg(est, truth_pending[i]);
+                if (tilt > max_rest_tilt)
+                    max_rest_tilt = tilt;
+            }
+        }
+        slot = 0;
+    }
+
+    int fail = (max_vs_float > MAX_VS_FLOAT_DEG) || (max_rest_tilt > MAX_TILT_DEG);
+    printf("%-12s %8ld %14.3f %14.3f %14.3f%s\n", c->name, samples, max_vs_float,
+           max_rest_tilt, max_vs_truth, fail ? "  FAIL" : "");
+    return fail;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Calibration report                                                    */
+/* ---------------------------------------------------------------------- */
+
+static int run_calibration(void)
+{
+    /* Gyro: bias per axis, 1.25x the nominal sensitivity; accel: offsets */
+    static const int16_t gyro_bias[3] = { 10, -20, 5 };
+    static const int16_t acc_plus[3]  = { 8000, 8300, 8150 };
+    static const int16_t acc_minus[3] = { -8400, -8100, -8250 };
+    static const double  rate_dps[3]  = { 100, -50, 25 };
+    static const double  accel_g[3]   = { 0.10, 0.98, -0.20 };
+    const uint8_t dev = 4;
+    uint8_t feature[37] = { 0x02 };
+    uint8_t report[REPORT_LEN] = { 0x01 };
+    int fail = 0;
+
+    for (int i = 0; i < 3; i++) {
+        put16(&feature[1 + 2 * i], gyro_bias[i]);
+        put16(&feature[7 + 4 * i], 6912);
+        put16(&feature[9 + 4 * i], -6912);
+        put16(&feature[23 + 4 * i], acc_plus[i]);
+        put16(&feature[25 + 4 * i], acc_minus[i]);
+    }
+    put16(&feature[19], 540);
+    put16(&feature[21], 540);
+
+    tjuh_imu_release(dev);
+    tjuh_imu_set_calib(dev, TJUH_PARSER_DS4, feature, sizeof(feature));
+
+    /* Raw counts the calibrated sensor would produce */
+    for (int i = 0; i < 3; i++) {
+        double range_2g = acc_plus[i] - acc_minus[i];
+        double bias     = acc_plus[i] - range_2g / 2;
+        put16(&report[13 + 2 * i], (int16_t)lround(rate_dps[i] * 16 / 1.25 + gyro_bias[i]));
+        put16(&report[19 + 2 * i], (int16_t)lround(accel_g[i] * range_2g / 2 + bias));
+    }
+
+    tjuh_imu_sample_t out[TJUH_IMU_MAX_SAMPLES];
+    if (tjuh_imu_process(dev, TJUH_PARSER_DS4, report, REPORT_LEN, out) != 1)
+        return 1;
+
+    for (int i = 0; i < 3; i++) {
+        long want_g = lround(rate_dps[i] * TJUH_IMU_GYRO_LSB_PER_DPS);
+        long want_a = lround(accel_g[i] * TJUH_IMU_ACCEL_LSB_PER_G);
+        if (labs(out[0].gyro[i] - want_g) > 2 || labs(out[0].accel[i] - want_a) > 2) {
+            printf("calibration axis %d: gyro %d (want %ld), accel %d (want %ld)\n", i,
+                   out[0].gyro[i], want_g, out[0].accel[i], want_a);
+            fail = 1;
+        }
+    }
+
+    printf("DS4 calibration report: %s\n", fail ? "FAIL" : "ok");
+    return fail;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static uint64_t ticks(void)
+{
+#if HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void run_timing(long samples)
+{
+    static uint8_t pool[1024][REPORT_LEN];
+    static int16_t gyro[1024][3];
+    static int16_t accel[1024][3];
+    const imu_case_t *c = &s_cases[0];
+    const uint8_t dev = 5;
+    volatile int32_t sink = 0;
+
+    /* Random rates up to 500 deg/s around a roughly level pad */
+    for (unsigned i = 0; i < ARRAY_SIZE(pool); i++) {
+        double rate[3] = { noise(500), noise(500), noise(500) };
+        double a[3]    = { noise(20) / 100.0, 1 + noise(20) / 100.0, noise(20) / 100.0 };
+        memset(pool[i], 0, REPORT_LEN);
+        put_sample(c, pool[i], 0, i * c->period_us, rate, a);
+        for (int k = 0; k < 3; k++) {
+            gyro[i][k]  = (int16_t)(rate[k] * TJUH_IMU_GYRO_LSB_PER_DPS);
+            accel[i][k] = (int16_t)(a[k] * TJUH_IMU_ACCEL_LSB_PER_G);
+        }
+    }
+
+    tjuh_imu_release(dev);
+    tjuh_imu_sample_t out[TJUH_IMU_MAX_SAMPLES];
+
+    double   t0 = now_s();
+    uint64_t c0 = ticks();
+    for (long i = 0; i < samples; i++) {
+        tjuh_imu_process(dev, c->parser, pool[i % ARRAY_SIZE(pool)], REPORT_LEN, out);
+        sink += out[0].quat[0];
+    }
+    uint64_t c1 = ticks();
+    double   t1 = now_s();
+
+    tjuh_imu_fusion_t f;
+    tjuh_imu_fusion_reset(&f);
+
+    double   t2 = now_s();
+    uint64_t c2 = ticks();
+    for (long i = 0; i < samples; i++) {
+        tjuh_imu_fuse(&f, gyro[i % ARRAY_SIZE(gyro)], accel[i % ARRAY_SIZE(accel)], 4000);
+        sink += f.q[0];
+    }
+    uint64_t c3 = ticks();
+    double   t3 = now_s();
+
+    (void)sink;
+    printf("\n%-28s %10s %10s\n", "per sample", "[ns]", HAVE_TSC ? "[tsc]" : "");
+    printf("%-28s %10.2f %10.1f\n", "tjuh_imu_process (DS4)",
+           (t1 - t0) * 1e9 / samples, (double)(c1 - c0) / samples);
+    printf("%-28s %10.2f %10.1f\n", "tjuh_imu_fuse",
+           (t3 - t2) * 1e9 / samples, (double)(c3 - c2) / samples);
+}
+
+int main(int argc, char **argv)
+{
+    long samples = (argc > 1) ? atol(argv[1]) : 2000000L;
+    int failures = 0;
+
+    if (samples < 1)
+        samples = 1;
+
+    printf("fusion gain %.3f rad/s per rad, %.0f s script\n",
+           TJUH_IMU_FUSION_GAIN / 256.0, script_seconds());
+    printf("%-12s %8s %14s %14s %14s\n", "controller", "samples", "vs float [deg]",
+           "rest tilt [deg]", "vs truth [deg]");
+
+    for (size_t i = 0; i < ARRAY_SIZE(s_cases); i++)
+        failures += run_accuracy(&s_cases[i]);
+
+    failures += run_calibration();
+    run_timing(samples);
+
+    printf("failures: %d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,463 @@
+/*
+ * TJUH host bench — table-driven vs reference button parsing
+ *
+ * Feeds the same raw reports through the production (lookup-table) parsers
+ * and the original bit-by-bit reference parsers, checks that every parsed
+ * state converts to the same packed report (reserved bits aside), that
+ * the extended 16-bit axes agree with the 8-bit ones, then times the
+ * table path with and without the extended report and the reference.
+ *
+ * The same reports also go through the hand-written parsers the report
+ * layout tables replaced (tjuh_layout.h): the generated parsers must
+ * produce identical states and extended reports, and take no longer.
+ * The run fails if, summed over all parsers, the generated ones are more
+ * than LAYOUT_SLACK slower.
+ *
+ *   bench_parse [reports]
+ *
+ * Every value of every button byte is covered, the remaining bytes being
+ * random; `reports` further fully random reports follow (default 1000000).
+ * Timings are host CPU time and only indicate the relative cost; on the
+ * RP2040 the bitfield read-modify-writes of the reference path are
+ * comparatively more expensive.
+ *
+ * A second pass runs registered devices through tjuh_parse_report() with
+ * and without a remap profile, checks the remapped reports against the
+ * reference parser followed by a bit-by-bit remap, switches profiles
+ * while reports keep arriving, and times both. A device without a quirk
+ * entry is checked the same way while the heuristic classifies it, after
+ * its parser is committed and after tjuh_parse_task() has built its
+ * tables, and must end up on the settled path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "tjuh_parse.h"
+
+#define REPORT_LEN   20
+#define TIMING_RUNS  4000000u
+#define TIMING_ROUNDS 5         /* best of, per path */
+#define LAYOUT_SLACK  1.10
+
+typedef struct {
+    const char *name;
+    uint8_t     parser;
+    uint8_t     report_id;      /* forced into data[0], 0 = leave random */
+    uint16_t    len;
+    uint8_t     button_bytes[4];
+    uint8_t     button_count;
+    bool        no_reference;   /* no bit-by-bit parser to compare with */
+} parse_case_t;
+
+static const parse_case_t s_cases[] = {
+    { "Xbox 360",         TJUH_PARSER_XBOX360,       0x00, 20, { 2, 3, 4, 5 }, 4, false },
+    { "Generic 8-byte",   TJUH_PARSER_GENERIC_8BYTE, 0x00,  8, { 5, 6 },       2, false },
+    { "Switch full 0x30", TJUH_PARSER_SWITCH,        0x30, 12, { 3, 4, 5 },    3, false },
+    { "Switch 0x3F",      TJUH_PARSER_SWITCH,        0x3F,  8, { 1, 2, 3 },    3, false },
+    { "DS4",              TJUH_PARSER_DS4,           0x01, 20, { 5, 6, 7 },    3, false },
+    { "DualSense",        TJUH_PARSER_DUALSENSE,     0x01, 20, { 8, 9, 10 },   3, false },
+    { "DInput",           TJUH_PARSER_DINPUT,        0x02,  9, { 5, 6, 7 },    3, false },
+    { "Generic 3-byte",   TJUH_PARSER_GENERIC_3BYTE, 0x00,  3, { 2 },          1, false },
+    { "Xbox One",         TJUH_PARSER_XBOX_ONE,      0x20, 18, { 4, 5 },       2, true  },
+};
+
+typedef struct {
+    const char *name;
+    uint16_t    vid;
+    uint16_t    pid;
+    uint8_t     case_index;     /* s_cases entry supplying the reports */
+} remap_case_t;
+
+static const remap_case_t s_remap_cases[] = {
+    { "Xbox 360",   0x045E, 0x028E, 0 },
+    { "Switch Pro", 0x057E, 0x2009, 2 },
+    { "DS4",        0x054C, 0x05C4, 4 },
+};
+
+static uint32_t s_rng = 0x12345678u;
+
+static uint8_t rnd8(void)
+{
+    /* xorshift32 */
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return (uint8_t)s_rng;
+}
+
+static void random_report(const parse_case_t *c, uint8_t *data)
+{
+    for (int i = 0; i < REPORT_LEN; i++)
+        data[i] = rnd8();
+    if (c->report_id)
+        data[0] = c->report_id;
+}
+
+static bool state_equal(const tjuh_gamepad_state_t *a, const tjuh_gamepad_state_t *b)
+{
+    return a->buttons == b->buttons && a->axes == b->axes && a->hat == b->hat;
+}
+
+/* Buttons only the state carries: DualSense mute, Edge Fn and paddles */
+static uint32_t extended_buttons(const parse_case_t *c, const uint8_t *data)
+{
+    if (c->parser != TJUH_PARSER_DUALSENSE)
+        return 0;
+
+    uint8_t v = data[10];
+    return ((v & 0x04) ? TJUH_BUTTON_MASK(TJUH_BUTTON_MUTE)     : 0) |
+           ((v & 0x10) ? TJUH_BUTTON_MASK(TJUH_BUTTON_FN_L)     : 0) |
+           ((v & 0x20) ? TJUH_BUTTON_MASK(TJUH_BUTTON_FN_R)     : 0) |
+           ((v & 0x40) ? TJUH_BUTTON_MASK(TJUH_BUTTON_PADDLE_L) : 0) |
+           ((v & 0x80) ? TJUH_BUTTON_MASK(TJUH_BUTTON_PADDLE_R) : 0);
+}
+
+static bool compare_one(const parse_case_t *c, const uint8_t *data)
+{
+    tjuh_gamepad_state_t  state = {0};
+    tjuh_gamepad_report_t fast  = {0};
+    tjuh_gamepad_report_t ref   = {0};
+
+    tjuh_gamepad_state_t  state_ext = {0};
+    tjuh_gamepad_ext_t    ext       = {0};
+
+    bool ok_fast = tjuh_parse_with(c->parser, data, c->len, &state, NULL);
+    bool ok_ext  = tjuh_parse_with(c->parser, data, c->len, &state_ext, &ext);
+    bool ok_ref  = tjuh_parse_with_reference(c->parser, data, c->len, &ref);
+
+    tjuh_gamepad_state_t  state_hand = {0};
+    tjuh_gamepad_ext_t    ext_hand   = {0};
+    bool ok_hand = tjuh_parse_with_handwritten(c->parser, data, c->len, &state_hand, &ext_hand);
+
+    tjuh_state_to_report(&state, &fast);
+    /* The DS4 frame counter the old parser copied along is not a button */
+    ref.reserved_bits = 0;
+    ref.reserved_byte = 0;
+
+    bool ext_ok = !ok_fast ||
+                  ((state.buttons & ~TJUH_REPORT_BUTTONS_MASK) == extended_buttons(c, data) &&
+                   ok_ext && state_equal(&state, &state_ext) &&
+                   (ext.x >> 8) == state.x && (ext.y >> 8) == state.y &&
+                   (ext.z >> 8) == state.z && (ext.rz >> 8) == state.rz);
+
+    bool ref_ok = c->no_reference ||
+                  (ok_fast == ok_ref && memcmp(&fast, &ref, sizeof(fast)) == 0);
+
+    /* Layout tables against the hand-written parsers: bit for bit */
+    bool hand_ok = ok_hand == ok_ext && state_equal(&state_ext, &state_hand) &&
+                   memcmp(&ext, &ext_hand, sizeof(ext)) == 0;
+
+    if (!ref_ok || !ext_ok || !hand_ok) {
+        fprintf(stderr, "%s: mismatch for raw", c->name);
+        for (int i = 0; i < c->len; i++)
+            fprintf(stderr, " %02x", data[i]);
+        fprintf(stderr, "\n");
+        return false;
+    }
+    return true;
+}
+
+typedef enum {
+    PATH_TABLE,
+    PATH_TABLE_EXT,
+    PATH_HAND,
+    PATH_HAND_EXT,
+    PATH_REFERENCE,
+    PATH_COUNT
+} parse_path_t;
+
+static double time_ns(const parse_case_t *c, const uint8_t (*pool)[REPORT_LEN], unsigned pool_n,
+                      parse_path_t path)
+{
+    volatile uint32_t sink = 0;
+    tjuh_gamepad_state_t  st  = {0};
+    tjuh_gamepad_ext_t    ext = {0};
+    tjuh_gamepad_report_t rpt = {0};
+
+    double t0 = now_s();
+    if (path == PATH_REFERENCE) {
+        for (unsigned i = 0; i < TIMING_RUNS; i++) {
+            tjuh_parse_with_reference(c->parser, pool[i % pool_n], c->len, &rpt);
+            sink += rpt.dpad_buttons_byte + rpt.trigger_buttons_byte + rpt.extra_buttons_byte;
+        }
+    } else if (path == PATH_HAND_EXT) {
+        for (unsigned i = 0; i < TIMING_RUNS; i++) {
+            tjuh_parse_with_handwritten(c->parser, pool[i % pool_n], c->len, &st, &ext);
+            sink += st.buttons + st.hat + ext.x + ext.l2;
+        }
+    } else if (path == PATH_HAND) {
+        for (unsigned i = 0; i < TIMING_RUNS; i++) {
+            tjuh_parse_with_handwritten(c->parser, pool[i % pool_n], c->len, &st, NULL);
+            sink += st.buttons + st.hat;
+        }
+    } else if (path == PATH_TABLE_EXT) {
+        for (unsigned i = 0; i < TIMING_RUNS; i++) {
+            tjuh_parse_with(c->parser, pool[i % pool_n], c->len, &st, &ext);
+            sink += st.buttons + st.hat + ext.x + ext.l2;
+        }
+    } else {
+        for (unsigned i = 0; i < TIMING_RUNS; i++) {
+            tjuh_parse_with(c->parser, pool[i % pool_n], c->len, &st, NULL);
+            sink += st.buttons + st.hat;
+        }
+    }
+    double t1 = now_s();
+
+    (void)sink;
+    return (t1 - t0) * 1e9 / TIMING_RUNS;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Remap profiles                                                        */
+/* ---------------------------------------------------------------------- */
+
+/* What a profile should do to an already parsed state, one bit at a time */
+static void remap_reference(const tjuh_remap_profile_t *p, tjuh_gamepad_state_t *rpt)
+{
+    uint32_t out = 0;
+
+    for (int b = 0; b < TJUH_BUTTON_COUNT; b++) {
+        if (tjuh_state_pressed(rpt, (tjuh_button_t)b) && p->button[b] != TJUH_BUTTON_NONE)
+            out |= TJUH_BUTTON_MASK(p->button[b]);
+    }
+    rpt->buttons = out;
+
+    if (p->swap_sticks) {
+        uint8_t x = rpt->x, y = rpt->y;
+        rpt->x = rpt->z;
+        rpt->y = rpt->rz;
+        rpt->z = x;
+        rpt->rz = y;
+    }
+    if (p->axis_invert & TJUH_AXIS_X)  rpt->x  ^= 0xFF;
+    if (p->axis_invert & TJUH_AXIS_Y)  rpt->y  ^= 0xFF;
+    if (p->axis_invert & TJUH_AXIS_Z)  rpt->z  ^= 0xFF;
+    if (p->axis_invert & TJUH_AXIS_RZ) rpt->rz ^= 0xFF;
+}
+
+/* Nintendo face layout, Select/Start swapped, sticks swapped, Y inverted */
+static void nintendo_profile(tjuh_remap_profile_t *p)
+{
+    tjuh_remap_profile_init(p);
+    p->button[TJUH_BUTTON_CROSS]    = TJUH_BUTTON_CIRCLE;
+    p->button[TJUH_BUTTON_CIRCLE]   = TJUH_BUTTON_CROSS;
+    p->button[TJUH_BUTTON_SQUARE]   = TJUH_BUTTON_TRIANGLE;
+    p->button[TJUH_BUTTON_TRIANGLE] = TJUH_BUTTON_SQUARE;
+    p->button[TJUH_BUTTON_SELECT]   = TJUH_BUTTON_START;
+    p->button[TJUH_BUTTON_START]    = TJUH_BUTTON_SELECT;
+    p->button[TJUH_BUTTON_EXTRA]    = TJUH_BUTTON_NONE;
+    p->swap_sticks = true;
+    p->axis_invert = TJUH_AXIS_Y;
+}
+
+static double time_device_ns(uint8_t dev_addr, const parse_case_t *c,
+                             const uint8_t (*pool)[REPORT_LEN], unsigned pool_n)
+{
+    volatile uint32_t sink = 0;
+    tjuh_gamepad_state_t st = {0};
+
+    double t0 = now_s();
+    for (unsigned i = 0; i < TIMING_RUNS; i++) {
+        tjuh_parse_report(dev_addr, pool[i % pool_n], c->len, 64, &st, NULL, TJUH_HINT_NONE);
+        sink += st.axes + st.buttons + st.hat;
+    }
+    double t1 = now_s();
+
+    (void)sink;
+    return (t1 - t0) * 1e9 / TIMING_RUNS;
+}
+
+static int bench_remap(long n, uint8_t (*pool)[REPORT_LEN], unsigned pool_n)
+{
+    tjuh_remap_profile_t nintendo;
+    tjuh_remap_profile_t identity;
+    int failures = 0;
+
+    nintendo_profile(&nintendo);
+    tjuh_remap_profile_init(&identity);
+
+    printf("\n%-18s %10s %12s %12s\n", "device", "checked", "plain [ns]", "remap [ns]");
+
+    for (size_t ri = 0; ri < ARRAY_SIZE(s_remap_cases); ri++) {
+        const remap_case_t *r = &s_remap_cases[ri];
+        const parse_case_t *c = &s_cases[r->case_index];
+        uint8_t dev_addr = (uint8_t)(ri + 1);
+        uint8_t data[REPORT_LEN];
+        long checked = 0;
+
+        tjuh_parse_init_device(dev_addr, r->vid, r->pid);
+
+        for (unsigned i = 0; i < pool_n; i++)
+            random_report(c, pool[i]);
+        double t_plain = time_device_ns(dev_addr, c, (const uint8_t (*)[REPORT_LEN])pool, pool_n);
+
+        /* Switch profiles every 7 reports; each report must match one profile exactly */
+        for (long i = 0; i < n; i++) {
+            const tjuh_remap_profile_t *p = ((i / 7) & 1) ? &nintendo : &identity;
+            if (i % 7 == 0)
+                tjuh_set_remap_profile(dev_addr, p);
+
+            tjuh_gamepad_state_t  got  = {0};
+            tjuh_gamepad_state_t  want = {0};
+            tjuh_gamepad_report_t ref  = {0};
+            tjuh_gamepad_ext_t    ext  = {0};
+            random_report(c, data);
+
+            bool ok_got  = tjuh_parse_report(dev_addr, data, c->len, 64, &got, &ext, TJUH_HINT_NONE);
+            bool ok_want = tjuh_parse_with_reference(c->parser, data, c->len, &ref);
+            tjuh_report_to_state(&ref, &want);
+            remap_reference(p, &want);
+
+            /* The extended axes go through the same swap and inversion */
+            bool ext_ok = (ext.x >> 8) == got.x && (ext.y >> 8) == got.y &&
+                          (ext.z >> 8) == got.z && (ext.rz >> 8) == got.rz;
+
+            if (ok_got != ok_want || (ok_got && (!state_equal(&got, &want) || !ext_ok))) {
+                fprintf(stderr, "%s: remap mismatch at report %ld\n", r->name, i);
+                failures++;
+            }
+            checked++;
+        }
+
+        tjuh_set_remap_profile(dev_addr, &nintendo);
+        double t_remap = time_device_ns(dev_addr, c, (const uint8_t (*)[REPORT_LEN])pool, pool_n);
+
+        printf("%-18s %10ld %12.2f %12.2f\n", r->name, checked, t_plain, t_remap);
+        tjuh_parse_free_device(dev_addr);
+    }
+
+    return failures;
+}
+
+/* An unknown 8-byte pad: the profile must hold on probation, right after
+ * the commit (tables not yet built) and once tjuh_parse_task() ran */
+static int bench_remap_probation(long n)
+{
+    const parse_case_t *c = &s_cases[1];
+    const uint8_t dev_addr = 1;
+    tjuh_remap_profile_t nintendo;
+    int failures = 0;
+
+    nintendo_profile(&nintendo);
+    tjuh_parse_init_device(dev_addr, 0x1234, 0x5678);
+    tjuh_parse_set_report_desc(dev_addr, NULL, 0, 0);
+    tjuh_set_remap_profile(dev_addr, &nintendo);
+
+    long task_at = TJUH_CLASSIFY_PROBATION_REPORTS + 4;
+    if (n < task_at + 4)
+        n = task_at + 4;
+
+    for (long i = 0; i < n; i++) {
+        if (i == task_at)
+            tjuh_parse_task();
+
+        tjuh_gamepad_state_t  got  = {0};
+        tjuh_gamepad_state_t  want = {0};
+        tjuh_gamepad_report_t ref  = {0};
+        uint8_t data[REPORT_LEN];
+        random_report(c, data);
+
+        bool ok_got  = tjuh_parse_report(dev_addr, data, c->len, 8, &got, NULL, TJUH_HINT_NONE);
+        bool ok_want = tjuh_parse_with_reference(c->parser, data, c->len, &ref);
+        tjuh_report_to_state(&ref, &want);
+        remap_reference(&nintendo, &want);
+
+        if (ok_got != ok_want || (ok_got && !state_equal(&got, &want))) {
+            fprintf(stderr, "probation: remap mismatch at report %ld\n", i);
+            failures++;
+        }
+    }
+
+    bool settled = tjuh_parse_get_parser(dev_addr) == c->parser &&
+                   tjuh_parse_settled[dev_addr - 1] != NULL;
+    printf("%-18s %10ld %s\n", "Probation 8-byte", n, settled ? "settled" : "NOT SETTLED");
+    failures += !settled;
+
+    tjuh_parse_free_device(dev_addr);
+    return failures;
+}
+
+int main(int argc, char **argv)
+{
+    long n = (argc > 1) ? atol(argv[1]) : 1000000L;
+    int failures = 0;
+
+    static uint8_t pool[1024][REPORT_LEN];
+
+    static const char *const path_name[PATH_COUNT] = {
+        "table [ns]", "+ext [ns]", "hand [ns]", "+ext [ns]", "ref [ns]",
+    };
+    double layout_ns = 0.0;
+    double hand_ns   = 0.0;
+
+    printf("%-18s %10s", "parser", "checked");
+    for (int path = 0; path < PATH_COUNT; path++)
+        printf(" %12s", path_name[path]);
+    printf("\n");
+
+    for (size_t ci = 0; ci < ARRAY_SIZE(s_cases); ci++) {
+        const parse_case_t *c = &s_cases[ci];
+        uint8_t data[REPORT_LEN];
+        long checked = 0;
+
+        /* Every value of each button byte */
+        for (int b = 0; b < c->button_count; b++) {
+            for (int v = 0; v < 256; v++) {
+                random_report(c, data);
+                data[c->button_bytes[b]] = (uint8_t)v;
+                failures += !compare_one(c, data);
+                checked++;
+            }
+        }
+
+        for (long i = 0; i < n; i++) {
+            random_report(c, data);
+            failures += !compare_one(c, data);
+            checked++;
+        }
+
+        for (unsigned i = 0; i < ARRAY_SIZE(pool); i++)
+            random_report(c, pool[i]);
+
+        const uint8_t (*p)[REPORT_LEN] = (const uint8_t (*)[REPORT_LEN])pool;
+        /* Rounds interleave the paths so a slow patch hits all of them */
+        double t[PATH_COUNT];
+        for (int round = 0; round < TIMING_ROUNDS; round++) {
+            for (int path = 0; path < PATH_COUNT; path++) {
+                if (path == PATH_REFERENCE && c->no_reference)
+                    continue;
+                double ns = time_ns(c, p, ARRAY_SIZE(pool), (parse_path_t)path);
+                if (round == 0 || ns < t[path])
+                    t[path] = ns;
+            }
+        }
+
+        printf("%-18s %10ld", c->name, checked);
+        for (int path = 0; path < PATH_COUNT; path++) {
+            if (path == PATH_REFERENCE && c->no_reference)
+                printf(" %12s", "-");
+            else
+                printf(" %12.2f", t[path]);
+        }
+        printf("\n");
+
+        layout_ns += t[PATH_TABLE] + t[PATH_TABLE_EXT];
+        hand_ns   += t[PATH_HAND] + t[PATH_HAND_EXT];
+    }
+
+    printf("layout tables vs hand-written: %.3fx the time\n", layout_ns / hand_ns);
+    if (layout_ns > hand_ns * LAYOUT_SLACK) {
+        fprintf(stderr, "generated parsers more than %.0f%% slower than hand-written\n",
+                (LAYOUT_SLACK - 1.0) * 100.0);
+        failures++;
+    }
+
+    failures += bench_remap(n, pool, ARRAY_SIZE(pool));
+    failures += bench_remap_probation(n);
+
+    printf("mismatches: %d\n", failures);
+    return failures ? 1 : 0;
+}
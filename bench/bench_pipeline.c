@@ -0,0 +1,233 @@
+/*
+ * TJUH host bench — composed report pipelines
+ *
+ * Runs Xbox 360 reports through every combination of pipeline stages
+ * (extended report, stick conditioning, change detection), with and
+ * without a remap profile, once through the device's composed pipeline
+ * and once as the separate stages the pipeline replaces, and checks both
+ * give the same state, extended report and result for every report.
+ * Then times both per report.
+ *
+ *   bench_pipeline [reports]
+ *
+ * `reports` is the timing run length (default 2000000). Reports repeat
+ * REPEAT times each, as a pad held still resends its state, so change
+ * detection sees both outcomes. Exits non-zero on any mismatch, or if
+ * the device is composed from other stages than configured. Fused and
+ * staged runs alternate over ROUNDS rounds and the fastest round of each
+ * is shown. Times are host CPU time; the TSC column is host
+ * timestamp-counter ticks.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#define BENCH_SEED 0x2468ACE1u
+#include "bench_util.h"
+#include "tjuh_condition.h"
+#include "tjuh_pipeline.h"
+
+#define DEV           1
+#define REPORT_LEN    20
+#define POOL_SIZE     1024
+#define REPEAT        4
+#define CHECK_REPORTS 20000
+#define ROUNDS        5     /* timing rounds, alternating; the fastest counts */
+
+typedef struct {
+    const char *name;
+    bool        ext;
+    bool        condition;
+    bool        changes;
+} combo_t;
+
+static const combo_t s_combos[] = {
+    { "parse",                 false, false, false },
+    { "parse+ext",             true,  false, false },
+    { "parse+changes",         false, false, true  },
+    { "parse+ext+changes",     true,  false, true  },
+    { "parse+cond",            false, true,  false },
+    { "parse+cond+changes",    false, true,  true  },
+};
+
+static uint8_t s_pool[POOL_SIZE][REPORT_LEN];
+
+static void fill_pool(void)
+{
+    for (unsigned i = 0; i < POOL_SIZE; i += REPEAT) {
+        for (int k = 0; k < REPORT_LEN; k++)
+            s_pool[i][k] = (uint8_t)rnd32();
+        s_pool[i][0] = 0x00;
+        s_pool[i][1] = REPORT_LEN;
+        for (unsigned r = 1; r < REPEAT; r++)
+            memcpy(s_pool[i + r], s_pool[i], REPORT_LEN);
+    }
+}
+
+/* Configure the stages and profiles of one combination */
+static bool setup(const combo_t *c, bool remap)
+{
+    tjuh_condition_profile_t cp;
+    tjuh_remap_profile_t     rp;
+
+    tjuh_condition_profile_init(&cp);
+    cp.stick[0].deadzone = 0x0C00;
+    cp.stick[1].curve    = TJUH_CURVE_QUADRATIC;
+    cp.trigger[0].deadzone = 0x0800;
+
+    tjuh_remap_profile_init(&rp);
+    rp.axis_invert = 0x0A;
+    rp.swap_sticks = true;
+
+    tjuh_pipeline_configure(c->ext, c->changes);
+    tjuh_set_remap_profile(DEV, remap ? &rp : NULL);
+    tjuh_set_condition_profile(DEV, c->condition ? &cp : NULL);
+
+    uint8_t want = (c->ext || c->condition ? TJUH_STAGE_EXT : 0) |
+                   (c->condition ? TJUH_STAGE_CONDITION : 0) |
+                   (c->changes ? TJUH_STAGE_CHANGES : 0);
+    return tjuh_pipeline_stages(DEV) == want;
+}
+
+/* Composed and staged over the same reports; each keeps its own last
+ * state. The deltas are checked against the states as well. */
+static long run_check(const combo_t *c, bool remap)
+{
+    static tjuh_gamepad_state_t st[2][CHECK_REPORTS];
+    static tjuh_gamepad_ext_t   ext[2][CHECK_REPORTS];
+    static tjuh_report_delta_t  delta[2][CHECK_REPORTS];
+    static uint8_t              res[2][CHECK_REPORTS];
+    long bad = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (!setup(c, remap))
+            return -1;
+        memset(ext[pass], 0, sizeof(ext[pass]));
+        for (int i = 0; i < CHECK_REPORTS; i++) {
+            const uint8_t *data = s_pool[i % POOL_SIZE];
+            res[pass][i] = pass == 0
+                ? tjuh_pipeline_run(DEV, data, REPORT_LEN, 32, TJUH_HINT_NONE,
+                                    &st[pass][i], &ext[pass][i], &delta[pass][i])
+                : tjuh_pipeline_run_staged(DEV, data, REPORT_LEN, 32, TJUH_HINT_NONE,
+                                           &st[pass][i], &ext[pass][i], &delta[pass][i]);
+        }
+    }
+
+    bench_delta_reset();
+    for (int i = 0; i < CHECK_REPORTS; i++) {
+        tjuh_report_delta_t want = bench_delta(DEV, &st[0][i]);
+        bool same = res[0][i] == res[1][i] &&
+                    st[0][i].buttons == st[1][i].buttons &&
+                    st[0][i].axes == st[1][i].axes && st[0][i].hat == st[1][i].hat &&
+                    memcmp(&ext[0][i], &ext[1][i], sizeof(ext[0][i])) == 0;
+        for (int pass = 0; pass < 2; pass++)
+            same = same && delta[pass][i].held == want.held &&
+                   delta[pass][i].edges == want.edges && delta[pass][i].fields == want.fields;
+        /* Repeats of a report are unchanged, first sightings changed */
+        bool changed = !c->changes || (i % REPEAT) == 0;
+        if (!same || res[0][i] != (TJUH_PIPELINE_PARSED |
+                                   (changed ? TJUH_PIPELINE_CHANGED : 0)))
+            bad++;
+    }
+    return bad;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static uint64_t ticks(void)
+{
+#if HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+typedef struct {
+    double ns;
+    double tsc;
+} cost_t;
+
+static cost_t time_run(long reports, bool staged)
+{
+    uint32_t acc = 0;
+    tjuh_gamepad_state_t st;
+    tjuh_gamepad_ext_t   ext = {0};
+    tjuh_report_delta_t  delta;
+
+    double   t0 = now_s();
+    uint64_t c0 = ticks();
+    if (staged) {
+        for (long i = 0; i < reports; i++) {
+            acc += tjuh_pipeline_run_staged(DEV, s_pool[i % POOL_SIZE], REPORT_LEN, 32,
+                                            TJUH_HINT_NONE, &st, &ext, &delta);
+            acc += st.buttons ^ st.axes ^ ext.l2 ^ delta.edges;
+        }
+    } else {
+        for (long i = 0; i < reports; i++) {
+            acc += tjuh_pipeline_run(DEV, s_pool[i % POOL_SIZE], REPORT_LEN, 32,
+                                     TJUH_HINT_NONE, &st, &ext, &delta);
+            acc += st.buttons ^ st.axes ^ ext.l2 ^ delta.edges;
+        }
+    }
+    uint64_t c1 = ticks();
+    double   t1 = now_s();
+
+    bench_sink(acc);
+    return (cost_t){ (t1 - t0) * 1e9 / reports, (double)(c1 - c0) / reports };
+}
+
+static cost_t cost_min(cost_t a, cost_t b)
+{
+    return (cost_t){ a.ns < b.ns ? a.ns : b.ns, a.tsc < b.tsc ? a.tsc : b.tsc };
+}
+
+int main(int argc, char **argv)
+{
+    long reports = bench_count(argc, argv, 2000000L);
+    int failures = 0;
+
+    fill_pool();
+    tjuh_parse_init_device(DEV, 0x045E, 0x028E);
+
+    printf("%-24s %6s %10s %10s\n", "stages", "remap", "reports", "mismatch");
+    for (int remap = 0; remap < 2; remap++) {
+        for (size_t i = 0; i < ARRAY_SIZE(s_combos); i++) {
+            long bad = run_check(&s_combos[i], remap);
+            printf("%-24s %6s %10d %10ld%s\n", s_combos[i].name, remap ? "yes" : "no",
+                   CHECK_REPORTS, bad < 0 ? 0 : bad, bad < 0 ? "  wrong stages" : "");
+            failures += bad != 0;
+        }
+    }
+
+    printf("\n%-24s %6s %10s %10s %10s %10s\n", "per report", "remap",
+           "fused [ns]", HAVE_TSC ? "[tsc]" : "", "staged [ns]", HAVE_TSC ? "[tsc]" : "");
+    for (int remap = 0; remap < 2; remap++) {
+        for (size_t i = 0; i < ARRAY_SIZE(s_combos); i++) {
+            cost_t fused  = { 1e30, 1e30 };
+            cost_t staged = { 1e30, 1e30 };
+            for (int r = 0; r < ROUNDS; r++) {
+                setup(&s_combos[i], remap);
+                fused = cost_min(fused, time_run(reports / ROUNDS + 1, false));
+                setup(&s_combos[i], remap);
+                staged = cost_min(staged, time_run(reports / ROUNDS + 1, true));
+            }
+            printf("%-24s %6s %10.2f %10.1f %10.2f %10.1f\n", s_combos[i].name,
+                   remap ? "yes" : "no", fused.ns, fused.tsc, staged.ns, staged.tsc);
+        }
+    }
+
+    tjuh_parse_free_device(DEV);
+    tjuh_condition_release(DEV);
+
+    return bench_exit(stdout, failures);
+}
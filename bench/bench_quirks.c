@@ -0,0 +1,246 @@
+/*
+ * TJUH host bench — runtime quirk blob
+ *
+ * Maps a blob built by tools/tjuh_quirk_blob.py from bench_quirks.txt
+ * (the build passes its path as BENCH_QUIRK_BLOB) and checks that its
+ * VID/PID entries, vendor-wide entries and fingerprints are found, that
+ * it takes precedence over the built-in table and that the built-in
+ * table still answers what the blob does not cover. The bench builds
+ * without Xbox One, so the blob's Xbox One entries stand in for a family
+ * left out; they, and a fingerprint with a built-in hash but another
+ * length, must fall through to the built-in entry. Then attaches
+ * damaged copies: a bad CRC, bad versions, unsorted keys and truncated
+ * lengths must all be rejected and leave the attached blob in place.
+ * Finally times one lookup per outcome, from one binary search (exact
+ * blob hit) to four (vendor-wide built-in hit, miss).
+ *
+ *   bench_quirks [lookups]
+ *
+ * `lookups` is the timing run length per row (default 2000000). Exits
+ * non-zero if any check fails. Times are host CPU time.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench_util.h"
+#include "tjuh_quirks.h"
+
+#ifndef BENCH_QUIRK_BLOB
+#error "BENCH_QUIRK_BLOB must name the blob built from bench_quirks.txt"
+#endif
+
+#define BLOB_MAX 4096
+
+/* Attached blobs are searched in place, so copies must outlive the checks */
+static uint32_t s_blob[BLOB_MAX / 4];
+static uint32_t s_bad[BLOB_MAX / 4];
+static uint32_t s_blob_len;
+
+typedef struct {
+    const char *name;
+    uint16_t    vid;
+    uint16_t    pid;
+    uint8_t     parser;         /* expected; TJUH_PARSER_AUTO = no entry */
+    uint8_t     flags;
+} lookup_case_t;
+
+/* Blob entries first, then what only the built-in table knows */
+static const lookup_case_t s_with_blob[] = {
+    { "blob exact",           0x2DC8, 0x6001, TJUH_PARSER_DS4,     TJUH_QUIRK_INVERT_Y },
+    { "blob overrides",       0x045E, 0x028E, TJUH_PARSER_XBOX360, TJUH_QUIRK_INVERT_Y },
+    { "blob exact, vendor",   0x0F0D, 0x00C1, TJUH_PARSER_SWITCH,  0 },
+    { "blob vendor-wide",     0x0F0D, 0x1234, TJUH_PARSER_DS4,     TJUH_QUIRK_SET_IDLE },
+    { "built-in exact",       0x054C, 0x05C4, TJUH_PARSER_DS4,     0 },
+    { "blob left out",        0x054C, 0x0CE6, TJUH_PARSER_DUALSENSE, 0 },
+    { "built-in vendor-wide", 0x057E, 0x1234, TJUH_PARSER_SWITCH,  0 },
+    { "miss",                 0x1234, 0x5678, TJUH_PARSER_AUTO,    0 },
+};
+
+static bool lookup_ok(const lookup_case_t *c)
+{
+    const tjuh_quirk_t *q = tjuh_quirk_lookup(c->vid, c->pid);
+
+    if (c->parser == TJUH_PARSER_AUTO)
+        return q == NULL;
+    return q && q->parser == c->parser && q->flags == c->flags;
+}
+
+static int check_lookups(const char *when)
+{
+    int failures = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(s_with_blob); i++) {
+        if (!lookup_ok(&s_with_blob[i])) {
+            fprintf(stderr, "%s: %s lookup wrong\n", when, s_with_blob[i].name);
+            failures++;
+        }
+    }
+
+    const tjuh_fingerprint_t *f = tjuh_fingerprint_lookup(0x5EED0001u, 64);
+    if (!f || f->parser != TJUH_PARSER_GENERIC_8BYTE || f->flags != TJUH_QUIRK_INVERT_X) {
+        fprintf(stderr, "%s: blob fingerprint not found\n", when);
+        failures++;
+    }
+    if (tjuh_fingerprint_lookup(0x5EED0001u, 65)) {
+        fprintf(stderr, "%s: fingerprint matched with the wrong length\n", when);
+        failures++;
+    }
+    f = tjuh_fingerprint_lookup(0xC67BAD2Cu, 63);
+    if (!f || f->parser != TJUH_PARSER_IGNORE) {
+        fprintf(stderr, "%s: built-in fingerprint hidden by a blob length\n", when);
+        failures++;
+    }
+    f = tjuh_fingerprint_lookup(0xC67BAD2Cu, 64);
+    if (!f || f->parser != TJUH_PARSER_GENERIC_8BYTE || f->flags != TJUH_QUIRK_INVERT_Y) {
+        fprintf(stderr, "%s: blob fingerprint sharing a hash not found\n", when);
+        failures++;
+    }
+    f = tjuh_fingerprint_lookup(0x09C9B29Fu, 99);
+    if (!f || f->parser != TJUH_PARSER_GENERIC_8BYTE) {
+        fprintf(stderr, "%s: built-in fingerprint hidden by a left-out family\n", when);
+        failures++;
+    }
+    return failures;
+}
+
+static uint32_t crc32_ieee(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+static bool load_blob(void)
+{
+    FILE *f = fopen(BENCH_QUIRK_BLOB, "rb");
+    if (!f)
+        return false;
+
+    s_blob_len = (uint32_t)fread(s_blob, 1, sizeof(s_blob), f);
+    fclose(f);
+    return s_blob_len > sizeof(tjuh_quirk_blob_header_t);
+}
+
+/* Fresh copy of the good blob to damage */
+static tjuh_quirk_blob_header_t *bad_copy(void)
+{
+    memcpy(s_bad, s_blob, s_blob_len);
+    return (tjuh_quirk_blob_header_t *)s_bad;
+}
+
+static void bad_recrc(void)
+{
+    tjuh_quirk_blob_header_t *hdr = (tjuh_quirk_blob_header_t *)s_bad;
+    const uint8_t *payload = (const uint8_t *)s_bad + sizeof(*hdr);
+    hdr->crc32 = crc32_ieee(payload, s_blob_len - (uint32_t)sizeof(*hdr));
+}
+
+/* Attach the damaged copy; one row; 1 if it was accepted */
+static int reject(const char *name, uint32_t len)
+{
+    bool attached = tjuh_quirk_blob_attach(s_bad, len);
+
+    printf("%-30s %8u %10s\n", name, (unsigned)len, attached ? "ATTACHED" : "rejected");
+    return attached;
+}
+
+static int check_rejects(void)
+{
+    const uint32_t hdr_len = (uint32_t)sizeof(tjuh_quirk_blob_header_t);
+    tjuh_quirk_t *entries = (tjuh_quirk_t *)((uint8_t *)s_bad + hdr_len);
+    int failures = 0;
+
+    printf("\n%-30s %8s %10s\n", "damaged blob", "bytes", "result");
+
+    bad_copy();
+    ((uint8_t *)entries)[3] ^= 0x01;
+    failures += reject("bad CRC", s_blob_len);
+
+    bad_copy()->version = TJUH_QUIRK_BLOB_VERSION + 1;
+    failures += reject("version too new", s_blob_len);
+
+    bad_copy()->version = 0;
+    failures += reject("version 0", s_blob_len);
+
+    /* Version 1 had no fingerprints */
+    bad_copy()->version = 1;
+    failures += reject("version 1 with fingerprints", s_blob_len);
+
+    /* Swapped entries with a CRC that matches them */
+    bad_copy();
+    tjuh_quirk_t t = entries[0];
+    entries[0] = entries[1];
+    entries[1] = t;
+    bad_recrc();
+    failures += reject("unsorted keys", s_blob_len);
+
+    bad_copy();
+    failures += reject("truncated by one byte", s_blob_len - 1);
+    failures += reject("header only", hdr_len);
+    failures += reject("shorter than a header", hdr_len - 1);
+
+    /* None of them replaced the good blob */
+    failures += check_lookups("after rejects");
+    return failures;
+}
+
+static void time_lookups(long n)
+{
+    printf("\n%-28s %10s\n", "lookup", "[ns]");
+    for (size_t i = 0; i < ARRAY_SIZE(s_with_blob); i++) {
+        const lookup_case_t *c = &s_with_blob[i];
+        uint32_t acc = 0;
+
+        double t0 = now_s();
+        for (long k = 0; k < n; k++) {
+            const tjuh_quirk_t *q = tjuh_quirk_lookup(c->vid, c->pid);
+            acc += q ? q->parser : 0u;
+        }
+        double t1 = now_s();
+
+        bench_row(c->name, t0, t1, n);
+        bench_sink(acc);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long n = bench_count(argc, argv, 2000000L);
+    int failures = 0;
+
+    if (!load_blob()) {
+        fprintf(stderr, "cannot read %s\n", BENCH_QUIRK_BLOB);
+        return bench_exit(stdout, 1);
+    }
+
+    if (!tjuh_quirk_blob_map_file(BENCH_QUIRK_BLOB)) {
+        fprintf(stderr, "mapped blob rejected\n");
+        failures++;
+    }
+    failures += check_lookups("mapped");
+
+    tjuh_quirk_blob_detach();
+    if (!lookup_ok(&(lookup_case_t){ "detached", 0x045E, 0x028E, TJUH_PARSER_XBOX360, 0 }) ||
+        tjuh_quirk_lookup(0x2DC8, 0x6001)) {
+        fprintf(stderr, "detached: blob entries still found\n");
+        failures++;
+    }
+
+    if (!tjuh_quirk_blob_attach(s_blob, s_blob_len)) {
+        fprintf(stderr, "attached blob rejected\n");
+        failures++;
+    }
+    failures += check_lookups("attached");
+    printf("blob: %u bytes, %zu lookups checked\n", (unsigned)s_blob_len, ARRAY_SIZE(s_with_blob));
+
+    failures += check_rejects();
+    time_lookups(n);
+
+    return bench_exit(stdout, failures);
+}
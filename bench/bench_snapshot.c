@@ -0,0 +1,191 @@
+/*
+ * TJUH host bench — all-device snapshot
+ *
+ * Plugs several simulated controllers, lets them stream, and takes
+ * snapshots at intervals while they do. Each snapshot must match the
+ * state the last on_state callback delivered for every device, with the
+ * age of that report, and the connected bitmap must follow plugs and
+ * unplugs, with neutral entries for empty slots. Then times a snapshot
+ * alone and with a pass over all slots.
+ *
+ *   bench_snapshot [snapshots]
+ *
+ * `snapshots` is the timing run length (default 2000000). Exits non-zero
+ * if a snapshot disagrees. Times are host CPU time; the device traffic
+ * runs on the simulated bus clock.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "tjuh.h"
+#include "sim_usb.h"
+
+#define STEP_US       7000      /* snapshot interval */
+#define RUN_US        3000000
+#define UNPLUG_AT_US  1500000
+
+typedef struct {
+    bool                 connected;
+    tjuh_gamepad_state_t state;
+    uint32_t             at_ms;     /* latest report, or the connect */
+} last_t;
+
+static last_t s_last[TJUH_MAX_DEVICES + 1];
+
+static void on_state(uint8_t dev_addr, const tjuh_gamepad_state_t *state)
+{
+    if (dev_addr > TJUH_MAX_DEVICES)
+        return;
+    s_last[dev_addr].state    = *state;
+    s_last[dev_addr].at_ms    = (uint32_t)(sim_now_us() / 1000);
+}
+
+static void on_report(uint8_t dev_addr, const tjuh_gamepad_report_t *report)
+{
+    (void)dev_addr;
+    (void)report;
+}
+
+static void on_connect(uint8_t dev_addr, uint16_t vid, uint16_t pid)
+{
+    (void)vid;
+    (void)pid;
+    if (dev_addr > TJUH_MAX_DEVICES)
+        return;
+    s_last[dev_addr] = (last_t){
+        .connected = true,
+        .state     = { .axes = 0x80808080u, .hat = 8 },
+        .at_ms     = (uint32_t)(sim_now_us() / 1000),
+    };
+}
+
+static void on_disconnect(uint8_t dev_addr)
+{
+    if (dev_addr <= TJUH_MAX_DEVICES)
+        memset(&s_last[dev_addr], 0, sizeof(s_last[dev_addr]));
+}
+
+/* One snapshot against the callbacks; returns mismatching entries */
+static int check(const tjuh_snapshot_t *s, uint32_t want_connected)
+{
+    uint32_t now_ms = (uint32_t)(sim_now_us() / 1000);
+    int bad = s->connected != want_connected;
+
+    for (uint8_t i = 0; i < TJUH_SNAPSHOT_SLOTS; i++) {
+        const last_t *l = (i < TJUH_MAX_DEVICES) ? &s_last[i + 1] : NULL;
+
+        if (l && l->connected) {
+            bad += s->buttons[i] != l->state.buttons || s->axes[i] != l->state.axes ||
+                   s->hat[i] != l->state.hat || s->age_ms[i] != now_ms - l->at_ms;
+        } else if (!(s->connected >> i & 1u)) {
+            bad += s->buttons[i] != 0 || s->axes[i] != 0x80808080u || s->hat[i] != 8 ||
+                   s->age_ms[i] != 0;
+        }
+    }
+    return bad;
+}
+
+static int run_check(FILE *out)
+{
+    static const sim_device_spec_t *const mix[] = {
+        &sim_dev_ds4, &sim_dev_xbox360, &sim_dev_dualsense, &sim_dev_generic8,
+    };
+    uint8_t  addr[ARRAY_SIZE(mix)];
+    uint32_t want = 0;
+    long     snapshots = 0;
+    int      bad = 0;
+
+    sim_reset();
+    tjuh_config_t config = {
+        .on_report     = on_report,
+        .on_connect    = on_connect,
+        .on_state      = on_state,
+        .on_disconnect = on_disconnect,
+    };
+    tjuh_init(&config);
+
+    for (size_t i = 0; i < ARRAY_SIZE(mix); i++)
+        addr[i] = sim_plug(mix[i], 0);
+
+    for (uint64_t t = STEP_US; t <= RUN_US; t += STEP_US) {
+        sim_run_until(t, tjuh_task);
+
+        if (t >= UNPLUG_AT_US && t < UNPLUG_AT_US + STEP_US)
+            sim_unplug(addr[1]);
+
+        want = 0;
+        for (uint8_t d = 1; d <= TJUH_MAX_DEVICES; d++)
+            want |= s_last[d].connected ? 1u << (d - 1) : 0;
+
+        tjuh_snapshot_t s;
+        uint8_t n = tjuh_get_snapshot(&s);
+        bad += check(&s, want) + (n != __builtin_popcount(want));
+        snapshots++;
+    }
+
+    fprintf(out, "%ld snapshots, %d devices at the end, mismatches: %d\n", snapshots,
+            __builtin_popcount(want), bad);
+    return bad != 0 || __builtin_popcount(want) != (int)ARRAY_SIZE(mix) - 1;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static void run_timing(FILE *out, long snapshots)
+{
+    tjuh_snapshot_t s;
+    volatile uint32_t sink = 0;
+    uint32_t acc = 0;
+
+    double t0 = now_s();
+    for (long k = 0; k < snapshots; k++) {
+        acc += tjuh_get_snapshot(&s);
+        acc += s.age_ms[0];
+    }
+    double t1 = now_s();
+
+    /* Pads holding cross, and the summed stick x */
+    double t2 = now_s();
+    for (long k = 0; k < snapshots; k++) {
+        tjuh_get_snapshot(&s);
+        uint32_t x = 0;
+        for (uint8_t i = 0; i < TJUH_SNAPSHOT_SLOTS; i++) {
+            x   += s.axes[i] & 0xFFu;
+            acc += (s.buttons[i] >> TJUH_BUTTON_CROSS) & 1u;
+        }
+        acc += x;
+    }
+    double t3 = now_s();
+
+    sink = acc;
+    (void)sink;
+    fprintf(out, "\n%u slots, %u bytes\n", (unsigned)TJUH_SNAPSHOT_SLOTS, (unsigned)sizeof(s));
+    fprintf(out, "%-28s %10s\n", "per frame", "[ns]");
+    fprintf(out, "%-28s %10.2f\n", "snapshot", (t1 - t0) * 1e9 / snapshots);
+    fprintf(out, "%-28s %10.2f\n", "snapshot + pass", (t3 - t2) * 1e9 / snapshots);
+}
+
+int main(int argc, char **argv)
+{
+    long snapshots = (argc > 1) ? atol(argv[1]) : 2000000L;
+
+    if (snapshots < 1)
+        snapshots = 1;
+
+    /* Keep the results, drop the library's diagnostic output */
+    FILE *out = fdopen(dup(fileno(stdout)), "w");
+    if (!out || !freopen("/dev/null", "w", stdout))
+        return 1;
+
+    int failures = run_check(out);
+    run_timing(out, snapshots);
+
+    fprintf(out, "failures: %d\n", failures);
+    fclose(out);
+    return failures ? 1 : 0;
+}
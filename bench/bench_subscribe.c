@@ -0,0 +1,332 @@
+/*
+ * TJUH host bench — filtered report subscriptions
+ *
+ * Plays 1000 Hz reports from several devices to a set of subscribers
+ * with different device masks, changed-field masks and rate caps, with
+ * subscribers coming and going and a device reconnecting along the way.
+ * For every report the subscribers called must be exactly those a naive
+ * fan-out picks, in which each consumer filters every report itself.
+ * Also checks that a subscriber unsubscribed by another during a
+ * dispatch is not called. Then times both per report.
+ *
+ *   bench_subscribe [reports]
+ *
+ * `reports` is the timing run length (default 2000000). Exits non-zero
+ * if a report reaches other subscribers than the naive fan-out. Times
+ * are host CPU time; the script runs on the simulated bus clock.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SEED 0x3C6EF372u
+#include "bench_util.h"
+#include "tjuh_subscribe.h"
+#include "tjuh_buttons.h"
+#include "sim_usb.h"
+
+#define DEVICES        4
+#define SCRIPT_MS      20000
+#define POOL_SIZE      4096
+
+/* An output mapper, a logger, a recorder and so on */
+static const tjuh_subscription_t s_mix[] = {
+    { .devices = TJUH_DEVICES_ALL, .fields = 0 },
+    { .devices = 0x1,              .fields = TJUH_FIELD_BUTTONS },
+    { .devices = 0x3,              .fields = TJUH_FIELD_STICK_L,  .min_interval_ms = 10 },
+    { .devices = TJUH_DEVICES_ALL, .fields = TJUH_FIELD_BUTTONS | TJUH_FIELD_HAT },
+    { .devices = 0x4,              .fields = TJUH_FIELD_STICK_R,  .min_interval_ms = 4 },
+    { .devices = TJUH_DEVICES_ALL, .fields = 0,                   .min_interval_ms = 16 },
+    { .devices = 0xA,              .fields = TJUH_FIELD_BUTTONS,  .min_interval_ms = 2 },
+    { .devices = 0x5,              .fields = TJUH_FIELD_ALL },
+};
+
+#define SUBS ARRAY_SIZE(s_mix)
+
+/* ---------------------------------------------------------------------- */
+/*  Naive fan-out: every consumer sees every report and filters it        */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    const tjuh_subscription_t *sub;     /* NULL = not subscribed */
+    tjuh_gamepad_state_t prev[DEVICES];
+    bool     owed[DEVICES];             /* first report, or held back by the cap */
+    bool     timed[DEVICES];
+    uint32_t last_ms[DEVICES];
+} naive_t;
+
+static naive_t s_naive[SUBS];
+
+static uint8_t changed_fields(const tjuh_gamepad_state_t *a, const tjuh_gamepad_state_t *b)
+{
+    return (uint8_t)((a->buttons != b->buttons ? TJUH_FIELD_BUTTONS : 0) |
+                     (a->hat != b->hat ? TJUH_FIELD_HAT : 0) |
+                     (a->x != b->x || a->y != b->y ? TJUH_FIELD_STICK_L : 0) |
+                     (a->z != b->z || a->rz != b->rz ? TJUH_FIELD_STICK_R : 0));
+}
+
+static void naive_subscribe(uint8_t n, const tjuh_subscription_t *sub)
+{
+    memset(&s_naive[n], 0, sizeof(s_naive[n]));
+    s_naive[n].sub = sub;
+    for (int d = 0; d < DEVICES; d++)
+        s_naive[n].owed[d] = true;
+}
+
+static void naive_release(uint8_t dev_addr)
+{
+    for (size_t n = 0; n < SUBS; n++) {
+        s_naive[n].owed[dev_addr - 1]  = true;
+        s_naive[n].timed[dev_addr - 1] = false;
+    }
+}
+
+/* Returns the mask of consumers that took the report */
+static uint32_t naive_dispatch(uint8_t dev_addr, const tjuh_gamepad_state_t *st, uint32_t now)
+{
+    uint8_t  d = dev_addr - 1;
+    uint32_t took = 0;
+
+    for (size_t n = 0; n < SUBS; n++) {
+        naive_t *c = &s_naive[n];
+        if (!c->sub)
+            continue;
+
+        uint8_t changed = changed_fields(&c->prev[d], st);
+        c->prev[d] = *st;
+
+        if (!(c->sub->devices >> d & 1u))
+            continue;
+        if (!c->owed[d] && c->sub->fields && !(c->sub->fields & changed))
+            continue;
+        if (c->sub->min_interval_ms && c->timed[d] &&
+            now - c->last_ms[d] < c->sub->min_interval_ms) {
+            c->owed[d] = true;
+            continue;
+        }
+
+        c->owed[d]    = false;
+        c->timed[d]   = true;
+        c->last_ms[d] = now;
+        took |= 1u << n;
+    }
+    return took;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Script                                                                */
+/* ---------------------------------------------------------------------- */
+
+static uint32_t s_called;       /* slots called for the current report */
+static int      s_handle[SUBS]; /* slot of each s_mix entry, -1 = none */
+
+static void on_sub(uint8_t dev_addr, const tjuh_gamepad_state_t *state, void *ctx)
+{
+    (void)dev_addr;
+    (void)state;
+    s_called |= 1u << *(int *)ctx;
+}
+
+/* Slot mask of the mix entries in a naive mask */
+static uint32_t slots_of(uint32_t took)
+{
+    uint32_t mask = 0;
+    for (size_t n = 0; n < SUBS; n++) {
+        if (took >> n & 1u)
+            mask |= 1u << s_handle[n];
+    }
+    return mask;
+}
+
+static bool add(size_t n)
+{
+    static int slot[SUBS];
+    tjuh_subscription_t sub = s_mix[n];
+
+    sub.callback = on_sub;
+    sub.ctx      = &slot[n];
+    s_handle[n]  = tjuh_subscribe(&sub);
+    slot[n]      = s_handle[n];
+    naive_subscribe((uint8_t)n, &s_mix[n]);
+    return s_handle[n] >= 0;
+}
+
+static void drop(size_t n)
+{
+    tjuh_unsubscribe((int8_t)s_handle[n]);
+    s_handle[n]     = -1;
+    s_naive[n].sub  = NULL;
+}
+
+static void step_state(tjuh_gamepad_state_t *st)
+{
+    uint32_t r = rnd32();
+
+    /* Mostly nothing changes, as from a pad at rest */
+    if ((r & 15) == 0)
+        st->buttons ^= TJUH_BUTTON_MASK((r >> 8) % TJUH_BUTTON_COUNT);
+    else if ((r & 31) == 1)
+        st->hat = (uint8_t)((r >> 8) % 9);
+    else if ((r & 7) == 2)
+        st->x = (uint8_t)(r >> 24);
+    else if ((r & 15) == 3)
+        st->rz = (uint8_t)(r >> 24);
+}
+
+static int run_script(void)
+{
+    tjuh_gamepad_state_t st[DEVICES];
+    long reports = 0, calls = 0, bad = 0;
+    bool ok = true;
+
+    sim_reset();
+    tjuh_subscribe_reset();
+    bench_delta_reset();
+    memset(s_naive, 0, sizeof(s_naive));
+    for (int d = 0; d < DEVICES; d++)
+        st[d] = (tjuh_gamepad_state_t){ .axes = 0x80808080u, .hat = TJUH_HAT_RELEASED };
+
+    for (size_t n = 0; n < SUBS; n++)
+        ok &= add(n);
+
+    for (uint32_t ms = 1; ms <= SCRIPT_MS; ms++) {
+        sim_run_until((uint64_t)ms * 1000, tuh_task);
+        uint32_t now = (uint32_t)(sim_now_us() / 1000);
+
+        /* Subscribers come and go; device 2 reconnects */
+        if (ms == SCRIPT_MS / 4)
+            drop(1);
+        if (ms == SCRIPT_MS / 2) {
+            drop(4);
+            ok &= add(1);
+        }
+        if (ms == 3 * SCRIPT_MS / 4) {
+            tjuh_subscribe_release(2);
+            bench_delta_release(2);
+            naive_release(2);
+            ok &= add(4);
+        }
+
+        for (uint8_t dev = 1; dev <= DEVICES; dev++) {
+            step_state(&st[dev - 1]);
+
+            s_called = 0;
+            tjuh_report_delta_t delta = bench_delta(dev, &st[dev - 1]);
+            tjuh_subscribe_dispatch(dev, &st[dev - 1], &delta);
+            uint32_t want = slots_of(naive_dispatch(dev, &st[dev - 1], now));
+
+            bad   += s_called != want;
+            calls += __builtin_popcount(s_called);
+            reports++;
+        }
+    }
+
+    printf("%-28s %8ld reports, %8ld calls (%.2f per report of %u subscribers), "
+           "%ld mismatching: %s\n", "random script", reports, calls, (double)calls / reports,
+           (unsigned)SUBS, bad, ok && bad == 0 ? "ok" : "FAIL");
+    return !ok || bad != 0;
+}
+
+/* A subscriber that unsubscribes the next one */
+static int8_t s_victim;
+
+static void on_first(uint8_t dev_addr, const tjuh_gamepad_state_t *state, void *ctx)
+{
+    (void)dev_addr;
+    (void)state;
+    (void)ctx;
+    s_called |= 1u;
+    tjuh_unsubscribe(s_victim);
+}
+
+static void on_victim(uint8_t dev_addr, const tjuh_gamepad_state_t *state, void *ctx)
+{
+    (void)dev_addr;
+    (void)state;
+    (void)ctx;
+    s_called |= 2u;
+}
+
+static int run_unsubscribe(void)
+{
+    tjuh_gamepad_state_t st = { .axes = 0x80808080u, .hat = TJUH_HAT_RELEASED };
+    tjuh_report_delta_t  delta;
+
+    tjuh_subscribe_reset();
+    bench_delta_reset();
+    delta = bench_delta(1, &st);
+    int8_t first = tjuh_subscribe(&(tjuh_subscription_t){ .callback = on_first,
+                                                          .devices  = TJUH_DEVICES_ALL });
+    s_victim     = tjuh_subscribe(&(tjuh_subscription_t){ .callback = on_victim,
+                                                          .devices  = TJUH_DEVICES_ALL });
+    s_called = 0;
+    tjuh_subscribe_dispatch(1, &st, &delta);
+
+    bool ok = first == 0 && s_victim == 1 && s_called == 1u && !tjuh_unsubscribe(s_victim) &&
+              tjuh_unsubscribe(first);
+    printf("%-28s %s\n", "unsubscribe in a callback", ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static void run_timing(long reports)
+{
+    static tjuh_gamepad_state_t pool[POOL_SIZE];
+    static tjuh_report_delta_t  delta[POOL_SIZE];
+    tjuh_gamepad_state_t st[DEVICES];
+    uint32_t acc = 0;
+
+    bench_delta_reset();
+    for (int d = 0; d < DEVICES; d++)
+        st[d] = (tjuh_gamepad_state_t){ .axes = 0x80808080u, .hat = TJUH_HAT_RELEASED };
+    for (unsigned i = 0; i < POOL_SIZE; i++) {
+        step_state(&st[i % DEVICES]);
+        pool[i]  = st[i % DEVICES];
+        delta[i] = bench_delta((uint8_t)(1 + i % DEVICES), &pool[i]);
+    }
+
+    sim_reset();
+    tjuh_subscribe_reset();
+    memset(s_naive, 0, sizeof(s_naive));
+    for (size_t n = 0; n < SUBS; n++)
+        add(n);
+
+    printf("\n%u subscribers, %d devices\n", (unsigned)SUBS, DEVICES);
+    printf("%-28s %10s\n", "per report", "[ns]");
+
+    s_called = 0;
+    double t0 = now_s();
+    for (long i = 0; i < reports; i++) {
+        unsigned k = (unsigned)(i % POOL_SIZE);
+        tjuh_subscribe_dispatch((uint8_t)(1 + k % DEVICES), &pool[k], &delta[k]);
+    }
+    double t1 = now_s();
+    acc += s_called;
+    bench_row("filtered dispatch", t0, t1, reports);
+
+    t0 = now_s();
+    for (long i = 0; i < reports; i++) {
+        unsigned k = (unsigned)(i % POOL_SIZE);
+        acc += naive_dispatch((uint8_t)(1 + k % DEVICES), &pool[k],
+                              (uint32_t)(sim_now_us() / 1000));
+    }
+    t1 = now_s();
+    bench_row("naive fan-out", t0, t1, reports);
+
+    bench_sink(acc);
+}
+
+int main(int argc, char **argv)
+{
+    long reports = bench_count(argc, argv, 2000000L);
+    int failures = 0;
+
+    failures += run_script();
+    failures += run_unsubscribe();
+    run_timing(reports);
+
+    return bench_exit(stdout, failures);
+}
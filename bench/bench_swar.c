@@ -0,0 +1,347 @@
+/*
+ * TJUH host bench — packed-word axis kernels
+ *
+ * Checks each kernel of tjuh_swar.h against per-axis scalar code: the
+ * centre deflection for every value of one lane against a spread of
+ * centres and edge values of the other, dx² + dy² for every dx, the
+ * narrowing to the compact axes and the inversion masks for every mask.
+ * Then parses Xbox 360 reports under every combination of inverted axes
+ * and swapped sticks and checks the extended sticks against the unmapped
+ * ones moved and inverted axis by axis. Finally times the kernels against
+ * the scalar code.
+ *
+ *   bench_swar [words]
+ *
+ * `words` is the timing run length (default 20000000). Exits non-zero on
+ * any difference. The host runs the portable kernels; the DSP ones carry
+ * the same contract and are cross-compiled for the RP2350's Cortex-M33
+ * (swar_cross.c) when arm-none-eabi-gcc is found. The library's own
+ * paths follow TJUH_SWAR_WORDS: bench_swar_words builds this with it on,
+ * so the end-to-end check covers both. The scalar column of the extended
+ * inversion is the per-lane code tjuh_parse.c uses with it off.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SEED 0x12345678u
+#include "bench_util.h"
+#include "tjuh_buttons.h"
+#include "tjuh_parse.h"
+#include "tjuh_swar.h"
+
+#define REPORT_LEN    20
+#define REMAP_REPORTS 2000
+
+/* ---------------------------------------------------------------------- */
+/*  Scalar references                                                     */
+/* ---------------------------------------------------------------------- */
+
+static int32_t sat16(int32_t v)
+{
+    return v < -32768 ? -32768 : v > 32767 ? 32767 : v;
+}
+
+static void scalar_deflection(uint16_t x, uint16_t y, int16_t cx, int16_t cy,
+                              int32_t *dx, int32_t *dy)
+{
+    *dx = sat16((int32_t)x - 0x8000 - cx);
+    *dy = sat16((int32_t)y - 0x8000 - cy);
+}
+
+static uint32_t scalar_narrow(const tjuh_gamepad_ext_t *ext)
+{
+    tjuh_gamepad_state_t st;
+    st.x  = (uint8_t)(ext->x >> 8);
+    st.y  = (uint8_t)(ext->y >> 8);
+    st.z  = (uint8_t)(ext->z >> 8);
+    st.rz = (uint8_t)(ext->rz >> 8);
+    return st.axes;
+}
+
+/* Per-axis inversion, as the extended transform was written before */
+static void scalar_invert(tjuh_gamepad_ext_t *ext, uint32_t axes_xor)
+{
+    tjuh_gamepad_state_t mask;
+    mask.axes = axes_xor;
+
+    if (mask.x)  ext->x  ^= 0xFFFF;
+    if (mask.y)  ext->y  ^= 0xFFFF;
+    if (mask.z)  ext->z  ^= 0xFFFF;
+    if (mask.rz) ext->rz ^= 0xFFFF;
+}
+
+/* Per-lane inversion as tjuh_parse.c does it without the DSP kernels */
+static void lane_invert(tjuh_gamepad_ext_t *ext, uint32_t axes_xor)
+{
+    ext->x  ^= (uint16_t)((axes_xor & 0xFFu) * 0x0101u);
+    ext->y  ^= (uint16_t)(((axes_xor >> 8) & 0xFFu) * 0x0101u);
+    ext->z  ^= (uint16_t)(((axes_xor >> 16) & 0xFFu) * 0x0101u);
+    ext->rz ^= (uint16_t)((axes_xor >> 24) * 0x0101u);
+}
+
+static void scalar_swap(tjuh_gamepad_ext_t *ext)
+{
+    uint16_t x = ext->x;
+    uint16_t y = ext->y;
+    ext->x  = ext->z;
+    ext->y  = ext->rz;
+    ext->z  = x;
+    ext->rz = y;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Kernel checks                                                         */
+/* ---------------------------------------------------------------------- */
+
+static const int16_t s_centres[] = { 0, 1, -1, 0x0300, -0x0280, 0x4000, -0x4000, 32767, -32768 };
+static const uint16_t s_edges[]  = { 0x0000, 0x0001, 0x7FFF, 0x8000, 0x8001, 0xFFFE, 0xFFFF };
+
+static long check_deflection(void)
+{
+    long bad = 0;
+
+    for (size_t ci = 0; ci < ARRAY_SIZE(s_centres); ci++) {
+        for (size_t cj = 0; cj < ARRAY_SIZE(s_centres); cj++) {
+            int16_t  cx     = s_centres[ci];
+            int16_t  cy     = s_centres[cj];
+            uint32_t center = ((uint32_t)cx & 0xFFFFu) | ((uint32_t)cy << 16);
+
+            for (uint32_t x = 0; x <= 0xFFFF; x++) {
+                uint16_t y = (x & 7) < ARRAY_SIZE(s_edges) ? s_edges[x & 7] : (uint16_t)rnd32();
+                int32_t  dx, dy;
+
+                scalar_deflection((uint16_t)x, y, cx, cy, &dx, &dy);
+                uint32_t d = tjuh_swar_deflection(x | ((uint32_t)y << 16), center);
+                if ((int16_t)d != dx || (int32_t)d >> 16 != dy)
+                    bad++;
+            }
+        }
+    }
+    return bad;
+}
+
+static long check_norm2(void)
+{
+    long bad = 0;
+
+    for (int32_t dx = -32768; dx <= 32767; dx++) {
+        int32_t dy = (dx & 3) == 0 ? -32768 : (dx & 3) == 1 ? 32767 : (int16_t)rnd32();
+        uint32_t want = (uint32_t)(dx * dx) + (uint32_t)(dy * dy);
+        uint32_t got  = tjuh_swar_norm2(((uint32_t)dx & 0xFFFFu) | ((uint32_t)dy << 16));
+        if (got != want)
+            bad++;
+    }
+    return bad;
+}
+
+static long check_narrow(void)
+{
+    long bad = 0;
+
+    for (long i = 0; i < 1000000; i++) {
+        tjuh_gamepad_ext_t ext = { (uint16_t)rnd32(), (uint16_t)rnd32(), (uint16_t)rnd32(),
+                                   (uint16_t)rnd32(), 0, 0 };
+        uint32_t pair[2];
+
+        tjuh_swar_load_sticks(&ext, pair);
+        if (tjuh_swar_narrow(pair[0], pair[1]) != scalar_narrow(&ext))
+            bad++;
+    }
+    return bad;
+}
+
+static long check_masks(void)
+{
+    long bad = 0;
+
+    for (uint8_t axes = 0; axes < 16; axes++) {
+        uint32_t           mask = tjuh_axes_invert_mask(axes);
+        tjuh_gamepad_ext_t want = { (uint16_t)rnd32(), (uint16_t)rnd32(), (uint16_t)rnd32(),
+                                    (uint16_t)rnd32(), 0, 0 };
+        tjuh_gamepad_ext_t got  = want;
+        tjuh_gamepad_ext_t lane = want;
+        uint32_t           pair[2];
+
+        scalar_invert(&want, mask);
+        tjuh_swar_load_sticks(&got, pair);
+        pair[0] ^= tjuh_swar_widen_mask(mask, 0);
+        pair[1] ^= tjuh_swar_widen_mask(mask, 1);
+        tjuh_swar_store_sticks(&got, pair);
+        lane_invert(&lane, mask);
+
+        if (memcmp(&got, &want, sizeof(got)) != 0 || memcmp(&lane, &want, sizeof(lane)) != 0)
+            bad++;
+    }
+    return bad;
+}
+
+/* Extended transform end to end: every inversion with and without the swap */
+static long check_remap(void)
+{
+    const uint8_t dev_addr = 1;
+    long bad = 0;
+
+    tjuh_parse_init_device(dev_addr, 0x045E, 0x028E);
+
+    for (uint8_t axes = 0; axes < 32; axes++) {
+        tjuh_remap_profile_t p;
+        tjuh_remap_profile_init(&p);
+        p.axis_invert = axes & 0x0F;
+        p.swap_sticks = (axes & 0x10) != 0;
+
+        for (int i = 0; i < REMAP_REPORTS; i++) {
+            uint8_t data[REPORT_LEN];
+            for (int k = 0; k < REPORT_LEN; k++)
+                data[k] = (uint8_t)rnd32();
+            data[0] = 0x00;
+            data[1] = REPORT_LEN;
+
+            tjuh_gamepad_state_t st;
+            tjuh_gamepad_ext_t   want = {0};
+            tjuh_gamepad_ext_t   got  = {0};
+
+            tjuh_set_remap_profile(dev_addr, NULL);
+            tjuh_parse_report(dev_addr, data, REPORT_LEN, 32, &st, &want, TJUH_HINT_NONE);
+            tjuh_set_remap_profile(dev_addr, &p);
+            tjuh_parse_report(dev_addr, data, REPORT_LEN, 32, &st, &got, TJUH_HINT_NONE);
+
+            if (p.swap_sticks)
+                scalar_swap(&want);
+            scalar_invert(&want, tjuh_axes_invert_mask(p.axis_invert));
+
+            if (memcmp(&got, &want, sizeof(got)) != 0 || st.axes != scalar_narrow(&got))
+                bad++;
+        }
+    }
+
+    tjuh_parse_free_device(dev_addr);
+    return bad;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Timing                                                                */
+/* ---------------------------------------------------------------------- */
+
+static void run_timing(long words)
+{
+    static tjuh_gamepad_ext_t pool[1024];
+    volatile uint32_t sink = 0;
+    uint32_t acc = 0;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(pool); i++) {
+        pool[i].x  = (uint16_t)rnd32();
+        pool[i].y  = (uint16_t)rnd32();
+        pool[i].z  = (uint16_t)rnd32();
+        pool[i].rz = (uint16_t)rnd32();
+    }
+
+    /* Deflection, norm and narrowing of both sticks: the conditioning path */
+    double t0 = now_s();
+    for (long i = 0; i < words; i++) {
+        const tjuh_gamepad_ext_t *e = &pool[i & 1023];
+        int32_t dx, dy, dz, drz;
+
+        scalar_deflection(e->x, e->y, 0x0300, -0x0280, &dx, &dy);
+        scalar_deflection(e->z, e->rz, -0x0200, 0x0180, &dz, &drz);
+        acc += (uint32_t)(dx * dx) + (uint32_t)(dy * dy) +
+               (uint32_t)(dz * dz) + (uint32_t)(drz * drz) + scalar_narrow(e);
+    }
+    double t1 = now_s();
+    sink += acc;
+    acc = 0;
+
+    const uint32_t c0 = 0x0300u | ((uint32_t)-0x0280 << 16);
+    const uint32_t c1 = 0xFE00u | ((uint32_t)0x0180 << 16);
+    double t2 = now_s();
+    for (long i = 0; i < words; i++) {
+        uint32_t pair[2];
+        tjuh_swar_load_sticks(&pool[i & 1023], pair);
+        acc += tjuh_swar_norm2(tjuh_swar_deflection(pair[0], c0)) +
+               tjuh_swar_norm2(tjuh_swar_deflection(pair[1], c1)) +
+               tjuh_swar_narrow(pair[0], pair[1]);
+    }
+    double t3 = now_s();
+    sink += acc;
+    acc = 0;
+
+    /* Inversion and swap of the extended sticks, masks known only at run time */
+    volatile uint32_t masks[2] = { tjuh_axes_invert_mask(TJUH_AXIS_Y | TJUH_AXIS_Z),
+                                   tjuh_axes_invert_mask(TJUH_AXIS_X) };
+    double t4 = now_s();
+    for (long i = 0; i < words; i++) {
+        tjuh_gamepad_ext_t e = pool[i & 1023];
+        lane_invert(&e, masks[0]);
+        if (i & 1)
+            scalar_swap(&e);
+        lane_invert(&e, masks[1]);
+        acc += e.x ^ e.rz;
+    }
+    double t5 = now_s();
+    sink += acc;
+    acc = 0;
+
+    double t6 = now_s();
+    for (long i = 0; i < words; i++) {
+        tjuh_gamepad_ext_t e = pool[i & 1023];
+        uint32_t pair[2];
+        uint32_t m0 = masks[0];
+        uint32_t m1 = masks[1];
+
+        tjuh_swar_load_sticks(&e, pair);
+        uint32_t xy  = pair[0] ^ tjuh_swar_widen_mask(m0, 0);
+        uint32_t zrz = pair[1] ^ tjuh_swar_widen_mask(m0, 1);
+        if (i & 1) {
+            uint32_t t = xy;
+            xy  = zrz;
+            zrz = t;
+        }
+        pair[0] = xy  ^ tjuh_swar_widen_mask(m1, 0);
+        pair[1] = zrz ^ tjuh_swar_widen_mask(m1, 1);
+        tjuh_swar_store_sticks(&e, pair);
+        acc += e.x ^ e.rz;
+    }
+    double t7 = now_s();
+    sink += acc;
+
+    (void)sink;
+    printf("\n%-28s %10s %10s\n", "per report", "scalar [ns]", "words [ns]");
+    printf("%-28s %10.2f %10.2f\n", "deflection + norm + narrow",
+           (t1 - t0) * 1e9 / words, (t3 - t2) * 1e9 / words);
+    printf("%-28s %10.2f %10.2f\n", "invert + swap (extended)",
+           (t5 - t4) * 1e9 / words, (t7 - t6) * 1e9 / words);
+}
+
+int main(int argc, char **argv)
+{
+    long words = (argc > 1) ? atol(argv[1]) : 20000000L;
+    long failures = 0;
+
+    if (words < 1)
+        words = 1;
+
+    printf("kernels: %s\n", TJUH_SWAR_DSP ? "DSP extension" : "portable C");
+    printf("extended sticks: %s\n", TJUH_SWAR_WORDS ? "words" : "per lane");
+
+    const struct {
+        const char *name;
+        long      (*check)(void);
+    } checks[] = {
+        { "deflection",         check_deflection },
+        { "norm2",              check_norm2 },
+        { "narrow",             check_narrow },
+        { "inversion masks",    check_masks },
+        { "remap, extended",    check_remap },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(checks); i++) {
+        long bad = checks[i].check();
+        printf("%-20s %s\n", checks[i].name, bad ? "FAIL" : "ok");
+        failures += bad;
+    }
+
+    run_timing(words);
+
+    printf("failures: %ld\n", failures);
+    return failures ? 1 : 0;
+}
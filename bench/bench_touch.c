@@ -0,0 +1,431 @@
+/*
+ * TJUH host bench — DS4 / DualSense touchpad tracking
+ *
+ * Feeds tjuh_touch_process() scripted DS4 reports carrying one to three
+ * touch frames and DualSense reports, and checks each report's events:
+ * DOWN, MOVE and UP, an UP and a DOWN when a slot's tracking id changes
+ * without a lift, nothing for an idle or repeated pad, the frame count
+ * clamped to three, frames past the report length ignored, and short
+ * reports or other report ids ignored without touching the contacts.
+ * A parser change and tjuh_touch_release() must forget the contacts.
+ * Then random reports, lengths and report ids are checked against a
+ * reference that diffs the contacts frame by frame, and the host time
+ * per report is measured for an idle and a busy pad.
+ *
+ *   bench_touch [reports]
+ *
+ * `reports` is the timing run length (default 2000000). Exits non-zero
+ * if any report's events differ from the expected ones.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_SEED 0x510E527Fu
+#include "bench_util.h"
+#include "tjuh_touch.h"
+#include "tjuh_parse.h"
+
+#define REPORT_MAX      80      /* room for a fourth DS4 frame */
+#define DS4_LEN         64
+#define DUALSENSE_LEN   64
+#define RANDOM_REPORTS  200000
+#define POOL_SIZE       1024
+
+/* A point as the controller sends it: bit 7 of tag set = not touching */
+typedef struct {
+    uint8_t  tag;
+    uint16_t x;
+    uint16_t y;
+} point_t;
+
+#define T(id, x, y) { (id), (x), (y) }
+#define L(id)       { 0x80 | (id), 0, 0 }
+
+#define DOWN(f, id, x, y) { TJUH_TOUCH_DOWN, (f), (id), (x), (y) }
+#define MOVE(f, id, x, y) { TJUH_TOUCH_MOVE, (f), (id), (x), (y) }
+#define UP(f, id, x, y)   { TJUH_TOUCH_UP,   (f), (id), (x), (y) }
+
+static void put_point(uint8_t *p, const point_t *pt)
+{
+    p[0] = pt->tag;
+    p[1] = (uint8_t)pt->x;
+    p[2] = (uint8_t)(((pt->x >> 8) & 0x0F) | ((pt->y & 0x0F) << 4));
+    p[3] = (uint8_t)(pt->y >> 4);
+}
+
+/* DS4 report 0x01: frame count at 33, 9-byte frames from 34 */
+static void ds4_report(uint8_t *buf, uint8_t report_id, uint8_t frames,
+                       const point_t (*pt)[TJUH_TOUCH_FINGERS], uint8_t n_pt)
+{
+    memset(buf, 0, REPORT_MAX);
+    buf[0]  = report_id;
+    buf[33] = frames;
+    for (uint8_t i = 0; i < n_pt; i++) {
+        uint8_t *frame = &buf[34 + 9 * i];
+        frame[0] = (uint8_t)(i * 3);    /* timestamp, not decoded */
+        for (uint8_t f = 0; f < TJUH_TOUCH_FINGERS; f++)
+            put_point(&frame[1 + 4 * f], &pt[i][f]);
+    }
+}
+
+/* DualSense report 0x01: one frame at 33 */
+static void dualsense_report(uint8_t *buf, uint8_t report_id,
+                             const point_t pt[TJUH_TOUCH_FINGERS])
+{
+    memset(buf, 0, REPORT_MAX);
+    buf[0] = report_id;
+    for (uint8_t f = 0; f < TJUH_TOUCH_FINGERS; f++)
+        put_point(&buf[33 + 4 * f], &pt[f]);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Script                                                                      */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+    const char        *what;
+    uint8_t            parser;
+    uint8_t            report_id;
+    uint8_t            frames;      /* DS4 frame count byte */
+    uint16_t           len;
+    bool               release;     /* tjuh_touch_release() before the report */
+    point_t            pt[4][TJUH_TOUCH_FINGERS];   /* DualSense: pt[0] */
+    uint8_t            n;
+    tjuh_touch_event_t want[6];
+} step_t;
+
+#define DS4 TJUH_PARSER_DS4
+#define DS5 TJUH_PARSER_DUALSENSE
+
+static const step_t s_script[] = {
+    { "DS4 idle", DS4, 0x01, 1, DS4_LEN, false,
+      { { L(0), L(0) } }, 0, { { 0 } } },
+    { "DS4 first finger down", DS4, 0x01, 1, DS4_LEN, false,
+      { { T(5, 100, 200), L(0) } }, 1, { DOWN(0, 5, 100, 200) } },
+    { "DS4 finger held still", DS4, 0x01, 1, DS4_LEN, false,
+      { { T(5, 100, 200), L(0) } }, 0, { { 0 } } },
+    { "DS4 finger moved", DS4, 0x01, 1, DS4_LEN, false,
+      { { T(5, 101, 200), L(0) } }, 1, { MOVE(0, 5, 101, 200) } },
+    { "DS4 2 frames, second lands", DS4, 0x01, 2, DS4_LEN, false,
+      { { T(5, 101, 200), L(0) }, { T(5, 102, 201), T(6, 1800, 900) } },
+      2, { MOVE(0, 5, 102, 201), DOWN(1, 6, 1800, 900) } },
+    { "DS4 3 frames, repeated", DS4, 0x01, 3, DS4_LEN, false,
+      { { T(5, 102, 201), T(6, 1800, 900) }, { T(5, 102, 201), T(6, 1800, 900) },
+        { T(5, 102, 201), T(6, 1800, 900) } }, 0, { { 0 } } },
+    { "DS4 new id in a slot", DS4, 0x01, 1, DS4_LEN, false,
+      { { T(7, 500, 500), T(6, 1800, 900) } },
+      2, { UP(0, 5, 102, 201), DOWN(0, 7, 500, 500) } },
+    { "DS4 3 frames, tap and lift", DS4, 0x01, 3, DS4_LEN, false,
+      { { L(7), T(6, 1800, 900) }, { T(8, 10, 4095), T(6, 1919, 941) }, { L(8), L(6) } },
+      5, { UP(0, 7, 500, 500), DOWN(0, 8, 10, 4095), MOVE(1, 6, 1919, 941),
+           UP(0, 8, 10, 4095), UP(1, 6, 1919, 941) } },
+    { "DS4 frame count clamped", DS4, 0x01, 4, REPORT_MAX, false,
+      { { L(8), L(6) }, { L(8), L(6) }, { L(8), L(6) }, { T(9, 1, 1), L(6) } },
+      0, { { 0 } } },
+    { "DS4 frame past len", DS4, 0x01, 2, 43, false,
+      { { L(8), L(6) }, { T(9, 300, 400), L(6) } }, 0, { { 0 } } },
+    { "DS4 frame within len", DS4, 0x01, 2, 52, false,
+      { { L(8), L(6) }, { T(9, 300, 400), L(6) } }, 1, { DOWN(0, 9, 300, 400) } },
+    { "DS4 short report", DS4, 0x01, 1, 42, false,
+      { { L(9), T(10, 1, 2) } }, 0, { { 0 } } },
+    { "DS4 other report id", DS4, 0x11, 1, DS4_LEN, false,
+      { { L(9), T(10, 1, 2) } }, 0, { { 0 } } },
+    { "DS4 contacts kept", DS4, 0x01, 1, DS4_LEN, false,
+      { { T(9, 300, 400), L(6) } }, 0, { { 0 } } },
+    { "DS4 no frames", DS4, 0x01, 0, DS4_LEN, false,
+      { { L(9), L(6) } }, 0, { { 0 } } },
+    { "DualSense resets contacts", DS5, 0x01, 0, DUALSENSE_LEN, false,
+      { { T(9, 300, 400), L(0) } }, 1, { DOWN(0, 9, 300, 400) } },
+    { "DualSense second finger", DS5, 0x01, 0, DUALSENSE_LEN, false,
+      { { T(9, 300, 400), T(20, 1919, 1079) } }, 1, { DOWN(1, 20, 1919, 1079) } },
+    { "DualSense idle", DS5, 0x01, 0, DUALSENSE_LEN, false,
+      { { T(9, 300, 400), T(20, 1919, 1079) } }, 0, { { 0 } } },
+    { "DualSense moved", DS5, 0x01, 0, DUALSENSE_LEN, false,
+      { { T(9, 300, 401), T(20, 1900, 1079) } },
+      2, { MOVE(0, 9, 300, 401), MOVE(1, 20, 1900, 1079) } },
+    { "DualSense new id in a slot", DS5, 0x01, 0, DUALSENSE_LEN, false,
+      { { T(9, 300, 401), T(21, 5, 6) } },
+      2, { UP(1, 20, 1900, 1079), DOWN(1, 21, 5, 6) } },
+    { "DualSense short report", DS5, 0x01, 0, 40, false,
+      { { L(9), L(21) } }, 0, { { 0 } } },
+    { "DualSense other report id", DS5, 0x31, 0, DUALSENSE_LEN, false,
+      { { L(9), L(21) } }, 0, { { 0 } } },
+    { "DualSense shortest report", DS5, 0x01, 0, 41, false,
+      { { L(9), L(21) } }, 2, { UP(0, 9, 300, 401), UP(1, 21, 5, 6) } },
+    { "DualSense finger down", DS5, 0x01, 0, DUALSENSE_LEN, false,
+      { { T(30, 700, 800), L(21) } }, 1, { DOWN(0, 30, 700, 800) } },
+    { "DualSense released", DS5, 0x01, 0, DUALSENSE_LEN, true,
+      { { T(30, 700, 800), L(21) } }, 1, { DOWN(0, 30, 700, 800) } },
+    { "DS4 resets contacts", DS4, 0x01, 1, DS4_LEN, false,
+      { { L(30), L(0) } }, 0, { { 0 } } },
+    { "no touchpad", TJUH_PARSER_XBOX360, 0x01, 1, DS4_LEN, false,
+      { { T(31, 1, 1), T(32, 2, 2) } }, 0, { { 0 } } },
+};
+
+static void build(uint8_t *buf, uint8_t parser, uint8_t report_id, uint8_t frames,
+                  const point_t (*pt)[TJUH_TOUCH_FINGERS])
+{
+    if (parser == TJUH_PARSER_DUALSENSE)
+        dualsense_report(buf, report_id, pt[0]);
+    else
+        ds4_report(buf, report_id, frames, pt, 4);
+}
+
+static void print_events(const char *label, const tjuh_touch_event_t *e, uint8_t n)
+{
+    static const char *const type[] = { "DOWN", "MOVE", "UP" };
+
+    printf("    %-5s", label);
+    for (uint8_t i = 0; i < n; i++)
+        printf(" %s(%u,%u,%u,%u)", e[i].type <= TJUH_TOUCH_UP ? type[e[i].type] : "?",
+               e[i].finger, e[i].id, e[i].x, e[i].y);
+    printf("\n");
+}
+
+static bool same_events(const tjuh_touch_event_t *a, uint8_t na,
+                        const tjuh_touch_event_t *b, uint8_t nb)
+{
+    if (na != nb)
+        return false;
+    for (uint8_t i = 0; i < na; i++) {
+        if (a[i].type != b[i].type || a[i].finger != b[i].finger || a[i].id != b[i].id ||
+            a[i].x != b[i].x || a[i].y != b[i].y)
+            return false;
+    }
+    return true;
+}
+
+static int run_script(uint8_t dev_addr)
+{
+    uint8_t buf[REPORT_MAX];
+    tjuh_touch_event_t out[TJUH_TOUCH_MAX_EVENTS];
+    int failures = 0;
+
+    tjuh_touch_release(dev_addr);
+    for (size_t i = 0; i < ARRAY_SIZE(s_script); i++) {
+        const step_t *s = &s_script[i];
+
+        build(buf, s->parser, s->report_id, s->frames, s->pt);
+        if (s->release)
+            tjuh_touch_release(dev_addr);
+
+        uint8_t n = tjuh_touch_process(dev_addr, s->parser, buf, s->len, out);
+        bool ok = same_events(out, n, s->want, s->n);
+
+        printf("  %-30s %u event%s %s\n", s->what, n, n == 1 ? " " : "s", ok ? "ok" : "FAIL");
+        if (!ok) {
+            print_events("got", out, n);
+            print_events("want", s->want, s->n);
+            failures++;
+        }
+    }
+
+    /* No slot for address 0 or past the last device */
+    build(buf, DS4, 0x01, 1, (const point_t[4][TJUH_TOUCH_FINGERS]){ { T(1, 1, 1), L(0) } });
+    if (tjuh_touch_process(0, DS4, buf, DS4_LEN, out) ||
+        tjuh_touch_process(TJUH_MAX_DEVICES + 1, DS4, buf, DS4_LEN, out)) {
+        printf("  events for an address without a slot FAIL\n");
+        failures++;
+    }
+    return failures;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Random reports against a reference                                          */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+    uint8_t parser;
+    bool    down[TJUH_TOUCH_FINGERS];
+    point_t last[TJUH_TOUCH_FINGERS];
+} ref_device_t;
+
+static void ref_event(tjuh_touch_event_t *out, uint8_t *n, uint8_t type, uint8_t f,
+                      const point_t *p)
+{
+    out[*n] = (tjuh_touch_event_t){ type, f, (uint8_t)(p->tag & 0x7F), p->x, p->y };
+    (*n)++;
+}
+
+static void ref_frame(ref_device_t *r, const point_t pt[TJUH_TOUCH_FINGERS],
+                      tjuh_touch_event_t *out, uint8_t *n)
+{
+    for (uint8_t f = 0; f < TJUH_TOUCH_FINGERS; f++) {
+        const point_t *p = &pt[f];
+        bool down = !(p->tag & 0x80);
+
+        if (r->down[f] && (!down || r->last[f].tag != p->tag))
+            ref_event(out, n, TJUH_TOUCH_UP, f, &r->last[f]);
+        if (down && (!r->down[f] || r->last[f].tag != p->tag))
+            ref_event(out, n, TJUH_TOUCH_DOWN, f, p);
+        else if (down && (r->last[f].x != p->x || r->last[f].y != p->y))
+            ref_event(out, n, TJUH_TOUCH_MOVE, f, p);
+
+        r->down[f] = down;
+        if (down)
+            r->last[f] = *p;
+    }
+}
+
+/* The frames a report of `len` bytes carries, read from the points it was built from */
+static uint8_t ref_report(ref_device_t *r, uint8_t parser, uint8_t report_id, uint8_t frames,
+                          uint16_t len, const point_t (*pt)[TJUH_TOUCH_FINGERS],
+                          tjuh_touch_event_t *out)
+{
+    uint8_t n = 0;
+
+    if (parser != r->parser)
+        *r = (ref_device_t){ .parser = parser };
+    if (report_id != 0x01)
+        return 0;
+
+    if (parser == TJUH_PARSER_DS4) {
+        if (len < 43)
+            return 0;
+        for (uint8_t i = 0; i < frames && i < 3 && 34 + 9 * i + 9 <= len; i++)
+            ref_frame(r, pt[i], out, &n);
+    } else if (parser == TJUH_PARSER_DUALSENSE) {
+        if (len < 41)
+            return 0;
+        ref_frame(r, pt[0], out, &n);
+    }
+    return n;
+}
+
+/* Mostly small moves of a few fingers, with lifts, new ids and the odd bad report */
+static void random_point(point_t *p)
+{
+    uint32_t r = rnd32();
+
+    if ((r & 7) == 0) {
+        p->tag ^= 0x80;
+    } else if ((r & 31) == 1) {
+        p->tag = (uint8_t)((p->tag & 0x80) | ((p->tag + 1) & 3));
+    } else if ((r & 3) == 2) {
+        p->x = (uint16_t)((p->x + (r >> 8) % 5 - 2) & 0xFFF);
+        p->y = (uint16_t)((p->y + (r >> 16) % 5 - 2) & 0xFFF);
+    }
+}
+
+static int run_random(void)
+{
+    static const uint8_t parsers[] = {
+        TJUH_PARSER_DS4, TJUH_PARSER_DS4, TJUH_PARSER_DS4, TJUH_PARSER_DS4,
+        TJUH_PARSER_DUALSENSE, TJUH_PARSER_DUALSENSE, TJUH_PARSER_DUALSENSE,
+        TJUH_PARSER_XBOX360,
+    };
+    static ref_device_t ref[TJUH_MAX_DEVICES];
+    point_t cur[TJUH_MAX_DEVICES][TJUH_TOUCH_FINGERS];
+    uint8_t parser[TJUH_MAX_DEVICES];
+    uint8_t buf[REPORT_MAX];
+    tjuh_touch_event_t out[TJUH_TOUCH_MAX_EVENTS], want[TJUH_TOUCH_MAX_EVENTS];
+    long events = 0;
+    int failures = 0;
+
+    for (uint8_t d = 0; d < TJUH_MAX_DEVICES; d++) {
+        tjuh_touch_release((uint8_t)(d + 1));
+        ref[d] = (ref_device_t){ 0 };
+        parser[d] = parsers[d % ARRAY_SIZE(parsers)];
+        for (uint8_t f = 0; f < TJUH_TOUCH_FINGERS; f++)
+            cur[d][f] = (point_t){ 0x80, (uint16_t)(rnd32() % 1920), (uint16_t)(rnd32() % 942) };
+    }
+
+    for (long i = 0; i < RANDOM_REPORTS; i++) {
+        uint8_t  d = (uint8_t)(rnd32() % TJUH_MAX_DEVICES);
+        uint32_t r = rnd32();
+        point_t  pt[4][TJUH_TOUCH_FINGERS];
+
+        if ((r & 0x3FF) == 0)
+            parser[d] = parsers[(r >> 10) % ARRAY_SIZE(parsers)];
+        if ((r & 0x3FF) == 1) {
+            tjuh_touch_release((uint8_t)(d + 1));
+            ref[d] = (ref_device_t){ .parser = parser[d] };
+        }
+
+        uint8_t  frames    = (uint8_t)((r >> 12) % 5);
+        uint8_t  report_id = ((r >> 16) & 63) == 0 ? 0x11 : 0x01;
+        uint16_t len       = ((r >> 22) & 15) == 0 ? (uint16_t)(30 + (r >> 26) % 40) : DS4_LEN;
+
+        for (uint8_t k = 0; k < 4; k++) {
+            for (uint8_t f = 0; f < TJUH_TOUCH_FINGERS; f++) {
+                random_point(&cur[d][f]);
+                pt[k][f] = cur[d][f];
+            }
+        }
+
+        build(buf, parser[d], report_id, frames, pt);
+        uint8_t n = tjuh_touch_process((uint8_t)(d + 1), parser[d], buf, len, out);
+        uint8_t m = ref_report(&ref[d], parser[d], report_id, frames, len, pt, want);
+        events += n;
+
+        if (!same_events(out, n, want, m)) {
+            if (failures < 5) {
+                printf("  report %ld (device %u, parser %u, frame count %u, len %u) FAIL\n",
+                       i, d + 1, parser[d], frames, len);
+                print_events("got", out, n);
+                print_events("want", want, m);
+            }
+            failures++;
+        }
+    }
+
+    printf("  %d random reports, %ld events, %d mismatches\n", RANDOM_REPORTS, events, failures);
+    return failures;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Timing                                                                      */
+/* -------------------------------------------------------------------------- */
+
+static void time_reports(const char *label, uint8_t parser, bool moving, long count)
+{
+    static uint8_t pool[POOL_SIZE][REPORT_MAX];
+    tjuh_touch_event_t out[TJUH_TOUCH_MAX_EVENTS];
+    point_t cur[TJUH_TOUCH_FINGERS] = { T(1, 900, 400), T(2, 300, 700) };
+    point_t pt[4][TJUH_TOUCH_FINGERS];
+    uint32_t acc = 0;
+
+    for (size_t i = 0; i < POOL_SIZE; i++) {
+        for (uint8_t k = 0; k < 4; k++) {
+            for (uint8_t f = 0; f < TJUH_TOUCH_FINGERS; f++) {
+                if (moving)
+                    cur[f].x = (uint16_t)((cur[f].x + 1 + rnd32() % 3) % 1920);
+                pt[k][f] = cur[f];
+            }
+        }
+        build(pool[i], parser, 0x01, 3, pt);
+    }
+
+    tjuh_touch_release(1);
+    double t0 = now_s();
+    for (long i = 0; i < count; i++)
+        acc += tjuh_touch_process(1, parser, pool[i & (POOL_SIZE - 1)], DS4_LEN, out);
+    double t1 = now_s();
+
+    bench_sink(acc);
+    bench_row(label, t0, t1, count);
+}
+
+int main(int argc, char **argv)
+{
+    long count = bench_count(argc, argv, 2000000);
+    int failures = 0;
+
+    printf("TJUH touchpad bench\n\n");
+
+    printf("script\n");
+    failures += run_script(1);
+
+    printf("\nrandom reports against the reference\n");
+    failures += run_random();
+
+    printf("\nhost time per report (ns)\n");
+    time_reports("DS4 3 frames, held still", TJUH_PARSER_DS4, false, count);
+    time_reports("DS4 3 frames, both moving", TJUH_PARSER_DS4, true, count);
+    time_reports("DualSense, held still", TJUH_PARSER_DUALSENSE, false, count);
+    time_reports("DualSense, both moving", TJUH_PARSER_DUALSENSE, true, count);
+
+    printf("\n");
+    return bench_exit(stdout, failures);
+}
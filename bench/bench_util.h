@@ -0,0 +1,116 @@
+/*
+ * TJUH host benches — shared helpers
+ *
+ * Random numbers, the wall clock, the argument and exit conventions and
+ * the timing row every bench prints. A bench that wants rnd32() defines
+ * BENCH_SEED before including this, so each keeps its own sequence.
+ */
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tjuh.h"
+#include "tjuh_buttons.h"
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+#ifdef BENCH_SEED
+static uint32_t s_rng = BENCH_SEED;
+
+static inline uint32_t rnd32(void)
+{
+    /* xorshift32 */
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+/* Random buttons (within `buttons_mask`), axes and hat for a timing pool */
+static inline void bench_random_states(tjuh_gamepad_state_t *pool, size_t n,
+                                       uint32_t buttons_mask)
+{
+    for (size_t i = 0; i < n; i++) {
+        pool[i].buttons = rnd32() & buttons_mask;
+        pool[i].axes    = rnd32();
+        pool[i].hat     = (uint8_t)(rnd32() % 9);
+    }
+}
+#endif
+
+/* Each device's previous report, as the pipeline keeps it */
+static inline tjuh_gamepad_state_t *bench_prev(uint8_t dev_addr)
+{
+    static tjuh_gamepad_state_t prev[TJUH_MAX_DEVICES + 1];
+    return &prev[dev_addr <= TJUH_MAX_DEVICES ? dev_addr : 0];
+}
+
+/* The device is gone, or was never there: no previous report */
+static inline void bench_delta_release(uint8_t dev_addr)
+{
+    *bench_prev(dev_addr) = (tjuh_gamepad_state_t){ .hat = TJUH_HAT_RELEASED };
+}
+
+static inline void bench_delta_reset(void)
+{
+    for (uint8_t i = 0; i <= TJUH_MAX_DEVICES; i++)
+        bench_delta_release(i);
+}
+
+/* The report delta the pipeline hands the modules for a report */
+static inline tjuh_report_delta_t bench_delta(uint8_t dev_addr, const tjuh_gamepad_state_t *st)
+{
+    tjuh_report_delta_t d;
+    tjuh_report_delta(bench_prev(dev_addr), st, &d);
+    *bench_prev(dev_addr) = *st;
+    return d;
+}
+
+/* Deltas for a pool one device replays in a loop: entry i against i - 1 */
+static inline void bench_pool_deltas(const tjuh_gamepad_state_t *pool,
+                                     tjuh_report_delta_t *delta, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        tjuh_report_delta(&pool[(i + n - 1) % n], &pool[i], &delta[i]);
+}
+
+static inline double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* One timing row: nanoseconds per item between two now_s() readings */
+static inline void bench_row(const char *label, double t0, double t1, long n)
+{
+    printf("%-28s %10.2f\n", label, (t1 - t0) * 1e9 / n);
+}
+
+/* Keeps the optimiser from dropping a timed loop's results */
+static inline void bench_sink(uint32_t acc)
+{
+    volatile uint32_t sink = acc;
+    (void)sink;
+}
+
+/* The run length: argv[1] if given, at least 1 */
+static inline long bench_count(int argc, char **argv, long fallback)
+{
+    long n = (argc > 1) ? atol(argv[1]) : fallback;
+    return n < 1 ? 1 : n;
+}
+
+/* Prints the failure count every bench ends with; the exit status */
+static inline int bench_exit(FILE *out, int failures)
+{
+    fprintf(out, "failures: %d\n", failures);
+    return failures ? 1 : 0;
+}
+
+#endif /* BENCH_UTIL_H */
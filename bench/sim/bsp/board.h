@@ -0,0 +1,23 @@
+/*
+ * TJUH host bench — TinyUSB board support stand-in
+ *
+ * board_millis() reads the simulated bus clock, not wall time.
+ */
+
+#ifndef _BSP_BOARD_H_
+#define _BSP_BOARD_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void     board_init(void);
+uint32_t board_millis(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BSP_BOARD_H_ */
@@ -0,0 +1,10 @@
+/*
+ * TJUH host bench — TinyUSB stand-in (see ../tusb.h)
+ */
+
+#ifndef _TUSB_USBH_H_
+#define _TUSB_USBH_H_
+
+#include "tusb.h"
+
+#endif /* _TUSB_USBH_H_ */
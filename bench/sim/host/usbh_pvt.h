@@ -0,0 +1,20 @@
+/*
+ * TJUH host bench — TinyUSB stand-in (see ../tusb.h)
+ */
+
+#ifndef _TUSB_USBH_PVT_H_
+#define _TUSB_USBH_PVT_H_
+
+#include "tusb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool usbh_edpt_busy(uint8_t dev_addr, uint8_t ep_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TUSB_USBH_PVT_H_ */
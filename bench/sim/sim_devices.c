@@ -0,0 +1,583 @@
+/*
+ * TJUH host bench — device models
+ *
+ * Descriptor and report shapes follow the real controllers closely enough
+ * for TJUH's enumeration and parsing paths. Audio/extra interfaces that the
+ * library ignores are left out to keep the tables short.
+ */
+
+#include "sim_usb.h"
+
+/* ---------------------------------------------------------------------- */
+/*  Shared helpers                                                        */
+/* ---------------------------------------------------------------------- */
+
+static uint16_t fill(uint8_t *buf, uint16_t max_len, uint16_t len)
+{
+    uint16_t n = len < max_len ? len : max_len;
+    memset(buf, 0, n);
+    return n;
+}
+
+/* Slow triangle wave around centre so axes are never static */
+static uint8_t wobble(uint32_t seq, uint8_t phase)
+{
+    uint32_t t = (seq + phase * 16u) & 63u;
+    return (uint8_t)(t < 32 ? 112 + t : 176 - (t - 32));
+}
+
+/* Cross/A held for 3 reports out of every 50 */
+static bool tap(uint32_t seq)
+{
+    return (seq % 50u) >= 20u && (seq % 50u) < 23u;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Sony DualShock 4 v2                                                   */
+/* ---------------------------------------------------------------------- */
+
+static const uint8_t s_ds4_config[] = {
+    0x09, 0x02, 0x29, 0x00, 0x01, 0x01, 0x00, 0xC0, 0xFA,   /* configuration */
+    0x09, 0x04, 0x00, 0x00, 0x02, 0x03, 0x00, 0x00, 0x00,   /* HID interface */
+    0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, 0xFB, 0x01,   /* HID descriptor */
+    0x07, 0x05, 0x84, 0x03, 0x40, 0x00, 0x05,               /* EP 0x84 IN  */
+    0x07, 0x05, 0x03, 0x03, 0x40, 0x00, 0x05,               /* EP 0x03 OUT */
+};
+
+static uint16_t ds4_report(const sim_device_spec_t *spec, uint8_t daddr, uint32_t seq,
+                           uint8_t *buf, uint16_t max_len)
+{
+    (void)spec;
+    (void)daddr;
+    uint16_t n = fill(buf, max_len, 64);
+
+    buf[0] = 0x01;
+    buf[1] = wobble(seq, 0);
+    buf[2] = wobble(seq, 1);
+    buf[3] = 0x80;
+    buf[4] = 0x80;
+    buf[5] = (uint8_t)(0x08 | (tap(seq) ? 0x20 : 0x00));   /* hat released, cross */
+    buf[7] = (uint8_t)(seq << 2);                           /* report counter */
+    return n;
+}
+
+const sim_device_spec_t sim_dev_ds4 = {
+    .name = "DualShock 4",
+    .desc_device = {
+        .bcdUSB = 0x0200, .bMaxPacketSize0 = 64,
+        .idVendor = 0x054C, .idProduct = 0x09CC, .bcdDevice = 0x0100,
+        .iManufacturer = 1, .iProduct = 2, .bNumConfigurations = 1,
+    },
+    .desc_config       = s_ds4_config,
+    .manufacturer      = "Sony Interactive Entertainment",
+    .product           = "Wireless Controller",
+    .desc_latency_us   = 2000,
+    .string_latency_us = 6000,
+    .make_report       = ds4_report,
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Sony DualSense                                                        */
+/* ---------------------------------------------------------------------- */
+
+static const uint8_t s_dualsense_config[] = {
+    0x09, 0x02, 0x29, 0x00, 0x01, 0x01, 0x00, 0xC0, 0xFA,
+    0x09, 0x04, 0x00, 0x00, 0x02, 0x03, 0x00, 0x00, 0x00,
+    0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, 0x11, 0x01,
+    0x07, 0x05, 0x84, 0x03, 0x40, 0x00, 0x04,
+    0x07, 0x05, 0x03, 0x03, 0x40, 0x00, 0x04,
+};
+
+static uint16_t dualsense_report(const sim_device_spec_t *spec, uint8_t daddr, uint32_t seq,
+                                 uint8_t *buf, uint16_t max_len)
+{
+    (void)spec;
+    (void)daddr;
+    uint16_t n = fill(buf, max_len, 64);
+
+    buf[0] = 0x01;
+    buf[1] = wobble(seq, 2);
+    buf[2] = wobble(seq, 3);
+    buf[3] = 0x80;
+    buf[4] = 0x80;
+    buf[7] = (uint8_t)seq;                                  /* sequence number */
+    buf[8] = (uint8_t)(0x08 | (tap(seq) ? 0x20 : 0x00));
+    return n;
+}
+
+const sim_device_spec_t sim_dev_dualsense = {
+    .name = "DualSense",
+    .desc_device = {
+        .bcdUSB = 0x0200, .bMaxPacketSize0 = 64,
+        .idVendor = 0x054C, .idProduct = 0x0CE6, .bcdDevice = 0x0100,
+        .iManufacturer = 1, .iProduct = 2, .bNumConfigurations = 1,
+    },
+    .desc_config       = s_dualsense_config,
+    .manufacturer      = "Sony Interactive Entertainment",
+    .product           = "DualSense Wireless Controller",
+    .desc_latency_us   = 2000,
+    .string_latency_us = 6000,
+    .make_report       = dualsense_report,
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Nintendo Switch Pro Controller                                        */
+/*                                                                        */
+/*  Stays silent until the host sends 80 04 (force USB), then streams     */
+/*  0x30 full reports.                                                    */
+/* ---------------------------------------------------------------------- */
+
+static const uint8_t s_switch_config[] = {
+    0x09, 0x02, 0x29, 0x00, 0x01, 0x01, 0x00, 0xA0, 0xFA,
+    0x09, 0x04, 0x00, 0x00, 0x02, 0x03, 0x00, 0x00, 0x00,
+    0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, 0xCB, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x40, 0x00, 0x08,
+    0x07, 0x05, 0x01, 0x03, 0x40, 0x00, 0x08,
+};
+
+static bool s_switch_usb_mode[SIM_MAX_DEVICES + 1];
+
+static void switch_out(const sim_device_spec_t *spec, uint8_t daddr,
+                       const uint8_t *data, uint16_t len)
+{
+    (void)spec;
+    if (len >= 2 && data[0] == 0x80 && data[1] == 0x04)
+        s_switch_usb_mode[daddr] = true;
+}
+
+static uint16_t switch_report(const sim_device_spec_t *spec, uint8_t daddr, uint32_t seq,
+                              uint8_t *buf, uint16_t max_len)
+{
+    (void)spec;
+    if (!s_switch_usb_mode[daddr])
+        return 0;
+
+    uint16_t n = fill(buf, max_len, 64);
+
+    uint16_t lx = (uint16_t)(wobble(seq, 0) << 4);
+    uint16_t ly = 0x800;
+
+    buf[0]  = 0x30;
+    buf[1]  = (uint8_t)seq;
+    buf[2]  = 0x91;
+    buf[3]  = tap(seq) ? 0x04 : 0x00;                       /* B (south) */
+    buf[6]  = (uint8_t)(lx & 0xFF);
+    buf[7]  = (uint8_t)(((lx >> 8) & 0x0F) | ((ly & 0x0F) << 4));
+    buf[8]  = (uint8_t)(ly >> 4);
+    buf[9]  = 0x00;
+    buf[10] = 0x08;
+    buf[11] = 0x80;
+    return n;
+}
+
+const sim_device_spec_t sim_dev_switch_pro = {
+    .name = "Switch Pro",
+    .desc_device = {
+        .bcdUSB = 0x0200, .bMaxPacketSize0 = 64,
+        .idVendor = 0x057E, .idProduct = 0x2009, .bcdDevice = 0x0210,
+        .iManufacturer = 1, .iProduct = 2, .bNumConfigurations = 1,
+    },
+    .desc_config       = s_switch_config,
+    .manufacturer      = "Nintendo Co., Ltd.",
+    .product           = "Pro Controller",
+    .desc_latency_us   = 2000,
+    .string_latency_us = 4000,
+    .make_report       = switch_report,
+    .on_out            = switch_out,
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Xbox 360 Wired (XInput, vendor class)                                 */
+/* ---------------------------------------------------------------------- */
+
+static const uint8_t s_xbox360_config[] = {
+    0x09, 0x02, 0x31, 0x00, 0x01, 0x01, 0x00, 0xA0, 0xFA,
+    0x09, 0x04, 0x00, 0x00, 0x02, 0xFF, 0x5D, 0x01, 0x00,
+    0x11, 0x21, 0x00, 0x01, 0x01, 0x25, 0x81, 0x14, 0x00,   /* vendor-specific */
+    0x00, 0x00, 0x00, 0x13, 0x01, 0x08, 0x00, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x20, 0x00, 0x04,
+    0x07, 0x05, 0x01, 0x03, 0x20, 0x00, 0x08,
+};
+
+static uint16_t xbox360_report(const sim_device_spec_t *spec, uint8_t daddr, uint32_t seq,
+                               uint8_t *buf, uint16_t max_len)
+{
+    (void)spec;
+    (void)daddr;
+    uint16_t n = fill(buf, max_len, 20);
+
+    int16_t lx = (int16_t)((wobble(seq, 1) - 128) * 256);
+
+    buf[0] = 0x00;
+    buf[1] = 0x14;
+    buf[3] = tap(seq) ? 0x10 : 0x00;                        /* A */
+    memcpy(buf + 6, &lx, sizeof(lx));
+    return n;
+}
+
+const sim_device_spec_t sim_dev_xbox360 = {
+    .name = "Xbox 360",
+    .desc_device = {
+        .bcdUSB = 0x0200, .bDeviceClass = 0xFF, .bDeviceSubClass = 0xFF,
+        .bDeviceProtocol = 0xFF, .bMaxPacketSize0 = 8,
+        .idVendor = 0x045E, .idProduct = 0x028E, .bcdDevice = 0x0114,
+        .iManufacturer = 1, .iProduct = 2, .bNumConfigurations = 1,
+    },
+    .desc_config       = s_xbox360_config,
+    .manufacturer      = "Microsoft",
+    .product           = "Controller",
+    .desc_latency_us   = 2000,
+    .string_latency_us = 3000,
+    .make_report       = xbox360_report,
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Xbox One S (GIP, vendor class)                                        */
+/*                                                                        */
+/*  Announces itself, then stays silent until powered on (05 20 .. 01     */
+/*  00) and streams 0x20 input packets. Every 100 packets the guide       */
+/*  button is pressed and released; each 0x07 packet asks for an          */
+/*  acknowledgement and is repeated, with input held back, until the      */
+/*  host sends it.                                                        */
+/* ---------------------------------------------------------------------- */
+
+static const uint8_t s_xbox_one_config[] = {
+    0x09, 0x02, 0x20, 0x00, 0x01, 0x01, 0x00, 0xA0, 0xFA,
+    0x09, 0x04, 0x00, 0x00, 0x02, 0xFF, 0x47, 0xD0, 0x00,   /* no class descriptor */
+    0x07, 0x05, 0x02, 0x03, 0x40, 0x00, 0x04,
+    0x07, 0x05, 0x82, 0x03, 0x40, 0x00, 0x04,
+};
+
+typedef struct {
+    bool     announced;
+    bool     powered;
+    uint8_t  seq;
+    uint8_t  unacked[6];        /* guide packet awaiting an ack, [0] = 0: none */
+    uint32_t packets;           /* input/guide packets since power on */
+    sim_xbox_one_stats_t stats;
+} xbox_one_state_t;
+
+static xbox_one_state_t s_xbox_one[SIM_MAX_DEVICES + 1];
+
+static uint8_t xbox_one_seq(xbox_one_state_t *x)
+{
+    if (++x->seq == 0)
+        x->seq = 1;
+    return x->seq;
+}
+
+static void xbox_one_out(const sim_device_spec_t *spec, uint8_t daddr,
+                         const uint8_t *data, uint16_t len)
+{
+    (void)spec;
+    xbox_one_state_t *x = &s_xbox_one[daddr];
+
+    if (len >= 5 && data[0] == 0x05 && data[3] == 0x01 && data[4] == 0x00)
+        x->powered = x->stats.powered = true;
+
+    if (len >= 13 && data[0] == 0x01 && x->unacked[0] &&
+        data[2] == x->unacked[2] && data[5] == x->unacked[0])
+    {
+        x->unacked[0] = 0;
+        x->stats.acks++;
+    }
+}
+
+static uint16_t xbox_one_report(const sim_device_spec_t *spec, uint8_t daddr, uint32_t seq,
+                                uint8_t *buf, uint16_t max_len)
+{
+    (void)spec;
+    xbox_one_state_t *x = &s_xbox_one[daddr];
+
+    if (!x->announced) {
+        uint16_t n = fill(buf, max_len, 32);
+        buf[0] = 0x02;
+        buf[1] = 0x20;
+        buf[2] = xbox_one_seq(x);
+        buf[3] = 0x1C;
+        x->announced = true;
+        return n;
+    }
+
+    if (!x->powered)
+        return 0;
+
+    if (x->unacked[0]) {
+        x->stats.resends++;
+        uint16_t n = fill(buf, max_len, sizeof(x->unacked));
+        memcpy(buf, x->unacked, n);
+        return n;
+    }
+
+    uint32_t phase = x->packets++ % 100u;
+    if (phase == 40 || phase == 46) {
+        const uint8_t guide[6] = { 0x07, 0x30, xbox_one_seq(x), 0x02,
+                                   phase == 40 ? 0x01 : 0x00, 0x5B };
+        memcpy(x->unacked, guide, sizeof(guide));
+        if (phase == 40)
+            x->stats.guide_presses++;
+        uint16_t n = fill(buf, max_len, sizeof(guide));
+        memcpy(buf, guide, n);
+        return n;
+    }
+
+    uint16_t n = fill(buf, max_len, 18);
+    int16_t  lx = (int16_t)((wobble(seq, 2) - 128) * 256);
+    uint16_t lt = (uint16_t)(wobble(seq, 3) << 2);
+
+    buf[0] = 0x20;
+    buf[1] = 0x00;
+    buf[2] = xbox_one_seq(x);
+    buf[3] = 0x0E;
+    buf[4] = tap(seq) ? 0x10 : 0x00;                        /* A */
+    buf[6] = (uint8_t)(lt & 0xFF);
+    buf[7] = (uint8_t)(lt >> 8);
+    memcpy(buf + 10, &lx, sizeof(lx));
+    return n;
+}
+
+sim_xbox_one_stats_t sim_xbox_one_stats(uint8_t daddr)
+{
+    sim_xbox_one_stats_t none = {0};
+    if (daddr == 0 || daddr > SIM_MAX_DEVICES)
+        return none;
+    sim_xbox_one_stats_t st = s_xbox_one[daddr].stats;
+    st.ack_outstanding = s_xbox_one[daddr].unacked[0] != 0;
+    return st;
+}
+
+const sim_device_spec_t sim_dev_xbox_one = {
+    .name = "Xbox One S",
+    .desc_device = {
+        .bcdUSB = 0x0200, .bDeviceClass = 0xFF, .bDeviceSubClass = 0x47,
+        .bDeviceProtocol = 0xD0, .bMaxPacketSize0 = 64,
+        .idVendor = 0x045E, .idProduct = 0x02EA, .bcdDevice = 0x0408,
+        .iManufacturer = 1, .iProduct = 2, .bNumConfigurations = 1,
+    },
+    .desc_config       = s_xbox_one_config,
+    .manufacturer      = "Microsoft",
+    .product           = "Controller",
+    .desc_latency_us   = 2000,
+    .string_latency_us = 3000,
+    .make_report       = xbox_one_report,
+    .on_out            = xbox_one_out,
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Generic USB 1.1 8-byte gamepad (DragonRise-style)                     */
+/* ---------------------------------------------------------------------- */
+
+static const uint8_t s_generic8_config[] = {
+    0x09, 0x02, 0x22, 0x00, 0x01, 0x01, 0x00, 0x80, 0xFA,
+    0x09, 0x04, 0x00, 0x00, 0x01, 0x03, 0x00, 0x00, 0x00,
+    0x09, 0x21, 0x10, 0x01, 0x21, 0x01, 0x22, 0x63, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x08, 0x00, 0x0A,
+};
+
+/* Joystick collection: 5 axes, hat, 12 buttons, 8 vendor bits, 7-byte output */
+static const uint8_t s_generic8_report_desc[] = {
+    0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0xA1, 0x02, 0x75, 0x08, 0x95, 0x05,
+    0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46, 0xFF, 0x00, 0x09, 0x32,
+    0x09, 0x35, 0x09, 0x30, 0x09, 0x31, 0x81, 0x02, 0x75, 0x04, 0x95, 0x01,
+    0x25, 0x07, 0x46, 0x3B, 0x01, 0x65, 0x14, 0x09, 0x39, 0x81, 0x42, 0x65,
+    0x00, 0x75, 0x01, 0x95, 0x0C, 0x25, 0x01, 0x45, 0x01, 0x05, 0x09, 0x19,
+    0x01, 0x29, 0x0C, 0x81, 0x02, 0x06, 0x00, 0xFF, 0x75, 0x01, 0x95, 0x08,
+    0x25, 0x01, 0x45, 0x01, 0x09, 0x01, 0x81, 0x02, 0xC0, 0xA1, 0x02, 0x75,
+    0x08, 0x95, 0x07, 0x46, 0xFF, 0x00, 0x26, 0xFF, 0x00, 0x09, 0x02, 0x91,
+    0x02, 0xC0, 0xC0,
+};
+
+static uint16_t generic8_report(const sim_device_spec_t *spec, uint8_t daddr, uint32_t seq,
+                                uint8_t *buf, uint16_t max_len)
+{
+    (void)spec;
+    (void)daddr;
+    uint16_t n = fill(buf, max_len, 8);
+
+    buf[0] = 0x7F;
+    buf[1] = 0x7F;
+    buf[2] = wobble(seq, 0);
+    buf[3] = 0x7F;
+    buf[4] = 0xFF;
+    buf[5] = (uint8_t)(0x0F | (tap(seq) ? 0x40 : 0x00));    /* hat released, cross */
+    return n;
+}
+
+const sim_device_spec_t sim_dev_generic8 = {
+    .name = "Generic 8-byte",
+    .desc_device = {
+        .bcdUSB = 0x0100, .bMaxPacketSize0 = 8,
+        .idVendor = 0x0079, .idProduct = 0x0006, .bcdDevice = 0x0107,
+        .iManufacturer = 1, .iProduct = 2, .bNumConfigurations = 1,
+    },
+    .desc_config         = s_generic8_config,
+    .desc_hid_report     = s_generic8_report_desc,
+    .desc_hid_report_len = sizeof(s_generic8_report_desc),
+    .manufacturer        = "DragonRise Inc.",
+    .product             = "Generic   USB  Joystick",
+    .desc_latency_us     = 3000,
+    .string_latency_us   = 12000,
+    .make_report         = generic8_report,
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Full-speed clone of the same pad                                      */
+/*                                                                        */
+/*  Same reports, other VID/PID, a 64-byte endpoint and the other         */
+/*  DragonRise descriptor. No quirk entry and no endpoint-size rule       */
+/*  fits it: only its descriptor fingerprint gives it a parser.           */
+/* ---------------------------------------------------------------------- */
+
+static const uint8_t s_clone8_config[] = {
+    0x09, 0x02, 0x22, 0x00, 0x01, 0x01, 0x00, 0x80, 0xFA,
+    0x09, 0x04, 0x00, 0x00, 0x01, 0x03, 0x00, 0x00, 0x00,
+    0x09, 0x21, 0x10, 0x01, 0x21, 0x01, 0x22, 0x65, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x40, 0x00, 0x0A,
+};
+
+/* As above with the axes listed X Y Z Z Rz */
+static const uint8_t s_clone8_report_desc[] = {
+    0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0xA1, 0x02, 0x75, 0x08, 0x95, 0x05,
+    0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46, 0xFF, 0x00, 0x09, 0x30,
+    0x09, 0x31, 0x09, 0x32, 0x09, 0x32, 0x09, 0x35, 0x81, 0x02, 0x75, 0x04,
+    0x95, 0x01, 0x25, 0x07, 0x46, 0x3B, 0x01, 0x65, 0x14, 0x09, 0x39, 0x81,
+    0x42, 0x65, 0x00, 0x75, 0x01, 0x95, 0x0C, 0x25, 0x01, 0x45, 0x01, 0x05,
+    0x09, 0x19, 0x01, 0x29, 0x0C, 0x81, 0x02, 0x06, 0x00, 0xFF, 0x75, 0x01,
+    0x95, 0x08, 0x25, 0x01, 0x45, 0x01, 0x09, 0x01, 0x81, 0x02, 0xC0, 0xA1,
+    0x02, 0x75, 0x08, 0x95, 0x07, 0x46, 0xFF, 0x00, 0x26, 0xFF, 0x00, 0x09,
+    0x02, 0x91, 0x02, 0xC0, 0xC0,
+};
+
+const sim_device_spec_t sim_dev_clone8 = {
+    .name = "Clone 8-byte",
+    .desc_device = {
+        .bcdUSB = 0x0110, .bMaxPacketSize0 = 64,
+        .idVendor = 0x2563, .idProduct = 0x0575, .bcdDevice = 0x0100,
+        .iManufacturer = 1, .iProduct = 2, .bNumConfigurations = 1,
+    },
+    .desc_config         = s_clone8_config,
+    .desc_hid_report     = s_clone8_report_desc,
+    .desc_hid_report_len = sizeof(s_clone8_report_desc),
+    .manufacturer        = "USB",
+    .product             = "Gamepad",
+    .desc_latency_us     = 2000,
+    .string_latency_us   = 6000,
+    .make_report         = generic8_report,
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Unknown DInput pad (classified by the report heuristic)               */
+/*                                                                        */
+/*  No quirk entry and an unknown descriptor, so only its reports say     */
+/*  what it is. Its script, by report number:                             */
+/*                                                                        */
+/*     0..3    stick pushed at plug-in: no axis near centre               */
+/*     4..8    DS4-style reports after report ID 1                        */
+/*     9..12   stick pushed again                                         */
+/*    13..59   DS4-style reports                                          */
+/*    60..79   report ID 5, which no DInput parse accepts                 */
+/*    80..     DS4-style reports                                          */
+/* ---------------------------------------------------------------------- */
+
+static const uint8_t s_dinput_config[] = {
+    0x09, 0x02, 0x22, 0x00, 0x01, 0x01, 0x00, 0x80, 0xFA,
+    0x09, 0x04, 0x00, 0x00, 0x01, 0x03, 0x00, 0x00, 0x00,
+    0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, 0x54, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x40, 0x00, 0x02,
+};
+
+/* Gamepad, report ID 1: X Y Z Rz, hat, 14 buttons, 6 + 8 vendor bits */
+static const uint8_t s_dinput_report_desc[] = {
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01, 0x85, 0x01, 0x09, 0x30, 0x09, 0x31,
+    0x09, 0x32, 0x09, 0x35, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95,
+    0x04, 0x81, 0x02, 0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x35, 0x00, 0x46,
+    0x3B, 0x01, 0x65, 0x14, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42, 0x65, 0x00,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x0E, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01,
+    0x95, 0x0E, 0x81, 0x02, 0x06, 0x00, 0xFF, 0x09, 0x20, 0x75, 0x06, 0x95,
+    0x01, 0x81, 0x02, 0x09, 0x21, 0x75, 0x08, 0x95, 0x01, 0x81, 0x02, 0xC0,
+};
+
+static uint16_t dinput_report(const sim_device_spec_t *spec, uint8_t daddr, uint32_t seq,
+                              uint8_t *buf, uint16_t max_len)
+{
+    (void)spec;
+    (void)daddr;
+    uint16_t n = fill(buf, max_len, 9);
+    bool pushed = seq < 4 || (seq >= 9 && seq < 13);
+
+    buf[0] = (seq >= 60 && seq < 80) ? 0x05 : 0x01;
+    buf[1] = pushed ? 0x00 : wobble(seq, 0);
+    buf[2] = pushed ? 0x00 : wobble(seq, 1);
+    buf[3] = pushed ? 0xFF : 0x80;
+    buf[4] = pushed ? 0xFF : 0x80;
+    buf[5] = (uint8_t)(0x08 | (tap(seq) ? 0x20 : 0x00));    /* hat released, cross */
+    return n;
+}
+
+const sim_device_spec_t sim_dev_dinput = {
+    .name = "DInput pad",
+    .desc_device = {
+        .bcdUSB = 0x0200, .bMaxPacketSize0 = 64,
+        .idVendor = 0x1209, .idProduct = 0x0001, .bcdDevice = 0x0100,
+        .iManufacturer = 1, .iProduct = 2, .bNumConfigurations = 1,
+    },
+    .desc_config         = s_dinput_config,
+    .desc_hid_report     = s_dinput_report_desc,
+    .desc_hid_report_len = sizeof(s_dinput_report_desc),
+    .manufacturer        = "pid.codes",
+    .product             = "Test Gamepad",
+    .desc_latency_us     = 2000,
+    .string_latency_us   = 4000,
+    .make_report         = dinput_report,
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Boot keyboard (not a gamepad — should never look like one)            */
+/* ---------------------------------------------------------------------- */
+
+static const uint8_t s_keyboard_config[] = {
+    0x09, 0x02, 0x22, 0x00, 0x01, 0x01, 0x00, 0xA0, 0x32,
+    0x09, 0x04, 0x00, 0x00, 0x01, 0x03, 0x01, 0x01, 0x00,
+    0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, 0x3F, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x08, 0x00, 0x0A,
+};
+
+/* HID 1.11 Appendix E.6 boot keyboard report descriptor */
+static const uint8_t s_keyboard_report_desc[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7,
+    0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02, 0x95, 0x01,
+    0x75, 0x08, 0x81, 0x01, 0x95, 0x05, 0x75, 0x01, 0x05, 0x08, 0x19, 0x01,
+    0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01, 0x95, 0x06,
+    0x75, 0x08, 0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65,
+    0x81, 0x00, 0xC0,
+};
+
+static uint16_t keyboard_report(const sim_device_spec_t *spec, uint8_t daddr, uint32_t seq,
+                                uint8_t *buf, uint16_t max_len)
+{
+    (void)spec;
+    (void)daddr;
+    uint16_t n = fill(buf, max_len, 8);
+
+    /* Occasional 'a' key press */
+    if ((seq % 40u) < 2u)
+        buf[2] = 0x04;
+    return n;
+}
+
+const sim_device_spec_t sim_dev_keyboard = {
+    .name = "Keyboard",
+    .desc_device = {
+        .bcdUSB = 0x0110, .bMaxPacketSize0 = 8,
+        .idVendor = 0x046D, .idProduct = 0xC31C, .bcdDevice = 0x6400,
+        .iManufacturer = 1, .iProduct = 2, .bNumConfigurations = 1,
+    },
+    .desc_config         = s_keyboard_config,
+    .desc_hid_report     = s_keyboard_report_desc,
+    .desc_hid_report_len = sizeof(s_keyboard_report_desc),
+    .manufacturer        = "Logitech",
+    .product             = "USB Keyboard",
+    .desc_latency_us     = 2000,
+    .string_latency_us   = 4000,
+    .make_report         = keyboard_report,
+};
@@ -0,0 +1,615 @@
+/*
+ * TJUH host bench — virtual USB bus implementation
+ *
+ * Models the parts of a TinyUSB host that matter for TJUH timing:
+ *   - one shared control pipe; a request made while it is busy is rejected
+ *     exactly like tuh_control_xfer() does
+ *   - stack enumeration of newly plugged devices, in plug order, competing
+ *     for the control pipe with application requests
+ *   - interrupt endpoints polled on their bInterval schedule
+ *   - blocking (NULL callback) control requests that spin tuh_task()
+ */
+
+#include "sim_usb.h"
+#include "host/usbh_pvt.h"
+#include "bsp/board.h"
+
+#include <stdio.h>
+
+#define SIM_MAX_EP         6
+#define SIM_CTRL_BUF_SIZE  1024
+
+typedef struct {
+    bool       opened;
+    bool       busy;
+    uint8_t    ep_addr;
+    uint16_t   max_packet;
+    uint32_t   interval_us;
+    uint64_t   due_us;
+    tuh_xfer_t xfer;
+} sim_ep_t;
+
+typedef struct {
+    const sim_device_spec_t *spec;
+    bool       attached;
+    bool       mounted;
+    uint64_t   plug_us;
+    uint32_t   report_seq;
+    uint32_t   in_reports;
+    sim_ep_t   ep[SIM_MAX_EP];
+} sim_dev_t;
+
+/* Index 0 is unused — device addresses are 1-based */
+static sim_dev_t s_dev[SIM_MAX_DEVICES + 1];
+static uint64_t  s_now_us;
+
+static struct {
+    bool                   busy;
+    bool                   stack;
+    uint8_t                stack_dev;
+    uint64_t               due_us;
+    int                    resp_len;
+    tuh_xfer_t             xfer;
+    tusb_control_request_t setup;
+    uint8_t                data[SIM_CTRL_BUF_SIZE];
+} s_ctrl;
+
+static struct {
+    uint8_t  dev;
+    uint8_t  steps_done;
+    uint64_t next_step_us;
+} s_stack;
+
+static uint32_t s_stack_step_us = 3000;
+static uint8_t  s_stack_steps   = 6;
+static uint32_t s_busy_rejects;
+
+/* ---------------------------------------------------------------------- */
+/*  Bus control                                                           */
+/* ---------------------------------------------------------------------- */
+
+void sim_reset(void)
+{
+    memset(s_dev, 0, sizeof(s_dev));
+    memset(&s_ctrl, 0, sizeof(s_ctrl));
+    memset(&s_stack, 0, sizeof(s_stack));
+    s_now_us = 0;
+    s_busy_rejects = 0;
+}
+
+void sim_set_stack_enum_us(uint32_t step_us, uint8_t steps)
+{
+    s_stack_step_us = step_us;
+    s_stack_steps   = steps ? steps : 1;
+}
+
+uint8_t sim_plug(const sim_device_spec_t *spec, uint64_t at_us)
+{
+    for (uint8_t a = 1; a <= SIM_MAX_DEVICES; a++) {
+        if (!s_dev[a].attached) {
+            memset(&s_dev[a], 0, sizeof(s_dev[a]));
+            s_dev[a].spec     = spec;
+            s_dev[a].attached = true;
+            s_dev[a].plug_us  = at_us;
+            return a;
+        }
+    }
+    return 0;
+}
+
+void sim_unplug(uint8_t daddr)
+{
+    if (daddr == 0 || daddr > SIM_MAX_DEVICES || !s_dev[daddr].attached)
+        return;
+
+    bool was_mounted = s_dev[daddr].mounted;
+    memset(&s_dev[daddr], 0, sizeof(s_dev[daddr]));
+
+    if (s_ctrl.busy && s_ctrl.xfer.daddr == daddr && !s_ctrl.stack)
+        s_ctrl.busy = false;
+
+    if (was_mounted)
+        tuh_umount_cb(daddr);
+}
+
+uint64_t sim_now_us(void)
+{
+    return s_now_us;
+}
+
+void sim_run_until(uint64_t t_us, void (*task)(void))
+{
+    while (s_now_us < t_us)
+        task();
+}
+
+uint32_t sim_in_reports(uint8_t daddr)
+{
+    return (daddr && daddr <= SIM_MAX_DEVICES) ? s_dev[daddr].in_reports : 0;
+}
+
+uint32_t sim_control_busy_rejects(void)
+{
+    return s_busy_rejects;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Board stand-in                                                        */
+/* ---------------------------------------------------------------------- */
+
+void board_init(void)
+{
+}
+
+uint32_t board_millis(void)
+{
+    return (uint32_t)(s_now_us / 1000);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Control requests                                                      */
+/* ---------------------------------------------------------------------- */
+
+static int make_string(const char *str, uint8_t *buf, uint16_t len)
+{
+    size_t n = strlen(str);
+    uint8_t total = (uint8_t)(2 + 2 * n);
+    uint8_t tmp[256];
+
+    tmp[0] = total;
+    tmp[1] = TUSB_DESC_STRING;
+    for (size_t i = 0; i < n; i++) {
+        tmp[2 + 2 * i] = (uint8_t)str[i];
+        tmp[3 + 2 * i] = 0;
+    }
+
+    int out = total < len ? total : len;
+    memcpy(buf, tmp, (size_t)out);
+    return out;
+}
+
+static int answer_request(const sim_device_spec_t *spec, uint8_t daddr,
+                          const tusb_control_request_t *req,
+                          uint8_t *buf, uint16_t len, uint32_t *latency_us)
+{
+    *latency_us = spec->desc_latency_us;
+
+    if (req->bRequest != TUSB_REQ_GET_DESCRIPTOR ||
+        req->bmRequestType_bit.type != TUSB_REQ_TYPE_STANDARD)
+    {
+        return spec->on_control ? spec->on_control(spec, daddr, req, buf, len) : -1;
+    }
+
+    uint8_t type  = (uint8_t)(req->wValue >> 8);
+    uint8_t index = (uint8_t)(req->wValue & 0xFF);
+    int     out;
+
+    switch (type) {
+        case TUSB_DESC_DEVICE:
+            out = len < sizeof(tusb_desc_device_t) ? len : (int)sizeof(tusb_desc_device_t);
+            memcpy(buf, &spec->desc_device, (size_t)out);
+            buf[0] = sizeof(tusb_desc_device_t);
+            buf[1] = TUSB_DESC_DEVICE;
+            return out;
+
+        case TUSB_DESC_CONFIGURATION: {
+            uint16_t total = (uint16_t)(spec->desc_config[2] | (spec->desc_config[3] << 8));
+            out = total < len ? total : len;
+            memcpy(buf, spec->desc_config, (size_t)out);
+            return out;
+        }
+
+        case TUSB_DESC_STRING:
+            *latency_us = spec->string_latency_us;
+            if (index == 0) {
+                static const uint8_t langs[] = {4, TUSB_DESC_STRING, 0x09, 0x04};
+                out = len < sizeof(langs) ? len : (int)sizeof(langs);
+                memcpy(buf, langs, (size_t)out);
+                return out;
+            }
+            if (index == spec->desc_device.iManufacturer && spec->manufacturer)
+                return make_string(spec->manufacturer, buf, len);
+            if (index == spec->desc_device.iProduct && spec->product)
+                return make_string(spec->product, buf, len);
+            return -1;
+
+        case HID_DESC_TYPE_REPORT:
+            if (!spec->desc_hid_report)
+                return -1;
+            out = spec->desc_hid_report_len < len ? spec->desc_hid_report_len : len;
+            memcpy(buf, spec->desc_hid_report, (size_t)out);
+            return out;
+
+        default:
+            return -1;
+    }
+}
+
+static void sync_complete(tuh_xfer_t *xfer)
+{
+    *(volatile xfer_result_t *)xfer->user_data = xfer->result;
+}
+
+bool tuh_control_xfer(tuh_xfer_t *xfer)
+{
+    uint8_t daddr = xfer->daddr;
+
+    if (s_ctrl.busy) {
+        s_busy_rejects++;
+        return false;
+    }
+    if (daddr == 0 || daddr > SIM_MAX_DEVICES || !s_dev[daddr].mounted)
+        return false;
+
+    const tusb_control_request_t *req = xfer->setup;
+    uint32_t latency_us;
+
+    s_ctrl.setup    = *req;
+    s_ctrl.xfer     = *xfer;
+    s_ctrl.xfer.setup = &s_ctrl.setup;
+    s_ctrl.resp_len = answer_request(s_dev[daddr].spec, daddr, req, s_ctrl.data,
+                                     req->wLength < SIM_CTRL_BUF_SIZE ? req->wLength
+                                                                      : SIM_CTRL_BUF_SIZE,
+                                     &latency_us);
+    s_ctrl.busy     = true;
+    s_ctrl.stack    = false;
+    s_ctrl.due_us   = s_now_us + latency_us;
+
+    /* Direction OUT: the data stage carries the caller's payload */
+    if (!req->bmRequestType_bit.direction && req->wLength && xfer->buffer)
+        memcpy(s_ctrl.data, xfer->buffer,
+               req->wLength < SIM_CTRL_BUF_SIZE ? req->wLength : SIM_CTRL_BUF_SIZE);
+
+    if (xfer->complete_cb)
+        return true;
+
+    /* Blocking request: spin the stack like TinyUSB does */
+    volatile xfer_result_t result = XFER_RESULT_INVALID;
+    s_ctrl.xfer.complete_cb = sync_complete;
+    s_ctrl.xfer.user_data   = (uintptr_t)&result;
+
+    while (result == XFER_RESULT_INVALID)
+        tuh_task();
+
+    xfer->result     = result;
+    xfer->actual_len = s_ctrl.xfer.actual_len;
+    return true;
+}
+
+static bool get_descriptor(uint8_t daddr, uint8_t recipient, uint8_t type, uint8_t index,
+                           uint16_t windex, void *buffer, uint16_t len,
+                           tuh_xfer_cb_t complete_cb, uintptr_t user_data)
+{
+    tusb_control_request_t const request = {
+        .bmRequestType_bit = {
+            .recipient = recipient,
+            .type      = TUSB_REQ_TYPE_STANDARD,
+            .direction = TUSB_DIR_IN,
+        },
+        .bRequest = TUSB_REQ_GET_DESCRIPTOR,
+        .wValue   = (uint16_t)((type << 8) | index),
+        .wIndex   = windex,
+        .wLength  = len,
+    };
+
+    tuh_xfer_t xfer = {
+        .daddr       = daddr,
+        .ep_addr     = 0,
+        .setup       = &request,
+        .buffer      = buffer,
+        .complete_cb = complete_cb,
+        .user_data   = user_data,
+    };
+
+    return tuh_control_xfer(&xfer);
+}
+
+bool tuh_descriptor_get(uint8_t daddr, uint8_t type, uint8_t index,
+                        void *buffer, uint16_t len,
+                        tuh_xfer_cb_t complete_cb, uintptr_t user_data)
+{
+    return get_descriptor(daddr, TUSB_REQ_RCPT_DEVICE, type, index, 0,
+                          buffer, len, complete_cb, user_data);
+}
+
+bool tuh_descriptor_get_device(uint8_t daddr, void *buffer, uint16_t len,
+                               tuh_xfer_cb_t complete_cb, uintptr_t user_data)
+{
+    return tuh_descriptor_get(daddr, TUSB_DESC_DEVICE, 0, buffer, len, complete_cb, user_data);
+}
+
+bool tuh_descriptor_get_configuration(uint8_t daddr, uint8_t index, void *buffer, uint16_t len,
+                                      tuh_xfer_cb_t complete_cb, uintptr_t user_data)
+{
+    return tuh_descriptor_get(daddr, TUSB_DESC_CONFIGURATION, index, buffer, len,
+                              complete_cb, user_data);
+}
+
+bool tuh_descriptor_get_string(uint8_t daddr, uint8_t index, uint16_t language_id,
+                               void *buffer, uint16_t len,
+                               tuh_xfer_cb_t complete_cb, uintptr_t user_data)
+{
+    return get_descriptor(daddr, TUSB_REQ_RCPT_DEVICE, TUSB_DESC_STRING, index, language_id,
+                          buffer, len, complete_cb, user_data);
+}
+
+bool tuh_descriptor_get_manufacturer_string(uint8_t daddr, uint16_t language_id,
+                                            void *buffer, uint16_t len,
+                                            tuh_xfer_cb_t complete_cb, uintptr_t user_data)
+{
+    if (!daddr || daddr > SIM_MAX_DEVICES || !s_dev[daddr].spec)
+        return false;
+    return tuh_descriptor_get_string(daddr, s_dev[daddr].spec->desc_device.iManufacturer,
+                                     language_id, buffer, len, complete_cb, user_data);
+}
+
+bool tuh_descriptor_get_product_string(uint8_t daddr, uint16_t language_id,
+                                       void *buffer, uint16_t len,
+                                       tuh_xfer_cb_t complete_cb, uintptr_t user_data)
+{
+    if (!daddr || daddr > SIM_MAX_DEVICES || !s_dev[daddr].spec)
+        return false;
+    return tuh_descriptor_get_string(daddr, s_dev[daddr].spec->desc_device.iProduct,
+                                     language_id, buffer, len, complete_cb, user_data);
+}
+
+bool tuh_descriptor_get_hid_report(uint8_t daddr, uint8_t itf_num, uint8_t desc_type,
+                                   uint8_t index, void *buffer, uint16_t len,
+                                   tuh_xfer_cb_t complete_cb, uintptr_t user_data)
+{
+    return get_descriptor(daddr, TUSB_REQ_RCPT_INTERFACE, desc_type, index, itf_num,
+                          buffer, len, complete_cb, user_data);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Endpoints                                                             */
+/* ---------------------------------------------------------------------- */
+
+static sim_ep_t *find_ep(uint8_t daddr, uint8_t ep_addr)
+{
+    if (daddr == 0 || daddr > SIM_MAX_DEVICES)
+        return NULL;
+
+    for (int i = 0; i < SIM_MAX_EP; i++) {
+        if (s_dev[daddr].ep[i].opened && s_dev[daddr].ep[i].ep_addr == ep_addr)
+            return &s_dev[daddr].ep[i];
+    }
+    return NULL;
+}
+
+static uint64_t next_poll_slot(const sim_ep_t *ep, uint64_t after_us)
+{
+    uint64_t slot = (after_us / ep->interval_us + 1) * ep->interval_us;
+    return slot;
+}
+
+bool tuh_edpt_open(uint8_t daddr, tusb_desc_endpoint_t const *desc_ep)
+{
+    if (daddr == 0 || daddr > SIM_MAX_DEVICES || !s_dev[daddr].mounted)
+        return false;
+
+    if (find_ep(daddr, desc_ep->bEndpointAddress))
+        return true;
+
+    for (int i = 0; i < SIM_MAX_EP; i++) {
+        sim_ep_t *ep = &s_dev[daddr].ep[i];
+        if (!ep->opened) {
+            memset(ep, 0, sizeof(*ep));
+            ep->opened      = true;
+            ep->ep_addr     = desc_ep->bEndpointAddress;
+            ep->max_packet  = tu_edpt_packet_size(desc_ep);
+            ep->interval_us = (desc_ep->bInterval ? desc_ep->bInterval : 1) * 1000u;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool tuh_edpt_xfer(tuh_xfer_t *xfer)
+{
+    sim_ep_t *ep = find_ep(xfer->daddr, xfer->ep_addr);
+    if (!ep || ep->busy)
+        return false;
+
+    ep->xfer = *xfer;
+    ep->busy = true;
+
+    if (tu_edpt_dir(xfer->ep_addr) == TUSB_DIR_IN) {
+        ep->due_us = next_poll_slot(ep, s_now_us);
+    } else {
+        const sim_device_spec_t *spec = s_dev[xfer->daddr].spec;
+        if (spec->on_out)
+            spec->on_out(spec, xfer->daddr, xfer->buffer, (uint16_t)xfer->buflen);
+        ep->due_us = s_now_us + 1000;
+    }
+    return true;
+}
+
+bool usbh_edpt_busy(uint8_t dev_addr, uint8_t ep_addr)
+{
+    sim_ep_t *ep = find_ep(dev_addr, ep_addr);
+    return ep && ep->busy;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Stack                                                                 */
+/* ---------------------------------------------------------------------- */
+
+bool tuh_init(uint8_t rhport)
+{
+    (void)rhport;
+    return true;
+}
+
+bool tuh_mounted(uint8_t daddr)
+{
+    return daddr && daddr <= SIM_MAX_DEVICES && s_dev[daddr].mounted;
+}
+
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t *vid, uint16_t *pid)
+{
+    if (!tuh_mounted(daddr))
+        return false;
+    *vid = s_dev[daddr].spec->desc_device.idVendor;
+    *pid = s_dev[daddr].spec->desc_device.idProduct;
+    return true;
+}
+
+static void stack_pick_next(void)
+{
+    if (s_stack.dev)
+        return;
+
+    uint8_t  best    = 0;
+    uint64_t best_us = UINT64_MAX;
+
+    for (uint8_t a = 1; a <= SIM_MAX_DEVICES; a++) {
+        if (s_dev[a].attached && !s_dev[a].mounted &&
+            s_dev[a].plug_us <= s_now_us && s_dev[a].plug_us < best_us)
+        {
+            best    = a;
+            best_us = s_dev[a].plug_us;
+        }
+    }
+
+    if (best) {
+        s_stack.dev          = best;
+        s_stack.steps_done   = 0;
+        s_stack.next_step_us = s_now_us;
+    }
+}
+
+static uint64_t next_event_us(void)
+{
+    uint64_t next = UINT64_MAX;
+
+    if (s_ctrl.busy && s_ctrl.due_us < next)
+        next = s_ctrl.due_us;
+
+    if (s_stack.dev && !s_ctrl.busy && s_stack.next_step_us < next)
+        next = s_stack.next_step_us;
+
+    for (uint8_t a = 1; a <= SIM_MAX_DEVICES; a++) {
+        if (!s_dev[a].attached)
+            continue;
+        if (!s_dev[a].mounted && s_dev[a].plug_us > s_now_us && s_dev[a].plug_us < next)
+            next = s_dev[a].plug_us;
+        for (int i = 0; i < SIM_MAX_EP; i++) {
+            const sim_ep_t *ep = &s_dev[a].ep[i];
+            if (ep->busy && ep->due_us < next)
+                next = ep->due_us;
+        }
+    }
+
+    return next;
+}
+
+static void stack_claim_pipe(void)
+{
+    if (s_stack.dev && !s_ctrl.busy && s_stack.next_step_us <= s_now_us) {
+        s_ctrl.busy      = true;
+        s_ctrl.stack     = true;
+        s_ctrl.stack_dev = s_stack.dev;
+        s_ctrl.due_us    = s_now_us + s_stack_step_us;
+    }
+}
+
+static void complete_control(void)
+{
+    tuh_xfer_t xfer = s_ctrl.xfer;
+    s_ctrl.busy = false;
+
+    if (s_ctrl.stack) {
+        uint8_t dev = s_ctrl.stack_dev;
+        if (s_stack.dev != dev || !s_dev[dev].attached)
+            return;
+
+        /* The stack chains its enumeration requests back-to-back */
+        s_stack.steps_done++;
+        s_stack.next_step_us = s_now_us;
+
+        if (s_stack.steps_done >= s_stack_steps) {
+            s_dev[dev].mounted = true;
+            s_stack.dev = 0;
+            tuh_mount_cb(dev);
+        }
+        return;
+    }
+
+    if (s_ctrl.resp_len < 0) {
+        xfer.result     = XFER_RESULT_STALLED;
+        xfer.actual_len = 0;
+    } else {
+        xfer.result     = XFER_RESULT_SUCCESS;
+        xfer.actual_len = (uint32_t)s_ctrl.resp_len;
+        if (s_ctrl.setup.bmRequestType_bit.direction && xfer.buffer)
+            memcpy(xfer.buffer, s_ctrl.data, (size_t)s_ctrl.resp_len);
+    }
+
+    /* Blocking callers read actual_len back from here */
+    s_ctrl.xfer.actual_len = xfer.actual_len;
+
+    /* A waiting stack request is queued ahead of whatever the callback
+     * submits next, so back-to-back application requests cannot starve
+     * enumeration of newly attached devices */
+    stack_pick_next();
+    stack_claim_pipe();
+
+    if (xfer.complete_cb)
+        xfer.complete_cb(&xfer);
+}
+
+static void complete_endpoint(uint8_t daddr, sim_ep_t *ep)
+{
+    tuh_xfer_t xfer = ep->xfer;
+
+    if (tu_edpt_dir(ep->ep_addr) == TUSB_DIR_IN) {
+        const sim_device_spec_t *spec = s_dev[daddr].spec;
+        uint16_t max = (uint16_t)(xfer.buflen < ep->max_packet ? xfer.buflen : ep->max_packet);
+        uint16_t len = spec->make_report(spec, daddr, s_dev[daddr].report_seq, xfer.buffer, max);
+
+        if (len == 0) {
+            /* NAK: the host retries on the next polling slot */
+            ep->due_us = next_poll_slot(ep, s_now_us);
+            return;
+        }
+
+        s_dev[daddr].report_seq++;
+        s_dev[daddr].in_reports++;
+        xfer.actual_len = len;
+    } else {
+        xfer.actual_len = xfer.buflen;
+    }
+
+    ep->busy    = false;
+    xfer.result = XFER_RESULT_SUCCESS;
+
+    if (xfer.complete_cb)
+        xfer.complete_cb(&xfer);
+}
+
+void tuh_task(void)
+{
+    stack_pick_next();
+
+    uint64_t next = next_event_us();
+    if (next == UINT64_MAX)
+        next = s_now_us + 1000;
+    if (next > s_now_us)
+        s_now_us = next;
+
+    stack_pick_next();
+
+    if (s_ctrl.busy && s_ctrl.due_us <= s_now_us)
+        complete_control();
+
+    stack_claim_pipe();
+
+    for (uint8_t a = 1; a <= SIM_MAX_DEVICES; a++) {
+        for (int i = 0; i < SIM_MAX_EP; i++) {
+            sim_ep_t *ep = &s_dev[a].ep[i];
+            if (s_dev[a].attached && ep->busy && ep->due_us <= s_now_us)
+                complete_endpoint(a, ep);
+        }
+    }
+}
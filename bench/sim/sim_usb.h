@@ -0,0 +1,96 @@
+/*
+ * TJUH host bench — virtual USB bus
+ *
+ * Devices are described by a sim_device_spec_t and plugged at a simulated
+ * time. The "stack" then enumerates them one at a time over the shared
+ * control pipe (like TinyUSB behind a hub) and raises tuh_mount_cb().
+ * Interrupt IN transfers complete on each device's polling interval with a
+ * report produced by the spec's generator.
+ *
+ * All times are in simulated microseconds. tuh_task() advances the clock to
+ * the next pending bus event, so a bench loop runs as fast as the host can
+ * execute the library code.
+ */
+
+#ifndef SIM_USB_H
+#define SIM_USB_H
+
+#include "tusb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_MAX_DEVICES 8
+
+typedef struct sim_device_spec sim_device_spec_t;
+
+struct sim_device_spec {
+    const char    *name;
+    tusb_desc_device_t desc_device;
+
+    const uint8_t *desc_config;        /* full configuration descriptor */
+    const uint8_t *desc_hid_report;    /* HID report descriptor, may be NULL */
+    uint16_t       desc_hid_report_len;
+
+    const char    *manufacturer;
+    const char    *product;
+
+    uint32_t       desc_latency_us;    /* per descriptor control transfer */
+    uint32_t       string_latency_us;  /* per string descriptor (often slow) */
+
+    /* Fill the next IN report; returns its length (0 = NAK this poll) */
+    uint16_t (*make_report)(const sim_device_spec_t *spec, uint8_t daddr, uint32_t seq,
+                            uint8_t *buf, uint16_t max_len);
+
+    /* Optional: observe OUT endpoint data */
+    void (*on_out)(const sim_device_spec_t *spec, uint8_t daddr,
+                   const uint8_t *data, uint16_t len);
+
+    /* Optional: answer a class/vendor control request; returns data length,
+     * or -1 to STALL */
+    int (*on_control)(const sim_device_spec_t *spec, uint8_t daddr,
+                      const tusb_control_request_t *req, uint8_t *buf, uint16_t len);
+};
+
+/* Built-in device models (sim_devices.c) */
+extern const sim_device_spec_t sim_dev_ds4;
+extern const sim_device_spec_t sim_dev_dualsense;
+extern const sim_device_spec_t sim_dev_switch_pro;
+extern const sim_device_spec_t sim_dev_xbox360;
+extern const sim_device_spec_t sim_dev_xbox_one;
+extern const sim_device_spec_t sim_dev_generic8;
+extern const sim_device_spec_t sim_dev_clone8;
+extern const sim_device_spec_t sim_dev_dinput;      /* scripted, see sim_devices.c */
+extern const sim_device_spec_t sim_dev_keyboard;
+
+/* Xbox One model: protocol counters */
+typedef struct {
+    bool     powered;
+    bool     ack_outstanding;   /* a guide packet is waiting for its ack */
+    uint32_t guide_presses;
+    uint32_t acks;
+    uint32_t resends;           /* packets repeated for a missing ack */
+} sim_xbox_one_stats_t;
+
+sim_xbox_one_stats_t sim_xbox_one_stats(uint8_t daddr);
+
+/* Bus control */
+void     sim_reset(void);
+uint8_t  sim_plug(const sim_device_spec_t *spec, uint64_t at_us);
+void     sim_unplug(uint8_t daddr);
+uint64_t sim_now_us(void);
+void     sim_run_until(uint64_t t_us, void (*task)(void));
+
+/* Time the stack needs to enumerate one device before tuh_mount_cb() */
+void     sim_set_stack_enum_us(uint32_t step_us, uint8_t steps);
+
+/* Statistics */
+uint32_t sim_in_reports(uint8_t daddr);
+uint32_t sim_control_busy_rejects(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_USB_H */
@@ -0,0 +1,258 @@
+/*
+ * TJUH host bench — minimal TinyUSB stand-in
+ *
+ * Declares the subset of the TinyUSB host API that TJUH uses, with the same
+ * names and signatures as TinyUSB 0.16. The implementation in sim_usb.c runs
+ * a virtual USB bus on a simulated clock so the library can be exercised and
+ * timed on a development machine. Not a general TinyUSB replacement.
+ */
+
+#ifndef _TUSB_H_
+#define _TUSB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TUSB_VERSION_MAJOR 0
+#define TUSB_VERSION_MINOR 16
+
+#ifndef BOARD_TUH_RHPORT
+#define BOARD_TUH_RHPORT 0
+#endif
+
+#define TU_ATTR_PACKED      __attribute__((packed))
+#define TU_ARRAY_SIZE(_arr) (sizeof(_arr) / sizeof(_arr[0]))
+#define TU_MIN(_x, _y)      (((_x) < (_y)) ? (_x) : (_y))
+
+/* ---------------------------------------------------------------------- */
+/*  Descriptor types                                                      */
+/* ---------------------------------------------------------------------- */
+
+typedef enum {
+    TUSB_DESC_DEVICE                = 0x01,
+    TUSB_DESC_CONFIGURATION         = 0x02,
+    TUSB_DESC_STRING                = 0x03,
+    TUSB_DESC_INTERFACE             = 0x04,
+    TUSB_DESC_ENDPOINT              = 0x05,
+    TUSB_DESC_INTERFACE_ASSOCIATION = 0x0B,
+    HID_DESC_TYPE_HID               = 0x21,
+    HID_DESC_TYPE_REPORT            = 0x22,
+} tusb_desc_type_t;
+
+typedef enum {
+    TUSB_DIR_OUT = 0,
+    TUSB_DIR_IN  = 1,
+} tusb_dir_t;
+
+typedef enum {
+    TUSB_XFER_CONTROL     = 0,
+    TUSB_XFER_ISOCHRONOUS = 1,
+    TUSB_XFER_BULK        = 2,
+    TUSB_XFER_INTERRUPT   = 3,
+} tusb_xfer_type_t;
+
+typedef enum {
+    TUSB_REQ_GET_DESCRIPTOR = 0x06,
+} tusb_request_code_t;
+
+typedef enum {
+    TUSB_REQ_TYPE_STANDARD = 0,
+    TUSB_REQ_TYPE_CLASS    = 1,
+    TUSB_REQ_TYPE_VENDOR   = 2,
+} tusb_request_type_t;
+
+typedef enum {
+    TUSB_REQ_RCPT_DEVICE    = 0,
+    TUSB_REQ_RCPT_INTERFACE = 1,
+    TUSB_REQ_RCPT_ENDPOINT  = 2,
+} tusb_request_recipient_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t  iManufacturer;
+    uint8_t  iProduct;
+    uint8_t  iSerialNumber;
+    uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t wTotalLength;
+    uint8_t  bNumInterfaces;
+    uint8_t  bConfigurationValue;
+    uint8_t  iConfiguration;
+    uint8_t  bmAttributes;
+    uint8_t  bMaxPower;
+} tusb_desc_configuration_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bInterfaceNumber;
+    uint8_t bAlternateSetting;
+    uint8_t bNumEndpoints;
+    uint8_t bInterfaceClass;
+    uint8_t bInterfaceSubClass;
+    uint8_t bInterfaceProtocol;
+    uint8_t iInterface;
+} tusb_desc_interface_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint8_t bFirstInterface;
+    uint8_t bInterfaceCount;
+    uint8_t bFunctionClass;
+    uint8_t bFunctionSubClass;
+    uint8_t bFunctionProtocol;
+    uint8_t iFunction;
+} tusb_desc_interface_assoc_t;
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint8_t  bEndpointAddress;
+    struct TU_ATTR_PACKED {
+        uint8_t xfer  : 2;
+        uint8_t sync  : 2;
+        uint8_t usage : 2;
+        uint8_t       : 2;
+    } bmAttributes;
+    uint16_t wMaxPacketSize;
+    uint8_t  bInterval;
+} tusb_desc_endpoint_t;
+
+typedef struct TU_ATTR_PACKED {
+    union {
+        struct TU_ATTR_PACKED {
+            uint8_t recipient : 5;
+            uint8_t type      : 2;
+            uint8_t direction : 1;
+        } bmRequestType_bit;
+        uint8_t bmRequestType;
+    };
+    uint8_t  bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+/* ---------------------------------------------------------------------- */
+/*  Descriptor helpers                                                    */
+/* ---------------------------------------------------------------------- */
+
+static inline uint8_t const *tu_desc_next(void const *desc)
+{
+    uint8_t const *desc8 = (uint8_t const *)desc;
+    return desc8 + desc8[0];
+}
+
+static inline uint8_t tu_desc_type(void const *desc)
+{
+    return ((uint8_t const *)desc)[1];
+}
+
+static inline uint8_t tu_desc_len(void const *desc)
+{
+    return ((uint8_t const *)desc)[0];
+}
+
+static inline uint16_t tu_le16toh(uint16_t v) { return v; }
+static inline uint16_t tu_htole16(uint16_t v) { return v; }
+
+static inline tusb_dir_t tu_edpt_dir(uint8_t addr)
+{
+    return (addr & 0x80) ? TUSB_DIR_IN : TUSB_DIR_OUT;
+}
+
+static inline uint16_t tu_edpt_packet_size(tusb_desc_endpoint_t const *desc_ep)
+{
+    return tu_le16toh(desc_ep->wMaxPacketSize) & 0x7FF;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Host transfers                                                        */
+/* ---------------------------------------------------------------------- */
+
+typedef enum {
+    XFER_RESULT_SUCCESS = 0,
+    XFER_RESULT_FAILED,
+    XFER_RESULT_STALLED,
+    XFER_RESULT_TIMEOUT,
+    XFER_RESULT_INVALID,
+} xfer_result_t;
+
+typedef struct tuh_xfer_s tuh_xfer_t;
+typedef void (*tuh_xfer_cb_t)(tuh_xfer_t *xfer);
+
+struct tuh_xfer_s {
+    uint8_t       daddr;
+    uint8_t       ep_addr;
+    uint8_t       reserved;
+    xfer_result_t result;
+    uint32_t      actual_len;
+
+    union {
+        tusb_control_request_t const *setup;
+        uint32_t                      buflen;
+    };
+
+    uint8_t      *buffer;
+    tuh_xfer_cb_t complete_cb;
+    uintptr_t     user_data;
+};
+
+bool tuh_init(uint8_t rhport);
+void tuh_task(void);
+bool tuh_mounted(uint8_t daddr);
+bool tuh_vid_pid_get(uint8_t daddr, uint16_t *vid, uint16_t *pid);
+
+bool tuh_control_xfer(tuh_xfer_t *xfer);
+bool tuh_edpt_open(uint8_t daddr, tusb_desc_endpoint_t const *desc_ep);
+bool tuh_edpt_xfer(tuh_xfer_t *xfer);
+
+bool tuh_descriptor_get(uint8_t daddr, uint8_t type, uint8_t index,
+                        void *buffer, uint16_t len,
+                        tuh_xfer_cb_t complete_cb, uintptr_t user_data);
+bool tuh_descriptor_get_device(uint8_t daddr, void *buffer, uint16_t len,
+                               tuh_xfer_cb_t complete_cb, uintptr_t user_data);
+bool tuh_descriptor_get_configuration(uint8_t daddr, uint8_t index, void *buffer, uint16_t len,
+                                      tuh_xfer_cb_t complete_cb, uintptr_t user_data);
+bool tuh_descriptor_get_string(uint8_t daddr, uint8_t index, uint16_t language_id,
+                               void *buffer, uint16_t len,
+                               tuh_xfer_cb_t complete_cb, uintptr_t user_data);
+bool tuh_descriptor_get_manufacturer_string(uint8_t daddr, uint16_t language_id,
+                                            void *buffer, uint16_t len,
+                                            tuh_xfer_cb_t complete_cb, uintptr_t user_data);
+bool tuh_descriptor_get_product_string(uint8_t daddr, uint16_t language_id,
+                                       void *buffer, uint16_t len,
+                                       tuh_xfer_cb_t complete_cb, uintptr_t user_data);
+bool tuh_descriptor_get_hid_report(uint8_t daddr, uint8_t itf_num, uint8_t desc_type,
+                                   uint8_t index, void *buffer, uint16_t len,
+                                   tuh_xfer_cb_t complete_cb, uintptr_t user_data);
+
+/* Application callbacks invoked by the stack */
+void tuh_mount_cb(uint8_t daddr);
+void tuh_umount_cb(uint8_t daddr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TUSB_H_ */
@@ -0,0 +1,46 @@
+/*
+ * TJUH — SWAR kernels, cross-compiled for the RP2350
+ *
+ * Not a bench: bench/CMakeLists.txt compiles this for the Cortex-M33
+ * when arm-none-eabi-gcc is found, next to the modules that inline the
+ * kernels, so the DSP path of tjuh_swar.h is built on every bench build.
+ * Each kernel gets an external copy to read in the disassembly
+ * (arm-none-eabi-objdump -d swar_cross.o).
+ */
+
+#include "tjuh_swar.h"
+
+#if !TJUH_SWAR_DSP
+#error "the Cortex-M33 build should select the DSP kernels"
+#endif
+
+uint32_t swar_deflection(uint32_t pair, uint32_t center);
+uint32_t swar_norm2(uint32_t d);
+uint32_t swar_pack_sat16(int32_t lo, int32_t hi);
+uint32_t swar_narrow(uint32_t xy, uint32_t zrz);
+uint32_t swar_widen_mask(uint32_t axes_mask, unsigned pair);
+
+uint32_t swar_deflection(uint32_t pair, uint32_t center)
+{
+    return tjuh_swar_deflection(pair, center);
+}
+
+uint32_t swar_norm2(uint32_t d)
+{
+    return tjuh_swar_norm2(d);
+}
+
+uint32_t swar_pack_sat16(int32_t lo, int32_t hi)
+{
+    return tjuh_swar_pack_sat16(lo, hi);
+}
+
+uint32_t swar_narrow(uint32_t xy, uint32_t zrz)
+{
+    return tjuh_swar_narrow(xy, zrz);
+}
+
+uint32_t swar_widen_mask(uint32_t axes_mask, unsigned pair)
+{
+    return tjuh_swar_widen_mask(axes_mask, pair);
+}
@@ -0,0 +1,91 @@
+# ---------------------------------------------------------------------- #
+#  TJUH size report                                                       #
+#                                                                         #
+#  Runs a Berkeley-format size tool over one or more binaries (ELF files  #
+#  or static libraries, whose members are summed) and prints one line     #
+#  per binary. Invoked with cmake -P from tjuh_size_report() and the      #
+#  bench size_report target:                                              #
+#                                                                         #
+#    -DSIZE_TOOL=<size> -DFILES=<file;...> [-DLABELS=<label;...>]         #
+#    [-DTITLE=<heading>]                                                  #
+# ---------------------------------------------------------------------- #
+
+if(NOT SIZE_TOOL OR NOT FILES)
+    message(FATAL_ERROR "tjuh_size.cmake: SIZE_TOOL and FILES are required")
+endif()
+
+set(spaces "                                        ")
+
+# Append value to row, right-aligned to width (string(REPEAT) needs 3.15)
+macro(tjuh_size_column row value width)
+    string(LENGTH "${value}" vlen)
+    if(vlen LESS ${width})
+        math(EXPR pad "${width} - ${vlen}")
+        string(SUBSTRING "${spaces}" 0 ${pad} fill)
+        string(APPEND ${row} "${fill}")
+    endif()
+    string(APPEND ${row} "${value}")
+endmacro()
+
+# Left-align a label to width
+macro(tjuh_size_label row label width)
+    set(${row} "  ${label}")
+    string(LENGTH "${${row}}" vlen)
+    if(vlen LESS ${width})
+        math(EXPR pad "${width} - ${vlen}")
+        string(SUBSTRING "${spaces}" 0 ${pad} fill)
+        string(APPEND ${row} "${fill}")
+    endif()
+endmacro()
+
+if(TITLE)
+    message("${TITLE}")
+endif()
+tjuh_size_label(header "configuration" 40)
+foreach(column text data bss flash RAM)
+    tjuh_size_column(header ${column} 9)
+endforeach()
+message("${header}")
+
+list(LENGTH FILES count)
+math(EXPR last "${count} - 1")
+
+foreach(i RANGE ${last})
+    list(GET FILES ${i} file)
+    if(LABELS)
+        list(GET LABELS ${i} label)
+    else()
+        get_filename_component(label ${file} NAME)
+    endif()
+
+    execute_process(
+        COMMAND ${SIZE_TOOL} -B ${file}
+        OUTPUT_VARIABLE out
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "tjuh_size.cmake: ${SIZE_TOOL} failed on ${file}")
+    endif()
+
+    set(text 0)
+    set(data 0)
+    set(bss 0)
+    string(REPLACE "\n" ";" lines "${out}")
+    foreach(line ${lines})
+        if(line MATCHES "^[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)")
+            math(EXPR text "${text} + ${CMAKE_MATCH_1}")
+            math(EXPR data "${data} + ${CMAKE_MATCH_2}")
+            math(EXPR bss  "${bss} + ${CMAKE_MATCH_3}")
+        endif()
+    endforeach()
+
+    # Initialized data lives in flash and is copied to RAM at boot
+    math(EXPR flash "${text} + ${data}")
+    math(EXPR ram   "${data} + ${bss}")
+
+    tjuh_size_label(row "${label}" 40)
+    foreach(value ${text} ${data} ${bss} ${flash} ${ram})
+        tjuh_size_column(row ${value} 9)
+    endforeach()
+    message("${row}")
+endforeach()
@@ -23,6 +23,13 @@
  * Compile with -DTJUH_EXAMPLE_ENABLE_PIN_OUTPUT=0 (or change the define
  * below) to disable all physical pin outputs and use serial logging only.
  *
+ * Compile with -DTJUH_EXAMPLE_MEASURE_REPORT_TIME=1 to measure the
+ * library's time per report instead of logging reports: the main loop
+ * evicts the XIP cache between reports, as a busy application would, and
+ * the min/mean/max time is printed every two seconds. Compare a build
+ * with TJUH_HOT_PATH_IN_RAM against one without to see the jitter the
+ * flash cache misses cause.
+ *
  * Pin assignment (active side of the Pico, all even GPIOs for PWM to
  * avoid slice conflicts):
  *
@@ -58,6 +65,11 @@
 #define TJUH_EXAMPLE_ENABLE_PIN_OUTPUT 1
 #endif
 
+/* Report timing mode; needs TJUH_ENABLE_REPORT_TIMING (CMake sets both) */
+#ifndef TJUH_EXAMPLE_MEASURE_REPORT_TIME
+#define TJUH_EXAMPLE_MEASURE_REPORT_TIME 0
+#endif
+
 #if TJUH_EXAMPLE_ENABLE_PIN_OUTPUT
 #include "hardware/pwm.h"
 
@@ -153,6 +165,8 @@ static void reset_outputs(void)
 
 #endif /* TJUH_EXAMPLE_ENABLE_PIN_OUTPUT */
 
+#if !TJUH_EXAMPLE_MEASURE_REPORT_TIME
+
 /* ---------------------------------------------------------------------- */
 /*  D-Pad direction strings                                               */
 /* ---------------------------------------------------------------------- */
@@ -189,6 +203,72 @@ static void log_report(const tjuh_gamepad_report_t *rpt)
     printf("\r\n");
 }
 
+#endif /* !TJUH_EXAMPLE_MEASURE_REPORT_TIME */
+
+/* ---------------------------------------------------------------------- */
+/*  Report timing                                                         */
+/* ---------------------------------------------------------------------- */
+
+#if TJUH_EXAMPLE_MEASURE_REPORT_TIME
+
+#define XIP_CACHE_EVICT_BYTES (32 * 1024)   /* twice the XIP cache */
+
+/* End of the firmware image in flash (linker script) */
+extern char __flash_binary_end;
+
+static volatile uint32_t s_evict_sink;
+
+/*
+ * Stand-in for other work between reports: stream flash through the XIP
+ * cache so the library's code and tables are no longer in it. The window
+ * starts past the firmware image: reading the image itself would pull
+ * the report path back into the cache. Works the same on RP2040 and
+ * RP2350, which flush their caches differently. A firmware within 32 KB
+ * of the end of flash gets the last 32 KB instead.
+ */
+static void evict_xip_cache(void)
+{
+    uintptr_t start = ((uintptr_t)&__flash_binary_end + 7u) & ~(uintptr_t)7u;
+    uintptr_t last  = XIP_BASE + PICO_FLASH_SIZE_BYTES - XIP_CACHE_EVICT_BYTES;
+    const volatile uint32_t *flash = (const volatile uint32_t *)(start < last ? start : last);
+    uint32_t sum = 0;
+
+    /* One read per 8-byte cache line */
+    for (uint32_t i = 0; i < XIP_CACHE_EVICT_BYTES / 4; i += 2)
+        sum += flash[i];
+    s_evict_sink = sum;
+}
+
+static void log_timing(void)
+{
+    static uint32_t last_ms;
+    uint32_t now = board_millis();
+
+    if (now - last_ms < 2000)
+        return;
+    last_ms = now;
+
+    tjuh_report_timing_t t;
+    if (!tjuh_get_report_timing(&t, true))
+        return;
+
+    /* Hundredths of a microsecond */
+    uint32_t div = t.ticks_per_us ? t.ticks_per_us : 1;
+    uint32_t min = t.min * 100 / div;
+    uint32_t avg = t.mean * 100 / div;
+    uint32_t max = t.max * 100 / div;
+
+    printf("[TJUH Example] %lu reports: min %lu.%02lu us, mean %lu.%02lu us, "
+           "max %lu.%02lu us, jitter %lu.%02lu us\r\n",
+           (unsigned long)t.count,
+           (unsigned long)(min / 100), (unsigned long)(min % 100),
+           (unsigned long)(avg / 100), (unsigned long)(avg % 100),
+           (unsigned long)(max / 100), (unsigned long)(max % 100),
+           (unsigned long)((max - min) / 100), (unsigned long)((max - min) % 100));
+}
+
+#endif /* TJUH_EXAMPLE_MEASURE_REPORT_TIME */
+
 /* ---------------------------------------------------------------------- */
 /*  TJUH callbacks                                                        */
 /* ---------------------------------------------------------------------- */
@@ -201,7 +281,12 @@ static void on_report(uint8_t dev_addr, const tjuh_gamepad_report_t *rpt)
     update_outputs(rpt);
 #endif
 
+    /* Logging every report would swamp the measurement */
+#if !TJUH_EXAMPLE_MEASURE_REPORT_TIME
     log_report(rpt);
+#else
+    (void)rpt;
+#endif
 }
 
 static void on_connect(uint8_t dev_addr, uint16_t vid, uint16_t pid)
@@ -251,6 +336,11 @@ int main(void)
     printf("Mode: Serial logging only (pin output disabled)\r\n");
 #endif
 
+#if TJUH_EXAMPLE_MEASURE_REPORT_TIME
+    printf("Measuring report time, hot path in %s\r\n",
+           TJUH_HOT_PATH_IN_RAM ? "SRAM" : "flash (XIP)");
+#endif
+
     printf("Connect a USB gamepad to begin.\r\n\r\n");
 
     tjuh_config_t config = {
@@ -261,7 +351,12 @@ int main(void)
     tjuh_init(&config);
 
     while (1) {
-        tuh_task();
+        tjuh_task();
+
+#if TJUH_EXAMPLE_MEASURE_REPORT_TIME
+        evict_xip_cache();
+        log_timing();
+#endif
     }
 
     return 0;
@@ -8,6 +8,7 @@
  *   - Sony DualSense / Edge (PS5)      VID=0x054c PID=0x0ce6 / 0x0df2
  *   - Nintendo Switch Pro Controller   VID=0x057e PID=0x2009
  *   - Xbox 360 Wired
+ *   - Xbox One / Series (GIP)
  *   - Generic HID gamepads (8-byte, 3-byte, and DInput-compatible reports)
  *
  * MIT License — see LICENSE
@@ -18,6 +19,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,6 +29,224 @@ extern "C" {
 #define TJUH_MAX_DEVICES 2
 #endif
 
+/* Building for a development host (bench/) instead of a Pico target */
+#ifndef TJUH_HOST_BUILD
+#define TJUH_HOST_BUILD 0
+#endif
+
+/*
+ * Flash region holding a quirk blob (see tools/tjuh_quirk_blob.py).
+ * When both are defined, tjuh_init() attaches the blob; an erased or
+ * invalid region is ignored and only the built-in table is used.
+ *   #define TJUH_QUIRK_BLOB_ADDR (XIP_BASE + 0x1FF000)
+ *   #define TJUH_QUIRK_BLOB_SIZE 4096
+ */
+
+/* Devices allowed to fetch descriptors at the same time during enumeration */
+#ifndef TJUH_ENUM_MAX_CONCURRENT
+#define TJUH_ENUM_MAX_CONCURRENT 1
+#endif
+
+/*
+ * Consecutive agreeing reports before a heuristically detected parser is
+ * locked in for an unknown device (and consecutive rejects before it is
+ * dropped again). Max 255.
+ */
+#ifndef TJUH_CLASSIFY_PROBATION_REPORTS
+#define TJUH_CLASSIFY_PROBATION_REPORTS 16
+#endif
+
+/*
+ * Per-device button/axis remap profiles (tjuh_set_remap_profile). A
+ * profile is compiled into RAM copies of the device's button tables, so
+ * remapped reports are parsed at the same cost as unmapped ones. Costs
+ * about 5 KB of RAM per table bank, with TJUH_MAX_DEVICES + 1 banks.
+ */
+#ifndef TJUH_ENABLE_REMAP
+#define TJUH_ENABLE_REMAP 0
+#endif
+
+/*
+ * Gyro/accelerometer samples and an orientation estimate from DS4,
+ * DualSense and Switch Pro controllers (on_imu). Integer arithmetic
+ * only, for the FPU-less RP2040.
+ */
+#ifndef TJUH_ENABLE_IMU
+#define TJUH_ENABLE_IMU 0
+#endif
+
+/*
+ * Stick and trigger conditioning after parsing (tjuh_set_condition_profile):
+ * centre offsets, radial deadzones, outer limits and response curves,
+ * compiled into per-device tables. Integer arithmetic only, a fixed cost
+ * per report. Costs about 1.8 KB of RAM per device.
+ */
+#ifndef TJUH_ENABLE_CONDITION
+#define TJUH_ENABLE_CONDITION 0
+#endif
+
+/*
+ * Button press/release events in a queue (tjuh_get_button_event), worked
+ * out once per report from the previous and current buttons. Costs
+ * 8 bytes of RAM per queue entry.
+ */
+#ifndef TJUH_ENABLE_EVENTS
+#define TJUH_ENABLE_EVENTS 0
+#endif
+
+/* Button event queue entries, a power of two */
+#ifndef TJUH_EVENT_QUEUE_SIZE
+#define TJUH_EVENT_QUEUE_SIZE 64
+#endif
+
+/*
+ * Per-device input accumulated between two tjuh_sample_frame() calls, for
+ * applications that read input once per frame. Costs 24 bytes of RAM per
+ * device.
+ */
+#ifndef TJUH_ENABLE_FRAMES
+#define TJUH_ENABLE_FRAMES 0
+#endif
+
+/*
+ * The latest state of every connected device, copied out in one call as
+ * arrays per field (tjuh_get_snapshot). Costs about 16 bytes of RAM per
+ * device.
+ */
+#ifndef TJUH_ENABLE_SNAPSHOT
+#define TJUH_ENABLE_SNAPSHOT 0
+#endif
+
+/* Snapshot array alignment: a cache line on host builds, for vector loads */
+#ifndef TJUH_SNAPSHOT_ALIGN
+#if TJUH_HOST_BUILD
+#define TJUH_SNAPSHOT_ALIGN 64
+#else
+#define TJUH_SNAPSHOT_ALIGN 4
+#endif
+#endif
+
+/*
+ * Reports held for one on_report_batch call. A tjuh_task() pass that
+ * completes more delivers them in several batches. 16 bytes of RAM each.
+ */
+#ifndef TJUH_BATCH_MAX
+#define TJUH_BATCH_MAX (2 * TJUH_MAX_DEVICES)
+#endif
+
+/*
+ * Several consumers of the report stream, each with its own device,
+ * changed-field and rate filter (tjuh_subscribe). Costs 4 bytes of RAM
+ * per subscriber and device.
+ */
+#ifndef TJUH_ENABLE_SUBSCRIBE
+#define TJUH_ENABLE_SUBSCRIBE 0
+#endif
+
+/* Subscription slots, max 32 */
+#ifndef TJUH_MAX_SUBSCRIBERS
+#define TJUH_MAX_SUBSCRIBERS 4
+#endif
+
+/*
+ * Button sequences ("combos") matched as they are entered, and a history
+ * of each device's latest button edges (tjuh_combo_register). Costs
+ * about 48 bytes of RAM per combo, and per device 200 plus one per
+ * combo.
+ */
+#ifndef TJUH_ENABLE_COMBOS
+#define TJUH_ENABLE_COMBOS 0
+#endif
+
+/* Combo slots, max 127 */
+#ifndef TJUH_MAX_COMBOS
+#define TJUH_MAX_COMBOS 8
+#endif
+
+/* Presses in the longest combo */
+#ifndef TJUH_COMBO_MAX_STEPS
+#define TJUH_COMBO_MAX_STEPS 16
+#endif
+
+/* Button edges kept per device, a power of two */
+#ifndef TJUH_INPUT_HISTORY
+#define TJUH_INPUT_HISTORY 16
+#endif
+
+/*
+ * Application actions (jump, menu, scroll) bound to button chords, d-pad
+ * directions and stick thresholds, evaluated per report into an action
+ * bitmask per device (tjuh_set_action_map). Costs 20 bytes of RAM per
+ * binding and 20 per device.
+ */
+#ifndef TJUH_ENABLE_ACTIONS
+#define TJUH_ENABLE_ACTIONS 0
+#endif
+
+/* Bindings in the action map, max 32 */
+#ifndef TJUH_MAX_BINDINGS
+#define TJUH_MAX_BINDINGS 16
+#endif
+
+/*
+ * Orientation fusion: how hard gravity pulls the estimate back, in
+ * rad/s per radian of tilt error, Q8 (128 = 0.5). Max 4096.
+ */
+#ifndef TJUH_IMU_FUSION_GAIN
+#define TJUH_IMU_FUSION_GAIN 128
+#endif
+
+/*
+ * Controller families compiled in. A family that is off loses its parser,
+ * button tables, quirk entries and enumeration handshake; its devices are
+ * left to the generic report heuristics (if those are on) or ignored.
+ */
+#ifndef TJUH_ENABLE_SONY
+#define TJUH_ENABLE_SONY 1       /* DualShock 4, DualSense */
+#endif
+
+#ifndef TJUH_ENABLE_SWITCH
+#define TJUH_ENABLE_SWITCH 1     /* Switch Pro, Joy-Con and compatibles */
+#endif
+
+#ifndef TJUH_ENABLE_XBOX360
+#define TJUH_ENABLE_XBOX360 1
+#endif
+
+#ifndef TJUH_ENABLE_XBOX_ONE
+#define TJUH_ENABLE_XBOX_ONE 1   /* GIP: Xbox One and Series */
+#endif
+
+#ifndef TJUH_ENABLE_GENERIC
+#define TJUH_ENABLE_GENERIC 1    /* 8-byte, 3-byte and DInput-compatible HID */
+#endif
+
+#if !(TJUH_ENABLE_SONY || TJUH_ENABLE_SWITCH || TJUH_ENABLE_XBOX360 || \
+      TJUH_ENABLE_XBOX_ONE || TJUH_ENABLE_GENERIC)
+#error "TJUH: no controller family enabled"
+#endif
+
+/*
+ * Run the report path (reception callback, parser dispatch, the enabled
+ * parsers and their button tables) from SRAM instead of from flash
+ * through the XIP cache, so a report that arrives after unrelated code
+ * evicted it does not wait on flash. Costs about 1 KB of RAM per button
+ * table, fewer with unused controller families turned off. No effect on
+ * host builds.
+ */
+#ifndef TJUH_HOT_PATH_IN_RAM
+#define TJUH_HOT_PATH_IN_RAM 0
+#endif
+
+/*
+ * Time the library's share of each report, from the USB transfer
+ * completing to the parsed state being ready for the callbacks
+ * (tjuh_get_report_timing). Uses SysTick on Cortex-M targets.
+ */
+#ifndef TJUH_ENABLE_REPORT_TIMING
+#define TJUH_ENABLE_REPORT_TIMING 0
+#endif
+
 /* -------------------------------------------------------------------------- */
 /*  Gamepad report — unified across all supported controllers                 */
 /* -------------------------------------------------------------------------- */
@@ -80,6 +300,395 @@ typedef struct __attribute__((packed))
     uint8_t reserved_byte;
 } tjuh_gamepad_report_t;
 
+/* -------------------------------------------------------------------------- */
+/*  Gamepad state — word-aligned, produced by the parsers                     */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Button ids, bit n of tjuh_gamepad_state_t.buttons. Ids 0..13 are the
+ * buttons of tjuh_gamepad_report_t in report bit order; the others only
+ * exist in the state. Ids up to 27 may be added.
+ */
+typedef enum {
+    TJUH_BUTTON_SQUARE = 0,
+    TJUH_BUTTON_CROSS,
+    TJUH_BUTTON_CIRCLE,
+    TJUH_BUTTON_TRIANGLE,
+    TJUH_BUTTON_L1,
+    TJUH_BUTTON_R1,
+    TJUH_BUTTON_L2,
+    TJUH_BUTTON_R2,
+    TJUH_BUTTON_SELECT,
+    TJUH_BUTTON_START,
+    TJUH_BUTTON_L3,
+    TJUH_BUTTON_R3,
+    TJUH_BUTTON_SYSTEM,
+    TJUH_BUTTON_EXTRA,
+    TJUH_BUTTON_MUTE,       /* DualSense microphone button */
+    TJUH_BUTTON_FN_L,       /* DualSense Edge function buttons */
+    TJUH_BUTTON_FN_R,
+    TJUH_BUTTON_PADDLE_L,   /* DualSense Edge back paddles */
+    TJUH_BUTTON_PADDLE_R,
+    TJUH_BUTTON_COUNT
+} tjuh_button_t;
+
+#define TJUH_BUTTON_NONE 0xFF    /* remap destination: drop the button */
+
+#define TJUH_BUTTON_MASK(b)      (1u << (b))
+#define TJUH_REPORT_BUTTONS_MASK 0x00003FFFu  /* ids carried by tjuh_gamepad_report_t */
+
+typedef struct {
+    uint32_t buttons;       /* TJUH_BUTTON_MASK(tjuh_button_t) */
+    union {
+        struct {
+            uint8_t x;
+            uint8_t y;
+            uint8_t z;
+            uint8_t rz;
+        };
+        uint32_t axes;      /* same byte order as tjuh_gamepad_report_t.axes_bytes */
+    };
+    uint8_t  hat;           /* 0=N 1=NE 2=E 3=SE 4=S 5=SW 6=W 7=NW 8=released */
+} tjuh_gamepad_state_t;
+
+static inline bool tjuh_state_pressed(const tjuh_gamepad_state_t *s, tjuh_button_t button)
+{
+    return (s->buttons & TJUH_BUTTON_MASK(button)) != 0;
+}
+
+/* Any of the buttons in `mask` pressed */
+static inline bool tjuh_state_any(const tjuh_gamepad_state_t *s, uint32_t mask)
+{
+    return (s->buttons & mask) != 0;
+}
+
+/* All of the buttons in `mask` pressed */
+static inline bool tjuh_state_all(const tjuh_gamepad_state_t *s, uint32_t mask)
+{
+    return (s->buttons & mask) == mask;
+}
+
+/* Buttons pressed in `now` but not in `before` */
+static inline uint32_t tjuh_state_pressed_since(const tjuh_gamepad_state_t *before,
+                                                const tjuh_gamepad_state_t *now)
+{
+    return now->buttons & ~before->buttons;
+}
+
+/* Packed report view of a state; ids above TJUH_BUTTON_EXTRA are dropped */
+static inline void tjuh_state_to_report(const tjuh_gamepad_state_t *s, tjuh_gamepad_report_t *r)
+{
+    r->axes_bytes           = s->axes;
+    r->dpad_buttons_byte    = (uint8_t)((s->hat & 0x0F) | ((s->buttons & 0x0F) << 4));
+    r->trigger_buttons_byte = (uint8_t)(s->buttons >> 4);
+    r->extra_buttons_byte   = (uint8_t)((s->buttons >> 12) & 0x03);
+    r->reserved_byte        = 0;
+}
+
+static inline void tjuh_report_to_state(const tjuh_gamepad_report_t *r, tjuh_gamepad_state_t *s)
+{
+    s->buttons = ((uint32_t)r->dpad_buttons_byte >> 4) |
+                 ((uint32_t)r->trigger_buttons_byte << 4) |
+                 ((uint32_t)(r->extra_buttons_byte & 0x03) << 12);
+    s->axes    = r->axes_bytes;
+    s->hat     = r->dpad_buttons_byte & 0x0F;
+}
+
+/*
+ * Full-precision values the compact state rounds off: 16-bit sticks in
+ * the same orientation (top byte equals the 8-bit axis) and analog
+ * triggers. Controllers with 8-bit sticks are scaled up (0x80 -> 0x8080);
+ * digital-only triggers read 0 or 0xFFFF, and 0 where there is none.
+ */
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t z;
+    uint16_t rz;
+    uint16_t l2;
+    uint16_t r2;
+} tjuh_gamepad_ext_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Remap profiles                                                            */
+/* -------------------------------------------------------------------------- */
+
+#define TJUH_AXIS_X  0x01
+#define TJUH_AXIS_Y  0x02
+#define TJUH_AXIS_Z  0x04
+#define TJUH_AXIS_RZ 0x08
+
+typedef struct {
+    uint8_t button[TJUH_BUTTON_COUNT];  /* destination tjuh_button_t per source button;
+                                           several sources may share one */
+    uint8_t axis_invert;                /* TJUH_AXIS_*, applied after swap_sticks */
+    bool    swap_sticks;                /* exchange (x, y) and (z, rz) */
+} tjuh_remap_profile_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Stick conditioning                                                        */
+/* -------------------------------------------------------------------------- */
+
+typedef enum {
+    TJUH_CURVE_LINEAR = 0,
+    TJUH_CURVE_QUADRATIC,       /* finer control near the centre */
+    TJUH_CURVE_CUBIC,
+    TJUH_CURVE_COUNT
+} tjuh_curve_t;
+
+/*
+ * One stick, (x, y) or (z, rz), in extended-axis units: 0x8000 is full
+ * deflection from the centre. Deflection up to `deadzone` (measured as a
+ * radius, so diagonals are not favoured) reads as centred, deflection of
+ * `outer` as full in the same direction, and the curve shapes the travel
+ * in between. Beyond `outer` the scaling stays the same and each axis
+ * saturates, so square-gated sticks still reach their corners.
+ */
+typedef struct {
+    int16_t  center[2];         /* rest position of each axis, offset from 0x8000 */
+    uint16_t deadzone;
+    uint16_t outer;             /* 0x4000..0x8000 (0: 0x8000), above deadzone */
+    uint8_t  curve;             /* tjuh_curve_t */
+} tjuh_stick_condition_t;
+
+/* One analog trigger: released up to `deadzone`, fully pressed from `outer` */
+typedef struct {
+    uint16_t deadzone;
+    uint16_t outer;             /* at least 0x100 above deadzone (0: 0xFFFF) */
+    uint8_t  curve;             /* tjuh_curve_t */
+} tjuh_trigger_condition_t;
+
+/*
+ * Conditioning of one device, applied to the axes as delivered (after a
+ * remap profile). The compact state's axes follow the extended ones.
+ */
+typedef struct {
+    tjuh_stick_condition_t   stick[2];      /* left (x, y), right (z, rz) */
+    tjuh_trigger_condition_t trigger[2];    /* l2, r2 */
+} tjuh_condition_profile_t;
+
+/* -------------------------------------------------------------------------- */
+/*  IMU                                                                       */
+/* -------------------------------------------------------------------------- */
+
+#define TJUH_IMU_GYRO_LSB_PER_DPS 16      /* +-2048 deg/s */
+#define TJUH_IMU_ACCEL_LSB_PER_G  4096    /* +-8 g */
+#define TJUH_IMU_QUAT_ONE         16384   /* quaternion component 1.0 (Q14) */
+
+/*
+ * One calibrated motion sample, in the same frame for every controller:
+ * held in front of you, +x points right, +y up out of the face and +z
+ * towards you, so a pad lying flat reads +1 g on y. Rotations are
+ * right-handed about those axes.
+ *
+ * `quat` (w, x, y, z) rotates the controller frame into a world frame
+ * with +y up; yaw is relative to where the pad pointed when tracking
+ * started (tjuh_imu_reset_orientation).
+ */
+typedef struct {
+    int16_t  gyro[3];
+    int16_t  accel[3];
+    int16_t  quat[4];
+    uint32_t timestamp_us;  /* controller sensor clock, wraps */
+} tjuh_imu_sample_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Touchpad                                                                  */
+/* -------------------------------------------------------------------------- */
+
+#define TJUH_TOUCH_FINGERS 2
+
+/* Touchpad size in contact coordinates */
+#define TJUH_TOUCH_DS4_WIDTH        1920
+#define TJUH_TOUCH_DS4_HEIGHT       942
+#define TJUH_TOUCH_DUALSENSE_WIDTH  1920
+#define TJUH_TOUCH_DUALSENSE_HEIGHT 1080
+
+typedef enum {
+    TJUH_TOUCH_DOWN = 0,    /* finger placed */
+    TJUH_TOUCH_MOVE,        /* finger moved */
+    TJUH_TOUCH_UP,          /* finger lifted; x, y are its last position */
+} tjuh_touch_type_t;
+
+/*
+ * One touchpad contact change. Events are only produced on a change, so
+ * an untouched pad produces none. A contact keeps its id from DOWN to
+ * UP; the controller hands out a new id for every touch.
+ */
+typedef struct {
+    uint8_t  type;      /* tjuh_touch_type_t */
+    uint8_t  finger;    /* 0 .. TJUH_TOUCH_FINGERS - 1 */
+    uint8_t  id;        /* controller tracking id, 0..127 */
+    uint16_t x;         /* 0 = left */
+    uint16_t y;         /* 0 = top */
+} tjuh_touch_event_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Button events                                                             */
+/* -------------------------------------------------------------------------- */
+
+/* Event-only ids for the d-pad directions, above the tjuh_button_t ids */
+#define TJUH_EVENT_DPAD_UP    28
+#define TJUH_EVENT_DPAD_RIGHT 29
+#define TJUH_EVENT_DPAD_DOWN  30
+#define TJUH_EVENT_DPAD_LEFT  31
+
+typedef enum {
+    TJUH_EDGE_RELEASE = 0,
+    TJUH_EDGE_PRESS,
+} tjuh_edge_t;
+
+/*
+ * One button going down or up. Every press of a button is followed by
+ * its release, even for a tap that came and went between two polls, and
+ * buttons still held when a device disconnects are released then.
+ */
+typedef struct {
+    uint32_t time_ms;   /* board_millis() when the report arrived */
+    uint8_t  dev_addr;
+    uint8_t  button;    /* tjuh_button_t or TJUH_EVENT_DPAD_* */
+    uint8_t  edge;      /* tjuh_edge_t */
+} tjuh_button_event_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Frame sampling                                                            */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * A device's input since the previous tjuh_sample_frame(). The masks use
+ * tjuh_button_t bits with the d-pad directions as TJUH_EVENT_DPAD_* bits,
+ * so a tap shorter than a frame shows in both `pressed` and `released`.
+ */
+typedef struct {
+    tjuh_gamepad_state_t state;     /* latest report */
+    uint32_t pressed;               /* down in any report since the last sample */
+    uint32_t released;              /* went up since the last sample */
+    uint16_t reports;               /* reports since the last sample */
+    bool     connected;
+} tjuh_frame_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Snapshot                                                                  */
+/* -------------------------------------------------------------------------- */
+
+/* Array length: whole groups of four devices, so vector loops need no tail */
+#define TJUH_SNAPSHOT_SLOTS (((TJUH_MAX_DEVICES) + 3) & ~3)
+
+/*
+ * All devices' latest state, one array per field; entry i is device
+ * address i + 1. Entries of devices that are not connected, and the
+ * padding slots, hold no buttons, centred axes and a released hat.
+ */
+typedef struct {
+    uint32_t connected;                                                     /* bit i: entry i */
+    uint32_t buttons[TJUH_SNAPSHOT_SLOTS] __attribute__((aligned(TJUH_SNAPSHOT_ALIGN)));
+    uint32_t axes[TJUH_SNAPSHOT_SLOTS]    __attribute__((aligned(TJUH_SNAPSHOT_ALIGN)));
+    uint32_t age_ms[TJUH_SNAPSHOT_SLOTS]  __attribute__((aligned(TJUH_SNAPSHOT_ALIGN)));
+    uint8_t  hat[TJUH_SNAPSHOT_SLOTS]     __attribute__((aligned(TJUH_SNAPSHOT_ALIGN)));
+} tjuh_snapshot_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Subscriptions                                                             */
+/* -------------------------------------------------------------------------- */
+
+/* Report fields a subscriber can wait for a change in */
+#define TJUH_FIELD_BUTTONS  0x01u   /* buttons */
+#define TJUH_FIELD_HAT      0x02u   /* hat */
+#define TJUH_FIELD_STICK_L  0x04u   /* x, y */
+#define TJUH_FIELD_STICK_R  0x08u   /* z, rz */
+#define TJUH_FIELD_ALL      0x0Fu
+
+/* Every device address */
+#define TJUH_DEVICES_ALL    0xFFFFFFFFu
+
+/**
+ * Called for each report that passes the subscriber's filters.
+ *
+ * @param dev_addr  TinyUSB device address (1-based)
+ * @param state     Input state of the report
+ * @param ctx       The subscription's ctx
+ */
+typedef void (*tjuh_subscriber_cb_t)(uint8_t dev_addr, const tjuh_gamepad_state_t *state,
+                                     void *ctx);
+
+typedef struct {
+    tjuh_subscriber_cb_t callback;
+    void    *ctx;
+    uint32_t devices;           /* bit n - 1: device address n */
+    uint8_t  fields;            /* TJUH_FIELD_* to wait for a change in; 0 = every report */
+    uint16_t min_interval_ms;   /* per device; 0 = no cap */
+} tjuh_subscription_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Combos                                                                    */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Called when a device completes a combo.
+ *
+ * @param dev_addr  TinyUSB device address (1-based)
+ * @param combo     Handle from tjuh_combo_register()
+ * @param ctx       The combo's ctx
+ */
+typedef void (*tjuh_combo_cb_t)(uint8_t dev_addr, int8_t combo, void *ctx);
+
+/*
+ * Buttons pressed one after the other, with no other press in between;
+ * releases do not matter. Matches overlap: "up, up" completes twice on
+ * three presses of up.
+ */
+typedef struct {
+    const uint8_t  *steps;      /* tjuh_button_t or TJUH_EVENT_DPAD_* ids, in order */
+    uint8_t         length;     /* 1 to TJUH_COMBO_MAX_STEPS */
+    uint16_t        window_ms;  /* max time from the first press to the last; 0 = any */
+    tjuh_combo_cb_t callback;
+    void           *ctx;
+} tjuh_combo_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Action map                                                                */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * One way to trigger an action: while every button in `buttons` is held
+ * and `axis` is at or past `on`. Once on, the binding stays on until the
+ * axis comes back past `off`, so a stick resting near the threshold does
+ * not flicker. Several bindings may trigger the same action.
+ */
+typedef struct {
+    uint32_t buttons;   /* TJUH_BUTTON_MASK() of tjuh_button_t and TJUH_EVENT_DPAD_* ids;
+                           0 = no buttons */
+    uint8_t  action;    /* 0 to 31 */
+    uint8_t  axis;      /* one TJUH_AXIS_*, 0 = no axis */
+    bool     below;     /* on at or below `on` rather than at or above */
+    uint8_t  on;        /* axis value that turns the binding on */
+    uint8_t  off;       /* on while at or past this; between the centre and `on` */
+} tjuh_binding_t;
+
+/* A device's actions, as bits 1u << action */
+typedef struct {
+    uint32_t active;    /* on in the latest report */
+    uint32_t pressed;   /* turned on since the previous tjuh_get_actions() */
+    uint32_t released;  /* turned off since then */
+} tjuh_actions_t;
+
+/* -------------------------------------------------------------------------- */
+/*  Report timing                                                             */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Library time per report since the last reset, in clock ticks: CPU
+ * cycles on Cortex-M targets, microseconds where there is no cycle
+ * counter, nanoseconds on host builds. Jitter is max - min.
+ */
+typedef struct {
+    uint32_t count;         /* reports timed */
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;
+    uint32_t ticks_per_us;
+} tjuh_report_timing_t;
+
 /* -------------------------------------------------------------------------- */
 /*  Callback types                                                            */
 /* -------------------------------------------------------------------------- */
@@ -92,6 +701,60 @@ typedef struct __attribute__((packed))
  */
 typedef void (*tjuh_report_cb_t)(uint8_t dev_addr, const tjuh_gamepad_report_t *report);
 
+/**
+ * Same as tjuh_report_cb_t with the word-aligned state, which also
+ * carries buttons the packed report has no room for.
+ *
+ * @param dev_addr  TinyUSB device address (1-based)
+ * @param state     Parsed gamepad state
+ */
+typedef void (*tjuh_state_cb_t)(uint8_t dev_addr, const tjuh_gamepad_state_t *state);
+
+/**
+ * Called after on_state with the full-precision axes and triggers of the
+ * same report. Only when this callback is set are they decoded.
+ *
+ * @param dev_addr  TinyUSB device address (1-based)
+ * @param state     Parsed gamepad state
+ * @param ext       Full-precision axes and analog triggers
+ */
+typedef void (*tjuh_ext_cb_t)(uint8_t dev_addr, const tjuh_gamepad_state_t *state,
+                              const tjuh_gamepad_ext_t *ext);
+
+/**
+ * Called for each IMU sample, after the report's other callbacks. The
+ * Switch Pro delivers three samples per report. Needs TJUH_ENABLE_IMU.
+ *
+ * @param dev_addr  TinyUSB device address (1-based)
+ * @param sample    Calibrated sample and orientation after fusing it
+ */
+typedef void (*tjuh_imu_cb_t)(uint8_t dev_addr, const tjuh_imu_sample_t *sample);
+
+/**
+ * Called for each touchpad contact change on DS4 and DualSense
+ * controllers, after the report's other callbacks. Contacts are only
+ * decoded while this callback is set.
+ *
+ * @param dev_addr  TinyUSB device address (1-based)
+ * @param event     Contact change
+ */
+typedef void (*tjuh_touch_cb_t)(uint8_t dev_addr, const tjuh_touch_event_t *event);
+
+/* One report of a batch */
+typedef struct {
+    tjuh_gamepad_state_t state;     /* tjuh_state_to_report() for the packed form */
+    uint8_t              dev_addr;
+} tjuh_report_entry_t;
+
+/**
+ * Called at the end of a tjuh_task() pass with the reports it completed,
+ * in arrival order, in place of on_state and on_report per report.
+ *
+ * @param entries   Reports of the pass; valid during the call only
+ * @param n         Number of entries, at least 1
+ */
+typedef void (*tjuh_report_batch_cb_t)(const tjuh_report_entry_t *entries, size_t n);
+
 /**
  * Called when a gamepad device is connected.
  *
@@ -116,6 +779,14 @@ typedef struct {
     tjuh_report_cb_t     on_report;
     tjuh_connect_cb_t    on_connect;
     tjuh_disconnect_cb_t on_disconnect;
+    tjuh_state_cb_t      on_state;       /* optional, called before on_report */
+    tjuh_ext_cb_t        on_ext;         /* optional, called after on_state */
+    tjuh_imu_cb_t        on_imu;         /* optional, TJUH_ENABLE_IMU builds */
+    tjuh_touch_cb_t      on_touch;       /* optional, DS4/DualSense touchpad */
+    bool                 changes_only;   /* on_state/on_ext/on_report only when the input
+                                            changed; on_imu/on_touch still every report */
+    tjuh_report_batch_cb_t on_report_batch; /* optional, replaces on_state and on_report;
+                                               on_ext/on_imu/on_touch stay per report */
 } tjuh_config_t;
 
 /* -------------------------------------------------------------------------- */
@@ -128,6 +799,12 @@ typedef struct {
  */
 void tjuh_init(const tjuh_config_t *config);
 
+/**
+ * Run the USB host stack and advance queued device enumeration.
+ * Call from the main loop in place of tuh_task().
+ */
+void tjuh_task(void);
+
 /**
  * Query VID/PID for a connected device.
  *
@@ -135,6 +812,210 @@ void tjuh_init(const tjuh_config_t *config);
  */
 bool tjuh_get_device_info(uint8_t dev_addr, uint16_t *vid, uint16_t *pid);
 
+/**
+ * Number of times the report-format heuristic changed its classification
+ * of a device (0 for devices known by VID/PID or report descriptor).
+ * A non-zero value points at a device worth adding to the quirk table.
+ */
+uint16_t tjuh_get_reclassify_count(uint8_t dev_addr);
+
+/**
+ * Extend the built-in quirk table with a blob in memory-mapped flash.
+ * The blob is validated (magic, version, CRC-32, sort order) and then
+ * searched in place; it must stay mapped while attached. Blob entries
+ * take precedence over built-in ones. Affects devices enumerated after
+ * the call.
+ *
+ * @return false if the blob is rejected; the previous blob stays attached.
+ */
+bool tjuh_quirk_blob_attach(const void *blob, uint32_t len);
+
+/** Drop the attached quirk blob, leaving only the built-in table. */
+void tjuh_quirk_blob_detach(void);
+
+#if TJUH_HOST_BUILD
+/**
+ * Host builds: map a blob file read-only and attach it, standing in for
+ * the flash region.
+ */
+bool tjuh_quirk_blob_map_file(const char *path);
+#endif
+
+#if TJUH_ENABLE_REMAP
+/** Fill a profile with the identity mapping. */
+void tjuh_remap_profile_init(tjuh_remap_profile_t *profile);
+
+/**
+ * Apply a remap profile to a connected device, or clear it with NULL.
+ * The profile is copied and compiled into the device's parse tables
+ * off to the side, then published with a single pointer store: every
+ * report is parsed entirely with either the old or the new profile and
+ * none is dropped. Call from the same core as tjuh_task(), e.g. from the
+ * connect callback. The profile is discarded when the device disconnects.
+ *
+ * @return false if the device is not connected or the profile names an
+ *         unknown button.
+ */
+bool tjuh_set_remap_profile(uint8_t dev_addr, const tjuh_remap_profile_t *profile);
+#endif
+
+#if TJUH_ENABLE_CONDITION
+/** Fill a profile that passes sticks and triggers through unchanged. */
+void tjuh_condition_profile_init(tjuh_condition_profile_t *profile);
+
+/**
+ * Condition a connected device's sticks and triggers, or stop with NULL.
+ * The profile is compiled into the device's tables here; each report then
+ * costs an integer square root and a table lookup per stick and a lookup
+ * per trigger. Call from the same core as tjuh_task(), e.g. from the
+ * connect callback. The profile is discarded when the device disconnects.
+ *
+ * @return false if the device is not connected or a limit or curve is
+ *         out of range.
+ */
+bool tjuh_set_condition_profile(uint8_t dev_addr, const tjuh_condition_profile_t *profile);
+#endif
+
+#if TJUH_ENABLE_IMU
+/**
+ * Restart orientation tracking: the next sample sets the tilt from
+ * gravity and the current heading becomes yaw 0.
+ *
+ * @return false if the device is not connected.
+ */
+bool tjuh_imu_reset_orientation(uint8_t dev_addr);
+#endif
+
+#if TJUH_ENABLE_EVENTS
+/**
+ * Take the oldest button event from the queue. Call from the same core
+ * as tjuh_task().
+ *
+ * @return false if the queue is empty.
+ */
+bool tjuh_get_button_event(tjuh_button_event_t *event);
+
+/**
+ * Edges that found the queue full since tjuh_init(), once per report
+ * they waited. Such an edge is not lost but queued with a later report,
+ * with that report's time.
+ */
+uint32_t tjuh_get_button_events_deferred(void);
+#endif
+
+#if TJUH_ENABLE_FRAMES
+/**
+ * Take every device's input since the previous call and start the next
+ * frame. frame[i] is device address i + 1. Buttons held now count as
+ * pressed in the next frame too. Call once per application frame, from
+ * the same core as tjuh_task().
+ *
+ * @return the number of connected devices.
+ */
+uint8_t tjuh_sample_frame(tjuh_frame_t frame[TJUH_MAX_DEVICES]);
+#endif
+
+#if TJUH_ENABLE_SNAPSHOT
+/**
+ * Copy the latest state of all devices. Each device's entries come from
+ * one report; age_ms is the time since it arrived (since the connect if
+ * none has yet). Call from the same core as tjuh_task().
+ *
+ * @return the number of connected devices.
+ */
+uint8_t tjuh_get_snapshot(tjuh_snapshot_t *snapshot);
+#endif
+
+#if TJUH_ENABLE_SUBSCRIBE
+/**
+ * Add a subscriber. It is called after on_state, on_ext and on_report,
+ * for reports from its devices in which one of its fields changed, and
+ * for the first report of each device after it subscribed or the device
+ * connected. A report held back by the rate cap is not dropped: the
+ * subscriber gets the first report from that device once the interval
+ * has passed, changed or not, so it always ends on the latest state.
+ * Subscriptions are cleared by tjuh_init(); call from the same core as
+ * tjuh_task(), also from inside a subscriber.
+ *
+ * @return a handle for tjuh_unsubscribe(), or -1 if all
+ *         TJUH_MAX_SUBSCRIBERS slots are taken or callback is NULL.
+ */
+int8_t tjuh_subscribe(const tjuh_subscription_t *subscription);
+
+/**
+ * Remove a subscriber. It is not called again, even for the report
+ * being dispatched.
+ *
+ * @return false if the handle is not subscribed.
+ */
+bool tjuh_unsubscribe(int8_t handle);
+#endif
+
+#if TJUH_ENABLE_COMBOS
+/**
+ * Add a combo. Its steps are copied and compiled, so they need not stay
+ * valid. Every device matches it from its next press on; the callback
+ * runs during the report that completes it, after the subscribers.
+ * Combos are cleared by tjuh_init(); call from the same core as
+ * tjuh_task(), also from inside a combo callback.
+ *
+ * @return a handle for tjuh_combo_unregister(), or -1 if all
+ *         TJUH_MAX_COMBOS slots are taken or the combo is invalid.
+ */
+int8_t tjuh_combo_register(const tjuh_combo_t *combo);
+
+/**
+ * Remove a combo.
+ *
+ * @return false if the handle is not registered.
+ */
+bool tjuh_combo_unregister(int8_t handle);
+
+/**
+ * Copy a device's latest button edges, newest first: up to
+ * TJUH_INPUT_HISTORY presses and releases since it connected.
+ *
+ * @return the number of events copied, 0 if the device is not connected.
+ */
+uint8_t tjuh_get_input_history(uint8_t dev_addr, tjuh_button_event_t *events, uint8_t max);
+#endif
+
+#if TJUH_ENABLE_ACTIONS
+/**
+ * Replace the action map, used for every device. The bindings are
+ * copied and compiled, so they need not stay valid. The map is cleared
+ * by tjuh_init(); call from the same core as tjuh_task().
+ *
+ * @param bindings  Up to TJUH_MAX_BINDINGS bindings; NULL or 0 clears the map
+ *
+ * @return false, leaving the map as it was, if there are too many
+ *         bindings or one is invalid.
+ */
+bool tjuh_set_action_map(const tjuh_binding_t *bindings, uint8_t count);
+
+/**
+ * Read a device's actions and start collecting the next edges. An
+ * action turned on and off again between two calls shows in both
+ * `pressed` and `released`; a disconnect releases the active ones. Call
+ * from the same core as tjuh_task().
+ *
+ * @return false if the device has not reported since it connected; the
+ *         releases of a disconnect are still read.
+ */
+bool tjuh_get_actions(uint8_t dev_addr, tjuh_actions_t *actions);
+#endif
+
+#if TJUH_ENABLE_REPORT_TIMING
+/**
+ * Read the report timing collected since the last reset.
+ *
+ * @param reset  Start a new measurement window after reading
+ *
+ * @return false if no report was timed in this window.
+ */
+bool tjuh_get_report_timing(tjuh_report_timing_t *timing, bool reset);
+#endif
+
 /* -------------------------------------------------------------------------- */
 /*  Debug utilities                                                           */
 /* -------------------------------------------------------------------------- */
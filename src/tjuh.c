@@ -5,6 +5,17 @@
 
 #include "tjuh.h"
 #include "tjuh_parse.h"
+#include "tjuh_quirks.h"
+#include "tjuh_condition.h"
+#include "tjuh_pipeline.h"
+#include "tjuh_events.h"
+#include "tjuh_frame.h"
+#include "tjuh_snapshot.h"
+#include "tjuh_subscribe.h"
+#include "tjuh_combo.h"
+#include "tjuh_actions.h"
+#include "tjuh_imu.h"
+#include "tjuh_touch.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -23,23 +34,108 @@
 #include "host/usbh_classdriver.h"
 #endif
 
+#if TJUH_ENABLE_REPORT_TIMING
+#if TJUH_HOST_BUILD
+#include <time.h>
+#elif defined(__arm__)
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#else
+#include "pico/time.h"
+#endif
+#endif
+
 /* ---------------------------------------------------------------------- */
 /*  Constants                                                             */
 /* ---------------------------------------------------------------------- */
 
 #define LANGUAGE_ID   0x0409
+
+/* One IN buffer per device, never fewer than 4 */
+#if TJUH_MAX_DEVICES > 4
+#define BUF_POOL_SIZE TJUH_MAX_DEVICES
+#else
 #define BUF_POOL_SIZE 4
+#endif
+
+/* Diagnostic output. Build with -DTJUH_ENABLE_LOG=0 to silence it; string
+ * descriptors are then no longer fetched since they are only printed. */
+#ifndef TJUH_ENABLE_LOG
+#define TJUH_ENABLE_LOG 1
+#endif
+
+#if TJUH_ENABLE_LOG
+#define TJUH_LOG(...) printf(__VA_ARGS__)
+#else
+#define TJUH_LOG(...) ((void)0)
+#endif
 
 /* ---------------------------------------------------------------------- */
 /*  Internal state                                                        */
 /* ---------------------------------------------------------------------- */
 
+typedef enum {
+    ENUM_IDLE = 0,        /* not mounted, or enumeration finished */
+    ENUM_QUEUED,          /* waiting for an admission slot */
+    ENUM_DEVICE_DESC,
+    ENUM_MANUFACTURER,
+    ENUM_PRODUCT,
+    ENUM_CONFIG_DESC,
+    ENUM_REPORT_DESC,     /* HID report descriptor, unknown devices only */
+    ENUM_SWITCH_HANDSHAKE,  /* Switch Pro OUT reports: handshake, */
+    ENUM_SWITCH_FORCE_USB,  /* USB-only mode, */
+    ENUM_SWITCH_IMU,        /* IMU on (on_imu only) */
+    ENUM_IMU_CALIB,       /* IMU calibration feature report, on_imu only */
+} tjuh_enum_step_t;
+
+/* Admission order: controllers in the quirk table, other devices, then
+ * boot keyboards and mice once their configuration descriptor shows it */
+enum {
+    ENUM_PRIO_DEMOTED = 0,
+    ENUM_PRIO_UNLISTED,
+    ENUM_PRIO_LISTED,
+};
+
+#if TJUH_ENABLE_XBOX_ONE
+#define GIP_MAX_PACKET 13   /* acknowledgement, the longest packet sent */
+#endif
+
 typedef struct {
     tusb_desc_device_t desc_device;
     tjuh_hint_t        hint;
+    const tjuh_quirk_t *quirk;      /* NULL if the device is not in the table */
     size_t             max_hid_buf_size;
+    uint8_t            hid_itf;             /* interface streaming reports */
+    uint16_t           report_desc_len;     /* 0 = no HID report descriptor */
+
+#if TJUH_ENABLE_XBOX_ONE || TJUH_ENABLE_SWITCH
+    uint8_t            ep_out;              /* 0 = not opened */
+#endif
+
+#if TJUH_ENABLE_XBOX_ONE
+    /* Xbox One GIP output (see "Xbox One output") */
+    uint8_t            gip_seq;             /* last host sequence number */
+    uint8_t            gip_pending_len;     /* 0 = nothing waiting for ep_out */
+    uint8_t            gip_pending[GIP_MAX_PACKET];
+    uint8_t            gip_tx[GIP_MAX_PACKET];
+#endif
+
+    /* Enumeration admission */
+    uint8_t            enum_step;
+    uint8_t            enum_resume;         /* step to readmit at, 0 = the first */
+    uint8_t            enum_priority;
+    uint8_t            enum_slot;
+    bool               enum_in_flight;
+    uint16_t           enum_seq;
 } tjuh_device_state_t;
 
+/* Scratch space for one admitted enumeration */
+typedef struct {
+    uint8_t  dev_addr;     /* 0 = free */
+    uint16_t buf[128];
+    tusb_control_request_t req;    /* class requests */
+} tjuh_enum_slot_t;
+
 static const tjuh_device_state_t s_dev_init = {0};
 
 /* Index 0 is unused — device addresses are 1-based */
@@ -49,21 +145,139 @@ static uint8_t s_assigned_mask;
 static uint8_t s_buf_pool[BUF_POOL_SIZE][64];
 static uint8_t s_buf_owner[BUF_POOL_SIZE];
 
+static tjuh_enum_slot_t s_enum_slots[TJUH_ENUM_MAX_CONCURRENT];
+static uint16_t s_enum_seq;
+static bool     s_enum_retry;
+
 static tjuh_config_t s_config;
-static const tjuh_gamepad_report_t s_zero_report = {0};
 
-/* Xbox One initialization sequence */
-static const uint8_t s_xboxone_start_input[] = {0x05, 0x20, 0x03, 0x01, 0x00};
+/* Reports of the current tjuh_task() pass, for on_report_batch */
+static tjuh_report_entry_t s_batch[TJUH_BATCH_MAX];
+static uint16_t            s_batch_n;
 
+#if TJUH_ENABLE_XBOX_ONE
+/* Xbox One power on (start input); byte 2 is the sequence number */
+static const uint8_t s_xboxone_start_input[] = {0x05, 0x20, 0x00, 0x01, 0x00};
+#endif
+
+#if TJUH_ENABLE_SWITCH
 /* Switch Pro initialization: handshake + force USB-only mode */
 static const uint8_t s_switch_handshake[] = {0x80, 0x02};
 static const uint8_t s_switch_force_usb[] = {0x80, 0x04};
+#endif
+
+#if TJUH_ENABLE_SWITCH && TJUH_ENABLE_IMU
+/* Switch Pro subcommand 0x40 0x01 (enable IMU), neutral rumble data */
+static const uint8_t s_switch_enable_imu[] = {
+    0x01, 0x00, 0x00, 0x01, 0x40, 0x40, 0x00, 0x01, 0x40, 0x40, 0x40, 0x01
+};
+#endif
+
+/* ---------------------------------------------------------------------- */
+/*  Report timing                                                         */
+/* ---------------------------------------------------------------------- */
+
+#if TJUH_ENABLE_REPORT_TIMING
+
+#if TJUH_HOST_BUILD
+
+static void timing_clock_init(void) {}
+
+static inline uint32_t timing_now(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+static inline uint32_t timing_since(uint32_t start)
+{
+    return timing_now() - start;
+}
 
-/* Known VID/PID for hint detection */
-#define TJUH_VID_NINTENDO     0x057E
-#define TJUH_PID_SWITCH_PRO   0x2009
-#define TJUH_PID_JOYCON_L     0x2006
-#define TJUH_PID_JOYCON_R     0x2007
+static uint32_t timing_ticks_per_us(void)
+{
+    return 1000;
+}
+
+#elif defined(__arm__)
+
+/* SysTick counts CPU cycles down from 2^24 - 1 and is otherwise unused */
+static void timing_clock_init(void)
+{
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;      /* enable, processor clock, no interrupt */
+}
+
+static inline uint32_t timing_now(void)
+{
+    return systick_hw->cvr;
+}
+
+static inline uint32_t timing_since(uint32_t start)
+{
+    return (start - systick_hw->cvr) & 0x00FFFFFFu;
+}
+
+static uint32_t timing_ticks_per_us(void)
+{
+    return clock_get_hz(clk_sys) / 1000000u;
+}
+
+#else
+
+/* RP2350 RISC-V cores: the microsecond timer */
+static void timing_clock_init(void) {}
+
+static inline uint32_t timing_now(void)
+{
+    return time_us_32();
+}
+
+static inline uint32_t timing_since(uint32_t start)
+{
+    return time_us_32() - start;
+}
+
+static uint32_t timing_ticks_per_us(void)
+{
+    return 1;
+}
+
+#endif
+
+static struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} s_timing;
+
+static inline void timing_record(uint32_t ticks)
+{
+    if (s_timing.count == 0 || ticks < s_timing.min)
+        s_timing.min = ticks;
+    if (ticks > s_timing.max)
+        s_timing.max = ticks;
+    s_timing.sum += ticks;
+    s_timing.count++;
+}
+
+bool tjuh_get_report_timing(tjuh_report_timing_t *timing, bool reset)
+{
+    timing->count        = s_timing.count;
+    timing->min          = s_timing.min;
+    timing->max          = s_timing.max;
+    timing->mean         = s_timing.count ? (uint32_t)(s_timing.sum / s_timing.count) : 0;
+    timing->ticks_per_us = timing_ticks_per_us();
+
+    if (reset)
+        memset(&s_timing, 0, sizeof(s_timing));
+    return timing->count != 0;
+}
+
+#endif /* TJUH_ENABLE_REPORT_TIMING */
 
 /* ---------------------------------------------------------------------- */
 /*  Buffer pool                                                           */
@@ -92,41 +306,194 @@ static void buf_pool_free(uint8_t dev_addr)
 /*  Forward declarations                                                  */
 /* ---------------------------------------------------------------------- */
 
-static void on_device_descriptor(tuh_xfer_t *xfer);
+static uint8_t enum_priority(uint8_t dev_addr);
+static void enum_release(uint8_t dev_addr);
+static void send_set_idle(uint8_t dev_addr, uint8_t itf_num);
+static void enum_pump(void);
+static void on_enum_xfer(tuh_xfer_t *xfer);
 static void on_report_received(tuh_xfer_t *xfer);
+#if TJUH_ENABLE_XBOX_ONE
+static void on_gip_sent(tuh_xfer_t *xfer);
+#endif
 static void parse_config_descriptor(uint8_t dev_addr, tusb_desc_configuration_t const *desc_cfg);
 static bool open_hid_interface(uint8_t dev_addr, tusb_desc_interface_t const *desc_itf, uint16_t max_len);
 static uint16_t count_interface_total_len(tusb_desc_interface_t const *desc_itf, uint8_t itf_count, uint16_t max_len);
 
 /* ---------------------------------------------------------------------- */
-/*  Xbox One output                                                       */
+/*  Switch Pro output                                                     */
 /* ---------------------------------------------------------------------- */
 
-static uint8_t s_epout_buf[64];
-
-static bool send_xinput_report(uint8_t dev_addr, uint8_t ep_out, const uint8_t *data, uint16_t len)
+#if TJUH_ENABLE_SWITCH
+/*
+ * The OUT report of a Switch enumeration step, sent from the device's
+ * enumeration slot so that pads enumerating side by side do not share a
+ * buffer. Its completion is the step's (on_enum_xfer).
+ */
+static bool switch_send_step(uint8_t dev_addr, uint8_t step, uint8_t *buf)
 {
-    if (len > sizeof(s_epout_buf))
-        return false;
+    const uint8_t *data = s_switch_handshake;
+    uint16_t len = sizeof(s_switch_handshake);
+
+    if (step == ENUM_SWITCH_FORCE_USB) {
+        data = s_switch_force_usb;
+        len  = sizeof(s_switch_force_usb);
+    }
+#if TJUH_ENABLE_IMU
+    if (step == ENUM_SWITCH_IMU) {
+        data = s_switch_enable_imu;
+        len  = sizeof(s_switch_enable_imu);
+    }
+#endif
 
-    memcpy(s_epout_buf, data, len);
+    memcpy(buf, data, len);
 
     tuh_xfer_t xfer = {
         .daddr       = dev_addr,
-        .ep_addr     = ep_out,
+        .ep_addr     = s_devices[dev_addr].ep_out,
         .buflen      = len,
-        .buffer      = s_epout_buf,
-        .complete_cb = NULL,
+        .buffer      = buf,
+        .complete_cb = on_enum_xfer,
         .user_data   = 0,
     };
 
     return tuh_edpt_xfer(&xfer);
 }
+#endif /* TJUH_ENABLE_SWITCH */
+
+/* ---------------------------------------------------------------------- */
+/*  Xbox One output                                                       */
+/* ---------------------------------------------------------------------- */
+
+#if TJUH_ENABLE_XBOX_ONE
+
+/*
+ * GIP packets are sent without blocking: a packet queued while ep_out is
+ * busy goes out when the previous one completes or the next report
+ * arrives. One packet is held per device and a newer one replaces it;
+ * the controller repeats a packet until it is acknowledged, so a dropped
+ * acknowledgement only costs a retransmission.
+ */
+static void TJUH_HOT_FUNC(gip_flush)(uint8_t daddr)
+{
+    tjuh_device_state_t *dev = &s_devices[daddr];
+
+    if (!dev->gip_pending_len || !dev->ep_out || usbh_edpt_busy(daddr, dev->ep_out))
+        return;
+
+    memcpy(dev->gip_tx, dev->gip_pending, dev->gip_pending_len);
+
+    tuh_xfer_t xfer = {
+        .daddr       = daddr,
+        .ep_addr     = dev->ep_out,
+        .buflen      = dev->gip_pending_len,
+        .buffer      = dev->gip_tx,
+        .complete_cb = on_gip_sent,
+        .user_data   = 0,
+    };
+
+    if (tuh_edpt_xfer(&xfer))
+        dev->gip_pending_len = 0;
+}
+
+static void on_gip_sent(tuh_xfer_t *xfer)
+{
+    gip_flush(xfer->daddr);
+}
+
+static void gip_send(uint8_t daddr, const uint8_t *pkt, uint8_t len)
+{
+    memcpy(s_devices[daddr].gip_pending, pkt, len);
+    s_devices[daddr].gip_pending_len = len;
+    gip_flush(daddr);
+}
+
+/* Host sequence numbers run 1..255 */
+static uint8_t gip_next_seq(uint8_t daddr)
+{
+    if (++s_devices[daddr].gip_seq == 0)
+        s_devices[daddr].gip_seq = 1;
+    return s_devices[daddr].gip_seq;
+}
+
+static void gip_power_on(uint8_t daddr)
+{
+    uint8_t pkt[sizeof(s_xboxone_start_input)];
+    memcpy(pkt, s_xboxone_start_input, sizeof(pkt));
+    pkt[2] = gip_next_seq(daddr);
+    gip_send(daddr, pkt, sizeof(pkt));
+}
+
+/*
+ * Protocol side of a received packet. The controller sets
+ * TJUH_GIP_OPT_ACK on packets it wants acknowledged (the guide button
+ * among them) and re-sends them, holding back input, until it is. An
+ * announce means it (re)started and waits for power on again.
+ */
+static void TJUH_HOT_FUNC(gip_receive)(uint8_t daddr, const uint8_t *pkt, uint16_t len)
+{
+    if (len < 4)
+        return;
+
+    if (pkt[1] & TJUH_GIP_OPT_ACK) {
+        /* Echoes command, sequence and payload length of the packet */
+        const uint8_t ack[GIP_MAX_PACKET] = {
+            TJUH_GIP_CMD_ACK, TJUH_GIP_OPT_INTERNAL, pkt[2], 0x09,
+            0x00, pkt[0], (uint8_t)(pkt[1] & TJUH_GIP_OPT_INTERNAL), pkt[3],
+            0x00, 0x00, 0x00, 0x00, 0x00,
+        };
+        gip_send(daddr, ack, sizeof(ack));
+    }
+
+    if (pkt[0] == TJUH_GIP_CMD_ANNOUNCE)
+        gip_power_on(daddr);
+}
+
+#endif /* TJUH_ENABLE_XBOX_ONE */
+
+/* ---------------------------------------------------------------------- */
+/*  HID class requests                                                    */
+/* ---------------------------------------------------------------------- */
+
+static void on_set_idle_done(tuh_xfer_t *xfer)
+{
+    (void)xfer;
+}
+
+/* SET_IDLE(0): only report on change. Best effort — ignored if the control
+ * pipe is busy, as the device still works at its default idle rate. */
+static void send_set_idle(uint8_t dev_addr, uint8_t itf_num)
+{
+    static const tusb_control_request_t req_template = {
+        .bmRequestType = 0x21,   /* class, interface, host-to-device */
+        .bRequest      = 0x0A,   /* SET_IDLE */
+        .wValue        = 0,
+        .wIndex        = 0,
+        .wLength       = 0,
+    };
+    static tusb_control_request_t req;
+
+    req = req_template;
+    req.wIndex = tu_htole16(itf_num);
+
+    tuh_xfer_t xfer = {
+        .daddr       = dev_addr,
+        .ep_addr     = 0,
+        .setup       = &req,
+        .buffer      = NULL,
+        .complete_cb = on_set_idle_done,
+        .user_data   = 0,
+    };
+
+    if (!tuh_control_xfer(&xfer))
+        TJUH_LOG("[TJUH] SET_IDLE skipped [dev %u]\r\n", dev_addr);
+}
 
 /* ---------------------------------------------------------------------- */
 /*  UTF-16 to UTF-8 helpers (for debug printing)                          */
 /* ---------------------------------------------------------------------- */
 
+#if TJUH_ENABLE_LOG
+
 static void convert_utf16le_to_utf8(const uint16_t *utf16, size_t utf16_len,
                                     uint8_t *utf8, size_t utf8_len)
 {
@@ -166,6 +533,33 @@ static void print_utf16(uint16_t *buf, size_t buf_len)
     printf("%s", (char *)buf);
 }
 
+#endif /* TJUH_ENABLE_LOG */
+
+/* ---------------------------------------------------------------------- */
+/*  Batch delivery                                                        */
+/* ---------------------------------------------------------------------- */
+
+static void batch_flush(void)
+{
+    if (s_batch_n == 0)
+        return;
+
+    uint16_t n = s_batch_n;
+    s_batch_n = 0;
+    s_config.on_report_batch(s_batch, n);
+}
+
+static inline void batch_add(uint8_t dev_addr, const tjuh_gamepad_state_t *state)
+{
+    /* A full batch goes out now rather than dropping reports */
+    if (s_batch_n == TJUH_BATCH_MAX)
+        batch_flush();
+
+    s_batch[s_batch_n].state    = *state;
+    s_batch[s_batch_n].dev_addr = dev_addr;
+    s_batch_n++;
+}
+
 /* ---------------------------------------------------------------------- */
 /*  Public API                                                            */
 /* ---------------------------------------------------------------------- */
@@ -175,18 +569,53 @@ void tjuh_init(const tjuh_config_t *config)
     if (config)
         s_config = *config;
 
+    tjuh_pipeline_configure(s_config.on_ext != NULL, s_config.changes_only);
+    tjuh_events_reset();
+    tjuh_frame_reset();
+    tjuh_snapshot_reset();
+    tjuh_subscribe_reset();
+    tjuh_combo_reset();
+    tjuh_actions_reset();
+    s_batch_n = 0;
+
     memset(s_devices, 0, sizeof(s_devices));
     memset(s_buf_owner, 0, sizeof(s_buf_owner));
+    memset(s_enum_slots, 0, sizeof(s_enum_slots));
     s_assigned_mask = 0;
+    s_enum_seq = 0;
+    s_enum_retry = false;
+
+#if TJUH_ENABLE_REPORT_TIMING
+    memset(&s_timing, 0, sizeof(s_timing));
+    timing_clock_init();
+#endif
+
+#if defined(TJUH_QUIRK_BLOB_ADDR) && defined(TJUH_QUIRK_BLOB_SIZE)
+    if (tjuh_quirk_blob_attach((const void *)(TJUH_QUIRK_BLOB_ADDR), TJUH_QUIRK_BLOB_SIZE))
+        TJUH_LOG("[TJUH] Quirk blob attached\r\n");
+#endif
 
     tuh_init(BOARD_TUH_RHPORT);
 }
 
+void tjuh_task(void)
+{
+    tuh_task();
+    tjuh_parse_task();
+    batch_flush();
+    enum_pump();
+}
+
 bool tjuh_get_device_info(uint8_t dev_addr, uint16_t *vid, uint16_t *pid)
 {
     return tjuh_parse_get_vid_pid(dev_addr, vid, pid);
 }
 
+uint16_t tjuh_get_reclassify_count(uint8_t dev_addr)
+{
+    return tjuh_parse_get_reclassify_count(dev_addr);
+}
+
 /* ---------------------------------------------------------------------- */
 /*  Debug utilities                                                       */
 /* ---------------------------------------------------------------------- */
@@ -229,88 +658,454 @@ void tjuh_print_raw(const uint8_t *buf, uint16_t len, uint16_t max_ep_size)
 
 void tuh_mount_cb(uint8_t dev_addr)
 {
-    printf("[TJUH] Device attached, address = %u\r\n", dev_addr);
+    TJUH_LOG("[TJUH] Device attached, address = %u\r\n", dev_addr);
 
     if (dev_addr > TJUH_MAX_DEVICES) {
-        printf("[TJUH] Device address %u exceeds max (%d)\r\n", dev_addr, TJUH_MAX_DEVICES);
+        TJUH_LOG("[TJUH] Device address %u exceeds max (%d)\r\n", dev_addr, TJUH_MAX_DEVICES);
         return;
     }
 
     s_devices[dev_addr] = s_dev_init;
     s_assigned_mask |= (uint8_t)(0x01 << dev_addr);
 
-    tuh_descriptor_get_device(dev_addr, &s_devices[dev_addr].desc_device, 18,
-                              on_device_descriptor, 0);
+    /* Queue the heavy descriptor work; admission happens in enum_pump() */
+    s_devices[dev_addr].enum_step     = ENUM_QUEUED;
+    s_devices[dev_addr].enum_priority = enum_priority(dev_addr);
+    s_devices[dev_addr].enum_seq      = s_enum_seq++;
+
+    enum_pump();
 }
 
 void tuh_umount_cb(uint8_t dev_addr)
 {
-    printf("[TJUH] Device removed, address = %u\r\n", dev_addr);
+    TJUH_LOG("[TJUH] Device removed, address = %u\r\n", dev_addr);
 
     tjuh_parse_free_device(dev_addr);
+    tjuh_condition_release(dev_addr);
+    tjuh_pipeline_release(dev_addr);
+    tjuh_events_release(dev_addr);
+    tjuh_frame_release(dev_addr);
+    tjuh_snapshot_release(dev_addr);
+    tjuh_subscribe_release(dev_addr);
+    tjuh_combo_release(dev_addr);
+    tjuh_actions_release(dev_addr);
+    tjuh_imu_release(dev_addr);
+    tjuh_touch_release(dev_addr);
     buf_pool_free(dev_addr);
 
     if (dev_addr <= TJUH_MAX_DEVICES) {
+        enum_release(dev_addr);
         s_devices[dev_addr].hint = TJUH_HINT_NONE;
+        s_devices[dev_addr].quirk = NULL;
+        s_devices[dev_addr].report_desc_len = 0;
         s_devices[dev_addr].max_hid_buf_size = 64;
+#if TJUH_ENABLE_XBOX_ONE || TJUH_ENABLE_SWITCH
+        s_devices[dev_addr].ep_out = 0;
+#endif
+#if TJUH_ENABLE_XBOX_ONE
+        s_devices[dev_addr].gip_seq = 0;
+        s_devices[dev_addr].gip_pending_len = 0;
+#endif
         s_assigned_mask &= (uint8_t)~(0x01 << dev_addr);
     }
 
+    /* The device's last reports before its disconnect */
+    batch_flush();
+
     if (s_config.on_disconnect)
         s_config.on_disconnect(dev_addr);
+
+    enum_pump();
 }
 
 /* ---------------------------------------------------------------------- */
-/*  Device descriptor callback                                            */
+/*  Enumeration admission queue                                           */
+/*                                                                        */
+/*  When a hub with several pads powers up, every device mounts at once.  */
+/*  Descriptor fetches all compete for the single control pipe, so at     */
+/*  most TJUH_ENUM_MAX_CONCURRENT devices are admitted at a time, highest */
+/*  priority (likely gamepads) first, then in mount order; a device whose */
+/*  configuration shows a boot keyboard or mouse gives up its slot to the */
+/*  queue. Every step, the Switch Pro's OUT reports included, is          */
+/*  asynchronous, so streaming pads keep being serviced by tuh_task()     */
+/*  between steps. A request rejected because the pipe is busy is simply  */
+/*  retried on the next pump.                                             */
 /* ---------------------------------------------------------------------- */
 
-static void on_device_descriptor(tuh_xfer_t *xfer)
+static uint8_t enum_priority(uint8_t dev_addr)
 {
-    if (xfer->result != XFER_RESULT_SUCCESS) {
-        printf("[TJUH] Failed to get device descriptor\r\n");
+    uint16_t vid = 0;
+    uint16_t pid = 0;
+
+    if (!tuh_vid_pid_get(dev_addr, &vid, &pid))
+        return ENUM_PRIO_DEMOTED;
+
+    return tjuh_quirk_lookup(vid, pid) ? ENUM_PRIO_LISTED : ENUM_PRIO_UNLISTED;
+}
+
+/* A boot keyboard or mouse interface (HID, boot subclass) in the first
+ * `len` bytes of a configuration descriptor */
+static bool config_has_boot_interface(tusb_desc_configuration_t const *desc_cfg, uint16_t len)
+{
+    uint8_t const *p_desc   = tu_desc_next(desc_cfg);
+    uint8_t const *desc_end = (uint8_t const *)desc_cfg +
+                              TU_MIN(tu_le16toh(desc_cfg->wTotalLength), len);
+
+    while (p_desc + 2 <= desc_end && tu_desc_len(p_desc)) {
+        tusb_desc_interface_t const *desc_itf = (tusb_desc_interface_t const *)p_desc;
+
+        if (tu_desc_type(p_desc) == TUSB_DESC_INTERFACE &&
+            p_desc + sizeof(tusb_desc_interface_t) <= desc_end &&
+            desc_itf->bInterfaceClass == 0x03 && desc_itf->bInterfaceSubClass == 0x01 &&
+            (desc_itf->bInterfaceProtocol == 0x01 || desc_itf->bInterfaceProtocol == 0x02))
+            return true;
+
+        p_desc = tu_desc_next(p_desc);
+    }
+    return false;
+}
+
+static void enum_release(uint8_t dev_addr)
+{
+    tjuh_device_state_t *dev = &s_devices[dev_addr];
+
+    if (s_enum_slots[dev->enum_slot].dev_addr == dev_addr)
+        s_enum_slots[dev->enum_slot].dev_addr = 0;
+
+    dev->enum_step      = ENUM_IDLE;
+    dev->enum_in_flight = false;
+}
+
+static bool enum_submit(uint8_t dev_addr)
+{
+    tjuh_device_state_t *dev = &s_devices[dev_addr];
+    uint16_t *buf = s_enum_slots[dev->enum_slot].buf;
+    bool ok = false;
+
+    switch (dev->enum_step) {
+        case ENUM_DEVICE_DESC:
+            ok = tuh_descriptor_get_device(dev_addr, &dev->desc_device, 18, on_enum_xfer, 0);
+            break;
+        case ENUM_MANUFACTURER:
+            ok = tuh_descriptor_get_manufacturer_string(dev_addr, LANGUAGE_ID, buf,
+                                                        sizeof(s_enum_slots[0].buf),
+                                                        on_enum_xfer, 0);
+            break;
+        case ENUM_PRODUCT:
+            ok = tuh_descriptor_get_product_string(dev_addr, LANGUAGE_ID, buf,
+                                                   sizeof(s_enum_slots[0].buf),
+                                                   on_enum_xfer, 0);
+            break;
+        case ENUM_CONFIG_DESC:
+            ok = tuh_descriptor_get_configuration(dev_addr, 0, buf,
+                                                  sizeof(s_enum_slots[0].buf),
+                                                  on_enum_xfer, 0);
+            break;
+        case ENUM_REPORT_DESC:
+            /* Longer descriptors are fingerprinted by their first bytes */
+            ok = tuh_descriptor_get_hid_report(dev_addr, dev->hid_itf, HID_DESC_TYPE_REPORT, 0,
+                                               buf, (uint16_t)TU_MIN(dev->report_desc_len,
+                                                                     sizeof(s_enum_slots[0].buf)),
+                                               on_enum_xfer, 0);
+            break;
+#if TJUH_ENABLE_SWITCH
+        case ENUM_SWITCH_HANDSHAKE:
+        case ENUM_SWITCH_FORCE_USB:
+        case ENUM_SWITCH_IMU:
+            ok = switch_send_step(dev_addr, dev->enum_step, (uint8_t *)buf);
+            break;
+#endif
+        case ENUM_IMU_CALIB: {
+            /* GET_REPORT(feature) */
+            tusb_control_request_t *req = &s_enum_slots[dev->enum_slot].req;
+            uint16_t len = 0;
+            uint8_t id = tjuh_imu_calib_report(tjuh_parse_get_parser(dev_addr), &len);
+
+            req->bmRequestType = 0xA1;   /* class, interface, device-to-host */
+            req->bRequest      = 0x01;   /* GET_REPORT */
+            req->wValue        = tu_htole16((uint16_t)((3u << 8) | id));
+            req->wIndex        = tu_htole16(dev->hid_itf);
+            req->wLength       = tu_htole16(len);
+
+            tuh_xfer_t xfer = {
+                .daddr       = dev_addr,
+                .ep_addr     = 0,
+                .setup       = req,
+                .buffer      = (uint8_t *)buf,
+                .complete_cb = on_enum_xfer,
+                .user_data   = 0,
+            };
+            ok = tuh_control_xfer(&xfer);
+            break;
+        }
+        default:
+            return false;
+    }
+
+    dev->enum_in_flight = ok;
+    if (!ok)
+        s_enum_retry = true;
+    return ok;
+}
+
+static int enum_free_slot(void)
+{
+    for (int i = 0; i < TJUH_ENUM_MAX_CONCURRENT; i++) {
+        if (s_enum_slots[i].dev_addr == 0)
+            return i;
+    }
+    return -1;
+}
+
+static uint8_t enum_next_queued(void)
+{
+    uint8_t best = 0;
+
+    for (uint8_t a = 1; a <= TJUH_MAX_DEVICES; a++) {
+        if (s_devices[a].enum_step != ENUM_QUEUED)
+            continue;
+        if (best == 0 ||
+            s_devices[a].enum_priority > s_devices[best].enum_priority ||
+            (s_devices[a].enum_priority == s_devices[best].enum_priority &&
+             (int16_t)(s_devices[a].enum_seq - s_devices[best].enum_seq) < 0))
+        {
+            best = a;
+        }
+    }
+    return best;
+}
+
+static void enum_pump(void)
+{
+    s_enum_retry = false;
+
+    /* Retry admitted devices whose last request was rejected */
+    for (int i = 0; i < TJUH_ENUM_MAX_CONCURRENT; i++) {
+        uint8_t a = s_enum_slots[i].dev_addr;
+        if (a && !s_devices[a].enum_in_flight)
+            enum_submit(a);
+    }
+
+    /* Admit queued devices into free slots */
+    int slot;
+    while ((slot = enum_free_slot()) >= 0) {
+        uint8_t a = enum_next_queued();
+        if (a == 0)
+            break;
+
+        s_enum_slots[slot].dev_addr = a;
+        s_devices[a].enum_slot   = (uint8_t)slot;
+        s_devices[a].enum_step   = s_devices[a].enum_resume ? s_devices[a].enum_resume
+                                                            : ENUM_DEVICE_DESC;
+        s_devices[a].enum_resume = 0;
+        enum_submit(a);
+    }
+}
+
+/*
+ * A boot keyboard or mouse goes back in the queue behind every other
+ * device, to carry on at the same step once readmitted. Without anyone
+ * waiting it simply carries on.
+ */
+static void enum_demote(uint8_t dev_addr)
+{
+    tjuh_device_state_t *dev = &s_devices[dev_addr];
+
+    dev->enum_priority = ENUM_PRIO_DEMOTED;
+    if (!enum_next_queued()) {
+        enum_submit(dev_addr);
         return;
     }
 
-    uint8_t daddr = xfer->daddr;
-    tusb_desc_device_t *desc = &s_devices[daddr].desc_device;
+    s_enum_slots[dev->enum_slot].dev_addr = 0;
+    dev->enum_resume = dev->enum_step;
+    dev->enum_step   = ENUM_QUEUED;
+    enum_pump();
+}
 
-    printf("[TJUH] Device %u: ID %04x:%04x\r\n", daddr, desc->idVendor, desc->idProduct);
+/* Step after the IMU set-up: its calibration, for controllers that have one */
+static uint8_t enum_step_calib(uint8_t dev_addr)
+{
+    uint16_t len;
 
-    /* Print string descriptors */
-    uint16_t temp_buf[128];
+    if (s_config.on_imu && tjuh_imu_calib_report(tjuh_parse_get_parser(dev_addr), &len))
+        return ENUM_IMU_CALIB;
+    return ENUM_IDLE;
+}
 
-    printf("  iManufacturer  %u  ", desc->iManufacturer);
-    if (XFER_RESULT_SUCCESS == tuh_descriptor_get_manufacturer_string_sync(
-            daddr, LANGUAGE_ID, temp_buf, sizeof(temp_buf)))
-        print_utf16(temp_buf, TU_ARRAY_SIZE(temp_buf));
-    printf("\r\n");
+/* Step after the descriptors: the Switch Pro's OUT reports, then the calibration */
+static uint8_t enum_step_after_desc(uint8_t dev_addr)
+{
+#if TJUH_ENABLE_SWITCH
+    if (s_devices[dev_addr].hint == TJUH_HINT_SWITCH_PRO && s_devices[dev_addr].ep_out)
+        return ENUM_SWITCH_HANDSHAKE;
+#endif
+    return enum_step_calib(dev_addr);
+}
 
-    printf("  iProduct       %u  ", desc->iProduct);
-    if (XFER_RESULT_SUCCESS == tuh_descriptor_get_product_string_sync(
-            daddr, LANGUAGE_ID, temp_buf, sizeof(temp_buf)))
-        print_utf16(temp_buf, TU_ARRAY_SIZE(temp_buf));
-    printf("\r\n");
+static void enum_finish(uint8_t dev_addr)
+{
+    enum_release(dev_addr);
+    enum_pump();
+}
+
+static void on_device_descriptor(uint8_t daddr)
+{
+    tusb_desc_device_t *desc = &s_devices[daddr].desc_device;
 
     if (tjuh_parse_init_device(daddr, desc->idVendor, desc->idProduct)) {
-        /* Detect controllers that need special handling during enumeration */
-        if (desc->idVendor == TJUH_VID_NINTENDO &&
-            (desc->idProduct == TJUH_PID_SWITCH_PRO ||
-             desc->idProduct == TJUH_PID_JOYCON_L ||
-             desc->idProduct == TJUH_PID_JOYCON_R))
-        {
-            printf("[TJUH] Nintendo Switch controller detected\r\n");
+        /* Controllers that need special handling during enumeration */
+        const tjuh_quirk_t *q = tjuh_quirk_lookup(desc->idVendor, desc->idProduct);
+        s_devices[daddr].quirk = q;
+
+#if TJUH_ENABLE_SWITCH
+        if (q && q->init == TJUH_INIT_SWITCH_USB) {
+            TJUH_LOG("[TJUH] Nintendo Switch controller detected\r\n");
             s_devices[daddr].hint = TJUH_HINT_SWITCH_PRO;
         }
+#endif
+#if TJUH_ENABLE_XBOX_ONE
+        if (q && q->init == TJUH_INIT_XBOX_ONE) {
+            TJUH_LOG("[TJUH] Xbox One controller detected\r\n");
+            s_devices[daddr].hint = TJUH_HINT_XBOX_ONE;
+        }
+#endif
+
+        /* Before on_connect, which may set a conditioning profile */
+        tjuh_pipeline_rebuild(daddr);
+        tjuh_snapshot_connect(daddr);
 
         if (s_config.on_connect)
             s_config.on_connect(daddr, desc->idVendor, desc->idProduct);
 
-        if (XFER_RESULT_SUCCESS == tuh_descriptor_get_configuration_sync(
-                daddr, 0, temp_buf, sizeof(temp_buf)))
-            parse_config_descriptor(daddr, (tusb_desc_configuration_t *)temp_buf);
+        s_devices[daddr].enum_step = ENUM_CONFIG_DESC;
+    } else {
+        s_devices[daddr].enum_step = ENUM_IDLE;
     }
 }
 
+static void on_enum_xfer(tuh_xfer_t *xfer)
+{
+    uint8_t daddr = xfer->daddr;
+
+    if (daddr == 0 || daddr > TJUH_MAX_DEVICES || !s_devices[daddr].enum_in_flight)
+        return;
+
+    tjuh_device_state_t *dev = &s_devices[daddr];
+    bool ok = (xfer->result == XFER_RESULT_SUCCESS);
+    bool demote = false;
+
+    dev->enum_in_flight = false;
+
+    switch (dev->enum_step) {
+        case ENUM_DEVICE_DESC:
+            if (!ok) {
+                TJUH_LOG("[TJUH] Failed to get device descriptor\r\n");
+                enum_finish(daddr);
+                return;
+            }
+            TJUH_LOG("[TJUH] Device %u: ID %04x:%04x\r\n", daddr,
+                     dev->desc_device.idVendor, dev->desc_device.idProduct);
+#if TJUH_ENABLE_LOG
+            dev->enum_step = ENUM_MANUFACTURER;
+#else
+            on_device_descriptor(daddr);
+#endif
+            break;
+
+#if TJUH_ENABLE_LOG
+        case ENUM_MANUFACTURER:
+            printf("  iManufacturer  %u  ", dev->desc_device.iManufacturer);
+            if (ok)
+                print_utf16(s_enum_slots[dev->enum_slot].buf, TU_ARRAY_SIZE(s_enum_slots[0].buf));
+            printf("\r\n");
+            dev->enum_step = ENUM_PRODUCT;
+            break;
+
+        case ENUM_PRODUCT:
+            printf("  iProduct       %u  ", dev->desc_device.iProduct);
+            if (ok)
+                print_utf16(s_enum_slots[dev->enum_slot].buf, TU_ARRAY_SIZE(s_enum_slots[0].buf));
+            printf("\r\n");
+            on_device_descriptor(daddr);
+            break;
+#endif
+
+        case ENUM_CONFIG_DESC:
+            if (ok) {
+                tusb_desc_configuration_t const *desc_cfg =
+                    (tusb_desc_configuration_t *)s_enum_slots[dev->enum_slot].buf;
+
+                parse_config_descriptor(daddr, desc_cfg);
+                demote = dev->enum_priority == ENUM_PRIO_UNLISTED &&
+                         config_has_boot_interface(desc_cfg, (uint16_t)xfer->actual_len);
+            }
+
+            if (ok && dev->report_desc_len && tjuh_parse_needs_report_desc(daddr)) {
+                dev->enum_step = ENUM_REPORT_DESC;
+            } else {
+                tjuh_parse_set_report_desc(daddr, NULL, 0, 0);
+                dev->enum_step = enum_step_after_desc(daddr);
+            }
+            break;
+
+        case ENUM_REPORT_DESC:
+            if (ok) {
+                uint32_t fp = tjuh_parse_set_report_desc(daddr,
+                    (const uint8_t *)s_enum_slots[dev->enum_slot].buf,
+                    (uint16_t)xfer->actual_len, dev->report_desc_len);
+                TJUH_LOG("[TJUH] Device %u: report descriptor %u bytes, fingerprint 0x%08lx\r\n",
+                         daddr, dev->report_desc_len, (unsigned long)fp);
+                (void)fp;
+            } else {
+                tjuh_parse_set_report_desc(daddr, NULL, 0, 0);
+            }
+            dev->enum_step = enum_step_after_desc(daddr);
+            break;
+
+#if TJUH_ENABLE_SWITCH
+        case ENUM_SWITCH_HANDSHAKE:
+            dev->enum_step = ENUM_SWITCH_FORCE_USB;
+            break;
+
+        case ENUM_SWITCH_FORCE_USB:
+            if (ok)
+                TJUH_LOG("[TJUH] Switch Pro USB mode activated\r\n");
+#if TJUH_ENABLE_IMU
+            if (s_config.on_imu) {
+                dev->enum_step = ENUM_SWITCH_IMU;
+                break;
+            }
+#endif
+            dev->enum_step = enum_step_calib(daddr);
+            break;
+
+        case ENUM_SWITCH_IMU:
+            dev->enum_step = enum_step_calib(daddr);
+            break;
+#endif
+
+        case ENUM_IMU_CALIB:
+            /* Without it the nominal sensor scale is used */
+            TJUH_LOG("[TJUH] Device %u: IMU calibration %s\r\n", daddr, ok ? "read" : "unavailable");
+            tjuh_imu_set_calib(daddr, tjuh_parse_get_parser(daddr),
+                               ok ? (const uint8_t *)s_enum_slots[dev->enum_slot].buf : NULL,
+                               (uint16_t)xfer->actual_len);
+            dev->enum_step = ENUM_IDLE;
+            break;
+
+        default:
+            break;
+    }
+
+    if (dev->enum_step == ENUM_IDLE)
+        enum_finish(daddr);
+    else if (demote)
+        enum_demote(daddr);
+    else
+        enum_submit(daddr);
+}
+
 /* ---------------------------------------------------------------------- */
 /*  Configuration descriptor parsing                                      */
 /* ---------------------------------------------------------------------- */
@@ -385,6 +1180,7 @@ static bool open_hid_interface(uint8_t daddr, tusb_desc_interface_t const *desc_
 {
     bool ep_in_found = false;
 
+#if TJUH_ENABLE_XBOX_ONE
     /* HID descriptor is always 9 bytes (USB HID 1.11 §6.2.1).
      * The type tusb_hid_descriptor_hid_t was removed in TinyUSB 0.16+. */
     uint16_t const expected_len =
@@ -395,31 +1191,51 @@ static bool open_hid_interface(uint8_t daddr, tusb_desc_interface_t const *desc_
      * Only set if no hint was assigned during VID/PID detection. */
     if (s_devices[daddr].hint == TJUH_HINT_NONE &&
         max_len == 23 && expected_len == 32 && max_len < expected_len) {
-        printf("[TJUH] Xbox One controller detected (descriptor mismatch)\r\n");
+        TJUH_LOG("[TJUH] Xbox One controller detected (descriptor mismatch)\r\n");
         s_devices[daddr].hint = TJUH_HINT_XBOX_ONE;
     }
+#else
+    (void)max_len;
+#endif
 
     uint8_t const *p_desc = (uint8_t const *)desc_itf;
 
     /* Skip interface descriptor */
     p_desc = tu_desc_next(p_desc);
 
-    /* Skip HID descriptor */
-    p_desc = tu_desc_next(p_desc);
+    /* HID descriptor: note the report descriptor for classification */
+    if (desc_itf->bInterfaceClass == 0x03 && tu_desc_type(p_desc) == HID_DESC_TYPE_HID &&
+        tu_desc_len(p_desc) >= 9 && p_desc[6] == HID_DESC_TYPE_REPORT) {
+        s_devices[daddr].hid_itf         = desc_itf->bInterfaceNumber;
+        s_devices[daddr].report_desc_len = (uint16_t)(p_desc[7] | (p_desc[8] << 8));
+    }
+
+    /* Skip HID descriptor (Xbox One interfaces have none) */
+    if (tu_desc_type(p_desc) == HID_DESC_TYPE_HID)
+        p_desc = tu_desc_next(p_desc);
 
     tusb_desc_endpoint_t const *desc_ep = (tusb_desc_endpoint_t const *)p_desc;
 
     for (int i = 0; i < desc_itf->bNumEndpoints; i++) {
         if (TUSB_DESC_ENDPOINT != desc_ep->bDescriptorType) {
             if (s_devices[daddr].hint != TJUH_HINT_XBOX_ONE) {
-                printf("[TJUH] Unexpected descriptor type 0x%02x\r\n", desc_ep->bDescriptorType);
+                TJUH_LOG("[TJUH] Unexpected descriptor type 0x%02x\r\n", desc_ep->bDescriptorType);
                 return false;
             }
         }
 
         if (tu_edpt_dir(desc_ep->bEndpointAddress) == TUSB_DIR_IN && !ep_in_found) {
+            /* Quirk table may override a device's advertised polling interval */
+            const tjuh_quirk_t *q = s_devices[daddr].quirk;
+            tusb_desc_endpoint_t ep_poll;
+            if (q && q->poll_ms) {
+                ep_poll = *desc_ep;
+                ep_poll.bInterval = q->poll_ms;
+                desc_ep = &ep_poll;
+            }
+
             if (!tuh_edpt_open(daddr, desc_ep)) {
-                printf("[TJUH] Failed to open IN endpoint 0x%02x\r\n", desc_ep->bEndpointAddress);
+                TJUH_LOG("[TJUH] Failed to open IN endpoint 0x%02x\r\n", desc_ep->bEndpointAddress);
                 return false;
             }
 
@@ -439,43 +1255,37 @@ static bool open_hid_interface(uint8_t daddr, tusb_desc_interface_t const *desc_
             };
 
             tuh_edpt_xfer(&xfer);
-            printf("[TJUH] Listening on [dev %u: ep 0x%02x]\r\n", daddr, desc_ep->bEndpointAddress);
+            TJUH_LOG("[TJUH] Listening on [dev %u: ep 0x%02x]\r\n", daddr, desc_ep->bEndpointAddress);
             ep_in_found = true;
 
+            if (q && (q->flags & TJUH_QUIRK_SET_IDLE))
+                send_set_idle(daddr, desc_itf->bInterfaceNumber);
+
         } else if (tu_edpt_dir(desc_ep->bEndpointAddress) == TUSB_DIR_OUT) {
-            /* Xbox One requires start-input command on the OUT endpoint */
+#if TJUH_ENABLE_XBOX_ONE
+            /* Xbox One stays silent until powered on over the OUT endpoint */
             if (s_devices[daddr].hint == TJUH_HINT_XBOX_ONE) {
                 if (!tuh_edpt_open(daddr, desc_ep)) {
-                    printf("[TJUH] Failed to open OUT endpoint 0x%02x\r\n",
-                           desc_ep->bEndpointAddress);
+                    TJUH_LOG("[TJUH] Failed to open OUT endpoint 0x%02x\r\n",
+                             desc_ep->bEndpointAddress);
                 } else {
-                    while (usbh_edpt_busy(daddr, desc_ep->bEndpointAddress))
-                        tuh_task();
-
-                    send_xinput_report(daddr, desc_ep->bEndpointAddress,
-                                       s_xboxone_start_input, sizeof(s_xboxone_start_input));
+                    s_devices[daddr].ep_out = desc_ep->bEndpointAddress;
+                    gip_power_on(daddr);
                 }
             }
+#endif
 
-            /* Switch Pro: handshake + force USB-only mode (prevents BT timeout) */
+#if TJUH_ENABLE_SWITCH
+            /* Switch Pro: handshake + force USB-only mode (prevents BT
+             * timeout), sent as enumeration steps once the descriptors are in */
             if (s_devices[daddr].hint == TJUH_HINT_SWITCH_PRO) {
-                if (!tuh_edpt_open(daddr, desc_ep)) {
-                    printf("[TJUH] Failed to open OUT endpoint 0x%02x\r\n",
-                           desc_ep->bEndpointAddress);
-                } else {
-                    while (usbh_edpt_busy(daddr, desc_ep->bEndpointAddress))
-                        tuh_task();
-                    send_xinput_report(daddr, desc_ep->bEndpointAddress,
-                                       s_switch_handshake, sizeof(s_switch_handshake));
-
-                    while (usbh_edpt_busy(daddr, desc_ep->bEndpointAddress))
-                        tuh_task();
-                    send_xinput_report(daddr, desc_ep->bEndpointAddress,
-                                       s_switch_force_usb, sizeof(s_switch_force_usb));
-
-                    printf("[TJUH] Switch Pro USB mode activated\r\n");
-                }
+                if (!tuh_edpt_open(daddr, desc_ep))
+                    TJUH_LOG("[TJUH] Failed to open OUT endpoint 0x%02x\r\n",
+                             desc_ep->bEndpointAddress);
+                else
+                    s_devices[daddr].ep_out = desc_ep->bEndpointAddress;
             }
+#endif
         }
 
         p_desc = tu_desc_next(p_desc);
@@ -489,21 +1299,93 @@ static bool open_hid_interface(uint8_t daddr, tusb_desc_interface_t const *desc_
 /*  Report reception callback                                             */
 /* ---------------------------------------------------------------------- */
 
-static void on_report_received(tuh_xfer_t *xfer)
+static void TJUH_HOT_FUNC(on_report_received)(tuh_xfer_t *xfer)
 {
     uint8_t *buf = (uint8_t *)xfer->user_data;
 
+    /* Enumeration requests rejected while the control pipe was busy */
+    if (s_enum_retry)
+        enum_pump();
+
+#if TJUH_ENABLE_REPORT_TIMING
+    uint32_t t_start = timing_now();
+#endif
+
+#if TJUH_ENABLE_XBOX_ONE
+    if (s_devices[xfer->daddr].hint == TJUH_HINT_XBOX_ONE) {
+        if (xfer->result == XFER_RESULT_SUCCESS)
+            gip_receive(xfer->daddr, buf, (uint16_t)xfer->actual_len);
+        gip_flush(xfer->daddr);
+    }
+#endif
+
     if (xfer->result == XFER_RESULT_SUCCESS) {
-        tjuh_gamepad_report_t report = s_zero_report;
+        tjuh_gamepad_state_t state;
+        tjuh_gamepad_ext_t   ext;
+        tjuh_report_delta_t  delta;
+
+        /* Parse, conditioning, change detection and the report delta,
+         * composed per device */
+        uint8_t result = tjuh_pipeline_run(xfer->daddr, buf,
+                                           (uint16_t)xfer->actual_len,
+                                           (uint16_t)s_devices[xfer->daddr].max_hid_buf_size,
+                                           s_devices[xfer->daddr].hint, &state, &ext, &delta);
+        bool parsed = (result & TJUH_PIPELINE_PARSED) != 0;
+
+        if (parsed) {
+            tjuh_events_update(xfer->daddr, &delta);
+            tjuh_frame_update(xfer->daddr, &state, &delta);
+            tjuh_snapshot_update(xfer->daddr, &state);
+            tjuh_actions_update(xfer->daddr, &state, &delta);
+        }
 
-        if (tjuh_parse_report(xfer->daddr, buf,
-                              (uint16_t)xfer->actual_len,
-                              (uint16_t)s_devices[xfer->daddr].max_hid_buf_size,
-                              &report,
-                              s_devices[xfer->daddr].hint))
-        {
-            if (s_config.on_report)
+#if TJUH_ENABLE_REPORT_TIMING
+        /* Up to the callbacks, which are the application's time */
+        if (parsed)
+            timing_record(timing_since(t_start));
+#endif
+
+        if (result & TJUH_PIPELINE_CHANGED) {
+            /* Batch mode: on_state and on_report at the end of the pass */
+            if (s_config.on_report_batch)
+                batch_add(xfer->daddr, &state);
+            else if (s_config.on_state)
+                s_config.on_state(xfer->daddr, &state);
+
+            if (s_config.on_ext)
+                s_config.on_ext(xfer->daddr, &state, &ext);
+
+            if (s_config.on_report && !s_config.on_report_batch) {
+                tjuh_gamepad_report_t report;
+                tjuh_state_to_report(&state, &report);
                 s_config.on_report(xfer->daddr, &report);
+            }
+        }
+
+        /* Subscribers and combos see every report, changes_only or not */
+        if (parsed) {
+            tjuh_subscribe_dispatch(xfer->daddr, &state, &delta);
+            tjuh_combo_update(xfer->daddr, &delta);
+        }
+
+        /* Motion and touch are streams: every report */
+        if (parsed) {
+
+            if (s_config.on_imu) {
+                tjuh_imu_sample_t imu[TJUH_IMU_MAX_SAMPLES];
+                uint8_t n = tjuh_imu_process(xfer->daddr, tjuh_parse_get_parser(xfer->daddr),
+                                             buf, (uint16_t)xfer->actual_len, imu);
+                for (uint8_t i = 0; i < n; i++)
+                    s_config.on_imu(xfer->daddr, &imu[i]);
+            }
+
+            if (s_config.on_touch) {
+                tjuh_touch_event_t touch[TJUH_TOUCH_MAX_EVENTS];
+                uint8_t n = tjuh_touch_process(xfer->daddr, tjuh_parse_get_parser(xfer->daddr),
+                                               buf, (uint16_t)xfer->actual_len, touch);
+                for (uint8_t i = 0; i < n; i++)
+                    s_config.on_touch(xfer->daddr, &touch[i]);
+            }
         }
     }
 
@@ -0,0 +1,187 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Action map: bindings compiled into mask/compare tables.
+ *
+ * Bindings are compiled into two tables. A chord row is a button mask
+ * that must be contained in the report's button word (d-pad folded in);
+ * the rows are kept as separate mask and action arrays, so the compiler
+ * can test several at once. An axis row adds a byte compare: the axis
+ * value, taken inverted for "below" bindings so every comparison is "at
+ * or above", against `on`, or `off` while the row is on, which is the
+ * hysteresis. The threshold is picked by masking rather than a branch,
+ * as latched rows are as good as random to a branch predictor. Every row
+ * of a kind costs the same fixed handful of word operations, so a report
+ * evaluates the whole map in a time set by the number of bindings alone.
+ *
+ * A report with the same buttons, hat and axes as the device's previous
+ * one gives the same actions (one pass settles the hysteresis), so it is
+ * not evaluated at all unless the map changed since.
+ */
+
+#include "tjuh_actions.h"
+#include "tjuh_parse.h"
+#include "tjuh_buttons.h"
+#include <string.h>
+
+#if TJUH_ENABLE_ACTIONS
+
+_Static_assert(TJUH_MAX_BINDINGS >= 1 && TJUH_MAX_BINDINGS <= 32,
+               "TJUH_MAX_BINDINGS must be 1 to 32");
+
+#define BINDABLE (TJUH_BTN_BUTTON_MASK | (0xFu << TJUH_EVENT_DPAD_UP))
+
+typedef struct {
+    uint32_t mask;          /* buttons that must all be held */
+    uint32_t action;        /* 1u << action */
+    uint8_t  sel;           /* byte of axis_bytes_t: 0-3 the axes, 4-7 inverted */
+    uint8_t  on;            /* threshold, on the (inverted) byte */
+    uint8_t  drop;          /* on - off: lower threshold while latched */
+} axis_rule_t;
+
+/* The axes word and its complement, as bytes */
+typedef union {
+    uint32_t w[2];
+    uint8_t  b[8];
+} axis_bytes_t;
+
+typedef struct {
+    tjuh_actions_t actions;
+    uint32_t       latched;     /* axis rows on in the latest report */
+    bool           reported;
+    bool           current;     /* evaluated with the latest report and map */
+} actions_device_t;
+
+static uint32_t         s_chord_mask[TJUH_MAX_BINDINGS];
+static uint32_t         s_chord_action[TJUH_MAX_BINDINGS];
+static uint8_t          s_chords;
+static axis_rule_t      s_axis_rule[TJUH_MAX_BINDINGS];
+static uint8_t          s_axis_rules;
+static actions_device_t s_dev[TJUH_MAX_DEVICES];
+
+static bool valid(const tjuh_binding_t *b)
+{
+    if (b->action > 31 || (b->buttons & ~BINDABLE) || (b->axis & (b->axis - 1)) ||
+        b->axis > TJUH_AXIS_RZ)
+        return false;
+
+    /* `off` lies between the centre and `on` */
+    return !b->axis || (b->below ? b->off >= b->on : b->off <= b->on);
+}
+
+void tjuh_actions_reset(void)
+{
+    memset(s_dev, 0, sizeof(s_dev));
+    s_chords     = 0;
+    s_axis_rules = 0;
+}
+
+void TJUH_HOT_FUNC(tjuh_actions_update)(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                                        const tjuh_report_delta_t *delta)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    actions_device_t *d = &s_dev[dev_addr - 1];
+
+    if (!delta->fields && d->current)
+        return;
+
+    uint32_t missing = ~delta->held;
+    uint32_t active  = 0;
+
+    for (uint8_t i = 0; i < s_chords; i++)
+        active |= s_chord_action[i] & -(uint32_t)((s_chord_mask[i] & missing) == 0);
+
+    axis_bytes_t v     = { .w = { st->axes, ~st->axes } };
+    uint32_t     was   = d->latched;
+    uint32_t     latch = 0;
+
+    for (uint8_t i = 0; i < s_axis_rules; i++) {
+        const axis_rule_t *r = &s_axis_rule[i];
+        uint32_t thr = r->on - (r->drop & -(was & 1u));
+        uint32_t hit = ((r->mask & missing) == 0) & (v.b[r->sel] >= thr);
+
+        was    >>= 1;
+        latch   |= hit << i;
+        active  |= r->action & -hit;
+    }
+
+    uint32_t before = d->actions.active;
+    d->actions.pressed  |= active & ~before;
+    d->actions.released |= before & ~active;
+    d->actions.active    = active;
+    d->latched           = latch;
+    d->reported          = true;
+    d->current           = true;
+}
+
+void tjuh_actions_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    actions_device_t *d = &s_dev[dev_addr - 1];
+
+    d->actions.released |= d->actions.active;
+    d->actions.active    = 0;
+    d->latched           = 0;
+    d->reported          = false;
+    d->current           = false;
+}
+
+bool tjuh_set_action_map(const tjuh_binding_t *bindings, uint8_t count)
+{
+    if (!bindings)
+        count = 0;
+    if (count > TJUH_MAX_BINDINGS)
+        return false;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!valid(&bindings[i]))
+            return false;
+    }
+
+    s_chords     = 0;
+    s_axis_rules = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const tjuh_binding_t *b = &bindings[i];
+
+        if (!b->axis) {
+            s_chord_mask[s_chords]   = b->buttons;
+            s_chord_action[s_chords] = 1u << b->action;
+            s_chords++;
+            continue;
+        }
+
+        axis_rule_t *r = &s_axis_rule[s_axis_rules++];
+        uint8_t flip = b->below ? 0xFF : 0x00;
+        r->mask   = b->buttons;
+        r->action = 1u << b->action;
+        r->sel    = (uint8_t)(__builtin_ctz(b->axis) + (b->below ? 4 : 0));
+        r->on     = b->on ^ flip;
+        r->drop   = (uint8_t)(r->on - (b->off ^ flip));
+    }
+
+    /* Row numbers changed: every binding starts from `on` again */
+    for (uint8_t i = 0; i < TJUH_MAX_DEVICES; i++) {
+        s_dev[i].latched = 0;
+        s_dev[i].current = false;
+    }
+    return true;
+}
+
+bool tjuh_get_actions(uint8_t dev_addr, tjuh_actions_t *actions)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES) {
+        memset(actions, 0, sizeof(*actions));
+        return false;
+    }
+
+    actions_device_t *d = &s_dev[dev_addr - 1];
+
+    *actions = d->actions;
+    d->actions.pressed  = 0;
+    d->actions.released = 0;
+    return d->reported;
+}
+
+#endif /* TJUH_ENABLE_ACTIONS */
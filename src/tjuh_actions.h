@@ -0,0 +1,51 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal action map interface.
+ */
+
+#ifndef TJUH_ACTIONS_H
+#define TJUH_ACTIONS_H
+
+#include "tjuh.h"
+#include "tjuh_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if TJUH_ENABLE_ACTIONS
+
+/** Clear the map and every device's actions. */
+void tjuh_actions_reset(void);
+
+/** Evaluate the map on a report. */
+void tjuh_actions_update(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                         const tjuh_report_delta_t *delta);
+
+/** The device is gone; its active actions are released. */
+void tjuh_actions_release(uint8_t dev_addr);
+
+#else
+
+static inline void tjuh_actions_reset(void) {}
+
+static inline void tjuh_actions_update(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                                       const tjuh_report_delta_t *delta)
+{
+    (void)dev_addr;
+    (void)st;
+    (void)delta;
+}
+
+static inline void tjuh_actions_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+#endif /* TJUH_ENABLE_ACTIONS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_ACTIONS_H */
@@ -0,0 +1,343 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Button lookup tables.
+ *
+ * Every table is expanded by the preprocessor from a per-byte mapping
+ * expression, so the tables are generated at build time from the same
+ * bit assignments the reference parsers in tjuh_parse.c use, and live in
+ * flash as const data (SRAM with TJUH_HOT_PATH_IN_RAM).
+ */
+
+#include "tjuh_buttons.h"
+#include "tjuh_parse.h"
+
+/* ---------------------------------------------------------------------- */
+/*  Table generation                                                      */
+/* ---------------------------------------------------------------------- */
+
+#define LUT_4(f, n)    f(n), f((n) + 1), f((n) + 2), f((n) + 3)
+#define LUT_16(f, n)   LUT_4(f, n), LUT_4(f, (n) + 4), LUT_4(f, (n) + 8), LUT_4(f, (n) + 12)
+#define LUT_64(f, n)   LUT_16(f, n), LUT_16(f, (n) + 16), LUT_16(f, (n) + 32), LUT_16(f, (n) + 48)
+#define LUT_256(f)     { LUT_64(f, 0), LUT_64(f, 64), LUT_64(f, 128), LUT_64(f, 192) }
+
+/* Raw bit `mask` of byte `v` set -> button bit `btn` */
+#define BIT(v, mask, btn)  (((v) & (mask)) ? (uint32_t)(btn) : 0u)
+
+/*
+ * Hat from four discrete direction bits. Diagonals win over single
+ * directions; opposing pairs resolve in the order up, right, down, left.
+ */
+#define HAT_FROM_DIRS(up, down, left, right)            \
+    TJUH_BTN_HAT(((up) && (right))   ? 1u :              \
+                 ((down) && (right)) ? 3u :              \
+                 ((down) && (left))  ? 5u :              \
+                 ((up) && (left))    ? 7u :              \
+                 (up)                ? 0u :              \
+                 (right)             ? 2u :              \
+                 (down)              ? 4u :              \
+                 (left)              ? 6u : TJUH_HAT_RELEASED)
+
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_zero) = {0};
+
+#define DPAD(d) (1u << TJUH_EVENT_DPAD_##d)
+
+const uint32_t TJUH_HOT_DATA(tjuh_hat_dpad)[16] = {
+    DPAD(UP),               DPAD(UP) | DPAD(RIGHT),   DPAD(RIGHT), DPAD(DOWN) | DPAD(RIGHT),
+    DPAD(DOWN),             DPAD(DOWN) | DPAD(LEFT),  DPAD(LEFT),  DPAD(UP) | DPAD(LEFT),
+};
+
+#define LAYOUT(o0, l0, o1, l1, o2, l2, o3, l3)          \
+    { .offset = { o0, o1, o2, o3 }, .lut = { l0, l1, l2, l3 } }
+
+#define LAYOUT_NONE \
+    LAYOUT(0, &s_lut_zero, 0, &s_lut_zero, 0, &s_lut_zero, 0, &s_lut_zero)
+
+static const tjuh_input_map_t TJUH_HOT_DATA(s_map_none) = {
+    .button = { LAYOUT_NONE, LAYOUT_NONE },
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Xbox 360                                                              */
+/*                                                                        */
+/*  data[2]: Up=0x01 Down=0x02 Left=0x04 Right=0x08 Start=0x10 Back=0x20  */
+/*           LS=0x40 RS=0x80                                              */
+/*  data[3]: LB=0x01 RB=0x02 Guide=0x04 A=0x10 B=0x20 X=0x40 Y=0x80       */
+/*  data[4], data[5]: analog LT/RT, pressed above half travel             */
+/* ---------------------------------------------------------------------- */
+
+/* Only the eight valid direction codes map to a hat; conflicts release */
+#define XBOX360_HAT(n)                                   \
+    ((n) == 0x01 ? 0u : (n) == 0x09 ? 1u : (n) == 0x08 ? 2u : (n) == 0x0A ? 3u : \
+     (n) == 0x02 ? 4u : (n) == 0x06 ? 5u : (n) == 0x04 ? 6u : (n) == 0x05 ? 7u : \
+     TJUH_HAT_RELEASED)
+
+#define XBOX360_DPAD(v)                                  \
+    (TJUH_BTN_HAT(XBOX360_HAT((v) & 0x0F)) |             \
+     BIT(v, 0x10, TJUH_BTN_START) | BIT(v, 0x20, TJUH_BTN_SELECT) | \
+     BIT(v, 0x40, TJUH_BTN_L3)    | BIT(v, 0x80, TJUH_BTN_R3))
+
+#define XBOX360_BUTTONS(v)                               \
+    (BIT(v, 0x01, TJUH_BTN_L1)     | BIT(v, 0x02, TJUH_BTN_R1)     | \
+     BIT(v, 0x04, TJUH_BTN_SYSTEM) | BIT(v, 0x10, TJUH_BTN_CROSS)  | \
+     BIT(v, 0x20, TJUH_BTN_CIRCLE) | BIT(v, 0x40, TJUH_BTN_SQUARE) | \
+     BIT(v, 0x80, TJUH_BTN_TRIANGLE))
+
+#define XBOX360_LT(v)  ((v) > 128 ? TJUH_BTN_L2 : 0u)
+#define XBOX360_RT(v)  ((v) > 128 ? TJUH_BTN_R2 : 0u)
+
+#if TJUH_ENABLE_XBOX360
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_xbox360_dpad)    = LUT_256(XBOX360_DPAD);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_xbox360_buttons) = LUT_256(XBOX360_BUTTONS);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_xbox360_lt)      = LUT_256(XBOX360_LT);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_xbox360_rt)      = LUT_256(XBOX360_RT);
+
+static const tjuh_input_map_t TJUH_HOT_DATA(s_map_xbox360) = {
+    .button = {
+        LAYOUT(2, &s_lut_xbox360_dpad, 3, &s_lut_xbox360_buttons,
+               4, &s_lut_xbox360_lt,   5, &s_lut_xbox360_rt),
+        LAYOUT_NONE,
+    },
+};
+#endif
+
+/* ---------------------------------------------------------------------- */
+/*  Xbox One (GIP input packet 0x20)                                      */
+/*                                                                        */
+/*  data[4]: Guide=0x02 (folded in by tjuh_parse.c) Menu=0x04 View=0x08   */
+/*           A=0x10 B=0x20 X=0x40 Y=0x80                                  */
+/*  data[5]: Up=0x01 Down=0x02 Left=0x04 Right=0x08 LB=0x10 RB=0x20       */
+/*           LS=0x40 RS=0x80                                              */
+/*  data[7], data[9]: high bits of the 10-bit LT/RT, pressed from half    */
+/* ---------------------------------------------------------------------- */
+
+#define XBOX_ONE_BUTTONS(v)                              \
+    (BIT(v, 0x02, TJUH_BTN_SYSTEM) | BIT(v, 0x04, TJUH_BTN_START)   | \
+     BIT(v, 0x08, TJUH_BTN_SELECT) | BIT(v, 0x10, TJUH_BTN_CROSS)   | \
+     BIT(v, 0x20, TJUH_BTN_CIRCLE) | BIT(v, 0x40, TJUH_BTN_SQUARE)  | \
+     BIT(v, 0x80, TJUH_BTN_TRIANGLE))
+
+/* Same direction bit order as the Xbox 360 */
+#define XBOX_ONE_DPAD(v)                                 \
+    (TJUH_BTN_HAT(XBOX360_HAT((v) & 0x0F)) |             \
+     BIT(v, 0x10, TJUH_BTN_L1) | BIT(v, 0x20, TJUH_BTN_R1) | \
+     BIT(v, 0x40, TJUH_BTN_L3) | BIT(v, 0x80, TJUH_BTN_R3))
+
+#define XBOX_ONE_LT(v)  (((v) & 0x03) >= 2 ? TJUH_BTN_L2 : 0u)
+#define XBOX_ONE_RT(v)  (((v) & 0x03) >= 2 ? TJUH_BTN_R2 : 0u)
+
+#if TJUH_ENABLE_XBOX_ONE
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_xbox_one_buttons) = LUT_256(XBOX_ONE_BUTTONS);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_xbox_one_dpad)    = LUT_256(XBOX_ONE_DPAD);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_xbox_one_lt)      = LUT_256(XBOX_ONE_LT);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_xbox_one_rt)      = LUT_256(XBOX_ONE_RT);
+
+static const tjuh_input_map_t TJUH_HOT_DATA(s_map_xbox_one) = {
+    .button = {
+        LAYOUT(4, &s_lut_xbox_one_buttons, 5, &s_lut_xbox_one_dpad,
+               7, &s_lut_xbox_one_lt,      9, &s_lut_xbox_one_rt),
+        LAYOUT_NONE,
+    },
+};
+#endif
+
+/* ---------------------------------------------------------------------- */
+/*  Generic 8-byte gamepad                                                */
+/*                                                                        */
+/*  data[5]: hat in low nibble, Triangle=0x10 Circle=0x20 Cross=0x40      */
+/*           Square=0x80                                                  */
+/*  data[6]: L1=0x01 R1=0x02 L2=0x04 R2=0x08 L3=0x10 R3=0x20              */
+/*           Select=0x40 Start=0x80                                       */
+/* ---------------------------------------------------------------------- */
+
+#define GENERIC8_HAT_FACE(v)                             \
+    (TJUH_BTN_HAT(((v) & 0x0F) > 8 ? TJUH_HAT_RELEASED : (uint32_t)((v) & 0x0F)) | \
+     BIT(v, 0x10, TJUH_BTN_TRIANGLE) | BIT(v, 0x20, TJUH_BTN_CIRCLE) | \
+     BIT(v, 0x40, TJUH_BTN_CROSS)    | BIT(v, 0x80, TJUH_BTN_SQUARE))
+
+#define GENERIC8_BUTTONS(v)                              \
+    (BIT(v, 0x01, TJUH_BTN_L1) | BIT(v, 0x02, TJUH_BTN_R1) | \
+     BIT(v, 0x04, TJUH_BTN_L2) | BIT(v, 0x08, TJUH_BTN_R2) | \
+     BIT(v, 0x10, TJUH_BTN_L3) | BIT(v, 0x20, TJUH_BTN_R3) | \
+     BIT(v, 0x40, TJUH_BTN_SELECT) | BIT(v, 0x80, TJUH_BTN_START))
+
+#if TJUH_ENABLE_GENERIC
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_generic8_hat_face) = LUT_256(GENERIC8_HAT_FACE);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_generic8_buttons)  = LUT_256(GENERIC8_BUTTONS);
+
+static const tjuh_input_map_t TJUH_HOT_DATA(s_map_generic_8byte) = {
+    .button = {
+        LAYOUT(5, &s_lut_generic8_hat_face, 6, &s_lut_generic8_buttons,
+               0, &s_lut_zero,              0, &s_lut_zero),
+        LAYOUT_NONE,
+    },
+};
+#endif
+
+/* ---------------------------------------------------------------------- */
+/*  Nintendo Switch Pro — full report (0x30)                              */
+/*                                                                        */
+/*  data[3]: Y=0x01 X=0x02 B=0x04 A=0x08 R=0x40 ZR=0x80                   */
+/*  data[4]: -=0x01 +=0x02 RS=0x04 LS=0x08 Home=0x10 Capture=0x20         */
+/*  data[5]: Down=0x01 Up=0x02 Right=0x04 Left=0x08 L=0x40 ZL=0x80        */
+/*  Face buttons map by physical position (B = south = cross).            */
+/* ---------------------------------------------------------------------- */
+
+#define SWITCH_FULL_RIGHT(v)                             \
+    (BIT(v, 0x01, TJUH_BTN_SQUARE) | BIT(v, 0x02, TJUH_BTN_TRIANGLE) | \
+     BIT(v, 0x04, TJUH_BTN_CROSS)  | BIT(v, 0x08, TJUH_BTN_CIRCLE)   | \
+     BIT(v, 0x40, TJUH_BTN_R1)     | BIT(v, 0x80, TJUH_BTN_R2))
+
+#define SWITCH_FULL_MIDDLE(v)                            \
+    (BIT(v, 0x01, TJUH_BTN_SELECT) | BIT(v, 0x02, TJUH_BTN_START)  | \
+     BIT(v, 0x04, TJUH_BTN_R3)     | BIT(v, 0x08, TJUH_BTN_L3)     | \
+     BIT(v, 0x10, TJUH_BTN_SYSTEM) | BIT(v, 0x20, TJUH_BTN_EXTRA))
+
+#define SWITCH_FULL_LEFT(v)                              \
+    (HAT_FROM_DIRS((v) & 0x02, (v) & 0x01, (v) & 0x08, (v) & 0x04) | \
+     BIT(v, 0x40, TJUH_BTN_L1) | BIT(v, 0x80, TJUH_BTN_L2))
+
+#if TJUH_ENABLE_SWITCH
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_switch_full_right)  = LUT_256(SWITCH_FULL_RIGHT);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_switch_full_middle) = LUT_256(SWITCH_FULL_MIDDLE);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_switch_full_left)   = LUT_256(SWITCH_FULL_LEFT);
+#endif
+
+
+/* ---------------------------------------------------------------------- */
+/*  Nintendo Switch — simple report (0x3F)                                */
+/*                                                                        */
+/*  data[1]: Y=0x01 B=0x02 A=0x04 X=0x08 L=0x10 R=0x20 ZL=0x40 ZR=0x80    */
+/*  data[2]: -=0x01 +=0x02 LS=0x04 RS=0x08 Home=0x10 Capture=0x20         */
+/*  data[3]: hat, values above 8 treated as released                      */
+/* ---------------------------------------------------------------------- */
+
+#define SWITCH_SIMPLE_BUTTONS(v)                         \
+    (BIT(v, 0x01, TJUH_BTN_SQUARE) | BIT(v, 0x02, TJUH_BTN_CROSS)    | \
+     BIT(v, 0x04, TJUH_BTN_CIRCLE) | BIT(v, 0x08, TJUH_BTN_TRIANGLE) | \
+     BIT(v, 0x10, TJUH_BTN_L1)     | BIT(v, 0x20, TJUH_BTN_R1)       | \
+     BIT(v, 0x40, TJUH_BTN_L2)     | BIT(v, 0x80, TJUH_BTN_R2))
+
+#define SWITCH_SIMPLE_MENU(v)                            \
+    (BIT(v, 0x01, TJUH_BTN_SELECT) | BIT(v, 0x02, TJUH_BTN_START)  | \
+     BIT(v, 0x04, TJUH_BTN_L3)     | BIT(v, 0x08, TJUH_BTN_R3)     | \
+     BIT(v, 0x10, TJUH_BTN_SYSTEM) | BIT(v, 0x20, TJUH_BTN_EXTRA))
+
+#define SWITCH_SIMPLE_HAT(v)  TJUH_BTN_HAT((v) > 8 ? TJUH_HAT_RELEASED : (uint32_t)(v))
+
+#if TJUH_ENABLE_SWITCH
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_switch_simple_buttons) =
+    LUT_256(SWITCH_SIMPLE_BUTTONS);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_switch_simple_menu) =
+    LUT_256(SWITCH_SIMPLE_MENU);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_switch_simple_hat) =
+    LUT_256(SWITCH_SIMPLE_HAT);
+
+/* Layout 0: full report, layout 1: simple report */
+static const tjuh_input_map_t TJUH_HOT_DATA(s_map_switch) = {
+    .button = {
+        LAYOUT(3, &s_lut_switch_full_right,     4, &s_lut_switch_full_middle,
+               5, &s_lut_switch_full_left,      0, &s_lut_zero),
+        LAYOUT(1, &s_lut_switch_simple_buttons, 2, &s_lut_switch_simple_menu,
+               3, &s_lut_switch_simple_hat,     0, &s_lut_zero),
+    },
+};
+#endif
+
+/* ---------------------------------------------------------------------- */
+/*  Sony DualShock 4 / DualSense, DInput-compatible                       */
+/*                                                                        */
+/*  DS4 and DInput: data[5..7], DualSense: data[8..10]                    */
+/*  byte 0: hat in low nibble (passed through), Square=0x10 Cross=0x20    */
+/*          Circle=0x40 Triangle=0x80                                     */
+/*  byte 1: L1 R1 L2 R2 Share Options L3 R3 from bit 0                    */
+/*  byte 2: PS=0x01 Touchpad=0x02; DS4 frame counter in the upper bits;   */
+/*          DualSense Mute=0x04, Edge Fn L=0x10 Fn R=0x20 paddles         */
+/*          L=0x40 R=0x80                                                 */
+/* ---------------------------------------------------------------------- */
+
+#define SONY_HAT_FACE(v)  (TJUH_BTN_HAT((v) & 0x0F) | ((uint32_t)(v) >> 4))
+#define SONY_BUTTONS(v)   ((uint32_t)(v) << TJUH_BUTTON_L1)
+
+#define DS4_SYSTEM(v)                                    \
+    (BIT(v, 0x01, TJUH_BTN_SYSTEM) | BIT(v, 0x02, TJUH_BTN_EXTRA))
+
+#define DUALSENSE_SYSTEM(v)                              \
+    (BIT(v, 0x01, TJUH_BTN_SYSTEM) | BIT(v, 0x02, TJUH_BTN_EXTRA)    | \
+     BIT(v, 0x04, TJUH_BTN_MUTE)   | BIT(v, 0x10, TJUH_BTN_FN_L)     | \
+     BIT(v, 0x20, TJUH_BTN_FN_R)   | BIT(v, 0x40, TJUH_BTN_PADDLE_L) | \
+     BIT(v, 0x80, TJUH_BTN_PADDLE_R))
+
+#if TJUH_ENABLE_SONY || TJUH_ENABLE_GENERIC
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_sony_hat_face)    = LUT_256(SONY_HAT_FACE);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_sony_buttons)     = LUT_256(SONY_BUTTONS);
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_ds4_system)       = LUT_256(DS4_SYSTEM);
+
+static const tjuh_input_map_t TJUH_HOT_DATA(s_map_ds4) = {
+    .button = {
+        LAYOUT(5, &s_lut_sony_hat_face, 6, &s_lut_sony_buttons,
+               7, &s_lut_ds4_system,    0, &s_lut_zero),
+        LAYOUT_NONE,
+    },
+};
+#endif
+
+#if TJUH_ENABLE_SONY
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_dualsense_system) = LUT_256(DUALSENSE_SYSTEM);
+
+static const tjuh_input_map_t TJUH_HOT_DATA(s_map_dualsense) = {
+    .button = {
+        LAYOUT(8,  &s_lut_sony_hat_face,    9, &s_lut_sony_buttons,
+               10, &s_lut_dualsense_system, 0, &s_lut_zero),
+        LAYOUT_NONE,
+    },
+};
+#endif
+
+/* ---------------------------------------------------------------------- */
+/*  Generic 3-byte gamepad                                                */
+/*                                                                        */
+/*  data[2]: four buttons in the low nibble, no hat                       */
+/* ---------------------------------------------------------------------- */
+
+#define GENERIC3_BUTTONS(v)  (((uint32_t)(v) & 0x0Fu) | TJUH_BTN_HAT(TJUH_HAT_RELEASED))
+
+#if TJUH_ENABLE_GENERIC
+static const tjuh_button_lut_t TJUH_HOT_DATA(s_lut_generic3_buttons) = LUT_256(GENERIC3_BUTTONS);
+
+static const tjuh_input_map_t TJUH_HOT_DATA(s_map_generic_3byte) = {
+    .button = {
+        LAYOUT(2, &s_lut_generic3_buttons, 0, &s_lut_zero,
+               0, &s_lut_zero,             0, &s_lut_zero),
+        LAYOUT_NONE,
+    },
+};
+#endif
+
+/* ---------------------------------------------------------------------- */
+/*  Lookup by parser                                                      */
+/* ---------------------------------------------------------------------- */
+
+const tjuh_input_map_t *TJUH_HOT_FUNC(tjuh_input_map_default)(uint8_t parser)
+{
+    switch (parser) {
+#if TJUH_ENABLE_SONY
+        case TJUH_PARSER_DS4:           return &s_map_ds4;
+        case TJUH_PARSER_DUALSENSE:     return &s_map_dualsense;
+#endif
+#if TJUH_ENABLE_SWITCH
+        case TJUH_PARSER_SWITCH:        return &s_map_switch;
+#endif
+#if TJUH_ENABLE_XBOX360
+        case TJUH_PARSER_XBOX360:       return &s_map_xbox360;
+#endif
+#if TJUH_ENABLE_XBOX_ONE
+        case TJUH_PARSER_XBOX_ONE:      return &s_map_xbox_one;
+#endif
+#if TJUH_ENABLE_GENERIC
+        case TJUH_PARSER_DINPUT:        return &s_map_ds4;
+        case TJUH_PARSER_GENERIC_8BYTE: return &s_map_generic_8byte;
+        case TJUH_PARSER_GENERIC_3BYTE: return &s_map_generic_3byte;
+#endif
+        default:                        return &s_map_none;
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Table-driven button mapping.
+ *
+ * Each controller's raw button bytes index precomputed 256-entry tables
+ * whose entries are already in the button word layout: bit n is
+ * tjuh_button_t n, the hat sits in the top nibble. A report's buttons are
+ * the OR of four lookups, split into tjuh_gamepad_state_t.buttons and
+ * .hat with two plain stores instead of per-bit bitfield updates.
+ */
+
+#ifndef TJUH_BUTTONS_H
+#define TJUH_BUTTONS_H
+
+#include "tjuh.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TJUH_BTN_SQUARE     TJUH_BUTTON_MASK(TJUH_BUTTON_SQUARE)
+#define TJUH_BTN_CROSS      TJUH_BUTTON_MASK(TJUH_BUTTON_CROSS)
+#define TJUH_BTN_CIRCLE     TJUH_BUTTON_MASK(TJUH_BUTTON_CIRCLE)
+#define TJUH_BTN_TRIANGLE   TJUH_BUTTON_MASK(TJUH_BUTTON_TRIANGLE)
+#define TJUH_BTN_L1         TJUH_BUTTON_MASK(TJUH_BUTTON_L1)
+#define TJUH_BTN_R1         TJUH_BUTTON_MASK(TJUH_BUTTON_R1)
+#define TJUH_BTN_L2         TJUH_BUTTON_MASK(TJUH_BUTTON_L2)
+#define TJUH_BTN_R2         TJUH_BUTTON_MASK(TJUH_BUTTON_R2)
+#define TJUH_BTN_SELECT     TJUH_BUTTON_MASK(TJUH_BUTTON_SELECT)
+#define TJUH_BTN_START      TJUH_BUTTON_MASK(TJUH_BUTTON_START)
+#define TJUH_BTN_L3         TJUH_BUTTON_MASK(TJUH_BUTTON_L3)
+#define TJUH_BTN_R3         TJUH_BUTTON_MASK(TJUH_BUTTON_R3)
+#define TJUH_BTN_SYSTEM     TJUH_BUTTON_MASK(TJUH_BUTTON_SYSTEM)
+#define TJUH_BTN_EXTRA      TJUH_BUTTON_MASK(TJUH_BUTTON_EXTRA)
+#define TJUH_BTN_MUTE       TJUH_BUTTON_MASK(TJUH_BUTTON_MUTE)
+#define TJUH_BTN_FN_L       TJUH_BUTTON_MASK(TJUH_BUTTON_FN_L)
+#define TJUH_BTN_FN_R       TJUH_BUTTON_MASK(TJUH_BUTTON_FN_R)
+#define TJUH_BTN_PADDLE_L   TJUH_BUTTON_MASK(TJUH_BUTTON_PADDLE_L)
+#define TJUH_BTN_PADDLE_R   TJUH_BUTTON_MASK(TJUH_BUTTON_PADDLE_R)
+
+/* Buttons a remap profile may move */
+#define TJUH_BTN_BUTTON_MASK  (TJUH_BUTTON_MASK(TJUH_BUTTON_COUNT) - 1u)
+
+/* Hat nibble of the button word */
+#define TJUH_BTN_HAT_SHIFT  28
+#define TJUH_BTN_HAT(n)     ((uint32_t)(n) << TJUH_BTN_HAT_SHIFT)
+
+#define TJUH_HAT_RELEASED   8u
+
+typedef uint32_t tjuh_button_lut_t[256];
+
+#define TJUH_BUTTON_MAP_SLOTS 4
+
+/* Raw report bytes feeding the button word; unused slots point at a zero
+ * table so every map costs the same four lookups */
+typedef struct {
+    uint8_t                  offset[TJUH_BUTTON_MAP_SLOTS];
+    const tjuh_button_lut_t *lut[TJUH_BUTTON_MAP_SLOTS];
+} tjuh_button_map_t;
+
+/* Report layouts per parser; only Switch has a second one (0x3F report) */
+#define TJUH_INPUT_MAP_LAYOUTS 2
+
+/*
+ * Everything a parser needs besides the axis decoding: the button tables
+ * for each report layout, and the axis transform applied to the axes
+ * word afterwards (rotate left by axis_rot, then XOR). The built-in maps carry
+ * an identity transform; a remap profile swaps in a RAM copy with its own
+ * tables and transform (tjuh_remap.c), so both paths cost the same.
+ */
+typedef struct {
+    tjuh_button_map_t button[TJUH_INPUT_MAP_LAYOUTS];
+    uint32_t          axis_xor;
+    uint8_t           axis_rot;     /* 0 or 16 (swap left/right stick) */
+} tjuh_input_map_t;
+
+/* Built-in map for a tjuh_parser_t; parsers without buttons get all-zero tables */
+const tjuh_input_map_t *tjuh_input_map_default(uint8_t parser);
+
+static inline uint32_t tjuh_buttons_lookup(const tjuh_button_map_t *map, const uint8_t *data)
+{
+    return (*map->lut[0])[data[map->offset[0]]] |
+           (*map->lut[1])[data[map->offset[1]]] |
+           (*map->lut[2])[data[map->offset[2]]] |
+           (*map->lut[3])[data[map->offset[3]]];
+}
+
+/* Hat as TJUH_EVENT_DPAD_* direction bits; 8 and above are released */
+extern const uint32_t tjuh_hat_dpad[16];
+
+/* Button word with the d-pad directions in the bits above the button ids */
+static inline uint32_t tjuh_buttons_with_dpad(const tjuh_gamepad_state_t *st)
+{
+    return st->buttons | tjuh_hat_dpad[st->hat & 0x0F];
+}
+
+/*
+ * What a report changed against the device's previous one. The pipeline
+ * works it out once per report; the modules that follow changes (events,
+ * frames, subscriptions, combos, actions) take it rather than each
+ * keeping the previous report.
+ */
+typedef struct {
+    uint32_t held;      /* tjuh_buttons_with_dpad() of the report */
+    uint32_t edges;     /* bits of `held` that differ from the previous report */
+    uint8_t  fields;    /* TJUH_FIELD_* that differ */
+} tjuh_report_delta_t;
+
+static inline void tjuh_report_delta(const tjuh_gamepad_state_t *prev,
+                                     const tjuh_gamepad_state_t *st,
+                                     tjuh_report_delta_t *delta)
+{
+    uint32_t held = tjuh_buttons_with_dpad(st);
+    uint32_t axes = st->axes ^ prev->axes;
+
+    delta->held   = held;
+    delta->edges  = held ^ tjuh_buttons_with_dpad(prev);
+    delta->fields = (uint8_t)((st->buttons != prev->buttons ? TJUH_FIELD_BUTTONS : 0) |
+                              (st->hat != prev->hat ? TJUH_FIELD_HAT : 0) |
+                              ((axes & 0x0000FFFFu) ? TJUH_FIELD_STICK_L : 0) |
+                              ((axes & 0xFFFF0000u) ? TJUH_FIELD_STICK_R : 0));
+}
+
+/* Axes word XOR mask inverting the TJUH_AXIS_* axes (same bits as
+ * TJUH_QUIRK_INVERT_*) */
+static inline uint32_t tjuh_axes_invert_mask(uint8_t axes)
+{
+    tjuh_gamepad_state_t r = {0};
+    r.x  = (axes & TJUH_AXIS_X)  ? 0xFF : 0;
+    r.y  = (axes & TJUH_AXIS_Y)  ? 0xFF : 0;
+    r.z  = (axes & TJUH_AXIS_Z)  ? 0xFF : 0;
+    r.rz = (axes & TJUH_AXIS_RZ) ? 0xFF : 0;
+    return r.axes;
+}
+
+static inline uint32_t tjuh_axes_transform(const tjuh_input_map_t *map, uint32_t axes)
+{
+    uint8_t rot = map->axis_rot & 31u;
+    return ((axes << rot) | (axes >> ((32u - rot) & 31u))) ^ map->axis_xor;
+}
+
+static inline void tjuh_buttons_store(tjuh_gamepad_state_t *st, uint32_t word)
+{
+    st->buttons = word & ~TJUH_BTN_HAT(0xF);
+    st->hat     = (uint8_t)(word >> TJUH_BTN_HAT_SHIFT);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_BUTTONS_H */
@@ -0,0 +1,208 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Button sequence (combo) matching and input history.
+ *
+ * Registering a combo compiles its steps into a matcher in the manner of
+ * Knuth-Morris-Pratt: for each step, how much of the combo is still
+ * matched when the press after it is a different button. Each device
+ * keeps one progress byte per combo, so a press advances every combo by
+ * a table lookup or two and nothing is rescanned. A combo is complete
+ * exactly when the device's latest presses are its steps; the window is
+ * then checked against the time of the first of them, kept in a small
+ * ring of press times.
+ *
+ * Edges come from the pipeline's report delta, worked out once for all
+ * the modules that follow them; a report without one costs a test and
+ * nothing else.
+ */
+
+#include "tjuh_combo.h"
+#include "tjuh_parse.h"
+#include "tjuh_buttons.h"
+#include "bsp/board.h"
+#include <string.h>
+
+#if TJUH_ENABLE_COMBOS
+
+_Static_assert(TJUH_MAX_COMBOS >= 1 && TJUH_MAX_COMBOS <= 127,
+               "TJUH_MAX_COMBOS must be 1 to 127");
+_Static_assert(TJUH_COMBO_MAX_STEPS >= 1 && TJUH_COMBO_MAX_STEPS <= 255,
+               "TJUH_COMBO_MAX_STEPS must be 1 to 255");
+_Static_assert((TJUH_INPUT_HISTORY & (TJUH_INPUT_HISTORY - 1)) == 0 &&
+               TJUH_INPUT_HISTORY <= 128,
+               "TJUH_INPUT_HISTORY must be a power of two up to 128");
+
+typedef struct {
+    uint8_t         step[TJUH_COMBO_MAX_STEPS];
+    uint8_t         fail[TJUH_COMBO_MAX_STEPS];  /* progress kept after a mismatch at step + 1 */
+    uint8_t         length;                      /* 0 = free slot */
+    uint16_t        window_ms;
+    tjuh_combo_cb_t callback;
+    void           *ctx;
+} combo_t;
+
+typedef struct {
+    uint32_t            press_ms[TJUH_COMBO_MAX_STEPS];  /* ring of the latest presses */
+    uint8_t             press_head;
+    uint8_t             history_head;
+    uint8_t             history_n;
+    uint8_t             progress[TJUH_MAX_COMBOS];       /* steps matched, per combo */
+    tjuh_button_event_t history[TJUH_INPUT_HISTORY];
+} device_t;
+
+static combo_t  s_combo[TJUH_MAX_COMBOS];
+static uint8_t  s_top;                  /* highest slot in use + 1 */
+static device_t s_dev[TJUH_MAX_DEVICES];
+
+static bool valid_step(uint8_t id)
+{
+    return id < TJUH_BUTTON_COUNT || (id >= TJUH_EVENT_DPAD_UP && id <= TJUH_EVENT_DPAD_LEFT);
+}
+
+/* Advance every combo on one press */
+static void TJUH_HOT_FUNC(press)(uint8_t dev_addr, device_t *d, uint8_t b, uint32_t now)
+{
+    d->press_ms[d->press_head] = now;
+    d->press_head = (uint8_t)((d->press_head + 1) % TJUH_COMBO_MAX_STEPS);
+
+    for (uint8_t c = 0; c < s_top; c++) {
+        const combo_t *m = &s_combo[c];
+        uint8_t k = d->progress[c];
+
+        if (!m->length)
+            continue;
+
+        while (k && m->step[k] != b)
+            k = m->fail[k - 1];
+        if (m->step[k] == b)
+            k++;
+
+        if (k == m->length) {
+            /* The latest k presses are the combo; the first of them opened it */
+            uint32_t first = d->press_ms[(d->press_head + TJUH_COMBO_MAX_STEPS - k) %
+                                         TJUH_COMBO_MAX_STEPS];
+            k = m->fail[k - 1];
+            d->progress[c] = k;
+            if (!m->window_ms || now - first <= m->window_ms)
+                m->callback(dev_addr, (int8_t)c, m->ctx);
+            continue;
+        }
+        d->progress[c] = k;
+    }
+}
+
+void tjuh_combo_reset(void)
+{
+    memset(s_combo, 0, sizeof(s_combo));
+    memset(s_dev, 0, sizeof(s_dev));
+    s_top = 0;
+}
+
+void TJUH_HOT_FUNC(tjuh_combo_update)(uint8_t dev_addr, const tjuh_report_delta_t *delta)
+{
+    uint32_t edges = delta->edges;
+
+    if (!edges || dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    device_t *d       = &s_dev[dev_addr - 1];
+    uint32_t  now     = delta->held;
+    uint32_t  time_ms = board_millis();
+
+    /* Ascending id order, as in the event queue */
+    while (edges) {
+        uint8_t b    = (uint8_t)__builtin_ctz(edges);
+        uint8_t edge = (uint8_t)((now >> b) & 1u);
+        edges &= edges - 1;
+
+        tjuh_button_event_t *e = &d->history[d->history_head];
+        d->history_head = (uint8_t)((d->history_head + 1) & (TJUH_INPUT_HISTORY - 1));
+        if (d->history_n < TJUH_INPUT_HISTORY)
+            d->history_n++;
+
+        e->time_ms  = time_ms;
+        e->dev_addr = dev_addr;
+        e->button   = b;
+        e->edge     = edge;
+
+        if (edge == TJUH_EDGE_PRESS)
+            press(dev_addr, d, b, time_ms);
+    }
+}
+
+void tjuh_combo_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    memset(&s_dev[dev_addr - 1], 0, sizeof(s_dev[dev_addr - 1]));
+}
+
+int8_t tjuh_combo_register(const tjuh_combo_t *combo)
+{
+    if (!combo || !combo->callback || !combo->steps || combo->length == 0 ||
+        combo->length > TJUH_COMBO_MAX_STEPS)
+        return -1;
+
+    for (uint8_t i = 0; i < combo->length; i++) {
+        if (!valid_step(combo->steps[i]))
+            return -1;
+    }
+
+    uint8_t c = 0;
+    while (c < TJUH_MAX_COMBOS && s_combo[c].length)
+        c++;
+    if (c == TJUH_MAX_COMBOS)
+        return -1;
+
+    combo_t *m = &s_combo[c];
+    memcpy(m->step, combo->steps, combo->length);
+
+    /* fail[i]: longest proper prefix of step[0..i] that is also its suffix */
+    m->fail[0] = 0;
+    for (uint8_t i = 1, k = 0; i < combo->length; i++) {
+        while (k && m->step[i] != m->step[k])
+            k = m->fail[k - 1];
+        if (m->step[i] == m->step[k])
+            k++;
+        m->fail[i] = k;
+    }
+
+    m->window_ms = combo->window_ms;
+    m->callback  = combo->callback;
+    m->ctx       = combo->ctx;
+    m->length    = combo->length;
+
+    for (uint8_t i = 0; i < TJUH_MAX_DEVICES; i++)
+        s_dev[i].progress[c] = 0;
+    if (c >= s_top)
+        s_top = (uint8_t)(c + 1);
+
+    return (int8_t)c;
+}
+
+bool tjuh_combo_unregister(int8_t handle)
+{
+    if (handle < 0 || handle >= TJUH_MAX_COMBOS || !s_combo[handle].length)
+        return false;
+
+    s_combo[handle].length = 0;
+    while (s_top && !s_combo[s_top - 1].length)
+        s_top--;
+    return true;
+}
+
+uint8_t tjuh_get_input_history(uint8_t dev_addr, tjuh_button_event_t *events, uint8_t max)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return 0;
+
+    const device_t *d = &s_dev[dev_addr - 1];
+    uint8_t n = d->history_n < max ? d->history_n : max;
+
+    for (uint8_t i = 0; i < n; i++)
+        events[i] = d->history[(d->history_head - 1 - i) & (TJUH_INPUT_HISTORY - 1)];
+    return n;
+}
+
+#endif /* TJUH_ENABLE_COMBOS */
@@ -0,0 +1,48 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal combo matcher interface.
+ */
+
+#ifndef TJUH_COMBO_H
+#define TJUH_COMBO_H
+
+#include "tjuh.h"
+#include "tjuh_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if TJUH_ENABLE_COMBOS
+
+/** Drop all combos and every device's history. */
+void tjuh_combo_reset(void);
+
+/** Record a report's edges and advance the combos on its presses. */
+void tjuh_combo_update(uint8_t dev_addr, const tjuh_report_delta_t *delta);
+
+/** The device is gone; clear its history and progress. */
+void tjuh_combo_release(uint8_t dev_addr);
+
+#else
+
+static inline void tjuh_combo_reset(void) {}
+
+static inline void tjuh_combo_update(uint8_t dev_addr, const tjuh_report_delta_t *delta)
+{
+    (void)dev_addr;
+    (void)delta;
+}
+
+static inline void tjuh_combo_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+#endif /* TJUH_ENABLE_COMBOS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_COMBO_H */
@@ -0,0 +1,173 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Stick and trigger conditioning.
+ *
+ * A profile is compiled into tables once, when it is set, so a report
+ * costs the same whatever the curve and limits:
+ *
+ *   stick    the deflection from the calibrated centre is scaled by a
+ *            gain looked up by its radius (output radius / input radius,
+ *            Q15). Deadzone, outer limit and curve all live in the gain,
+ *            and scaling both axes by it keeps the stick's direction.
+ *            Past the outer limit the gain stays as it is there, so a
+ *            square-gated stick still reaches its corners.
+ *   trigger  the travel is looked up directly, in Q16 kept modulo 2^16
+ *            so that full travel (1 << 16) fits next to the rest.
+ *
+ * Both tables are sampled every 256 units and interpolated between
+ * samples. The radius comes from a fixed 16-round integer square root;
+ * there are no divisions or floating point on the report path. With
+ * TJUH_SWAR_WORDS the two axes of a stick are handled as one word
+ * (tjuh_swar.h), otherwise axis by axis. The report path is inline in
+ * tjuh_condition.h, for the report pipeline to fuse.
+ */
+
+#include "tjuh_condition.h"
+#include "tjuh_parse.h"
+#include "tjuh_pipeline.h"
+#include <string.h>
+
+#if TJUH_ENABLE_CONDITION
+
+#define STICK_FULL          0x8000   /* full deflection from the centre */
+#define GAIN_SHIFT          TJUH_CONDITION_GAIN_SHIFT
+#define GAIN_MAX            0xFFFF
+
+static tjuh_condition_t s_condition[TJUH_MAX_DEVICES];
+static bool             s_condition_set[TJUH_MAX_DEVICES];
+
+/* ---------------------------------------------------------------------- */
+/*  Profile compilation                                                   */
+/* ---------------------------------------------------------------------- */
+
+/* Position of v between lo and hi, Q16 (0 to 1 << 16) */
+static uint32_t travel(uint32_t v, uint32_t lo, uint32_t hi)
+{
+    if (v <= lo)
+        return 0;
+    if (v >= hi)
+        return UINT32_C(1) << 16;
+    return (uint32_t)(((uint64_t)(v - lo) << 16) / (hi - lo));
+}
+
+/* Response curve over Q16 travel */
+static uint32_t shape(uint8_t curve, uint32_t t)
+{
+    switch (curve) {
+        case TJUH_CURVE_QUADRATIC:
+            return (uint32_t)(((uint64_t)t * t) >> 16);
+
+        case TJUH_CURVE_CUBIC:
+            return (uint32_t)(((((uint64_t)t * t) >> 16) * t) >> 16);
+
+        default:
+            return t;
+    }
+}
+
+static void compile_stick(tjuh_condition_stick_t *s, const tjuh_stick_condition_t *p)
+{
+    uint32_t outer = p->outer ? p->outer : STICK_FULL;
+
+    s->center    = ((uint32_t)p->center[0] & 0xFFFFu) | ((uint32_t)p->center[1] << 16);
+    s->deadzone  = p->deadzone;
+
+    for (uint32_t i = 0; i < TJUH_CONDITION_GAIN_ENTRIES; i++) {
+        /* Radius 0 takes the gain just off centre */
+        uint32_t r    = i ? i << 8 : 1;
+
+        if (r > outer)
+            r = outer;
+        uint64_t out  = shape(p->curve, travel(r, p->deadzone, outer));   /* Q16 of STICK_FULL */
+        uint64_t gain = ((out << (GAIN_SHIFT - 1)) + r / 2) / r;
+
+        s->gain[i] = (uint16_t)(gain > GAIN_MAX ? GAIN_MAX : gain);
+    }
+}
+
+static void compile_trigger(tjuh_condition_trigger_t *t, const tjuh_trigger_condition_t *p)
+{
+    uint32_t outer = p->outer ? p->outer : 0xFFFF;
+
+    t->deadzone = p->deadzone;
+    t->outer    = (uint16_t)outer;
+
+    for (uint32_t i = 0; i < TJUH_CONDITION_LEVEL_ENTRIES; i++)
+        t->level[i] = (uint16_t)shape(p->curve, travel(i << 8, p->deadzone, outer));
+}
+
+static bool profile_valid(const tjuh_condition_profile_t *p)
+{
+    for (uint8_t i = 0; i < 2; i++) {
+        const tjuh_stick_condition_t   *s = &p->stick[i];
+        const tjuh_trigger_condition_t *t = &p->trigger[i];
+        uint32_t stick_outer   = s->outer ? s->outer : STICK_FULL;
+        uint32_t trigger_outer = t->outer ? t->outer : 0xFFFF;
+
+        /* Below half travel the gain at the outer limit would not fit Q15 */
+        if (stick_outer < STICK_FULL / 2 || stick_outer > STICK_FULL || s->deadzone >= stick_outer)
+            return false;
+        /* Neighbouring trigger levels must differ by less than full travel */
+        if (t->deadzone + 0x100u > trigger_outer)
+            return false;
+        if (s->curve >= TJUH_CURVE_COUNT || t->curve >= TJUH_CURVE_COUNT)
+            return false;
+    }
+    return true;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Device profiles                                                       */
+/* ---------------------------------------------------------------------- */
+
+const tjuh_condition_t *tjuh_condition_get(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES || !s_condition_set[dev_addr - 1])
+        return NULL;
+    return &s_condition[dev_addr - 1];
+}
+
+void tjuh_condition_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+    s_condition_set[dev_addr - 1] = false;
+}
+
+void tjuh_condition_profile_init(tjuh_condition_profile_t *profile)
+{
+    memset(profile, 0, sizeof(*profile));
+
+    for (uint8_t i = 0; i < 2; i++) {
+        profile->stick[i].outer   = STICK_FULL;
+        profile->stick[i].curve   = TJUH_CURVE_LINEAR;
+        profile->trigger[i].outer = 0xFFFF;
+        profile->trigger[i].curve = TJUH_CURVE_LINEAR;
+    }
+}
+
+bool tjuh_set_condition_profile(uint8_t dev_addr, const tjuh_condition_profile_t *profile)
+{
+    uint16_t vid;
+    uint16_t pid;
+
+    if (!tjuh_parse_get_vid_pid(dev_addr, &vid, &pid))
+        return false;
+
+    if (profile) {
+        if (!profile_valid(profile))
+            return false;
+
+        tjuh_condition_t *c = &s_condition[dev_addr - 1];
+        for (uint8_t i = 0; i < 2; i++) {
+            compile_stick(&c->stick[i], &profile->stick[i]);
+            compile_trigger(&c->trigger[i], &profile->trigger[i]);
+        }
+    }
+
+    s_condition_set[dev_addr - 1] = (profile != NULL);
+    tjuh_pipeline_rebuild(dev_addr);
+    return true;
+}
+
+#endif /* TJUH_ENABLE_CONDITION */
@@ -0,0 +1,191 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal stick and trigger conditioning interface.
+ */
+
+#ifndef TJUH_CONDITION_H
+#define TJUH_CONDITION_H
+
+#include "tjuh.h"
+#include "tjuh_swar.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Compiled tables of one device's profile */
+typedef struct tjuh_condition tjuh_condition_t;
+
+#if TJUH_ENABLE_CONDITION
+
+#define TJUH_CONDITION_GAIN_SHIFT     15
+#define TJUH_CONDITION_MAX_RADIUS     46341   /* |(-0x8000, -0x8000)|, rounded up */
+#define TJUH_CONDITION_GAIN_ENTRIES   ((TJUH_CONDITION_MAX_RADIUS >> 8) + 2)
+#define TJUH_CONDITION_LEVEL_ENTRIES  257
+
+typedef struct {
+    uint32_t center;        /* int16 offsets from 0x8000, x and y lanes */
+    uint32_t deadzone;
+    uint16_t gain[TJUH_CONDITION_GAIN_ENTRIES];     /* Q15, by radius / 256 */
+} tjuh_condition_stick_t;
+
+typedef struct {
+    uint16_t deadzone;
+    uint16_t outer;
+    uint16_t level[TJUH_CONDITION_LEVEL_ENTRIES];   /* Q16 mod 2^16, by input / 256 */
+} tjuh_condition_trigger_t;
+
+struct tjuh_condition {
+    tjuh_condition_stick_t   stick[2];
+    tjuh_condition_trigger_t trigger[2];
+};
+
+/** The device's compiled profile, NULL if it has none. */
+const tjuh_condition_t *tjuh_condition_get(uint8_t dev_addr);
+
+/* Bit-by-bit square root, always 16 rounds */
+static inline uint32_t tjuh_condition_isqrt(uint32_t v)
+{
+    uint32_t root = 0;
+
+    for (uint32_t bit = UINT32_C(1) << 30; bit; bit >>= 2) {
+        uint32_t trial = root + bit;
+
+        root >>= 1;
+        if (v >= trial) {
+            v    -= trial;
+            root += bit;
+        }
+    }
+    return root;
+}
+
+/* A stick's deflection scaled by the gain at its radius, back to
+ * unsigned lanes */
+static inline uint32_t tjuh_condition_scale(const tjuh_condition_stick_t *s, int32_t dx,
+                                            int32_t dy, uint32_t r)
+{
+    if (r <= s->deadzone)
+        return 0x80008000u;
+
+    const uint16_t *g = &s->gain[r >> 8];
+    int32_t gain = g[0] + ((((int32_t)g[1] - g[0]) * (int32_t)(r & 0xFF)) >> 8);
+
+    /* |d| <= 0x8000 and gain <= 0xFFFF: the products fit */
+    int32_t round = 1 << (TJUH_CONDITION_GAIN_SHIFT - 1);
+
+    return tjuh_swar_pack_sat16((dx * gain + round) >> TJUH_CONDITION_GAIN_SHIFT,
+                                (dy * gain + round) >> TJUH_CONDITION_GAIN_SHIFT) ^ 0x80008000u;
+}
+
+#if TJUH_SWAR_WORDS
+
+/* One stick, both axes in the lanes of `pair` */
+static inline uint32_t tjuh_condition_stick(const tjuh_condition_stick_t *s, uint32_t pair)
+{
+    uint32_t d = tjuh_swar_deflection(pair, s->center);
+
+    return tjuh_condition_scale(s, (int16_t)d, (int32_t)d >> 16,
+                                tjuh_condition_isqrt(tjuh_swar_norm2(d)));
+}
+
+#else
+
+static inline int32_t tjuh_condition_sat16(int32_t v)
+{
+    return v < INT16_MIN ? INT16_MIN : v > INT16_MAX ? INT16_MAX : v;
+}
+
+/* One stick, axis by axis; the result in the lanes of a word */
+static inline uint32_t tjuh_condition_stick(const tjuh_condition_stick_t *s, uint16_t x,
+                                            uint16_t y)
+{
+    int32_t dx = tjuh_condition_sat16((int32_t)x - 0x8000 - (int16_t)s->center);
+    int32_t dy = tjuh_condition_sat16((int32_t)y - 0x8000 - ((int32_t)s->center >> 16));
+
+    return tjuh_condition_scale(s, dx, dy,
+                                tjuh_condition_isqrt((uint32_t)(dx * dx) + (uint32_t)(dy * dy)));
+}
+
+#endif /* TJUH_SWAR_WORDS */
+
+static inline uint16_t tjuh_condition_trigger(const tjuh_condition_trigger_t *t, uint16_t v)
+{
+    if (v <= t->deadzone)
+        return 0;
+    if (v >= t->outer)
+        return 0xFFFF;
+
+    /* The step is taken modulo 2^16 too, so it is right next to full
+     * travel; v < outer keeps the result itself below it */
+    const uint16_t *l = &t->level[v >> 8];
+    uint32_t step = (uint16_t)(l[1] - l[0]);
+    return (uint16_t)(l[0] + ((step * (v & 0xFFu)) >> 8));
+}
+
+/**
+ * Condition a parsed report in place: sticks and triggers of the extended
+ * report, and the state's axes from the conditioned sticks. The extended
+ * report must have been filled by the parser.
+ */
+static inline void tjuh_condition_apply(const tjuh_condition_t *c, tjuh_gamepad_state_t *st,
+                                        tjuh_gamepad_ext_t *ext)
+{
+#if TJUH_SWAR_WORDS
+    uint32_t pair[2];
+    tjuh_swar_load_sticks(ext, pair);
+
+    pair[0] = tjuh_condition_stick(&c->stick[0], pair[0]);
+    pair[1] = tjuh_condition_stick(&c->stick[1], pair[1]);
+    tjuh_swar_store_sticks(ext, pair);
+    st->axes = tjuh_swar_narrow(pair[0], pair[1]);
+#else
+    uint32_t xy  = tjuh_condition_stick(&c->stick[0], ext->x, ext->y);
+    uint32_t zrz = tjuh_condition_stick(&c->stick[1], ext->z, ext->rz);
+
+    ext->x  = (uint16_t)xy;
+    ext->y  = (uint16_t)(xy >> 16);
+    ext->z  = (uint16_t)zrz;
+    ext->rz = (uint16_t)(zrz >> 16);
+    st->x   = (uint8_t)(ext->x >> 8);
+    st->y   = (uint8_t)(ext->y >> 8);
+    st->z   = (uint8_t)(ext->z >> 8);
+    st->rz  = (uint8_t)(ext->rz >> 8);
+#endif
+
+    ext->l2 = tjuh_condition_trigger(&c->trigger[0], ext->l2);
+    ext->r2 = tjuh_condition_trigger(&c->trigger[1], ext->r2);
+}
+
+/** Forget the device's profile. */
+void tjuh_condition_release(uint8_t dev_addr);
+
+#else
+
+static inline const tjuh_condition_t *tjuh_condition_get(uint8_t dev_addr)
+{
+    (void)dev_addr;
+    return NULL;
+}
+
+static inline void tjuh_condition_apply(const tjuh_condition_t *c, tjuh_gamepad_state_t *st,
+                                        tjuh_gamepad_ext_t *ext)
+{
+    (void)c;
+    (void)st;
+    (void)ext;
+}
+
+static inline void tjuh_condition_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+#endif /* TJUH_ENABLE_CONDITION */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_CONDITION_H */
@@ -0,0 +1,115 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Button press/release events.
+ *
+ * Each device keeps the button word as last queued, with the d-pad
+ * folded in as four more bits. One XOR against the report's word, which
+ * the pipeline has already worked out, gives every edge at once; a
+ * report with no change costs that and nothing else. The queued word is
+ * kept apart from the previous report because of the rule below. Edges
+ * go into one queue shared by all devices, which the application drains
+ * at its own pace, so a tap between two polls still leaves its press
+ * and its release.
+ *
+ * An edge that finds the queue full is not recorded as seen: the bit
+ * stays as it was and the edge is queued with a later report. Presses and
+ * releases of a button therefore always alternate in the queue.
+ */
+
+#include "tjuh_events.h"
+#include "tjuh_parse.h"
+#include "tjuh_buttons.h"
+#include "bsp/board.h"
+#include <string.h>
+
+#if TJUH_ENABLE_EVENTS
+
+_Static_assert((TJUH_EVENT_QUEUE_SIZE & (TJUH_EVENT_QUEUE_SIZE - 1)) == 0 &&
+               TJUH_EVENT_QUEUE_SIZE <= 0x8000,
+               "TJUH_EVENT_QUEUE_SIZE must be a power of two up to 32768");
+
+static uint32_t s_held[TJUH_MAX_DEVICES];       /* as last queued */
+
+static tjuh_button_event_t s_queue[TJUH_EVENT_QUEUE_SIZE];
+static volatile uint16_t   s_head;              /* free-running, written by the producer */
+static volatile uint16_t   s_tail;              /* free-running, written by the consumer */
+static uint32_t            s_deferred;
+
+/* Queue the edges in ascending id order; returns those that fit */
+static uint32_t TJUH_HOT_FUNC(push_edges)(uint8_t dev_addr, uint32_t edges, uint32_t now)
+{
+    uint32_t time_ms = board_millis();
+    uint32_t queued  = 0;
+    uint16_t head    = s_head;
+
+    while (edges) {
+        if ((uint16_t)(head - s_tail) == TJUH_EVENT_QUEUE_SIZE) {
+            s_deferred += (uint32_t)__builtin_popcount(edges);
+            break;
+        }
+
+        uint8_t b = (uint8_t)__builtin_ctz(edges);
+        tjuh_button_event_t *e = &s_queue[head & (TJUH_EVENT_QUEUE_SIZE - 1)];
+        e->time_ms  = time_ms;
+        e->dev_addr = dev_addr;
+        e->button   = b;
+        e->edge     = (uint8_t)((now >> b) & 1u);
+
+        queued |= edges & -edges;
+        edges  &= edges - 1;
+        head++;
+    }
+
+    s_head = head;
+    return queued;
+}
+
+void tjuh_events_reset(void)
+{
+    memset(s_held, 0, sizeof(s_held));
+    s_head     = 0;
+    s_tail     = 0;
+    s_deferred = 0;
+}
+
+void TJUH_HOT_FUNC(tjuh_events_update)(uint8_t dev_addr, const tjuh_report_delta_t *delta)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    uint32_t *held  = &s_held[dev_addr - 1];
+    uint32_t  edges = delta->held ^ *held;
+
+    if (edges)
+        *held ^= push_edges(dev_addr, edges, delta->held);
+}
+
+void tjuh_events_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    /* No later report to retry with: releases that do not fit are lost */
+    if (s_held[dev_addr - 1])
+        push_edges(dev_addr, s_held[dev_addr - 1], 0);
+    s_held[dev_addr - 1] = 0;
+}
+
+bool tjuh_get_button_event(tjuh_button_event_t *event)
+{
+    uint16_t tail = s_tail;
+
+    if (tail == s_head)
+        return false;
+
+    *event = s_queue[tail & (TJUH_EVENT_QUEUE_SIZE - 1)];
+    s_tail = (uint16_t)(tail + 1);
+    return true;
+}
+
+uint32_t tjuh_get_button_events_deferred(void)
+{
+    return s_deferred;
+}
+
+#endif /* TJUH_ENABLE_EVENTS */
@@ -0,0 +1,48 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal button event queue interface.
+ */
+
+#ifndef TJUH_EVENTS_H
+#define TJUH_EVENTS_H
+
+#include "tjuh.h"
+#include "tjuh_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if TJUH_ENABLE_EVENTS
+
+/** Empty the queue and forget all held buttons. */
+void tjuh_events_reset(void);
+
+/** Queue the presses and releases since the device's previous report. */
+void tjuh_events_update(uint8_t dev_addr, const tjuh_report_delta_t *delta);
+
+/** Queue releases for the device's held buttons and forget them. */
+void tjuh_events_release(uint8_t dev_addr);
+
+#else
+
+static inline void tjuh_events_reset(void) {}
+
+static inline void tjuh_events_update(uint8_t dev_addr, const tjuh_report_delta_t *delta)
+{
+    (void)dev_addr;
+    (void)delta;
+}
+
+static inline void tjuh_events_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+#endif /* TJUH_ENABLE_EVENTS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_EVENTS_H */
@@ -0,0 +1,77 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Frame-synchronised sampling.
+ *
+ * A game loop reading input once per frame sees only the last of the
+ * several reports a pad sends meanwhile, and misses taps that fall
+ * between frames. Instead each report is folded into the device's frame
+ * as it arrives: the state is kept, every button seen down is ORed into
+ * `pressed`, and every button that went up since the previous report
+ * into `released`, both from the pipeline's report delta. That is three
+ * word operations per report, and a sample copies the frames out and
+ * restarts them, whatever the number of reports in between.
+ */
+
+#include "tjuh_frame.h"
+#include "tjuh_parse.h"
+#include "tjuh_buttons.h"
+#include <string.h>
+
+#if TJUH_ENABLE_FRAMES
+
+static tjuh_frame_t s_frame[TJUH_MAX_DEVICES];
+
+void tjuh_frame_reset(void)
+{
+    memset(s_frame, 0, sizeof(s_frame));
+    for (uint8_t i = 0; i < TJUH_MAX_DEVICES; i++)
+        s_frame[i].state.hat = TJUH_HAT_RELEASED;
+}
+
+void TJUH_HOT_FUNC(tjuh_frame_update)(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                                      const tjuh_report_delta_t *delta)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    tjuh_frame_t *f = &s_frame[dev_addr - 1];
+
+    f->state      = *st;
+    f->pressed   |= delta->held;
+    f->released  |= delta->edges & ~delta->held;
+    f->reports++;
+    f->connected  = true;
+}
+
+void tjuh_frame_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    tjuh_frame_t *f = &s_frame[dev_addr - 1];
+
+    f->released      |= tjuh_buttons_with_dpad(&f->state);
+    f->state.buttons  = 0;
+    f->state.hat      = TJUH_HAT_RELEASED;
+    f->connected      = false;
+}
+
+uint8_t tjuh_sample_frame(tjuh_frame_t frame[TJUH_MAX_DEVICES])
+{
+    uint8_t connected = 0;
+
+    for (uint8_t i = 0; i < TJUH_MAX_DEVICES; i++) {
+        tjuh_frame_t *f = &s_frame[i];
+
+        frame[i]  = *f;
+        connected += f->connected;
+
+        /* Still held: pressed in the next frame as well */
+        f->pressed  = tjuh_buttons_with_dpad(&f->state);
+        f->released = 0;
+        f->reports  = 0;
+    }
+    return connected;
+}
+
+#endif /* TJUH_ENABLE_FRAMES */
@@ -0,0 +1,51 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal frame sampling interface.
+ */
+
+#ifndef TJUH_FRAME_H
+#define TJUH_FRAME_H
+
+#include "tjuh.h"
+#include "tjuh_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if TJUH_ENABLE_FRAMES
+
+/** Forget all devices' input. */
+void tjuh_frame_reset(void);
+
+/** Fold a report into the device's current frame. */
+void tjuh_frame_update(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                       const tjuh_report_delta_t *delta);
+
+/** Release the device's held buttons and mark it disconnected. */
+void tjuh_frame_release(uint8_t dev_addr);
+
+#else
+
+static inline void tjuh_frame_reset(void) {}
+
+static inline void tjuh_frame_update(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                                     const tjuh_report_delta_t *delta)
+{
+    (void)dev_addr;
+    (void)st;
+    (void)delta;
+}
+
+static inline void tjuh_frame_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+#endif /* TJUH_ENABLE_FRAMES */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_FRAME_H */
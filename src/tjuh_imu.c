@@ -0,0 +1,488 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * IMU sample extraction, calibration and orientation fusion.
+ *
+ * Raw gyro and accelerometer words are read straight from the DS4,
+ * DualSense and Switch Pro input reports, rotated into the common frame
+ * of tjuh_imu_sample_t and scaled with a per-axis bias and Q12 gain,
+ * from the Sony calibration feature reports or nominal values. Each
+ * sample then drives a Mahony complementary filter: the gyro rate is
+ * integrated into a quaternion while the measured gravity direction
+ * pulls the tilt back.
+ *
+ * Everything is integer. The quaternion is Q30 so that slow rotations
+ * at a 1 kHz report rate still move it; its products use 32x32->64-bit
+ * multiplies, 16 per sample. The gravity error only needs Q14 and uses
+ * 32-bit multiplies.
+ */
+
+#include "tjuh_imu.h"
+#include "tjuh_parse.h"
+#include <string.h>
+
+#if TJUH_ENABLE_IMU
+
+/* ---------------------------------------------------------------------- */
+/*  Fixed point                                                           */
+/* ---------------------------------------------------------------------- */
+
+#define Q30_ONE (INT32_C(1) << 30)
+
+/*
+ * Half the rotation of one gyro LSB over one microsecond, Q46:
+ * (pi / 180 / TJUH_IMU_GYRO_LSB_PER_DPS) * 1e-6 / 2 * 2^46.
+ */
+#define HALF_ANGLE_Q46   38380
+
+/* Gyro LSB per rad/s: 180 / pi * TJUH_IMU_GYRO_LSB_PER_DPS */
+#define GYRO_LSB_PER_RAD 917
+
+/* Longest step integrated; longer gaps are treated as this long */
+#define MAX_DT_US        50000u
+
+/*
+ * Gravity only corrects the tilt while |accel| is within 0.75..1.25 g,
+ * squared in Q24: the pad is not being shaken, and one Newton step
+ * gives 1/|accel| to within 10 %.
+ */
+#define ACCEL_MIN_SQ     9437184u
+#define ACCEL_MAX_SQ     26214400u
+
+static inline int32_t mul_q30(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b) >> 30);
+}
+
+static inline int16_t sat16(int32_t v)
+{
+    if (v > INT16_MAX)
+        return INT16_MAX;
+    if (v < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t)v;
+}
+
+static uint32_t isqrt32(uint32_t v)
+{
+    uint32_t root = 0;
+    uint32_t bit  = UINT32_C(1) << 30;
+
+    while (bit > v)
+        bit >>= 2;
+
+    while (bit) {
+        if (v >= root + bit) {
+            v    -= root + bit;
+            root  = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Orientation fusion                                                    */
+/* ---------------------------------------------------------------------- */
+
+void tjuh_imu_fusion_reset(tjuh_imu_fusion_t *f)
+{
+    f->q[0]   = Q30_ONE;
+    f->q[1]   = 0;
+    f->q[2]   = 0;
+    f->q[3]   = 0;
+    f->seeded = false;
+}
+
+/*
+ * Tilt from one accelerometer reading: the shortest rotation taking the
+ * measured up direction u onto +y, (1 + u.y, u x y) normalised. Only
+ * runs once per reset, so the 64-bit divides do not matter.
+ */
+static void seed_from_gravity(tjuh_imu_fusion_t *f, const int16_t accel[3])
+{
+    int32_t ax = accel[0] >> 2;
+    int32_t ay = accel[1] >> 2;
+    int32_t az = accel[2] >> 2;
+    int32_t mag = (int32_t)isqrt32((uint32_t)(ax * ax + ay * ay + az * az));
+
+    tjuh_imu_fusion_reset(f);
+    f->seeded = true;
+
+    if (mag == 0)
+        return;
+
+    int32_t c[4] = { mag + ay, -az, 0, ax };
+
+    /* Upside down: any half turn about a horizontal axis */
+    if (c[0] < mag / 64) {
+        f->q[0] = 0;
+        f->q[1] = Q30_ONE;
+        return;
+    }
+
+    int32_t norm = (int32_t)isqrt32((uint32_t)(c[0] * c[0] + c[1] * c[1] + c[3] * c[3]));
+    for (int i = 0; i < 4; i++)
+        f->q[i] = (int32_t)(((int64_t)c[i] << 30) / norm);
+}
+
+/* Gravity error (Q28 radians) to a gyro correction in Q8 LSB */
+static inline int32_t gravity_correction(int32_t err)
+{
+    return ((((err >> 14) * GYRO_LSB_PER_RAD) >> 6) * TJUH_IMU_FUSION_GAIN) >> 8;
+}
+
+void tjuh_imu_fuse(tjuh_imu_fusion_t *f, const int16_t gyro[3], const int16_t accel[3],
+                   uint32_t dt_us)
+{
+    if (!f->seeded) {
+        seed_from_gravity(f, accel);
+        return;
+    }
+
+    if (dt_us > MAX_DT_US)
+        dt_us = MAX_DT_US;
+
+    /* Body rate, Q8 gyro LSB */
+    int32_t w8[3] = {
+        (int32_t)gyro[0] * 256,
+        (int32_t)gyro[1] * 256,
+        (int32_t)gyro[2] * 256,
+    };
+
+    int32_t ax = accel[0];
+    int32_t ay = accel[1];
+    int32_t az = accel[2];
+    uint32_t a_sq = (uint32_t)(ax * ax) + (uint32_t)(ay * ay) + (uint32_t)(az * az);
+
+    if (a_sq > ACCEL_MIN_SQ && a_sq < ACCEL_MAX_SQ) {
+        /* 1/|a| in Q12: one Newton step from 1 g */
+        int32_t inv = (int32_t)((UINT32_C(3) << 24) - a_sq) >> 13;
+        ax = (ax * inv) >> 10;
+        ay = (ay * inv) >> 10;
+        az = (az * inv) >> 10;
+
+        /* Up as the estimate sees it, in the controller frame (Q14) */
+        int32_t qw = f->q[0] >> 16;
+        int32_t qx = f->q[1] >> 16;
+        int32_t qy = f->q[2] >> 16;
+        int32_t qz = f->q[3] >> 16;
+        int32_t vx = (qx * qy + qw * qz) >> 13;
+        int32_t vy = (qw * qw - qx * qx + qy * qy - qz * qz) >> 14;
+        int32_t vz = (qy * qz - qw * qx) >> 13;
+
+        /* Rotating by measured x estimated closes the gap */
+        w8[0] += gravity_correction(ay * vz - az * vy);
+        w8[1] += gravity_correction(az * vx - ax * vz);
+        w8[2] += gravity_correction(ax * vy - ay * vx);
+    }
+
+    /* Half-angle step, Q30 radians */
+    int32_t kdt = (int32_t)((dt_us * HALF_ANGLE_Q46) >> 8);
+    int32_t hx  = (int32_t)(((int64_t)w8[0] * kdt) >> 16);
+    int32_t hy  = (int32_t)(((int64_t)w8[1] * kdt) >> 16);
+    int32_t hz  = (int32_t)(((int64_t)w8[2] * kdt) >> 16);
+
+    /* q += q * (0, h) */
+    int32_t qw = f->q[0];
+    int32_t qx = f->q[1];
+    int32_t qy = f->q[2];
+    int32_t qz = f->q[3];
+
+    f->q[0] = qw - mul_q30(qx, hx) - mul_q30(qy, hy) - mul_q30(qz, hz);
+    f->q[1] = qx + mul_q30(qw, hx) + mul_q30(qy, hz) - mul_q30(qz, hy);
+    f->q[2] = qy + mul_q30(qw, hy) - mul_q30(qx, hz) + mul_q30(qz, hx);
+    f->q[3] = qz + mul_q30(qw, hz) + mul_q30(qx, hy) - mul_q30(qy, hx);
+
+    /* Renormalise: q *= (3 - |q|^2) / 2, one Newton step per sample */
+    uint32_t n = 0;
+    for (int i = 0; i < 4; i++) {
+        int32_t s = f->q[i] >> 15;
+        n += (uint32_t)(s * s);
+    }
+
+    int32_t d = (int32_t)((uint32_t)Q30_ONE - n) / 2;
+    for (int i = 0; i < 4; i++)
+        f->q[i] += mul_q30(f->q[i], d);
+}
+
+void tjuh_imu_fusion_quat(const tjuh_imu_fusion_t *f, int16_t quat[4])
+{
+    for (int i = 0; i < 4; i++)
+        quat[i] = sat16((f->q[i] + (1 << 15)) >> 16);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Calibration                                                           */
+/* ---------------------------------------------------------------------- */
+
+/* Per axis in frame order: gyro x, y, z, then accel x, y, z */
+typedef struct {
+    int16_t bias[6];    /* raw */
+    int32_t gain[6];    /* Q12, raw - bias -> tjuh_imu_sample_t units */
+} imu_calib_t;
+
+/* Nominal: Sony ~16 LSB per deg/s and 8192 per g */
+static const imu_calib_t s_calib_sony = {
+    .bias = { 0, 0, 0, 0, 0, 0 },
+    .gain = { 4096, 4096, 4096, 2048, 2048, 2048 },
+};
+
+/* Nominal: Switch Pro 0.061 deg/s and 0.244 mg per LSB */
+static const imu_calib_t s_calib_switch = {
+    .bias = { 0, 0, 0, 0, 0, 0 },
+    .gain = { 4000, 4000, 4000, 4096, 4096, 4096 },
+};
+
+/* Calibrated gains outside 1/16..8 are rejected as garbage */
+#define GAIN_MIN 256
+#define GAIN_MAX 32768
+
+static inline int32_t le16s(const uint8_t *p)
+{
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static const imu_calib_t *calib_default(uint8_t parser)
+{
+    return (parser == TJUH_PARSER_SWITCH) ? &s_calib_switch : &s_calib_sony;
+}
+
+/*
+ * DS4 feature report 0x02 and DualSense 0x05, USB layout: gyro bias
+ * pitch/yaw/roll, then the readings at +/- the reference rate for each
+ * axis, the reference rate itself (+ and -), and the accelerometer
+ * readings at +/- 1 g per axis. Axes the report gets wrong keep their
+ * nominal gain.
+ */
+static void calib_from_sony(imu_calib_t *c, const uint8_t *buf)
+{
+    int32_t speed_2x = le16s(&buf[19]) + le16s(&buf[21]);
+
+    for (int i = 0; i < 3; i++) {
+        int32_t plus  = le16s(&buf[7 + 4 * i]);
+        int32_t minus = le16s(&buf[9 + 4 * i]);
+        int32_t span  = plus - minus;
+
+        if (span <= 0 || speed_2x <= 0 || speed_2x >= 32768)
+            continue;
+
+        int32_t gain = (int32_t)(((int64_t)speed_2x * TJUH_IMU_GYRO_LSB_PER_DPS << 12) / span);
+        if (gain >= GAIN_MIN && gain <= GAIN_MAX) {
+            c->bias[i] = (int16_t)le16s(&buf[1 + 2 * i]);
+            c->gain[i] = gain;
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        int32_t plus     = le16s(&buf[23 + 4 * i]);
+        int32_t minus    = le16s(&buf[25 + 4 * i]);
+        int32_t range_2g = plus - minus;
+
+        if (range_2g <= 0)
+            continue;
+
+        int32_t gain = (2 * TJUH_IMU_ACCEL_LSB_PER_G << 12) / range_2g;
+        if (gain >= GAIN_MIN && gain <= GAIN_MAX) {
+            c->bias[3 + i] = (int16_t)(plus - range_2g / 2);
+            c->gain[3 + i] = gain;
+        }
+    }
+}
+
+static inline int16_t calib_apply(const imu_calib_t *c, int axis, int32_t raw)
+{
+    return sat16(((raw - c->bias[axis]) * c->gain[axis]) >> 12);
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Devices                                                               */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    imu_calib_t       calib;
+    uint8_t           calib_parser;  /* parser `calib` was read for, AUTO = none */
+    uint8_t           parser;        /* parser of the samples being fused */
+    bool              have_ts;
+    uint32_t          last_ts;       /* controller timestamp of the last report */
+    uint32_t          time_us;
+    tjuh_imu_fusion_t fusion;
+} imu_device_t;
+
+static imu_device_t s_imu[TJUH_MAX_DEVICES];
+
+static void device_restart(imu_device_t *d)
+{
+    d->have_ts = false;
+    tjuh_imu_fusion_reset(&d->fusion);
+}
+
+uint8_t tjuh_imu_calib_report(uint8_t parser, uint16_t *len)
+{
+    switch (parser) {
+#if TJUH_ENABLE_SONY
+        case TJUH_PARSER_DS4:
+            *len = 37;
+            return 0x02;
+        case TJUH_PARSER_DUALSENSE:
+            *len = 41;
+            return 0x05;
+#endif
+        default:
+            (void)len;
+            return 0;
+    }
+}
+
+void tjuh_imu_set_calib(uint8_t dev_addr, uint8_t parser, const uint8_t *buf, uint16_t len)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    imu_device_t *d = &s_imu[dev_addr - 1];
+    uint16_t want = 0;
+    uint8_t id = tjuh_imu_calib_report(parser, &want);
+
+    d->calib        = *calib_default(parser);
+    d->calib_parser = parser;
+    if (buf && id && len >= 35 && buf[0] == id)
+        calib_from_sony(&d->calib, buf);
+
+    /* The scale changed under the estimate */
+    device_restart(d);
+}
+
+void tjuh_imu_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    memset(&s_imu[dev_addr - 1], 0, sizeof(s_imu[0]));
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Extraction                                                            */
+/* ---------------------------------------------------------------------- */
+
+uint8_t tjuh_imu_process(uint8_t dev_addr, uint8_t parser, const uint8_t *data, uint16_t len,
+                         tjuh_imu_sample_t out[TJUH_IMU_MAX_SAMPLES])
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return 0;
+
+    imu_device_t *d = &s_imu[dev_addr - 1];
+    int32_t  raw[TJUH_IMU_MAX_SAMPLES][6];
+    uint32_t step_us;
+    uint32_t ts = 0;
+    uint8_t  n;
+
+    if (parser != d->parser) {
+        d->parser = parser;
+        device_restart(d);
+    }
+
+    switch (parser) {
+#if TJUH_ENABLE_SONY
+        case TJUH_PARSER_DS4:
+            /* Timestamp in 16/3 us units, gyro pitch/yaw/roll, accel x/y/z */
+            if (len < 25 || data[0] != 0x01)
+                return 0;
+            ts = (uint32_t)(data[10] | (data[11] << 8));
+            step_us = (uint16_t)(ts - d->last_ts) * 16u / 3u;
+            for (int i = 0; i < 6; i++)
+                raw[0][i] = le16s(&data[13 + 2 * i]);
+            n = 1;
+            break;
+
+        case TJUH_PARSER_DUALSENSE:
+            /* Same, with a 32-bit timestamp in 1/3 us units after the IMU */
+            if (len < 32 || data[0] != 0x01)
+                return 0;
+            ts = le32(&data[28]);
+            step_us = (ts - d->last_ts) / 3u;
+            for (int i = 0; i < 6; i++)
+                raw[0][i] = le16s(&data[16 + 2 * i]);
+            n = 1;
+            break;
+#endif
+
+#if TJUH_ENABLE_SWITCH
+        case TJUH_PARSER_SWITCH:
+            /*
+             * Full report only: three samples 5 ms apart, each accel then
+             * gyro. The sensor's x points away from the player, y left and
+             * z up: x = -y', y = z', z = -x'.
+             */
+            if (len < 49 || data[0] != 0x30)
+                return 0;
+            for (int s = 0; s < 3; s++) {
+                const uint8_t *p = &data[13 + 12 * s];
+                raw[s][3] = -le16s(&p[2]);
+                raw[s][4] =  le16s(&p[4]);
+                raw[s][5] = -le16s(&p[0]);
+                raw[s][0] = -le16s(&p[8]);
+                raw[s][1] =  le16s(&p[10]);
+                raw[s][2] = -le16s(&p[6]);
+            }
+            step_us = 5000;
+            n = 3;
+            break;
+#endif
+
+        default:
+            (void)data;
+            (void)len;
+            return 0;
+    }
+
+    if (!d->have_ts)
+        step_us = 0;
+    d->have_ts = true;
+    d->last_ts = ts;
+
+    const imu_calib_t *c = (d->calib_parser == parser) ? &d->calib : calib_default(parser);
+
+    for (uint8_t s = 0; s < n; s++) {
+        tjuh_imu_sample_t *o = &out[s];
+
+        for (int i = 0; i < 3; i++) {
+            o->gyro[i]  = calib_apply(c, i, raw[s][i]);
+            o->accel[i] = calib_apply(c, 3 + i, raw[s][3 + i]);
+        }
+
+        d->time_us     += step_us;
+        o->timestamp_us = d->time_us;
+
+        tjuh_imu_fuse(&d->fusion, o->gyro, o->accel, step_us);
+        tjuh_imu_fusion_quat(&d->fusion, o->quat);
+
+        /* Samples after the first of a Switch report are 5 ms apart */
+        step_us = 5000;
+    }
+    return n;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Public API                                                            */
+/* ---------------------------------------------------------------------- */
+
+bool tjuh_imu_reset_orientation(uint8_t dev_addr)
+{
+    uint16_t vid;
+    uint16_t pid;
+
+    if (!tjuh_parse_get_vid_pid(dev_addr, &vid, &pid))
+        return false;
+
+    tjuh_imu_fusion_reset(&s_imu[dev_addr - 1].fusion);
+    return true;
+}
+
+#endif /* TJUH_ENABLE_IMU */
@@ -0,0 +1,100 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal IMU extraction and orientation fusion interface.
+ */
+
+#ifndef TJUH_IMU_H
+#define TJUH_IMU_H
+
+#include "tjuh.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TJUH_IMU_MAX_SAMPLES 3   /* Switch Pro: three samples per report */
+
+#if TJUH_ENABLE_IMU
+
+/* Orientation estimate, w, x, y, z in Q30 */
+typedef struct {
+    int32_t q[4];
+    bool    seeded;     /* false: set the tilt from the next sample */
+} tjuh_imu_fusion_t;
+
+void tjuh_imu_fusion_reset(tjuh_imu_fusion_t *f);
+
+/**
+ * Advance the estimate by one calibrated sample taken dt_us after the
+ * previous one. The first sample after a reset only sets the tilt.
+ */
+void tjuh_imu_fuse(tjuh_imu_fusion_t *f, const int16_t gyro[3], const int16_t accel[3],
+                   uint32_t dt_us);
+
+/** The estimate as TJUH_IMU_QUAT_ONE-scaled w, x, y, z. */
+void tjuh_imu_fusion_quat(const tjuh_imu_fusion_t *f, int16_t quat[4]);
+
+/**
+ * Feature report holding the factory calibration of controllers parsed
+ * with `parser`.
+ *
+ * @return the report ID, 0 if there is none to fetch.
+ */
+uint8_t tjuh_imu_calib_report(uint8_t parser, uint16_t *len);
+
+/** Apply a calibration feature report; buf = NULL keeps the defaults. */
+void tjuh_imu_set_calib(uint8_t dev_addr, uint8_t parser, const uint8_t *buf, uint16_t len);
+
+/**
+ * Extract, calibrate and fuse the IMU samples of one report.
+ *
+ * @return the number of samples written to out, 0 if the parser or
+ *         report carries none.
+ */
+uint8_t tjuh_imu_process(uint8_t dev_addr, uint8_t parser, const uint8_t *data, uint16_t len,
+                         tjuh_imu_sample_t out[TJUH_IMU_MAX_SAMPLES]);
+
+/** Forget the device's calibration and orientation. */
+void tjuh_imu_release(uint8_t dev_addr);
+
+#else
+
+static inline uint8_t tjuh_imu_calib_report(uint8_t parser, uint16_t *len)
+{
+    (void)parser;
+    (void)len;
+    return 0;
+}
+
+static inline void tjuh_imu_set_calib(uint8_t dev_addr, uint8_t parser,
+                                      const uint8_t *buf, uint16_t len)
+{
+    (void)dev_addr;
+    (void)parser;
+    (void)buf;
+    (void)len;
+}
+
+static inline uint8_t tjuh_imu_process(uint8_t dev_addr, uint8_t parser, const uint8_t *data,
+                                       uint16_t len, tjuh_imu_sample_t out[TJUH_IMU_MAX_SAMPLES])
+{
+    (void)dev_addr;
+    (void)parser;
+    (void)data;
+    (void)len;
+    (void)out;
+    return 0;
+}
+
+static inline void tjuh_imu_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+#endif /* TJUH_ENABLE_IMU */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_IMU_H */
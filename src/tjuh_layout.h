@@ -0,0 +1,128 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Declarative report layouts.
+ *
+ * A controller's sticks and analog triggers are described by a table of
+ * fields, one X-macro row each:
+ *
+ *   F(field, byte, shift, bits, sign, invert)
+ *
+ *   field   X, Y, Z, RZ: stick, 8-bit state axis and 16-bit extended axis
+ *           L2, R2:      trigger, extended report only
+ *   byte    report byte holding the field's least significant bit
+ *   shift   position of that bit within the byte
+ *   bits    1 (digital: 0 or full scale) or 8..16, little-endian
+ *   sign    1 if two's complement (centred on 0), 0 if unsigned
+ *   invert  1 to flip the axis (e.g. Y up to Y down)
+ *
+ * Every value is widened to 16 bits by repeating its top bits into the
+ * bottom (0x80 -> 0x8080, 12-bit 0x800 -> 0x8008) for the extended
+ * report; the state axis is the high byte of that. TJUH_LAYOUT_PARSER()
+ * expands a table into a parser with one straight-line statement per
+ * row. All columns are constants, so each row folds to the loads, shifts
+ * and masks a hand-written parser would use. Fields missing from a table
+ * are left untouched; buttons go through the lookup tables of
+ * tjuh_buttons.c.
+ */
+
+#ifndef TJUH_LAYOUT_H
+#define TJUH_LAYOUT_H
+
+#include "tjuh_parse.h"
+#include "tjuh_buttons.h"
+
+#define TJUH_LAYOUT_MASK(bits)  ((1u << (bits)) - 1u)
+
+/* Two bytes at most: a field spans into the next byte only if it must */
+#define TJUH_LAYOUT_VALID(shift, bits) \
+    ((shift) < 8 && ((bits) == 1 || ((bits) >= 8 && (bits) + (shift) <= 16)))
+
+#define TJUH_LAYOUT_RAW(d, byte, shift, bits)                                         \
+    ((((shift) + (bits) <= 8 ? (uint32_t)(d)[byte]                                      \
+                             : (uint32_t)(d)[byte] | ((uint32_t)(d)[(byte) + 1] << 8)) \
+      >> (shift)) & TJUH_LAYOUT_MASK(bits))
+
+/* Signed fields to offset binary: flip the sign bit */
+#define TJUH_LAYOUT_UNSIGNED(v, bits, sign) \
+    ((v) ^ ((sign) ? 1u << ((bits) - 1) : 0u))
+
+#define TJUH_LAYOUT_WIDEN(v, bits)                                       \
+    ((bits) == 1 ? 0u - (v)                                              \
+                 : ((v) << (16 - (bits))) | ((v) >> ((2 * (bits) - 16) & 15)))
+
+/* Extended report value: widened, then inverted */
+#define TJUH_LAYOUT_EXT_VALUE(v, bits, invert) \
+    ((uint16_t)(TJUH_LAYOUT_WIDEN(v, bits) ^ ((invert) ? 0xFFFFu : 0u)))
+
+/* State axis: the high byte of the extended value, straight from the field */
+#define TJUH_LAYOUT_STATE_VALUE(v, bits, invert)                                 \
+    ((uint8_t)(((bits) == 1 ? 0u - (v) : (v) >> (((bits) - 8) & 15)) ^           \
+               ((invert) ? 0xFFu : 0u)))
+
+/* Per field: member name, and whether it is a stick or a trigger */
+#define TJUH_LAYOUT_MEMBER_X    x
+#define TJUH_LAYOUT_MEMBER_Y    y
+#define TJUH_LAYOUT_MEMBER_Z    z
+#define TJUH_LAYOUT_MEMBER_RZ   rz
+#define TJUH_LAYOUT_MEMBER_L2   l2
+#define TJUH_LAYOUT_MEMBER_R2   r2
+
+#define TJUH_LAYOUT_STICK_X(code)     code
+#define TJUH_LAYOUT_STICK_Y(code)     code
+#define TJUH_LAYOUT_STICK_Z(code)     code
+#define TJUH_LAYOUT_STICK_RZ(code)    code
+#define TJUH_LAYOUT_STICK_L2(code)
+#define TJUH_LAYOUT_STICK_R2(code)
+
+#define TJUH_LAYOUT_TRIGGER_X(code)
+#define TJUH_LAYOUT_TRIGGER_Y(code)
+#define TJUH_LAYOUT_TRIGGER_Z(code)
+#define TJUH_LAYOUT_TRIGGER_RZ(code)
+#define TJUH_LAYOUT_TRIGGER_L2(code)  code
+#define TJUH_LAYOUT_TRIGGER_R2(code)  code
+
+/*
+ * Row expansions. Fields are read into locals before anything is stored:
+ * as far as the compiler knows the report may alias the outputs, and a
+ * store between two reads would force the second to be reloaded.
+ */
+#define TJUH_LAYOUT_CHECK(field, byte, shift, bits, sign, invert) \
+    _Static_assert(TJUH_LAYOUT_VALID(shift, bits), "bad layout field " #field);
+
+#define TJUH_LAYOUT_READ(field, byte, shift, bits, sign)                                 \
+    const uint32_t layout_##field =                                                        \
+        TJUH_LAYOUT_UNSIGNED(TJUH_LAYOUT_RAW(data, byte, shift, bits), bits, sign);
+
+#define TJUH_LAYOUT_READ_STICK(field, byte, shift, bits, sign, invert) \
+    TJUH_LAYOUT_STICK_##field(TJUH_LAYOUT_READ(field, byte, shift, bits, sign))
+
+#define TJUH_LAYOUT_READ_TRIGGER(field, byte, shift, bits, sign, invert) \
+    TJUH_LAYOUT_TRIGGER_##field(TJUH_LAYOUT_READ(field, byte, shift, bits, sign))
+
+#define TJUH_LAYOUT_STORE_STATE(field, byte, shift, bits, sign, invert)        \
+    TJUH_LAYOUT_STICK_##field(st->TJUH_LAYOUT_MEMBER_##field =                   \
+                                  TJUH_LAYOUT_STATE_VALUE(layout_##field, bits, invert);)
+
+#define TJUH_LAYOUT_STORE_EXT(field, byte, shift, bits, sign, invert) \
+    ext->TJUH_LAYOUT_MEMBER_##field = TJUH_LAYOUT_EXT_VALUE(layout_##field, bits, invert);
+
+/*
+ * Parser for one report layout: buttons from the input map's `buttons`
+ * layout, the sticks of LAYOUT into the state and, if wanted, every field
+ * of it into the extended report. The caller checks the report length.
+ */
+#define TJUH_LAYOUT_PARSER(name, buttons, LAYOUT)                                        \
+    static void TJUH_HOT_FUNC(name)(const tjuh_input_map_t *map, const uint8_t *data,      \
+                                    tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)     \
+    {                                                                                    \
+        LAYOUT(TJUH_LAYOUT_CHECK)                                                        \
+        LAYOUT(TJUH_LAYOUT_READ_STICK)                                                   \
+        tjuh_buttons_store(st, tjuh_buttons_lookup(&map->button[buttons], data));        \
+        LAYOUT(TJUH_LAYOUT_STORE_STATE)                                                  \
+        if (ext) {                                                                       \
+            LAYOUT(TJUH_LAYOUT_READ_TRIGGER)                                             \
+            LAYOUT(TJUH_LAYOUT_STORE_EXT)                                                \
+        }                                                                                \
+    }
+
+#endif /* TJUH_LAYOUT_H */
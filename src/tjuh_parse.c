@@ -4,11 +4,17 @@
  *
  * Dispatch priority:
  *   1. Hint-based (Xbox One, Switch Pro — set during enumeration)
- *   2. VID/PID-based (Sony, Nintendo)
- *   3. Endpoint size heuristic (Xbox 360, generic HID)
+ *   2. Quirk table parser (looked up once per device, see tjuh_quirks.c),
+ *      or HID report descriptor fingerprint / top-level usage
+ *   3. Endpoint size heuristic (generic HID)
  */
 
 #include "tjuh_parse.h"
+#include "tjuh_quirks.h"
+#include "tjuh_buttons.h"
+#include "tjuh_layout.h"
+#include "tjuh_remap.h"
+#include "tjuh_swar.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -17,40 +23,95 @@
 #endif
 
 /* ---------------------------------------------------------------------- */
-/*  Known vendor/product IDs                                              */
+/*  Device registry                                                       */
 /* ---------------------------------------------------------------------- */
 
-#define VID_SONY              0x054C
-#define PID_DS4_V1            0x05C4   /* CUH-ZCT1 */
-#define PID_DS4_V2            0x09CC   /* CUH-ZCT2 */
-#define PID_DUALSENSE         0x0CE6
-#define PID_DUALSENSE_EDGE    0x0DF2
-
-#define VID_NINTENDO          0x057E
-#define PID_SWITCH_PRO        0x2009
-#define PID_JOYCON_L          0x2006
-#define PID_JOYCON_R          0x2007
+typedef enum {
+    CLASSIFY_FIXED = 0,    /* parser from the quirk table or report descriptor */
+    CLASSIFY_PROBATION,    /* heuristic, evaluated per report */
+    CLASSIFY_COMMITTED,    /* heuristic result locked in */
+} classify_state_t;
 
-/* ---------------------------------------------------------------------- */
-/*  Device registry                                                       */
-/* ---------------------------------------------------------------------- */
+#define GIP_INPUT_LEN 18   /* GIP input packet up to the right stick */
 
 typedef struct {
     uint8_t  dev_addr;
+    uint8_t  parser;    /* tjuh_parser_t, cached from the quirk table */
     uint16_t vid;
     uint16_t pid;
+    uint8_t  flags;     /* TJUH_QUIRK_* */
+    bool     desc_pending;  /* waiting for the HID report descriptor */
+    uint32_t axis_xor;      /* quirk axis inversion as an axes_bytes mask */
+    const tjuh_input_map_t *map;  /* tables for `parser`, remapped or built-in */
+
+    /* Heuristic classification (see "Probationary classification") */
+    uint8_t  classify;      /* classify_state_t */
+    uint8_t  candidate;     /* tjuh_parser_t under evaluation */
+    uint8_t  votes;         /* agreeing reports, or rejects once committed */
+    uint16_t reclassify;    /* candidate flips + committed parser reverts */
+    bool     rebind;        /* parser changed by a report; map built in tjuh_parse_task() */
+
+#if TJUH_ENABLE_XBOX_ONE
+    /* Xbox One: last input packet, guide state folded in (see "Xbox One") */
+    uint8_t  gip_input[GIP_INPUT_LEN];
+#endif
 } tjuh_device_entry_t;
 
 static tjuh_device_entry_t s_devices[TJUH_MAX_DEVICES];
 
+tjuh_parse_fn_t tjuh_parse_settled[TJUH_MAX_DEVICES];
+
+static void device_route(tjuh_device_entry_t *dev);
+
+static void device_set_parser(tjuh_device_entry_t *dev, uint8_t parser)
+{
+    dev->parser = parser;
+    /* Single pointer store: a report sees the old map or the new one */
+    dev->map    = tjuh_remap_bind(dev->dev_addr, parser);
+}
+
+/*
+ * For a parser committed or reverted from the report path: building the
+ * remap tables (up to five 256-entry tables) waits for tjuh_parse_task().
+ * Until then the built-in map is used and the profile applied to the
+ * parsed report (tjuh_remap_late()).
+ */
+static void device_defer_parser(tjuh_device_entry_t *dev, uint8_t parser)
+{
+    dev->parser = parser;
+    dev->map    = tjuh_input_map_default(parser);
+    dev->rebind = true;
+}
+
+static void device_set_flags(tjuh_device_entry_t *dev, uint8_t flags)
+{
+    dev->flags    = flags;
+    dev->axis_xor = tjuh_axes_invert_mask(flags & TJUH_QUIRK_INVERT_MASK);
+}
+
 bool tjuh_parse_init_device(uint8_t dev_addr, uint16_t vid, uint16_t pid)
 {
     if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
         return false;
 
+    const tjuh_quirk_t *q = tjuh_quirk_lookup(vid, pid);
+
     s_devices[dev_addr - 1].dev_addr = dev_addr;
     s_devices[dev_addr - 1].vid = vid;
     s_devices[dev_addr - 1].pid = pid;
+    device_set_parser(&s_devices[dev_addr - 1], q ? q->parser : TJUH_PARSER_AUTO);
+    device_set_flags(&s_devices[dev_addr - 1], q ? q->flags : 0);
+    s_devices[dev_addr - 1].desc_pending = (q == NULL || q->parser == TJUH_PARSER_AUTO);
+    s_devices[dev_addr - 1].classify  = (q == NULL || q->parser == TJUH_PARSER_AUTO)
+                                        ? CLASSIFY_PROBATION : CLASSIFY_FIXED;
+    s_devices[dev_addr - 1].candidate  = TJUH_PARSER_AUTO;
+    s_devices[dev_addr - 1].votes      = 0;
+    s_devices[dev_addr - 1].reclassify = 0;
+    s_devices[dev_addr - 1].rebind     = false;
+#if TJUH_ENABLE_XBOX_ONE
+    memset(s_devices[dev_addr - 1].gip_input, 0, GIP_INPUT_LEN);
+#endif
+    device_route(&s_devices[dev_addr - 1]);
     return true;
 }
 
@@ -59,10 +120,36 @@ bool tjuh_parse_free_device(uint8_t dev_addr)
     if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
         return false;
 
+    tjuh_remap_release(dev_addr);
     memset(&s_devices[dev_addr - 1], 0, sizeof(s_devices[0]));
+    tjuh_parse_settled[dev_addr - 1] = NULL;
+    return true;
+}
+
+bool tjuh_parse_rebind_map(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES || s_devices[dev_addr - 1].vid == 0)
+        return false;
+
+    device_set_parser(&s_devices[dev_addr - 1], s_devices[dev_addr - 1].parser);
+    s_devices[dev_addr - 1].rebind = false;
+    device_route(&s_devices[dev_addr - 1]);
     return true;
 }
 
+void tjuh_parse_task(void)
+{
+    for (uint8_t i = 0; i < TJUH_MAX_DEVICES; i++) {
+        tjuh_device_entry_t *dev = &s_devices[i];
+        if (!dev->rebind)
+            continue;
+
+        device_set_parser(dev, dev->parser);
+        dev->rebind = false;
+        device_route(dev);
+    }
+}
+
 bool tjuh_parse_get_vid_pid(uint8_t dev_addr, uint16_t *vid, uint16_t *pid)
 {
     if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
@@ -76,22 +163,221 @@ bool tjuh_parse_get_vid_pid(uint8_t dev_addr, uint16_t *vid, uint16_t *pid)
     return true;
 }
 
-static bool get_vid_pid(uint8_t dev_addr, uint16_t *vid, uint16_t *pid)
+/* ---------------------------------------------------------------------- */
+/*  HID report descriptor classification                                  */
+/* ---------------------------------------------------------------------- */
+
+#define HID_USAGE_PAGE_DESKTOP      0x01
+#define HID_USAGE_DESKTOP_MOUSE     0x02
+#define HID_USAGE_DESKTOP_JOYSTICK  0x04
+#define HID_USAGE_DESKTOP_GAMEPAD   0x05
+#define HID_USAGE_DESKTOP_KEYBOARD  0x06
+#define HID_USAGE_DESKTOP_KEYPAD    0x07
+#define HID_USAGE_DESKTOP_MULTIAXIS 0x08
+
+typedef enum {
+    DESC_USAGE_UNKNOWN = 0,
+    DESC_USAGE_GAMEPAD,
+    DESC_USAGE_OTHER,      /* keyboard, mouse, keypad only */
+} desc_usage_t;
+
+/*
+ * Walk the short items and classify the top-level application collections.
+ * Any joystick/gamepad/multi-axis collection wins; a descriptor made only
+ * of keyboard/mouse/keypad collections is not a gamepad.
+ */
+static desc_usage_t scan_top_level_usage(const uint8_t *desc, uint16_t len)
+{
+    uint16_t usage_page = 0;
+    uint16_t usage      = 0;
+    uint16_t usage_in   = 0;    /* page of `usage`: its own if extended, else the global one */
+    bool     usage_ext  = false;
+    uint8_t  depth      = 0;
+    bool     gamepad    = false;
+    bool     other      = false;
+    uint16_t i          = 0;
+
+    while (i < len) {
+        uint8_t prefix = desc[i];
+
+        if (prefix == 0xFE) {                      /* long item: skip */
+            if (i + 2 >= len)
+                break;
+            i = (uint16_t)(i + 3 + desc[i + 1]);
+            continue;
+        }
+
+        uint8_t size = prefix & 0x03;
+        if (size == 3)
+            size = 4;
+        if (i + 1 + size > len)
+            break;
+
+        uint32_t data = 0;
+        for (uint8_t b = 0; b < size; b++)
+            data |= (uint32_t)desc[i + 1 + b] << (8 * b);
+
+        switch (prefix & 0xFC) {
+            case 0x04:                             /* Usage Page (global) */
+                usage_page = (uint16_t)data;
+                break;
+            case 0x08:                             /* Usage (local) */
+                /* An extended usage carries its page; the global one is untouched */
+                usage     = (uint16_t)data;
+                usage_ext = (size == 4);
+                usage_in  = (uint16_t)(data >> 16);
+                break;
+            case 0xA0:                             /* Collection */
+                if (!usage_ext)
+                    usage_in = usage_page;
+                if (depth == 0 && data == 0x01 && usage_in == HID_USAGE_PAGE_DESKTOP) {
+                    switch (usage) {
+                        case HID_USAGE_DESKTOP_JOYSTICK:
+                        case HID_USAGE_DESKTOP_GAMEPAD:
+                        case HID_USAGE_DESKTOP_MULTIAXIS:
+                            gamepad = true;
+                            break;
+                        case HID_USAGE_DESKTOP_MOUSE:
+                        case HID_USAGE_DESKTOP_KEYBOARD:
+                        case HID_USAGE_DESKTOP_KEYPAD:
+                            other = true;
+                            break;
+                        default:
+                            break;
+                    }
+                }
+                depth++;
+                usage     = 0;
+                usage_ext = false;
+                break;
+            case 0xC0:                             /* End Collection */
+                if (depth)
+                    depth--;
+                break;
+            case 0x80:                             /* Input/Output/Feature */
+            case 0x90:
+            case 0xB0:
+                usage     = 0;
+                usage_ext = false;
+                break;
+            default:
+                break;
+        }
+
+        i = (uint16_t)(i + 1 + size);
+    }
+
+    if (gamepad)
+        return DESC_USAGE_GAMEPAD;
+    return other ? DESC_USAGE_OTHER : DESC_USAGE_UNKNOWN;
+}
+
+bool tjuh_parse_needs_report_desc(uint8_t dev_addr)
 {
-    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES) {
-        *vid = 0;
-        *pid = 0;
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
         return false;
+
+    return s_devices[dev_addr - 1].desc_pending;
+}
+
+uint32_t tjuh_parse_set_report_desc(uint8_t dev_addr, const uint8_t *desc,
+                                    uint16_t len, uint16_t total_len)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return 0;
+
+    tjuh_device_entry_t *dev = &s_devices[dev_addr - 1];
+    dev->desc_pending = false;
+
+    if (!desc || len == 0) {
+        device_route(dev);
+        return 0;
     }
-    *vid = s_devices[dev_addr - 1].vid;
-    *pid = s_devices[dev_addr - 1].pid;
-    return (*vid != 0);
+
+    uint32_t hash = tjuh_fnv1a(TJUH_FNV1A_INIT, desc, len);
+
+    const tjuh_fingerprint_t *f = tjuh_fingerprint_lookup(hash, total_len);
+    if (f) {
+        device_set_parser(dev, f->parser);
+        device_set_flags(dev, f->flags);
+        dev->classify = CLASSIFY_FIXED;
+    } else if (scan_top_level_usage(desc, len) == DESC_USAGE_OTHER) {
+        device_set_parser(dev, TJUH_PARSER_IGNORE);
+        dev->classify = CLASSIFY_FIXED;
+    }
+
+    device_route(dev);
+    return hash;
 }
 
 /* ---------------------------------------------------------------------- */
 /*  Axis conversion helpers                                               */
 /* ---------------------------------------------------------------------- */
 
+/*
+ * Quirk inversion and map transform, as applied to the compact axes: the
+ * byte masks widen to the 16-bit lanes of the two stick words, and the
+ * 16-bit rotate that swaps the sticks in the axes word swaps the words.
+ * With TJUH_SWAR_WORDS off each lane takes its byte of the mask instead.
+ */
+#if !TJUH_SWAR_WORDS
+static inline uint16_t lane_mask(uint32_t axes_mask, unsigned axis)
+{
+    return (uint16_t)(((axes_mask >> (8 * axis)) & 0xFFu) * 0x0101u);
+}
+#endif
+
+static void TJUH_HOT_FUNC(ext_axes_transform)(const tjuh_input_map_t *map, uint32_t quirk_xor,
+                                              tjuh_gamepad_ext_t *ext)
+{
+    if (!quirk_xor && !map->axis_xor && !map->axis_rot)
+        return;
+
+#if TJUH_SWAR_WORDS
+    uint32_t pair[2];
+    tjuh_swar_load_sticks(ext, pair);
+
+    uint32_t xy  = pair[0] ^ tjuh_swar_widen_mask(quirk_xor, 0);
+    uint32_t zrz = pair[1] ^ tjuh_swar_widen_mask(quirk_xor, 1);
+
+    if (map->axis_rot) {
+        uint32_t t = xy;
+        xy  = zrz;
+        zrz = t;
+    }
+
+    pair[0] = xy  ^ tjuh_swar_widen_mask(map->axis_xor, 0);
+    pair[1] = zrz ^ tjuh_swar_widen_mask(map->axis_xor, 1);
+    tjuh_swar_store_sticks(ext, pair);
+#else
+    uint16_t x  = ext->x  ^ lane_mask(quirk_xor, 0);
+    uint16_t y  = ext->y  ^ lane_mask(quirk_xor, 1);
+    uint16_t z  = ext->z  ^ lane_mask(quirk_xor, 2);
+    uint16_t rz = ext->rz ^ lane_mask(quirk_xor, 3);
+
+    if (map->axis_rot) {
+        uint16_t tx = x, ty = y;
+        x  = z;
+        y  = rz;
+        z  = tx;
+        rz = ty;
+    }
+
+    ext->x  = x  ^ lane_mask(map->axis_xor, 0);
+    ext->y  = y  ^ lane_mask(map->axis_xor, 1);
+    ext->z  = z  ^ lane_mask(map->axis_xor, 2);
+    ext->rz = rz ^ lane_mask(map->axis_xor, 3);
+#endif
+}
+
+#if TJUH_PARSE_REFERENCE
+
+/*
+ * Hand-coded axis decoding of the parsers before the layout tables
+ * (tjuh_layout.h), kept as the *_hand parsers the generated ones are
+ * checked and timed against.
+ */
+
 static inline uint8_t int16_to_uint8(int val)
 {
     val += 0x8000;
@@ -104,10 +390,89 @@ static inline uint8_t int16_to_uint8_inv(int val)
     return (uint8_t)(0xFF - (val >> 8));
 }
 
+/* 8-bit axis or trigger to the extended 16-bit range (0x80 -> 0x8080) */
+static inline uint16_t uint8_to_uint16(uint8_t val)
+{
+    return (uint16_t)(val * 0x0101u);
+}
+
+/* Extended axes for controllers that only report 8-bit sticks */
+static inline void ext_axes_from_state(const tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    ext->x  = uint8_to_uint16(st->x);
+    ext->y  = uint8_to_uint16(st->y);
+    ext->z  = uint8_to_uint16(st->z);
+    ext->rz = uint8_to_uint16(st->rz);
+}
+
+static inline uint16_t digital_trigger(bool pressed)
+{
+    return pressed ? 0xFFFF : 0;
+}
+
+#if TJUH_ENABLE_XBOX360 || TJUH_ENABLE_XBOX_ONE
+
+/* Four signed 16-bit little-endian sticks, Y up, starting at `axes` */
+static void parse_xinput_axes(const uint8_t *axes, tjuh_gamepad_state_t *st,
+                              tjuh_gamepad_ext_t *ext)
+{
+    int16_t x_val;
+    int16_t y_val;
+    int16_t z_val;
+    int16_t rz_val;
+    memcpy(&x_val,  axes + 0, sizeof(int16_t));
+    memcpy(&y_val,  axes + 2, sizeof(int16_t));
+    memcpy(&z_val,  axes + 4, sizeof(int16_t));
+    memcpy(&rz_val, axes + 6, sizeof(int16_t));
+
+    st->x  = int16_to_uint8(x_val);
+    st->y  = int16_to_uint8_inv(y_val);
+    st->z  = int16_to_uint8(z_val);
+    st->rz = int16_to_uint8_inv(rz_val);
+
+    if (ext) {
+        ext->x  = (uint16_t)(x_val + 0x8000);
+        ext->y  = (uint16_t)(0x7FFF - y_val);
+        ext->z  = (uint16_t)(z_val + 0x8000);
+        ext->rz = (uint16_t)(0x7FFF - rz_val);
+    }
+}
+
+#endif /* TJUH_ENABLE_XBOX360 || TJUH_ENABLE_XBOX_ONE */
+
+#endif /* TJUH_PARSE_REFERENCE */
+
+#if TJUH_ENABLE_XBOX360
+
 /* ---------------------------------------------------------------------- */
 /*  Xbox 360 parsing                                                      */
 /* ---------------------------------------------------------------------- */
 
+/* Buttons at [2..3], 8-bit triggers at [4..5], signed 16-bit sticks, Y up */
+#define XBOX360_LAYOUT(F)         \
+    F(X,   6, 0, 16, 1, 0)        \
+    F(Y,   8, 0, 16, 1, 1)        \
+    F(Z,  10, 0, 16, 1, 0)        \
+    F(RZ, 12, 0, 16, 1, 1)        \
+    F(L2,  4, 0,  8, 0, 0)        \
+    F(R2,  5, 0,  8, 0, 0)
+
+TJUH_LAYOUT_PARSER(parse_xbox360, 0, XBOX360_LAYOUT)
+
+#if TJUH_PARSE_REFERENCE
+
+static void parse_xbox360_hand(const tjuh_input_map_t *map, const uint8_t *data,
+                               tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    tjuh_buttons_store(st, tjuh_buttons_lookup(&map->button[0], data));
+    parse_xinput_axes(data + 6, st, ext);
+
+    if (ext) {
+        ext->l2 = uint8_to_uint16(data[4]);
+        ext->r2 = uint8_to_uint16(data[5]);
+    }
+}
+
 static void parse_xbox360_dpad_buttons(uint8_t byte, tjuh_gamepad_report_t *rpt)
 {
     uint8_t dpad_bits = byte & 0x0F;
@@ -142,7 +507,7 @@ static void parse_xbox360_buttons(uint8_t byte, tjuh_gamepad_report_t *rpt)
     rpt->triangle = (byte & 0x80) != 0;
 }
 
-static void parse_xbox360(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
+static void parse_xbox360_ref(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
 {
     (void)len;
 
@@ -152,26 +517,139 @@ static void parse_xbox360(const uint8_t *data, uint16_t len, tjuh_gamepad_report
     rpt->l2 = data[4] > 128;
     rpt->r2 = data[5] > 128;
 
-    int16_t x_val;
-    int16_t y_val;
-    int16_t z_val;
-    int16_t rz_val;
-    memcpy(&x_val,  data + 6,  sizeof(int16_t));
-    memcpy(&y_val,  data + 8,  sizeof(int16_t));
-    memcpy(&z_val,  data + 10, sizeof(int16_t));
-    memcpy(&rz_val, data + 12, sizeof(int16_t));
+    tjuh_gamepad_state_t axes;
+    parse_xinput_axes(data + 6, &axes, NULL);
+    rpt->axes_bytes = axes.axes;
+}
 
-    rpt->x  = int16_to_uint8(x_val);
-    rpt->y  = int16_to_uint8_inv(y_val);
-    rpt->z  = int16_to_uint8(z_val);
-    rpt->rz = int16_to_uint8_inv(rz_val);
+#endif /* TJUH_PARSE_REFERENCE */
+
+#endif /* TJUH_ENABLE_XBOX360 */
+
+#if TJUH_ENABLE_XBOX_ONE
+
+/* ---------------------------------------------------------------------- */
+/*  Xbox One (GIP)                                                        */
+/*                                                                        */
+/*  Input packet 0x20: buttons at [4..5], 10-bit triggers at [6..9],      */
+/*  signed 16-bit sticks at [10..17]. The guide button is not in it: it   */
+/*  arrives as its own packet (0x07), which the controller repeats until  */
+/*  the host acknowledges it (see tjuh.c).                                */
+/*  Reference: Linux drivers/input/joystick/xpad.c                        */
+/* ---------------------------------------------------------------------- */
+
+#define GIP_GUIDE_BIT 0x02   /* unused bit of [4] that carries the guide state */
+
+#define XBOX_ONE_LAYOUT(F)        \
+    F(X,  10, 0, 16, 1, 0)        \
+    F(Y,  12, 0, 16, 1, 1)        \
+    F(Z,  14, 0, 16, 1, 0)        \
+    F(RZ, 16, 0, 16, 1, 1)        \
+    F(L2,  6, 0, 10, 0, 0)        \
+    F(R2,  8, 0, 10, 0, 0)
+
+TJUH_LAYOUT_PARSER(parse_xbox_one, 0, XBOX_ONE_LAYOUT)
+
+#if TJUH_PARSE_REFERENCE
+
+/* 10-bit trigger to the extended 16-bit range */
+static inline uint16_t gip_trigger(const uint8_t *p)
+{
+    uint16_t v = (uint16_t)((p[0] | (p[1] << 8)) & 0x3FF);
+    return (uint16_t)((v << 6) | (v >> 4));
 }
 
+static void parse_xbox_one_hand(const tjuh_input_map_t *map, const uint8_t *data,
+                                tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    tjuh_buttons_store(st, tjuh_buttons_lookup(&map->button[0], data));
+    parse_xinput_axes(data + 10, st, ext);
+
+    if (ext) {
+        ext->l2 = gip_trigger(data + 6);
+        ext->r2 = gip_trigger(data + 8);
+    }
+}
+
+#endif /* TJUH_PARSE_REFERENCE */
+
+/*
+ * Input and guide packets each carry part of the state. The last input
+ * packet is kept per device with the guide folded into its button byte,
+ * and either packet re-parses that copy, so the guide goes through the
+ * same tables (and remap profile) as every other button.
+ */
+static bool TJUH_HOT_FUNC(parse_gip)(tjuh_device_entry_t *dev, const tjuh_input_map_t *map,
+                                     const uint8_t *data, uint16_t len,
+                                     tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    uint8_t *in = dev->gip_input;
+
+    switch (data[0]) {
+        case TJUH_GIP_CMD_INPUT: {
+            if (len < GIP_INPUT_LEN)
+                return false;
+            uint8_t guide = in[4] & GIP_GUIDE_BIT;
+            memcpy(in, data, GIP_INPUT_LEN);
+            in[4] = (uint8_t)((in[4] & ~GIP_GUIDE_BIT) | guide);
+            break;
+        }
+
+        case TJUH_GIP_CMD_VIRTUAL_KEY:
+            if (len < 5)
+                return false;
+            if (data[4] & 0x03)
+                in[4] |= GIP_GUIDE_BIT;
+            else
+                in[4] &= (uint8_t)~GIP_GUIDE_BIT;
+            break;
+
+        default:
+            return false;   /* announce, status, acks: transport only */
+    }
+
+    parse_xbox_one(map, in, st, ext);
+    return true;
+}
+
+#endif /* TJUH_ENABLE_XBOX_ONE */
+
+#if TJUH_ENABLE_SONY
+
 /* ---------------------------------------------------------------------- */
 /*  Sony DualSense (PS5) parsing                                          */
 /* ---------------------------------------------------------------------- */
 
-static void parse_sony_dualsense(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
+/* Report ID 0x01, sticks, triggers, timestamp, buttons at [8..10] */
+#define DUALSENSE_LAYOUT(F)       \
+    F(X,   1, 0,  8, 0, 0)        \
+    F(Y,   2, 0,  8, 0, 0)        \
+    F(Z,   3, 0,  8, 0, 0)        \
+    F(RZ,  4, 0,  8, 0, 0)        \
+    F(L2,  5, 0,  8, 0, 0)        \
+    F(R2,  6, 0,  8, 0, 0)
+
+TJUH_LAYOUT_PARSER(parse_sony_dualsense, 0, DUALSENSE_LAYOUT)
+
+#if TJUH_PARSE_REFERENCE
+
+static void parse_sony_dualsense_hand(const tjuh_input_map_t *map, const uint8_t *data,
+                                      tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    /* Axes follow the report ID byte (0x01) */
+    memcpy(&st->axes, data + 1, sizeof(st->axes));
+
+    /* Buttons in data[8..10], after 2 bytes analog triggers + 1 byte timestamp */
+    tjuh_buttons_store(st, tjuh_buttons_lookup(&map->button[0], data));
+
+    if (ext) {
+        ext_axes_from_state(st, ext);
+        ext->l2 = uint8_to_uint16(data[5]);
+        ext->r2 = uint8_to_uint16(data[6]);
+    }
+}
+
+static void parse_sony_dualsense_ref(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
 {
     (void)len;
 
@@ -188,11 +666,56 @@ static void parse_sony_dualsense(const uint8_t *data, uint16_t len, tjuh_gamepad
     rpt->extra_buttons_byte   = *data;
 }
 
+#endif /* TJUH_PARSE_REFERENCE */
+
+#endif /* TJUH_ENABLE_SONY */
+
+#if TJUH_ENABLE_SONY || TJUH_ENABLE_GENERIC
+
 /* ---------------------------------------------------------------------- */
 /*  Sony DualShock 4 parsing                                              */
 /* ---------------------------------------------------------------------- */
 
-static void parse_sony_ds4(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
+/* Report ID 0x01, sticks, buttons at [5..7], then the analog triggers */
+#define DS4_STICKS(F)             \
+    F(X,   1, 0,  8, 0, 0)        \
+    F(Y,   2, 0,  8, 0, 0)        \
+    F(Z,   3, 0,  8, 0, 0)        \
+    F(RZ,  4, 0,  8, 0, 0)
+
+#define DS4_LAYOUT(F)             \
+    DS4_STICKS(F)                 \
+    F(L2,  8, 0,  8, 0, 0)        \
+    F(R2,  9, 0,  8, 0, 0)
+
+#if TJUH_ENABLE_SONY
+TJUH_LAYOUT_PARSER(parse_sony_ds4, 0, DS4_LAYOUT)
+#endif
+
+/* DInput pads share the DS4 layout up to the buttons (see parse_with) */
+#if TJUH_ENABLE_GENERIC
+TJUH_LAYOUT_PARSER(parse_dinput, 0, DS4_STICKS)
+#endif
+
+#if TJUH_PARSE_REFERENCE
+
+static void parse_sony_ds4_hand(const tjuh_input_map_t *map, const uint8_t *data, uint16_t len,
+                                tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    /* Report ID byte (0x01), axes, buttons in data[5..7], analog triggers */
+    memcpy(&st->axes, data + 1, sizeof(st->axes));
+    tjuh_buttons_store(st, tjuh_buttons_lookup(&map->button[0], data));
+
+    if (ext) {
+        ext_axes_from_state(st, ext);
+        if (len >= 10) {
+            ext->l2 = uint8_to_uint16(data[8]);
+            ext->r2 = uint8_to_uint16(data[9]);
+        }
+    }
+}
+
+static void parse_sony_ds4_ref(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
 {
     (void)len;
 
@@ -202,6 +725,12 @@ static void parse_sony_ds4(const uint8_t *data, uint16_t len, tjuh_gamepad_repor
     memcpy(rpt, data, sizeof(*rpt));
 }
 
+#endif /* TJUH_PARSE_REFERENCE */
+
+#endif /* TJUH_ENABLE_SONY || TJUH_ENABLE_GENERIC */
+
+#if TJUH_ENABLE_SWITCH
+
 /* ---------------------------------------------------------------------- */
 /*  Nintendo Switch Pro Controller — full report (0x30)                   */
 /*                                                                        */
@@ -210,7 +739,63 @@ static void parse_sony_ds4(const uint8_t *data, uint16_t len, tjuh_gamepad_repor
 /*  Reference: dekuNukem/Nintendo_Switch_Reverse_Engineering              */
 /* ---------------------------------------------------------------------- */
 
-static void parse_switch_pro_full(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
+/*
+ * data[0] = 0x30 (report ID), data[1] = timer, data[2] = battery, buttons
+ * at [3..5], then two 12-bit sticks (Y up) packed into [6..8] and
+ * [9..11]. ZL / ZR are digital.
+ */
+#define SWITCH_FULL_LAYOUT(F)     \
+    F(X,   6, 0, 12, 0, 0)        \
+    F(Y,   7, 4, 12, 0, 1)        \
+    F(Z,   9, 0, 12, 0, 0)        \
+    F(RZ, 10, 4, 12, 0, 1)        \
+    F(L2,  5, 7,  1, 0, 0)        \
+    F(R2,  3, 7,  1, 0, 0)
+
+TJUH_LAYOUT_PARSER(parse_switch_pro_full, 0, SWITCH_FULL_LAYOUT)
+
+#if TJUH_PARSE_REFERENCE
+
+static void parse_switch_pro_full_sticks(const uint8_t *data, tjuh_gamepad_state_t *st,
+                                         tjuh_gamepad_ext_t *ext)
+{
+    /* Left stick: 12-bit packed in bytes 6–8 */
+    uint16_t lx = (uint16_t)(data[6] | ((data[7] & 0x0F) << 8));
+    uint16_t ly = (uint16_t)((data[7] >> 4) | (data[8] << 4));
+
+    /* Right stick: 12-bit packed in bytes 9–11 */
+    uint16_t rx = (uint16_t)(data[9] | ((data[10] & 0x0F) << 8));
+    uint16_t ry = (uint16_t)((data[10] >> 4) | (data[11] << 4));
+
+    /* 12-bit (0–4095, ~2048 center) → 8-bit (0–255, 128 center) */
+    st->x  = (uint8_t)(lx >> 4);
+    st->y  = (uint8_t)(0xFF - (ly >> 4)); /* invert: up = 0 */
+    st->z  = (uint8_t)(rx >> 4);
+    st->rz = (uint8_t)(0xFF - (ry >> 4));
+
+    /* 12-bit → 16-bit, top bits repeated into the bottom */
+    if (ext) {
+        ext->x  = (uint16_t)((lx << 4) | (lx >> 8));
+        ext->y  = (uint16_t)(0xFFFF - ((ly << 4) | (ly >> 8)));
+        ext->z  = (uint16_t)((rx << 4) | (rx >> 8));
+        ext->rz = (uint16_t)(0xFFFF - ((ry << 4) | (ry >> 8)));
+    }
+}
+
+static void parse_switch_pro_full_hand(const tjuh_input_map_t *map, const uint8_t *data,
+                                       tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    tjuh_buttons_store(st, tjuh_buttons_lookup(&map->button[0], data));
+    parse_switch_pro_full_sticks(data, st, ext);
+
+    /* ZL / ZR are digital */
+    if (ext) {
+        ext->l2 = digital_trigger(data[5] & 0x80);
+        ext->r2 = digital_trigger(data[3] & 0x80);
+    }
+}
+
+static void parse_switch_pro_full_ref(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
 {
     if (len < 12)
         return;
@@ -255,21 +840,13 @@ static void parse_switch_pro_full(const uint8_t *data, uint16_t len, tjuh_gamepa
     else if (left)           rpt->dpad = 6;
     else                     rpt->dpad = 8;
 
-    /* Left stick: 12-bit packed in bytes 6–8 */
-    uint16_t lx = (uint16_t)(data[6] | ((data[7] & 0x0F) << 8));
-    uint16_t ly = (uint16_t)((data[7] >> 4) | (data[8] << 4));
-
-    /* Right stick: 12-bit packed in bytes 9–11 */
-    uint16_t rx = (uint16_t)(data[9] | ((data[10] & 0x0F) << 8));
-    uint16_t ry = (uint16_t)((data[10] >> 4) | (data[11] << 4));
-
-    /* 12-bit (0–4095, ~2048 center) → 8-bit (0–255, 128 center) */
-    rpt->x  = (uint8_t)(lx >> 4);
-    rpt->y  = (uint8_t)(0xFF - (ly >> 4)); /* invert: up = 0 */
-    rpt->z  = (uint8_t)(rx >> 4);
-    rpt->rz = (uint8_t)(0xFF - (ry >> 4));
+    tjuh_gamepad_state_t sticks;
+    parse_switch_pro_full_sticks(data, &sticks, NULL);
+    rpt->axes_bytes = sticks.axes;
 }
 
+#endif /* TJUH_PARSE_REFERENCE */
+
 /* ---------------------------------------------------------------------- */
 /*  Nintendo Switch Pro Controller — simple report (0x3F)                 */
 /*                                                                        */
@@ -278,7 +855,37 @@ static void parse_switch_pro_full(const uint8_t *data, uint16_t len, tjuh_gamepa
 /*  Uses standard hat encoding and 8-bit axes.                            */
 /* ---------------------------------------------------------------------- */
 
-static void parse_switch_pro_simple(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
+/* data[0] = 0x3F (report ID), buttons at [1..2] with ZL / ZR, hat at [3] */
+#define SWITCH_SIMPLE_LAYOUT(F)   \
+    F(X,   4, 0,  8, 0, 0)        \
+    F(Y,   5, 0,  8, 0, 0)        \
+    F(Z,   6, 0,  8, 0, 0)        \
+    F(RZ,  7, 0,  8, 0, 0)        \
+    F(L2,  1, 6,  1, 0, 0)        \
+    F(R2,  1, 7,  1, 0, 0)
+
+TJUH_LAYOUT_PARSER(parse_switch_pro_simple, 1, SWITCH_SIMPLE_LAYOUT)
+
+#if TJUH_PARSE_REFERENCE
+
+static void parse_switch_pro_simple_hand(const tjuh_input_map_t *map, const uint8_t *data,
+                                         tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    tjuh_buttons_store(st, tjuh_buttons_lookup(&map->button[1], data));
+
+    st->x  = data[4];
+    st->y  = data[5];
+    st->z  = data[6];
+    st->rz = data[7];
+
+    if (ext) {
+        ext_axes_from_state(st, ext);
+        ext->l2 = digital_trigger(data[1] & 0x40);
+        ext->r2 = digital_trigger(data[1] & 0x80);
+    }
+}
+
+static void parse_switch_pro_simple_ref(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
 {
     if (len < 8)
         return;
@@ -312,32 +919,114 @@ static void parse_switch_pro_simple(const uint8_t *data, uint16_t len, tjuh_game
     rpt->rz = data[7];
 }
 
+#endif /* TJUH_PARSE_REFERENCE */
+
 /* ---------------------------------------------------------------------- */
 /*  Nintendo Switch — dispatch by report ID                               */
 /* ---------------------------------------------------------------------- */
 
-static bool parse_switch(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
+static bool TJUH_HOT_FUNC(parse_switch)(const tjuh_input_map_t *map, const uint8_t *data,
+                                        uint16_t len, tjuh_gamepad_state_t *st,
+                                        tjuh_gamepad_ext_t *ext)
 {
     if (len < 8)
         return false;
 
     switch (data[0]) {
         case 0x30:
-            parse_switch_pro_full(data, len, rpt);
+            /* A short full report is accepted with nothing in it */
+            if (len >= 12)
+                parse_switch_pro_full(map, data, st, ext);
             return true;
         case 0x3F:
-            parse_switch_pro_simple(data, len, rpt);
+            parse_switch_pro_simple(map, data, st, ext);
             return true;
         default:
             return false;
     }
 }
 
+#if TJUH_PARSE_REFERENCE
+
+static bool parse_switch_hand(const tjuh_input_map_t *map, const uint8_t *data, uint16_t len,
+                              tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    if (len < 8)
+        return false;
+
+    switch (data[0]) {
+        case 0x30:
+            if (len >= 12)
+                parse_switch_pro_full_hand(map, data, st, ext);
+            return true;
+        case 0x3F:
+            parse_switch_pro_simple_hand(map, data, st, ext);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool parse_switch_ref(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
+{
+    if (len < 8)
+        return false;
+
+    switch (data[0]) {
+        case 0x30:
+            parse_switch_pro_full_ref(data, len, rpt);
+            return true;
+        case 0x3F:
+            parse_switch_pro_simple_ref(data, len, rpt);
+            return true;
+        default:
+            return false;
+    }
+}
+
+#endif /* TJUH_PARSE_REFERENCE */
+
+#endif /* TJUH_ENABLE_SWITCH */
+
+#if TJUH_ENABLE_GENERIC
+
 /* ---------------------------------------------------------------------- */
 /*  Generic 8-byte gamepad                                                */
 /* ---------------------------------------------------------------------- */
 
-static void parse_generic_8byte(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
+/* data[4] is typically 0xFF (unused), buttons at [5..6] with digital L2 / R2 */
+#define GENERIC_8BYTE_LAYOUT(F)   \
+    F(RZ,  0, 0,  8, 0, 0)        \
+    F(Z,   1, 0,  8, 0, 0)        \
+    F(X,   2, 0,  8, 0, 0)        \
+    F(Y,   3, 0,  8, 0, 0)        \
+    F(L2,  6, 2,  1, 0, 0)        \
+    F(R2,  6, 3,  1, 0, 0)
+
+TJUH_LAYOUT_PARSER(parse_generic_8byte, 0, GENERIC_8BYTE_LAYOUT)
+
+#if TJUH_PARSE_REFERENCE
+
+static void parse_generic_8byte_hand(const tjuh_input_map_t *map, const uint8_t *data,
+                                     tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    st->rz = data[0];
+    st->z  = data[1];
+    st->x  = data[2];
+    st->y  = data[3];
+
+    /* data[4] is typically 0xFF (unused) */
+
+    tjuh_buttons_store(st, tjuh_buttons_lookup(&map->button[0], data));
+
+    if (ext) {
+        ext_axes_from_state(st, ext);
+        ext->l2 = digital_trigger(data[6] & 0x04);
+        ext->r2 = digital_trigger(data[6] & 0x08);
+    }
+}
+
+static void parse_generic_8byte_ref(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
 {
     (void)len;
 
@@ -368,11 +1057,33 @@ static void parse_generic_8byte(const uint8_t *data, uint16_t len, tjuh_gamepad_
     rpt->r2 = (bits & 0x08) != 0;
 }
 
+#endif /* TJUH_PARSE_REFERENCE */
+
 /* ---------------------------------------------------------------------- */
 /*  Generic 3-byte gamepad (minimal: X, Y, buttons)                       */
 /* ---------------------------------------------------------------------- */
 
-static void parse_generic_3byte(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
+#define GENERIC_3BYTE_LAYOUT(F)   \
+    F(X,   0, 0,  8, 0, 0)        \
+    F(Y,   1, 0,  8, 0, 0)
+
+TJUH_LAYOUT_PARSER(parse_generic_3byte, 0, GENERIC_3BYTE_LAYOUT)
+
+#if TJUH_PARSE_REFERENCE
+
+static void parse_generic_3byte_hand(const tjuh_input_map_t *map, const uint8_t *data,
+                                     tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    st->x = data[0];
+    st->y = data[1];
+
+    tjuh_buttons_store(st, tjuh_buttons_lookup(&map->button[0], data));
+
+    if (ext)
+        ext_axes_from_state(st, ext);
+}
+
+static void parse_generic_3byte_ref(const uint8_t *data, uint16_t len, tjuh_gamepad_report_t *rpt)
 {
     (void)len;
 
@@ -382,58 +1093,54 @@ static void parse_generic_3byte(const uint8_t *data, uint16_t len, tjuh_gamepad_
     rpt->dpad_buttons_byte = (uint8_t)((data[2] << 4) | 0x08);
 }
 
+#endif /* TJUH_PARSE_REFERENCE */
+
+#endif /* TJUH_ENABLE_GENERIC */
+
+#if TJUH_ENABLE_SONY
+
 /* ---------------------------------------------------------------------- */
 /*  Sony controller dispatch                                              */
 /* ---------------------------------------------------------------------- */
 
-static bool parse_sony(uint16_t pid, const uint8_t *data, uint16_t len,
-                       tjuh_gamepad_report_t *rpt)
+static bool TJUH_HOT_FUNC(parse_sony)(uint8_t parser, const tjuh_input_map_t *map,
+                                      const uint8_t *data, uint16_t len, tjuh_gamepad_state_t *st,
+                                      tjuh_gamepad_ext_t *ext)
 {
     if (len < 10 || data[0] != 0x01)
         return false;
 
-    switch (pid) {
-        case PID_DUALSENSE:
-        case PID_DUALSENSE_EDGE:
-            parse_sony_dualsense(data, len, rpt);
-            return true;
-
-        case PID_DS4_V1:
-        case PID_DS4_V2:
-        default:
-            /* DS4 layout is the default for unknown Sony PIDs (covers clones) */
-            parse_sony_ds4(data, len, rpt);
-            return true;
-    }
+    if (parser == TJUH_PARSER_DUALSENSE)
+        parse_sony_dualsense(map, data, st, ext);
+    else
+        parse_sony_ds4(map, data, st, ext);
+    return true;
 }
 
+#endif /* TJUH_ENABLE_SONY */
+
 /* ---------------------------------------------------------------------- */
-/*  Size-based fallback for unknown VID/PID                               */
+/*  Size-based heuristic for unknown VID/PID                              */
 /*                                                                        */
 /*  Preserves the original detection paths for generic gamepads and       */
 /*  Xbox 360, but no longer blindly sends ep_size=64 to the DS4 parser.  */
+/*  Returns the parser one report looks like, or TJUH_PARSER_AUTO.        */
 /* ---------------------------------------------------------------------- */
 
-static bool parse_by_endpoint_size(const uint8_t *data, uint16_t actual_len,
-                                   uint16_t max_ep_size, tjuh_gamepad_report_t *rpt)
+static uint8_t TJUH_HOT_FUNC(classify_by_endpoint_size)(const uint8_t *data, uint16_t actual_len,
+                                                        uint16_t max_ep_size)
 {
     switch (max_ep_size) {
         case 8:
-            if (actual_len == 8) {
-                parse_generic_8byte(data, actual_len, rpt);
-                return true;
-            }
-            if (actual_len == 3) {
-                parse_generic_3byte(data, actual_len, rpt);
-                return true;
-            }
+            if (actual_len == 8)
+                return TJUH_PARSER_GENERIC_8BYTE;
+            if (actual_len == 3)
+                return TJUH_PARSER_GENERIC_3BYTE;
             break;
 
         case 32:
-            if (actual_len == 20) {
-                parse_xbox360(data, actual_len, rpt);
-                return true;
-            }
+            if (actual_len == 20)
+                return TJUH_PARSER_XBOX360;
             break;
 
         default:
@@ -446,7 +1153,7 @@ static bool parse_by_endpoint_size(const uint8_t *data, uint16_t actual_len,
      * that start with a report ID followed by 4 axis bytes and a hat/button
      * byte in DS4-compatible layout. Accept these only if they look plausible.
      */
-    if (actual_len >= 8 && max_ep_size >= 8) {
+    if (actual_len >= 9 && max_ep_size >= 8) {
         uint8_t report_id = data[0];
 
         /* Report ID is typically 0x01–0x04 for gamepads */
@@ -458,71 +1165,470 @@ static bool parse_by_endpoint_size(const uint8_t *data, uint16_t actual_len,
              * This filters out non-gamepad HID reports (keyboards, mice, etc.)
              * that happen to start with a small report ID byte.
              */
-            bool any_centered = false;
-            for (int i = 0; i < 4 && (i + 1) < actual_len; i++) {
+            for (int i = 0; i < 4; i++) {
                 if (axes[i] >= 96 && axes[i] <= 160) {
-                    any_centered = true;
-                    break;
+                    /*
+                     * Assume DS4-compatible layout: report_id + axes(4) + buttons(4).
+                     * This covers many third-party DInput pads, Logitech F310 (D mode),
+                     * 8BitDo controllers in DInput mode, and similar devices.
+                     */
+                    return TJUH_PARSER_DINPUT;
                 }
             }
-
-            if (any_centered && actual_len >= 9) {
-                /*
-                 * Assume DS4-compatible layout: report_id + axes(4) + buttons(4).
-                 * This covers many third-party DInput pads, Logitech F310 (D mode),
-                 * 8BitDo controllers in DInput mode, and similar devices.
-                 */
-                parse_sony_ds4(data, actual_len, rpt);
-                return true;
-            }
         }
     }
 
-    return false;
+    return TJUH_PARSER_AUTO;
 }
 
 /* ---------------------------------------------------------------------- */
-/*  Main dispatch                                                         */
+/*  Parser dispatch                                                       */
 /* ---------------------------------------------------------------------- */
 
-bool tjuh_parse_report(uint8_t dev_addr,
-                       const uint8_t *data,
-                       uint16_t actual_len,
-                       uint16_t max_ep_size,
-                       tjuh_gamepad_report_t *report_out,
-                       tjuh_hint_t hint)
+/* `map` must be the built-in or remapped input map for `parser`; with a
+ * constant `parser` only that parser's case is left */
+static inline __attribute__((always_inline))
+bool parse_body(uint8_t parser, const tjuh_input_map_t *map, const uint8_t *data,
+                uint16_t actual_len, tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
 {
-    if (actual_len == 0)
-        return false;
+    switch (parser) {
+#if TJUH_ENABLE_SONY
+        case TJUH_PARSER_DS4:
+        case TJUH_PARSER_DUALSENSE:
+            return parse_sony(parser, map, data, actual_len, st, ext);
+#endif
 
-    /* --- Stage 1: Hint-based routing (set during enumeration) --- */
+#if TJUH_ENABLE_SWITCH
+        case TJUH_PARSER_SWITCH:
+            return parse_switch(map, data, actual_len, st, ext);
+#endif
 
-    if (hint == TJUH_HINT_XBOX_ONE)
-        return false;
+#if TJUH_ENABLE_XBOX360
+        case TJUH_PARSER_XBOX360:
+            if (actual_len < 14)
+                return false;
+            parse_xbox360(map, data, st, ext);
+            return true;
+#endif
 
-    if (hint == TJUH_HINT_SWITCH_PRO)
-        return parse_switch(data, actual_len, report_out);
+#if TJUH_ENABLE_GENERIC
+        case TJUH_PARSER_GENERIC_8BYTE:
+            if (actual_len < 8)
+                return false;
+            parse_generic_8byte(map, data, st, ext);
+            return true;
 
-    /* --- Stage 2: VID/PID-based routing --- */
+        case TJUH_PARSER_GENERIC_3BYTE:
+            if (actual_len < 3)
+                return false;
+            parse_generic_3byte(map, data, st, ext);
+            return true;
 
-    uint16_t vid = 0;
-    uint16_t pid = 0;
-    bool have_id = get_vid_pid(dev_addr, &vid, &pid);
+        case TJUH_PARSER_DINPUT:
+            if (actual_len < 9 || data[0] < 0x01 || data[0] > 0x04)
+                return false;
+            parse_dinput(map, data, st, ext);
+            /* Nothing is known about the bytes after the buttons */
+            if (ext)
+                ext->l2 = ext->r2 = 0;
+            return true;
+#endif
+
+#if TJUH_ENABLE_XBOX_ONE
+        case TJUH_PARSER_XBOX_ONE:
+            if (actual_len < GIP_INPUT_LEN || data[0] != TJUH_GIP_CMD_INPUT)
+                return false;
+            parse_xbox_one(map, data, st, ext);
+            return true;
+#endif
+
+        case TJUH_PARSER_IGNORE:
+        default:
+            return false;
+    }
+}
 
-    if (have_id) {
-        switch (vid) {
-            case VID_SONY:
-                return parse_sony(pid, data, actual_len, report_out);
+static bool TJUH_HOT_FUNC(parse_with)(uint8_t parser, const tjuh_input_map_t *map,
+                                      const uint8_t *data, uint16_t actual_len,
+                                      tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    return parse_body(parser, map, data, actual_len, st, ext);
+}
 
-            case VID_NINTENDO:
-                return parse_switch(data, actual_len, report_out);
+#if TJUH_PARSE_REFERENCE
 
-            default:
-                break;
-        }
+bool tjuh_parse_with(uint8_t parser, const uint8_t *data, uint16_t len,
+                     tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    return parse_with(parser, tjuh_input_map_default(parser), data, len, st, ext);
+}
+
+/* parse_with() over the hand-written parsers; kept out of line like
+ * parse_with() so both are timed through the same call chain */
+__attribute__((noinline))
+static bool parse_with_hand(uint8_t parser, const tjuh_input_map_t *map, const uint8_t *data,
+                            uint16_t len, tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    switch (parser) {
+#if TJUH_ENABLE_SONY
+        case TJUH_PARSER_DS4:
+        case TJUH_PARSER_DUALSENSE:
+            if (len < 10 || data[0] != 0x01)
+                return false;
+            if (parser == TJUH_PARSER_DUALSENSE)
+                parse_sony_dualsense_hand(map, data, st, ext);
+            else
+                parse_sony_ds4_hand(map, data, len, st, ext);
+            return true;
+#endif
+
+#if TJUH_ENABLE_SWITCH
+        case TJUH_PARSER_SWITCH:
+            return parse_switch_hand(map, data, len, st, ext);
+#endif
+
+#if TJUH_ENABLE_XBOX360
+        case TJUH_PARSER_XBOX360:
+            if (len < 14)
+                return false;
+            parse_xbox360_hand(map, data, st, ext);
+            return true;
+#endif
+
+#if TJUH_ENABLE_GENERIC
+        case TJUH_PARSER_GENERIC_8BYTE:
+            if (len < 8)
+                return false;
+            parse_generic_8byte_hand(map, data, st, ext);
+            return true;
+
+        case TJUH_PARSER_GENERIC_3BYTE:
+            if (len < 3)
+                return false;
+            parse_generic_3byte_hand(map, data, st, ext);
+            return true;
+
+        case TJUH_PARSER_DINPUT:
+            if (len < 9 || data[0] < 0x01 || data[0] > 0x04)
+                return false;
+            parse_sony_ds4_hand(map, data, len, st, ext);
+            if (ext)
+                ext->l2 = ext->r2 = 0;
+            return true;
+#endif
+
+#if TJUH_ENABLE_XBOX_ONE
+        case TJUH_PARSER_XBOX_ONE:
+            if (len < GIP_INPUT_LEN || data[0] != TJUH_GIP_CMD_INPUT)
+                return false;
+            parse_xbox_one_hand(map, data, st, ext);
+            return true;
+#endif
+
+        default:
+            (void)data;
+            (void)len;
+            (void)st;
+            (void)ext;
+            (void)map;
+            return false;
     }
+}
 
-    /* --- Stage 3: Endpoint-size heuristic (generic / Xbox 360) --- */
+bool tjuh_parse_with_handwritten(uint8_t parser, const uint8_t *data, uint16_t len,
+                                 tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    return parse_with_hand(parser, tjuh_input_map_default(parser), data, len, st, ext);
+}
+
+bool tjuh_parse_with_reference(uint8_t parser, const uint8_t *data, uint16_t len,
+                               tjuh_gamepad_report_t *rpt)
+{
+    switch (parser) {
+#if TJUH_ENABLE_SONY
+        case TJUH_PARSER_DS4:
+        case TJUH_PARSER_DUALSENSE:
+            if (len < 10 || data[0] != 0x01)
+                return false;
+            if (parser == TJUH_PARSER_DUALSENSE)
+                parse_sony_dualsense_ref(data, len, rpt);
+            else
+                parse_sony_ds4_ref(data, len, rpt);
+            return true;
+#endif
+
+#if TJUH_ENABLE_SWITCH
+        case TJUH_PARSER_SWITCH:
+            return parse_switch_ref(data, len, rpt);
+#endif
+
+#if TJUH_ENABLE_XBOX360
+        case TJUH_PARSER_XBOX360:
+            if (len < 14)
+                return false;
+            parse_xbox360_ref(data, len, rpt);
+            return true;
+#endif
+
+#if TJUH_ENABLE_GENERIC
+        case TJUH_PARSER_GENERIC_8BYTE:
+            if (len < 8)
+                return false;
+            parse_generic_8byte_ref(data, len, rpt);
+            return true;
+
+        case TJUH_PARSER_GENERIC_3BYTE:
+            if (len < 3)
+                return false;
+            parse_generic_3byte_ref(data, len, rpt);
+            return true;
+
+        case TJUH_PARSER_DINPUT:
+            if (len < 9 || data[0] < 0x01 || data[0] > 0x04)
+                return false;
+            parse_sony_ds4_ref(data, len, rpt);
+            return true;
+#endif
+
+        default:
+            (void)data;
+            (void)len;
+            (void)rpt;
+            return false;
+    }
+}
+
+#endif /* TJUH_PARSE_REFERENCE */
+
+/* ---------------------------------------------------------------------- */
+/*  Probationary classification                                           */
+/*                                                                        */
+/*  A device with no parser from the quirk table or its report            */
+/*  descriptor is classified per report for its first reports. Once       */
+/*  TJUH_CLASSIFY_PROBATION_REPORTS consecutive reports agree, the        */
+/*  parser is committed and the heuristic is no longer evaluated. If the  */
+/*  committed parser then rejects as many reports in a row, the device    */
+/*  goes back on probation.                                               */
+/* ---------------------------------------------------------------------- */
+
+static void TJUH_HOT_FUNC(probation_vote)(tjuh_device_entry_t *dev, uint8_t candidate)
+{
+    /* Inconclusive reports (e.g. stick held off-centre) neither add nor reset */
+    if (candidate == TJUH_PARSER_AUTO)
+        return;
+
+    if (candidate != dev->candidate) {
+        if (dev->candidate != TJUH_PARSER_AUTO)
+            dev->reclassify++;
+        dev->candidate = candidate;
+        dev->votes = 0;
+    }
+
+    if (++dev->votes >= TJUH_CLASSIFY_PROBATION_REPORTS) {
+        device_defer_parser(dev, candidate);
+        dev->classify = CLASSIFY_COMMITTED;
+        dev->votes    = 0;
+        device_route(dev);
+    }
+}
+
+static void TJUH_HOT_FUNC(committed_result)(tjuh_device_entry_t *dev, bool ok)
+{
+    if (ok) {
+        dev->votes = 0;
+        return;
+    }
+
+    if (++dev->votes >= TJUH_CLASSIFY_PROBATION_REPORTS) {
+        device_defer_parser(dev, TJUH_PARSER_AUTO);
+        dev->candidate = TJUH_PARSER_AUTO;
+        dev->classify  = CLASSIFY_PROBATION;
+        dev->votes     = 0;
+        dev->reclassify++;
+        device_route(dev);
+    }
+}
+
+uint8_t tjuh_parse_get_parser(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return TJUH_PARSER_AUTO;
+
+    const tjuh_device_entry_t *dev = &s_devices[dev_addr - 1];
+    if (dev->vid == 0 || dev->desc_pending || dev->classify == CLASSIFY_PROBATION)
+        return TJUH_PARSER_AUTO;
+
+    return dev->parser;
+}
+
+uint16_t tjuh_parse_get_reclassify_count(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return 0;
+
+    return s_devices[dev_addr - 1].reclassify;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Settled devices                                                       */
+/*                                                                        */
+/*  Once a device's parser is fixed or committed, its reports always take */
+/*  Stage 2 below. One entry per parser does that with the parser as a    */
+/*  constant, so the pipeline can call it instead of tjuh_parse_report()  */
+/*  and the parser is chosen once rather than again for every report.     */
+/* ---------------------------------------------------------------------- */
+
+static inline __attribute__((always_inline))
+bool parse_settled(const uint8_t parser, uint8_t dev_addr, const uint8_t *data, uint16_t len,
+                   tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext)
+{
+    tjuh_device_entry_t    *dev = &s_devices[dev_addr - 1];
+    const tjuh_input_map_t *map = dev->map;
+    bool ok = parse_body(parser, map, data, len, st, ext);
+
+    if (dev->classify == CLASSIFY_COMMITTED)
+        committed_result(dev, ok);
+
+    if (ok) {
+        st->axes = tjuh_axes_transform(map, st->axes ^ dev->axis_xor);
+        if (ext)
+            ext_axes_transform(map, dev->axis_xor, ext);
+    }
+    return ok;
+}
+
+#define SETTLED_PARSER(name, parser)                                               \
+    static bool TJUH_HOT_FUNC(name)(uint8_t dev_addr, const uint8_t *data,         \
+                                    uint16_t len, tjuh_gamepad_state_t *st,        \
+                                    tjuh_gamepad_ext_t *ext)                       \
+    {                                                                              \
+        return parse_settled(parser, dev_addr, data, len, st, ext);                \
+    }
+
+#if TJUH_ENABLE_SONY
+SETTLED_PARSER(settled_ds4,           TJUH_PARSER_DS4)
+SETTLED_PARSER(settled_dualsense,     TJUH_PARSER_DUALSENSE)
+#endif
+#if TJUH_ENABLE_SWITCH
+SETTLED_PARSER(settled_switch,        TJUH_PARSER_SWITCH)
+#endif
+#if TJUH_ENABLE_XBOX360
+SETTLED_PARSER(settled_xbox360,       TJUH_PARSER_XBOX360)
+#endif
+#if TJUH_ENABLE_XBOX_ONE
+SETTLED_PARSER(settled_xbox_one,      TJUH_PARSER_XBOX_ONE)
+#endif
+#if TJUH_ENABLE_GENERIC
+SETTLED_PARSER(settled_generic_8byte, TJUH_PARSER_GENERIC_8BYTE)
+SETTLED_PARSER(settled_generic_3byte, TJUH_PARSER_GENERIC_3BYTE)
+SETTLED_PARSER(settled_dinput,        TJUH_PARSER_DINPUT)
+#endif
+
+/* By parser; TJUH_PARSER_IGNORE is left to tjuh_parse_report() */
+static const tjuh_parse_fn_t s_settled[TJUH_PARSER_COUNT] = {
+#if TJUH_ENABLE_SONY
+    [TJUH_PARSER_DS4]           = settled_ds4,
+    [TJUH_PARSER_DUALSENSE]     = settled_dualsense,
+#endif
+#if TJUH_ENABLE_SWITCH
+    [TJUH_PARSER_SWITCH]        = settled_switch,
+#endif
+#if TJUH_ENABLE_XBOX360
+    [TJUH_PARSER_XBOX360]       = settled_xbox360,
+#endif
+#if TJUH_ENABLE_XBOX_ONE
+    [TJUH_PARSER_XBOX_ONE]      = settled_xbox_one,
+#endif
+#if TJUH_ENABLE_GENERIC
+    [TJUH_PARSER_GENERIC_8BYTE] = settled_generic_8byte,
+    [TJUH_PARSER_GENERIC_3BYTE] = settled_generic_3byte,
+    [TJUH_PARSER_DINPUT]        = settled_dinput,
+#endif
+};
+
+/* After anything Stage 2 depends on changed; a single pointer store */
+static void device_route(tjuh_device_entry_t *dev)
+{
+    bool settled = dev->vid != 0 && !dev->desc_pending && !dev->rebind &&
+                   dev->classify != CLASSIFY_PROBATION && dev->parser < TJUH_PARSER_COUNT;
+
+    tjuh_parse_settled[dev->dev_addr - 1] = settled ? s_settled[dev->parser] : NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Main dispatch                                                         */
+/* ---------------------------------------------------------------------- */
+
+bool TJUH_HOT_FUNC(tjuh_parse_report)(uint8_t dev_addr,
+                                      const uint8_t *data,
+                                      uint16_t actual_len,
+                                      uint16_t max_ep_size,
+                                      tjuh_gamepad_state_t *state_out,
+                                      tjuh_gamepad_ext_t *ext_out,
+                                      tjuh_hint_t hint)
+{
+    if (actual_len == 0)
+        return false;
+
+    tjuh_device_entry_t *dev = NULL;
+    if (dev_addr != 0 && dev_addr <= TJUH_MAX_DEVICES && s_devices[dev_addr - 1].vid != 0)
+        dev = &s_devices[dev_addr - 1];
+
+    const tjuh_input_map_t *map;
+    bool ok;
+
+    /* --- Stage 1: Hint-based routing (set during enumeration) --- */
+
+    /* Hints are only set for families that are compiled in */
+    (void)hint;
+#if TJUH_ENABLE_XBOX_ONE
+    if (hint == TJUH_HINT_XBOX_ONE) {
+        if (!dev)
+            return false;
+        map = (dev->parser == TJUH_PARSER_XBOX_ONE)
+              ? dev->map : tjuh_input_map_default(TJUH_PARSER_XBOX_ONE);
+        ok = parse_gip(dev, map, data, actual_len, state_out, ext_out);
+    } else
+#endif
+#if TJUH_ENABLE_SWITCH
+    if (hint == TJUH_HINT_SWITCH_PRO) {
+        map = (dev && dev->parser == TJUH_PARSER_SWITCH)
+              ? dev->map : tjuh_input_map_default(TJUH_PARSER_SWITCH);
+        ok = parse_switch(map, data, actual_len, state_out, ext_out);
+    } else
+#endif
+    if (dev && dev->desc_pending) {
+        /* Hold reports until the report descriptor has classified the device */
+        return false;
+    } else if (dev && dev->classify != CLASSIFY_PROBATION) {
+        /* --- Stage 2: Quirk table / report descriptor / committed parser --- */
+        map = dev->map;
+        ok  = parse_with(dev->parser, map, data, actual_len, state_out, ext_out);
+        if (ok && dev->rebind)
+            map = tjuh_remap_late(dev_addr, map, state_out);
+        if (dev->classify == CLASSIFY_COMMITTED)
+            committed_result(dev, ok);
+    } else {
+        /* --- Stage 3: Endpoint-size heuristic (generic / Xbox 360) --- */
+        uint8_t candidate = classify_by_endpoint_size(data, actual_len, max_ep_size);
+        if (!TJUH_PARSER_ENABLED(candidate))
+            candidate = TJUH_PARSER_AUTO;
+        if (dev)
+            probation_vote(dev, candidate);
+        map = tjuh_input_map_default(candidate);
+        ok  = parse_with(candidate, map, data, actual_len, state_out, ext_out);
+        /* The candidate changes from report to report: no tables are built */
+        if (ok && dev)
+            map = tjuh_remap_late(dev_addr, map, state_out);
+    }
+
+    /* Quirk axis inversion, then the map's (remap profile) axis transform */
+    if (ok) {
+        uint32_t quirk_xor = dev ? dev->axis_xor : 0u;
+        state_out->axes = tjuh_axes_transform(map, state_out->axes ^ quirk_xor);
+        if (ext_out)
+            ext_axes_transform(map, quirk_xor, ext_out);
+    }
 
-    return parse_by_endpoint_size(data, actual_len, max_ep_size, report_out);
+    return ok;
 }
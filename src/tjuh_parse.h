@@ -18,19 +18,125 @@ typedef enum {
     TJUH_HINT_SWITCH_PRO = 2,
 } tjuh_hint_t;
 
+/* Report parser selected for a device (see tjuh_quirks.c) */
+typedef enum {
+    TJUH_PARSER_AUTO          = 0,   /* endpoint-size heuristic */
+    TJUH_PARSER_DS4           = 1,
+    TJUH_PARSER_DUALSENSE     = 2,
+    TJUH_PARSER_SWITCH        = 3,
+    TJUH_PARSER_XBOX360       = 4,
+    TJUH_PARSER_XBOX_ONE      = 5,
+    TJUH_PARSER_GENERIC_8BYTE = 6,
+    TJUH_PARSER_GENERIC_3BYTE = 7,
+    TJUH_PARSER_IGNORE        = 8,   /* not a gamepad: drop its reports */
+    TJUH_PARSER_DINPUT        = 9,   /* DS4-like layout after report ID 1..4 */
+    TJUH_PARSER_COUNT
+} tjuh_parser_t;
+
+/* Parser compiled in (TJUH_ENABLE_SONY and friends); constant-folds */
+#define TJUH_PARSER_ENABLED(p)                                                    \
+    (((p) == TJUH_PARSER_DS4 || (p) == TJUH_PARSER_DUALSENSE) ? TJUH_ENABLE_SONY :  \
+     ((p) == TJUH_PARSER_SWITCH)   ? TJUH_ENABLE_SWITCH   :                         \
+     ((p) == TJUH_PARSER_XBOX360)  ? TJUH_ENABLE_XBOX360  :                         \
+     ((p) == TJUH_PARSER_XBOX_ONE) ? TJUH_ENABLE_XBOX_ONE :                         \
+     ((p) == TJUH_PARSER_GENERIC_8BYTE || (p) == TJUH_PARSER_GENERIC_3BYTE ||      \
+      (p) == TJUH_PARSER_DINPUT)   ? TJUH_ENABLE_GENERIC  : 1)
+
+/*
+ * Xbox One GIP packet header: command, flags, sequence number, payload
+ * length. The payload starts at byte 4.
+ */
+#define TJUH_GIP_CMD_ACK          0x01
+#define TJUH_GIP_CMD_ANNOUNCE     0x02
+#define TJUH_GIP_CMD_POWER        0x05
+#define TJUH_GIP_CMD_VIRTUAL_KEY  0x07   /* guide button */
+#define TJUH_GIP_CMD_INPUT        0x20
+
+#define TJUH_GIP_OPT_ACK          0x10   /* sender waits for an acknowledgement */
+#define TJUH_GIP_OPT_INTERNAL     0x20   /* protocol rather than device data */
+
+/*
+ * Report path placement (TJUH_HOT_PATH_IN_RAM): the sections the Pico
+ * SDK's __not_in_flash_func() uses, which crt0 copies to SRAM. Spelled
+ * out so the library does not depend on pico/platform.h. Data sections
+ * are named per object, as const data may not share a section with code.
+ */
+#if TJUH_HOT_PATH_IN_RAM && !TJUH_HOST_BUILD
+#define TJUH_HOT_FUNC(name) __attribute__((section(".time_critical." #name))) name
+#define TJUH_HOT_DATA(name) __attribute__((section(".time_critical.tjuh_" #name))) name
+#else
+#define TJUH_HOT_FUNC(name) name
+#define TJUH_HOT_DATA(name) name
+#endif
+
+/*
+ * Keep the original bit-by-bit button parsers and hand-coded axis decoding
+ * alongside the table-driven parsers so they can be compared report for
+ * report (bench/bench_parse.c).
+ */
+#ifndef TJUH_PARSE_REFERENCE
+#define TJUH_PARSE_REFERENCE TJUH_HOST_BUILD
+#endif
+
 /* Device registry */
 bool tjuh_parse_init_device(uint8_t dev_addr, uint16_t vid, uint16_t pid);
 bool tjuh_parse_free_device(uint8_t dev_addr);
 bool tjuh_parse_get_vid_pid(uint8_t dev_addr, uint16_t *vid, uint16_t *pid);
 
 /**
- * Parse a raw USB report into a unified gamepad report.
+ * True if the device has no parser from the quirk table yet and its HID
+ * report descriptor should be fetched for classification. Reports from
+ * such a device are held back until tjuh_parse_set_report_desc() runs.
+ */
+bool tjuh_parse_needs_report_desc(uint8_t dev_addr);
+
+/**
+ * Classify a device from its HID report descriptor: known fingerprints
+ * map straight to a parser, non-gamepad top-level usages (keyboard, mouse)
+ * are ignored, everything else falls back to the report heuristics.
+ * Pass desc = NULL if the descriptor is unavailable.
+ *
+ * @param desc       Descriptor bytes received (may be a prefix)
+ * @param len        Bytes in desc
+ * @param total_len  wDescriptorLength from the HID descriptor
+ *
+ * @return the descriptor fingerprint (0 if desc is NULL).
+ */
+uint32_t tjuh_parse_set_report_desc(uint8_t dev_addr, const uint8_t *desc,
+                                    uint16_t len, uint16_t total_len);
+
+/**
+ * Re-resolve the device's input map after its remap profile changed
+ * (tjuh_remap.c). Returns false if the device is not registered.
+ */
+bool tjuh_parse_rebind_map(uint8_t dev_addr);
+
+/**
+ * Work kept out of the report path: builds the remap tables of devices
+ * whose parser a report committed or reverted. Called from tjuh_task().
+ */
+void tjuh_parse_task(void);
+
+/**
+ * Parser the device's reports go through: from the quirk table, report
+ * descriptor or a committed heuristic. TJUH_PARSER_AUTO while it is
+ * still being classified.
+ */
+uint8_t tjuh_parse_get_parser(uint8_t dev_addr);
+
+/** Times the heuristic classifier changed its mind about a device. */
+uint16_t tjuh_parse_get_reclassify_count(uint8_t dev_addr);
+
+/**
+ * Parse a raw USB report into the unified gamepad state.
  *
  * @param dev_addr    TinyUSB device address
  * @param data        Raw report bytes
  * @param actual_len  Bytes received
  * @param max_ep_size Maximum endpoint packet size
- * @param report_out  Destination for parsed data
+ * @param state_out   Destination for parsed data
+ * @param ext_out     Destination for full-precision axes and analog
+ *                    triggers, filled in the same pass; NULL to skip
  * @param hint        Controller type hint from enumeration
  *
  * @return true if the report was successfully parsed.
@@ -39,9 +145,35 @@ bool tjuh_parse_report(uint8_t dev_addr,
                        const uint8_t *data,
                        uint16_t actual_len,
                        uint16_t max_ep_size,
-                       tjuh_gamepad_report_t *report_out,
+                       tjuh_gamepad_state_t *state_out,
+                       tjuh_gamepad_ext_t *ext_out,
                        tjuh_hint_t hint);
 
+typedef bool (*tjuh_parse_fn_t)(uint8_t dev_addr, const uint8_t *data, uint16_t len,
+                                tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext);
+
+/**
+ * Per device (index dev_addr - 1): its parser once that is settled (from
+ * the quirk table, the report descriptor or a committed heuristic), with
+ * the map and axis transforms of tjuh_parse_report() but none of its
+ * routing. NULL while the device is unknown, waiting for its descriptor
+ * or on probation. Reports with a hint still go through
+ * tjuh_parse_report().
+ */
+extern tjuh_parse_fn_t tjuh_parse_settled[TJUH_MAX_DEVICES];
+
+#if TJUH_PARSE_REFERENCE
+/* Run one parser directly: production (table-driven, word-aligned state),
+ * the same with the hand-coded axis decoding the report layouts replaced
+ * (tjuh_layout.h), or reference (bit-by-bit into the packed report) */
+bool tjuh_parse_with(uint8_t parser, const uint8_t *data, uint16_t len,
+                     tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext);
+bool tjuh_parse_with_handwritten(uint8_t parser, const uint8_t *data, uint16_t len,
+                                 tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext);
+bool tjuh_parse_with_reference(uint8_t parser, const uint8_t *data, uint16_t len,
+                               tjuh_gamepad_report_t *rpt);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
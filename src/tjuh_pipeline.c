@@ -0,0 +1,293 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Per-device report pipeline.
+ *
+ * Everything that happens to a report before the callbacks, for one
+ * device, runs as one function: the parser (with any remap profile
+ * already folded into its tables), then the stages the device has
+ * enabled — stick conditioning and change detection — on the state still
+ * in registers. Once the device's parser is settled the variant calls it
+ * straight from tjuh_parse_settled[], skipping tjuh_parse_report() and
+ * its choice of parser.
+ *
+ * There is one pre-generated variant per combination of stages, each the
+ * same inline body with the stage set as a constant, so a variant holds
+ * only the code of its own stages and no per-stage tests or calls. A
+ * device's variant is picked when its configuration changes (mount,
+ * tjuh_init, a new conditioning profile), not per report.
+ *
+ * Every variant ends by comparing the state with the device's previous
+ * report, which change detection needs anyway, into a tjuh_report_delta_t
+ * for the modules after the callbacks.
+ */
+
+#include "tjuh_pipeline.h"
+#include "tjuh_condition.h"
+#include "tjuh_buttons.h"
+#include <string.h>
+
+typedef struct pipeline pipeline_t;
+
+#define PIPELINE_PARAMS                                                                \
+    pipeline_t *p, uint8_t dev_addr, const uint8_t *data, uint16_t len,               \
+    uint16_t max_ep_size, tjuh_hint_t hint, tjuh_gamepad_state_t *st,                 \
+    tjuh_gamepad_ext_t *ext, tjuh_report_delta_t *delta
+
+#define PIPELINE_ARGS p, dev_addr, data, len, max_ep_size, hint, st, ext, delta
+
+typedef uint8_t (*pipeline_fn_t)(PIPELINE_PARAMS);
+
+struct pipeline {
+    pipeline_fn_t           handler;
+    uint8_t                 stages;
+    bool                    have_last;  /* change detection: deliver the next report if not */
+    const tjuh_condition_t *cond;
+    tjuh_gamepad_state_t    last;       /* previous report */
+    tjuh_gamepad_ext_t      last_ext;   /* last delivered, change detection */
+};
+
+static pipeline_t s_pipeline[TJUH_MAX_DEVICES];
+static pipeline_t s_pipeline_any;       /* addresses without a device slot */
+
+static bool s_want_ext;
+static bool s_changes_only;
+
+static const tjuh_gamepad_state_t TJUH_HOT_DATA(s_zero_state) = {0};
+
+/* ---------------------------------------------------------------------- */
+/*  Stages                                                                */
+/* ---------------------------------------------------------------------- */
+
+static inline bool state_same(const tjuh_gamepad_state_t *a, const tjuh_gamepad_state_t *b)
+{
+    return a->buttons == b->buttons && a->axes == b->axes && a->hat == b->hat;
+}
+
+/*
+ * New unless it equals the last delivered report; remembers it if new.
+ * Reports that are not new equal the last delivered one, so `last` is
+ * also the previous report.
+ */
+static inline bool stage_changed(pipeline_t *p, const tjuh_gamepad_state_t *st,
+                                 const tjuh_gamepad_ext_t *ext)
+{
+    if (p->have_last && state_same(st, &p->last) &&
+        (!ext || memcmp(ext, &p->last_ext, sizeof(*ext)) == 0))
+        return false;
+
+    p->have_last = true;
+    if (ext)
+        p->last_ext = *ext;
+    return true;
+}
+
+/* What changed since the previous report; it becomes the previous one */
+static inline void stage_delta(pipeline_t *p, const tjuh_gamepad_state_t *st,
+                               tjuh_report_delta_t *delta)
+{
+    tjuh_report_delta(&p->last, st, delta);
+    p->last = *st;
+}
+
+/* The pipeline body; `stages` is a constant in every variant */
+static inline __attribute__((always_inline))
+uint8_t pipeline_body(PIPELINE_PARAMS, const uint8_t stages)
+{
+    const bool want_ext = (stages & TJUH_STAGE_EXT) != 0;
+
+    *st = s_zero_state;
+    if (want_ext)
+        memset(ext, 0, sizeof(*ext));
+
+    /* A settled device's parser directly; the rest through the routing */
+    tjuh_parse_fn_t parse = (hint == TJUH_HINT_NONE && p != &s_pipeline_any)
+                            ? tjuh_parse_settled[dev_addr - 1] : NULL;
+    bool ok = parse ? parse(dev_addr, data, len, st, want_ext ? ext : NULL)
+                    : tjuh_parse_report(dev_addr, data, len, max_ep_size, st,
+                                        want_ext ? ext : NULL, hint);
+    if (!ok)
+        return 0;
+
+    if (stages & TJUH_STAGE_CONDITION)
+        tjuh_condition_apply(p->cond, st, ext);
+
+    uint8_t result = TJUH_PIPELINE_PARSED | TJUH_PIPELINE_CHANGED;
+    if ((stages & TJUH_STAGE_CHANGES) && !stage_changed(p, st, want_ext ? ext : NULL))
+        result = TJUH_PIPELINE_PARSED;
+
+    stage_delta(p, st, delta);
+    return result;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Variants                                                              */
+/* ---------------------------------------------------------------------- */
+
+#define PIPELINE_VARIANT(name, stages)                        \
+    static uint8_t TJUH_HOT_FUNC(name)(PIPELINE_PARAMS)       \
+    {                                                         \
+        return pipeline_body(PIPELINE_ARGS, stages);          \
+    }
+
+PIPELINE_VARIANT(pipeline_parse,       0)
+PIPELINE_VARIANT(pipeline_ext,         TJUH_STAGE_EXT)
+PIPELINE_VARIANT(pipeline_changes,     TJUH_STAGE_CHANGES)
+PIPELINE_VARIANT(pipeline_ext_changes, TJUH_STAGE_EXT | TJUH_STAGE_CHANGES)
+#if TJUH_ENABLE_CONDITION
+PIPELINE_VARIANT(pipeline_condition,   TJUH_STAGE_EXT | TJUH_STAGE_CONDITION)
+PIPELINE_VARIANT(pipeline_condition_changes,
+                 TJUH_STAGE_EXT | TJUH_STAGE_CONDITION | TJUH_STAGE_CHANGES)
+#endif
+
+/* By stage set; conditioning without the extended report never happens */
+static const pipeline_fn_t s_variants[TJUH_STAGE_COMBINATIONS] = {
+    [0]                                       = pipeline_parse,
+    [TJUH_STAGE_EXT]                          = pipeline_ext,
+    [TJUH_STAGE_CHANGES]                      = pipeline_changes,
+    [TJUH_STAGE_EXT | TJUH_STAGE_CHANGES]     = pipeline_ext_changes,
+#if TJUH_ENABLE_CONDITION
+    [TJUH_STAGE_EXT | TJUH_STAGE_CONDITION]   = pipeline_condition,
+    [TJUH_STAGE_EXT | TJUH_STAGE_CONDITION | TJUH_STAGE_CHANGES] = pipeline_condition_changes,
+#endif
+};
+
+/* ---------------------------------------------------------------------- */
+/*  Composition                                                           */
+/* ---------------------------------------------------------------------- */
+
+/* Keeps the previous report: what the buttons were does not change with
+ * the stages */
+static void compose(pipeline_t *p, const tjuh_condition_t *cond, bool changes)
+{
+    uint8_t stages = s_want_ext ? TJUH_STAGE_EXT : 0;
+
+    if (changes)
+        stages |= TJUH_STAGE_CHANGES;
+    if (cond)
+        stages |= TJUH_STAGE_EXT | TJUH_STAGE_CONDITION;
+
+    p->stages    = stages;
+    p->cond      = cond;
+    p->handler   = s_variants[stages];
+    p->have_last = false;
+}
+
+static void forget(pipeline_t *p)
+{
+    memset(p, 0, sizeof(*p));
+    p->last.hat = TJUH_HAT_RELEASED;
+}
+
+void tjuh_pipeline_configure(bool ext, bool changes_only)
+{
+    s_want_ext     = ext;
+    s_changes_only = changes_only;
+
+    for (uint8_t i = 0; i < TJUH_MAX_DEVICES; i++) {
+        forget(&s_pipeline[i]);
+        compose(&s_pipeline[i], tjuh_condition_get((uint8_t)(i + 1)), changes_only);
+    }
+
+    /* Reports of different devices share it: no change detection */
+    forget(&s_pipeline_any);
+    compose(&s_pipeline_any, NULL, false);
+}
+
+void tjuh_pipeline_rebuild(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+    compose(&s_pipeline[dev_addr - 1], tjuh_condition_get(dev_addr), s_changes_only);
+}
+
+void tjuh_pipeline_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+    forget(&s_pipeline[dev_addr - 1]);
+    compose(&s_pipeline[dev_addr - 1], NULL, s_changes_only);
+}
+
+uint8_t tjuh_pipeline_stages(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return s_pipeline_any.stages;
+    return s_pipeline[dev_addr - 1].stages;
+}
+
+uint8_t TJUH_HOT_FUNC(tjuh_pipeline_run)(uint8_t dev_addr, const uint8_t *data, uint16_t len,
+                                         uint16_t max_ep_size, tjuh_hint_t hint,
+                                         tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext,
+                                         tjuh_report_delta_t *delta)
+{
+    pipeline_t *p = (dev_addr != 0 && dev_addr <= TJUH_MAX_DEVICES)
+                    ? &s_pipeline[dev_addr - 1] : &s_pipeline_any;
+
+    /* Before tjuh_pipeline_configure(): parse only */
+    if (!p->handler)
+        return pipeline_parse(PIPELINE_ARGS);
+    return p->handler(PIPELINE_ARGS);
+}
+
+#if TJUH_PARSE_REFERENCE
+
+/* ---------------------------------------------------------------------- */
+/*  Staged reference                                                      */
+/* ---------------------------------------------------------------------- */
+
+static __attribute__((noinline)) bool staged_parse(uint8_t dev_addr, const uint8_t *data,
+                                                   uint16_t len, uint16_t max_ep_size,
+                                                   tjuh_hint_t hint, tjuh_gamepad_state_t *st,
+                                                   tjuh_gamepad_ext_t *ext)
+{
+    *st = s_zero_state;
+    if (ext)
+        memset(ext, 0, sizeof(*ext));
+    return tjuh_parse_report(dev_addr, data, len, max_ep_size, st, ext, hint);
+}
+
+static __attribute__((noinline)) void staged_condition(const tjuh_condition_t *cond,
+                                                       tjuh_gamepad_state_t *st,
+                                                       tjuh_gamepad_ext_t *ext)
+{
+    tjuh_condition_apply(cond, st, ext);
+}
+
+static __attribute__((noinline)) bool staged_changed(pipeline_t *p,
+                                                     const tjuh_gamepad_state_t *st,
+                                                     const tjuh_gamepad_ext_t *ext)
+{
+    return stage_changed(p, st, ext);
+}
+
+static __attribute__((noinline)) void staged_delta(pipeline_t *p,
+                                                   const tjuh_gamepad_state_t *st,
+                                                   tjuh_report_delta_t *delta)
+{
+    stage_delta(p, st, delta);
+}
+
+uint8_t tjuh_pipeline_run_staged(uint8_t dev_addr, const uint8_t *data, uint16_t len,
+                                 uint16_t max_ep_size, tjuh_hint_t hint,
+                                 tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext,
+                                 tjuh_report_delta_t *delta)
+{
+    pipeline_t *p = (dev_addr != 0 && dev_addr <= TJUH_MAX_DEVICES)
+                    ? &s_pipeline[dev_addr - 1] : &s_pipeline_any;
+    tjuh_gamepad_ext_t *e = (p->stages & TJUH_STAGE_EXT) ? ext : NULL;
+
+    if (!staged_parse(dev_addr, data, len, max_ep_size, hint, st, e))
+        return 0;
+
+    if (p->stages & TJUH_STAGE_CONDITION)
+        staged_condition(p->cond, st, ext);
+
+    uint8_t result = TJUH_PIPELINE_PARSED | TJUH_PIPELINE_CHANGED;
+    if ((p->stages & TJUH_STAGE_CHANGES) && !staged_changed(p, st, e))
+        result = TJUH_PIPELINE_PARSED;
+
+    staged_delta(p, st, delta);
+    return result;
+}
+
+#endif /* TJUH_PARSE_REFERENCE */
@@ -0,0 +1,71 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal per-device report pipeline interface.
+ */
+
+#ifndef TJUH_PIPELINE_H
+#define TJUH_PIPELINE_H
+
+#include "tjuh.h"
+#include "tjuh_parse.h"
+#include "tjuh_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stages run on a report; the parser always runs */
+#define TJUH_STAGE_EXT        0x01   /* decode the extended report */
+#define TJUH_STAGE_CONDITION  0x02   /* stick conditioning, implies TJUH_STAGE_EXT */
+#define TJUH_STAGE_CHANGES    0x04   /* change detection against the last report */
+#define TJUH_STAGE_COMBINATIONS 8
+
+/* tjuh_pipeline_run() result bits */
+#define TJUH_PIPELINE_PARSED   0x01
+#define TJUH_PIPELINE_CHANGED  0x02  /* deliver: parsed and new (always, without change detection) */
+
+/**
+ * Stages wanted for every device: the extended report (on_ext set) and
+ * change detection (tjuh_config_t.changes_only). Rebuilds all pipelines.
+ */
+void tjuh_pipeline_configure(bool ext, bool changes_only);
+
+/**
+ * Recompose a device's pipeline after its configuration changed (mount,
+ * conditioning profile). The next report is delivered; edges are still
+ * taken against the previous one.
+ */
+void tjuh_pipeline_rebuild(uint8_t dev_addr);
+
+/** Back to the configured stages and no previous report, on disconnect. */
+void tjuh_pipeline_release(uint8_t dev_addr);
+
+/** Stages the device's pipeline was composed from (TJUH_STAGE_*). */
+uint8_t tjuh_pipeline_stages(uint8_t dev_addr);
+
+/**
+ * Parse a report and run the device's other stages in one pass.
+ * `ext` is only written when the pipeline has TJUH_STAGE_EXT; `delta`
+ * only when the report parsed.
+ *
+ * @return TJUH_PIPELINE_* bits.
+ */
+uint8_t tjuh_pipeline_run(uint8_t dev_addr, const uint8_t *data, uint16_t len,
+                          uint16_t max_ep_size, tjuh_hint_t hint,
+                          tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext,
+                          tjuh_report_delta_t *delta);
+
+#if TJUH_PARSE_REFERENCE
+/* The same stages as separate calls chosen per report, which the composed
+ * pipelines replace; for bench/bench_pipeline.c */
+uint8_t tjuh_pipeline_run_staged(uint8_t dev_addr, const uint8_t *data, uint16_t len,
+                                 uint16_t max_ep_size, tjuh_hint_t hint,
+                                 tjuh_gamepad_state_t *st, tjuh_gamepad_ext_t *ext,
+                                 tjuh_report_delta_t *delta);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_PIPELINE_H */
@@ -0,0 +1,349 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Controller quirk database.
+ *
+ * All controller-specific VID/PID knowledge lives in one sorted const table
+ * (flash-resident on RP2040/RP2350). It is searched once per device at
+ * enumeration; the result is cached in the device registry, so the table
+ * can grow to thousands of clone IDs without any per-report cost or RAM.
+ *
+ * A second table can be attached at runtime from a CRC-checked blob in a
+ * flash region. It is searched in place with the same binary search, so
+ * data-only updates cost the same per lookup as built-in entries.
+ */
+
+#include "tjuh_quirks.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#if TJUH_HOST_BUILD
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* ---------------------------------------------------------------------- */
+/*  Table                                                                 */
+/*                                                                        */
+/*  Keep sorted by VID, then PID. TJUH_QUIRK_PID_ANY (0xFFFF) entries     */
+/*  sort last within their vendor.                                        */
+/* ---------------------------------------------------------------------- */
+
+#define Q(vid, pid, parser, init, flags, poll_ms) \
+    { (vid), (pid), (parser), (init), (flags), (poll_ms) }
+
+/*
+ * Rows of families that are compiled out are dropped (TJUH_ENABLE_SONY
+ * and friends). A generic-only build has no rows at all.
+ */
+#if TJUH_ENABLE_SONY || TJUH_ENABLE_SWITCH || TJUH_ENABLE_XBOX360 || TJUH_ENABLE_XBOX_ONE
+#define HAVE_QUIRKS 1
+#else
+#define HAVE_QUIRKS 0
+#endif
+
+#if HAVE_QUIRKS
+
+static const tjuh_quirk_t s_quirks[] = {
+    /* Microsoft */
+#if TJUH_ENABLE_XBOX360
+    Q(0x045E, 0x028E, TJUH_PARSER_XBOX360,   TJUH_INIT_NONE,       0, 0), /* Xbox 360 Wired         */
+#endif
+#if TJUH_ENABLE_XBOX_ONE
+    Q(0x045E, 0x02D1, TJUH_PARSER_XBOX_ONE,  TJUH_INIT_XBOX_ONE,   0, 0), /* Xbox One               */
+    Q(0x045E, 0x02DD, TJUH_PARSER_XBOX_ONE,  TJUH_INIT_XBOX_ONE,   0, 0), /* Xbox One (2015 fw)     */
+    Q(0x045E, 0x02E3, TJUH_PARSER_XBOX_ONE,  TJUH_INIT_XBOX_ONE,   0, 0), /* Xbox One Elite         */
+    Q(0x045E, 0x02EA, TJUH_PARSER_XBOX_ONE,  TJUH_INIT_XBOX_ONE,   0, 0), /* Xbox One S             */
+    Q(0x045E, 0x0B00, TJUH_PARSER_XBOX_ONE,  TJUH_INIT_XBOX_ONE,   0, 0), /* Xbox Elite Series 2    */
+    Q(0x045E, 0x0B12, TJUH_PARSER_XBOX_ONE,  TJUH_INIT_XBOX_ONE,   0, 0), /* Xbox Series X|S        */
+#endif
+
+#if TJUH_ENABLE_SONY
+    /* Sony */
+    Q(0x054C, 0x05C4, TJUH_PARSER_DS4,       TJUH_INIT_NONE,       0, 0), /* DualShock 4 CUH-ZCT1   */
+    Q(0x054C, 0x09CC, TJUH_PARSER_DS4,       TJUH_INIT_NONE,       0, 0), /* DualShock 4 CUH-ZCT2   */
+    Q(0x054C, 0x0CE6, TJUH_PARSER_DUALSENSE, TJUH_INIT_NONE,       0, 0), /* DualSense              */
+    Q(0x054C, 0x0DF2, TJUH_PARSER_DUALSENSE, TJUH_INIT_NONE,       0, 0), /* DualSense Edge         */
+    Q(0x054C, 0xFFFF, TJUH_PARSER_DS4,       TJUH_INIT_NONE,       0, 0), /* DS4 layout (clones)    */
+#endif
+
+#if TJUH_ENABLE_SWITCH
+    /* Nintendo */
+    Q(0x057E, 0x2006, TJUH_PARSER_SWITCH,    TJUH_INIT_SWITCH_USB, 0, 0), /* Joy-Con (L)            */
+    Q(0x057E, 0x2007, TJUH_PARSER_SWITCH,    TJUH_INIT_SWITCH_USB, 0, 0), /* Joy-Con (R)            */
+    Q(0x057E, 0x2009, TJUH_PARSER_SWITCH,    TJUH_INIT_SWITCH_USB, 0, 0), /* Switch Pro Controller  */
+    Q(0x057E, 0xFFFF, TJUH_PARSER_SWITCH,    TJUH_INIT_NONE,       0, 0), /* Switch-compatible      */
+#endif
+};
+
+#define QUIRK_COUNT (sizeof(s_quirks) / sizeof(s_quirks[0]))
+
+#else
+
+#define s_quirks    ((const tjuh_quirk_t *)NULL)
+#define QUIRK_COUNT 0u
+
+#endif /* HAVE_QUIRKS */
+
+#undef Q
+
+/* ---------------------------------------------------------------------- */
+/*  HID report descriptor fingerprints                                    */
+/*                                                                        */
+/*  Keep sorted by hash. TJUH logs the fingerprint of every unclassified  */
+/*  device at enumeration; add entries from real hardware only.           */
+/* ---------------------------------------------------------------------- */
+
+#define FP(hash, desc_len, parser, flags) \
+    { (hash), (desc_len), (parser), (flags) }
+
+static const tjuh_fingerprint_t s_fingerprints[] = {
+#if TJUH_ENABLE_GENERIC
+    /* DragonRise 0079:0006 joystick; the same chip ships under many other IDs */
+    FP(0x09C9B29F,  99, TJUH_PARSER_GENERIC_8BYTE, 0),  /* axes listed Z Rz X Y     */
+    FP(0xAF4BC9FA, 101, TJUH_PARSER_GENERIC_8BYTE, 0),  /* axes listed X Y Z Z Rz   */
+#endif
+    FP(0xC67BAD2C,  63, TJUH_PARSER_IGNORE,        0),  /* HID 1.11 boot keyboard (Appendix E.6) */
+};
+
+#undef FP
+
+#define FINGERPRINT_COUNT (sizeof(s_fingerprints) / sizeof(s_fingerprints[0]))
+
+/* ---------------------------------------------------------------------- */
+/*  Lookup                                                                */
+/* ---------------------------------------------------------------------- */
+
+static inline uint32_t quirk_key(uint16_t vid, uint16_t pid)
+{
+    return ((uint32_t)vid << 16) | pid;
+}
+
+static const tjuh_quirk_t *quirk_find(const tjuh_quirk_t *table, uint32_t count, uint32_t key)
+{
+    uint32_t lo = 0;
+    uint32_t hi = count;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        uint32_t k   = quirk_key(table[mid].vid, table[mid].pid);
+
+        if (k == key)
+            return &table[mid];
+        if (k < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Runtime blob                                                          */
+/* ---------------------------------------------------------------------- */
+
+static const tjuh_quirk_t       *s_blob_entries;
+static uint32_t                  s_blob_count;
+static const tjuh_fingerprint_t *s_blob_fps;
+static uint32_t                  s_blob_fp_count;
+
+static uint32_t crc32_ieee(const uint8_t *data, uint32_t len)
+{
+    /* Bitwise: runs once per attach, not worth 1 KiB of table */
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+static bool blob_entries_valid(const tjuh_quirk_t *e, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        if (e[i].parser >= TJUH_PARSER_COUNT || e[i].init > TJUH_INIT_XBOX_ONE)
+            return false;
+
+        /* Binary search needs strictly ascending keys */
+        if (i > 0 && quirk_key(e[i].vid, e[i].pid) <= quirk_key(e[i - 1].vid, e[i - 1].pid))
+            return false;
+    }
+    return true;
+}
+
+static bool blob_fingerprints_valid(const tjuh_fingerprint_t *f, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        if (f[i].parser >= TJUH_PARSER_COUNT)
+            return false;
+        if (i > 0 && f[i].hash <= f[i - 1].hash)
+            return false;
+    }
+    return true;
+}
+
+bool tjuh_quirk_blob_attach(const void *blob, uint32_t len)
+{
+    const tjuh_quirk_blob_header_t *hdr = (const tjuh_quirk_blob_header_t *)blob;
+
+    if (!blob || ((uintptr_t)blob & 3u) || len < sizeof(*hdr))
+        return false;
+
+    if (hdr->magic != TJUH_QUIRK_BLOB_MAGIC ||
+        hdr->version < 1 || hdr->version > TJUH_QUIRK_BLOB_VERSION ||
+        hdr->entry_size != sizeof(tjuh_quirk_t))
+        return false;
+
+    /* Version 1 had no fingerprint section; the field was reserved */
+    if (hdr->version == 1 && hdr->fp_count != 0)
+        return false;
+
+    uint32_t avail = len - (uint32_t)sizeof(*hdr);
+    if (hdr->count > avail / sizeof(tjuh_quirk_t))
+        return false;
+
+    uint32_t quirk_len = hdr->count * (uint32_t)sizeof(tjuh_quirk_t);
+    uint32_t fp_len    = hdr->fp_count * (uint32_t)sizeof(tjuh_fingerprint_t);
+    if (fp_len > avail - quirk_len)
+        return false;
+
+    const uint8_t *payload = (const uint8_t *)blob + sizeof(*hdr);
+
+    if (crc32_ieee(payload, quirk_len + fp_len) != hdr->crc32)
+        return false;
+
+    const tjuh_quirk_t       *entries = (const tjuh_quirk_t *)payload;
+    const tjuh_fingerprint_t *fps     = (const tjuh_fingerprint_t *)(payload + quirk_len);
+
+    if (!blob_entries_valid(entries, hdr->count) ||
+        !blob_fingerprints_valid(fps, hdr->fp_count))
+        return false;
+
+    s_blob_entries  = entries;
+    s_blob_count    = hdr->count;
+    s_blob_fps      = fps;
+    s_blob_fp_count = hdr->fp_count;
+    return true;
+}
+
+void tjuh_quirk_blob_detach(void)
+{
+    s_blob_entries  = NULL;
+    s_blob_count    = 0;
+    s_blob_fps      = NULL;
+    s_blob_fp_count = 0;
+}
+
+#if TJUH_HOST_BUILD
+
+bool tjuh_quirk_blob_map_file(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || st.st_size > UINT32_MAX) {
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    if (!tjuh_quirk_blob_attach(map, (uint32_t)st.st_size)) {
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+
+    /* The mapping stays alive for the life of the process, like flash */
+    return true;
+}
+
+#endif /* TJUH_HOST_BUILD */
+
+/* ---------------------------------------------------------------------- */
+/*  Public lookup                                                         */
+/* ---------------------------------------------------------------------- */
+
+static const tjuh_quirk_t *quirk_find_all(uint32_t key)
+{
+    const tjuh_quirk_t *q = NULL;
+
+    /* Blob entries may name a family this build leaves out; the built-in
+     * entry for the same key still applies then */
+    if (s_blob_count) {
+        q = quirk_find(s_blob_entries, s_blob_count, key);
+        if (q && TJUH_PARSER_ENABLED(q->parser))
+            return q;
+    }
+
+    q = quirk_find(s_quirks, QUIRK_COUNT, key);
+    return (q && TJUH_PARSER_ENABLED(q->parser)) ? q : NULL;
+}
+
+const tjuh_quirk_t *tjuh_quirk_lookup(uint16_t vid, uint16_t pid)
+{
+    const tjuh_quirk_t *q = quirk_find_all(quirk_key(vid, pid));
+    if (q)
+        return q;
+
+    return quirk_find_all(quirk_key(vid, TJUH_QUIRK_PID_ANY));
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Fingerprint lookup                                                    */
+/* ---------------------------------------------------------------------- */
+
+uint32_t tjuh_fnv1a(uint32_t hash, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+static const tjuh_fingerprint_t *fingerprint_find(const tjuh_fingerprint_t *table,
+                                                  uint32_t count, uint32_t hash)
+{
+    uint32_t lo = 0;
+    uint32_t hi = count;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+
+        if (table[mid].hash == hash)
+            return &table[mid];
+        if (table[mid].hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return NULL;
+}
+
+const tjuh_fingerprint_t *tjuh_fingerprint_lookup(uint32_t hash, uint16_t desc_len)
+{
+    const tjuh_fingerprint_t *f = NULL;
+
+    /* The length guards against the rare 32-bit hash collision, so a blob
+     * entry that fails it, or names a family left out, does not hide a
+     * built-in fingerprint with the same hash */
+    if (s_blob_fp_count) {
+        f = fingerprint_find(s_blob_fps, s_blob_fp_count, hash);
+        if (f && f->desc_len == desc_len && TJUH_PARSER_ENABLED(f->parser))
+            return f;
+    }
+
+    f = fingerprint_find(s_fingerprints, FINGERPRINT_COUNT, hash);
+    if (!f || f->desc_len != desc_len || !TJUH_PARSER_ENABLED(f->parser))
+        return NULL;
+    return f;
+}
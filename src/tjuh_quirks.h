@@ -0,0 +1,117 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Controller quirk database: per VID/PID parser, init script and flags.
+ */
+
+#ifndef TJUH_QUIRKS_H
+#define TJUH_QUIRKS_H
+
+#include "tjuh_parse.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Matches every PID of a vendor; exact entries take precedence */
+#define TJUH_QUIRK_PID_ANY      0xFFFF
+
+/* Quirk flags */
+#define TJUH_QUIRK_INVERT_X     0x01
+#define TJUH_QUIRK_INVERT_Y     0x02
+#define TJUH_QUIRK_INVERT_Z     0x04
+#define TJUH_QUIRK_INVERT_RZ    0x08
+#define TJUH_QUIRK_INVERT_MASK  0x0F
+#define TJUH_QUIRK_SET_IDLE     0x10   /* send HID SET_IDLE(0): report on change only */
+
+typedef enum {
+    TJUH_INIT_NONE       = 0,
+    TJUH_INIT_SWITCH_USB = 1,   /* 80 02 handshake + 80 04 force USB */
+    TJUH_INIT_XBOX_ONE   = 2,   /* GIP power-on */
+} tjuh_init_script_t;
+
+/*
+ * One table entry. Fixed 8-byte layout, sorted by (vid, pid) so lookups
+ * are a binary search over flash-resident data.
+ */
+typedef struct {
+    uint16_t vid;
+    uint16_t pid;
+    uint8_t  parser;    /* tjuh_parser_t      */
+    uint8_t  init;      /* tjuh_init_script_t */
+    uint8_t  flags;     /* TJUH_QUIRK_*       */
+    uint8_t  poll_ms;   /* 0 = use the endpoint's bInterval */
+} tjuh_quirk_t;
+
+_Static_assert(sizeof(tjuh_quirk_t) == 8, "tjuh_quirk_t must stay 8 bytes");
+
+/*
+ * HID report descriptor fingerprint: FNV-1a over the descriptor bytes as
+ * fetched during enumeration, matched together with the declared length.
+ * Sorted by hash. Lets clones with random VID/PIDs but a known layout skip the
+ * report heuristics.
+ */
+typedef struct {
+    uint32_t hash;
+    uint16_t desc_len;  /* wDescriptorLength */
+    uint8_t  parser;    /* tjuh_parser_t */
+    uint8_t  flags;     /* TJUH_QUIRK_* */
+} tjuh_fingerprint_t;
+
+_Static_assert(sizeof(tjuh_fingerprint_t) == 8, "tjuh_fingerprint_t must stay 8 bytes");
+
+/*
+ * Runtime quirk blob (little-endian, 4-byte aligned):
+ *
+ *   offset  size  field
+ *   0       4     magic "TJQB"
+ *   4       1     version (1 or 2)
+ *   5       1     entry size (sizeof(tjuh_quirk_t))
+ *   6       2     fingerprint count (version 2; 0 in version 1)
+ *   8       4     quirk entry count
+ *   12      4     CRC-32 (IEEE) of everything after the header
+ *   16      ...   tjuh_quirk_t entries, sorted like the built-in table
+ *   ...     ...   tjuh_fingerprint_t entries, sorted by hash
+ */
+#define TJUH_QUIRK_BLOB_MAGIC    0x42514A54u   /* "TJQB" */
+#define TJUH_QUIRK_BLOB_VERSION  2
+
+typedef struct {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  entry_size;
+    uint16_t fp_count;
+    uint32_t count;
+    uint32_t crc32;
+} tjuh_quirk_blob_header_t;
+
+_Static_assert(sizeof(tjuh_quirk_blob_header_t) == 16, "blob header must stay 16 bytes");
+
+/**
+ * Look up the quirk entry for a device: exact VID/PID first, then the
+ * vendor-wide TJUH_QUIRK_PID_ANY entry. At each step the attached blob
+ * is searched before the built-in table, so a device no table knows
+ * costs four binary searches. That happens once per device at
+ * enumeration; merging the tables at attach time would need a RAM copy
+ * of both (bench/bench_quirks.c times each case).
+ *
+ * @return entry in flash, or NULL if the device is unknown.
+ */
+const tjuh_quirk_t *tjuh_quirk_lookup(uint16_t vid, uint16_t pid);
+
+/* FNV-1a, 32-bit. Chain calls to hash data in pieces. */
+#define TJUH_FNV1A_INIT  0x811C9DC5u
+
+uint32_t tjuh_fnv1a(uint32_t hash, const uint8_t *data, uint32_t len);
+
+/**
+ * Look up a HID report descriptor fingerprint, blob first.
+ *
+ * @return entry in flash, or NULL if the layout is unknown.
+ */
+const tjuh_fingerprint_t *tjuh_fingerprint_lookup(uint32_t hash, uint16_t desc_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_QUIRKS_H */
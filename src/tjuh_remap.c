@@ -0,0 +1,208 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Per-device button/axis remap profiles.
+ *
+ * A profile is never applied to a parsed report. Instead it is compiled
+ * into copies of the device's button lookup tables (each entry's button
+ * bits moved to their destinations) plus an axis rotate/XOR, and the
+ * parser runs on those exactly as it runs on the built-in tables.
+ *
+ * Tables live in banks, one more than TJUH_MAX_DEVICES: a new profile is
+ * always built into a bank no device is reading, then published by the
+ * parser with a single pointer store, and the device's previous bank
+ * becomes the free one.
+ *
+ * Banks are built when a profile is set or a device's parser is fixed,
+ * never while a report is parsed. A device still being classified, or
+ * whose parser a report has just committed, gets its profile applied to
+ * the parsed report instead until tjuh_parse_task() builds the bank.
+ */
+
+#include "tjuh_remap.h"
+#include "tjuh_parse.h"
+#include <string.h>
+
+#if TJUH_ENABLE_REMAP
+
+/* ---------------------------------------------------------------------- */
+/*  Banks                                                                 */
+/* ---------------------------------------------------------------------- */
+
+/*
+ * Tables carrying buttons in the largest built-in map (Switch: three for
+ * the full report, two for the simple one). Hat-only and zero tables are
+ * not affected by a profile and stay shared with the built-in map.
+ */
+#define REMAP_BANK_TABLES 5
+#define REMAP_BANKS       (TJUH_MAX_DEVICES + 1)
+
+typedef struct {
+    tjuh_input_map_t  map;
+    tjuh_button_lut_t lut[REMAP_BANK_TABLES];
+    uint8_t           owner;    /* dev_addr, 0 = free */
+} remap_bank_t;
+
+static remap_bank_t s_banks[REMAP_BANKS];
+
+static tjuh_remap_profile_t s_profiles[TJUH_MAX_DEVICES];
+static bool                 s_profile_set[TJUH_MAX_DEVICES];
+static tjuh_input_map_t     s_late_axes[TJUH_MAX_DEVICES];  /* axis transform only */
+
+static remap_bank_t *bank_owned_by(uint8_t dev_addr)
+{
+    for (uint8_t i = 0; i < REMAP_BANKS; i++) {
+        if (s_banks[i].owner == dev_addr)
+            return &s_banks[i];
+    }
+    return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Profile compilation                                                   */
+/* ---------------------------------------------------------------------- */
+
+static bool profile_moves_buttons(const tjuh_remap_profile_t *p)
+{
+    for (uint8_t b = 0; b < TJUH_BUTTON_COUNT; b++) {
+        if (p->button[b] != b)
+            return true;
+    }
+    return false;
+}
+
+static uint32_t remap_word(const tjuh_remap_profile_t *p, uint32_t word)
+{
+    uint32_t out = word & ~TJUH_BTN_BUTTON_MASK;
+
+    for (uint8_t b = 0; b < TJUH_BUTTON_COUNT; b++) {
+        if ((word & TJUH_BUTTON_MASK(b)) && p->button[b] != TJUH_BUTTON_NONE)
+            out |= TJUH_BUTTON_MASK(p->button[b]);
+    }
+    return out;
+}
+
+static bool lut_has_buttons(const tjuh_button_lut_t *lut)
+{
+    for (uint16_t i = 0; i < 256; i++) {
+        if ((*lut)[i] & TJUH_BTN_BUTTON_MASK)
+            return true;
+    }
+    return false;
+}
+
+static bool build_bank(remap_bank_t *bank, const tjuh_input_map_t *base,
+                       const tjuh_remap_profile_t *p)
+{
+    uint8_t used = 0;
+
+    bank->map = *base;
+    bank->map.axis_rot = p->swap_sticks ? 16 : 0;
+    bank->map.axis_xor = tjuh_axes_invert_mask(p->axis_invert);
+
+    /* Axis-only profiles share every table with the built-in map */
+    if (!profile_moves_buttons(p))
+        return true;
+
+    for (uint8_t l = 0; l < TJUH_INPUT_MAP_LAYOUTS; l++) {
+        for (uint8_t s = 0; s < TJUH_BUTTON_MAP_SLOTS; s++) {
+            const tjuh_button_lut_t *src = base->button[l].lut[s];
+            if (!lut_has_buttons(src))
+                continue;
+            if (used == REMAP_BANK_TABLES)
+                return false;
+
+            for (uint16_t i = 0; i < 256; i++)
+                bank->lut[used][i] = remap_word(p, (*src)[i]);
+            bank->map.button[l].lut[s] = &bank->lut[used++];
+        }
+    }
+    return true;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Internal interface                                                    */
+/* ---------------------------------------------------------------------- */
+
+const tjuh_input_map_t *tjuh_remap_bind(uint8_t dev_addr, uint8_t parser)
+{
+    const tjuh_input_map_t *base = tjuh_input_map_default(parser);
+
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return base;
+
+    remap_bank_t *old = bank_owned_by(dev_addr);
+
+    /* Each device owns at most one bank, so one is always free */
+    remap_bank_t *bank = bank_owned_by(0);
+    const tjuh_input_map_t *map = base;
+
+    if (s_profile_set[dev_addr - 1] && bank &&
+        build_bank(bank, base, &s_profiles[dev_addr - 1])) {
+        bank->owner = dev_addr;
+        map = &bank->map;
+    }
+
+    if (old)
+        old->owner = 0;
+    return map;
+}
+
+const tjuh_input_map_t *TJUH_HOT_FUNC(tjuh_remap_late)(uint8_t dev_addr,
+                                                        const tjuh_input_map_t *base,
+                                                        tjuh_gamepad_state_t *st)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES || !s_profile_set[dev_addr - 1])
+        return base;
+
+    st->buttons = remap_word(&s_profiles[dev_addr - 1], st->buttons);
+    return &s_late_axes[dev_addr - 1];
+}
+
+void tjuh_remap_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    s_profile_set[dev_addr - 1] = false;
+
+    remap_bank_t *bank = bank_owned_by(dev_addr);
+    if (bank)
+        bank->owner = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/*  Public API                                                            */
+/* ---------------------------------------------------------------------- */
+
+void tjuh_remap_profile_init(tjuh_remap_profile_t *profile)
+{
+    for (uint8_t b = 0; b < TJUH_BUTTON_COUNT; b++)
+        profile->button[b] = b;
+    profile->axis_invert = 0;
+    profile->swap_sticks = false;
+}
+
+bool tjuh_set_remap_profile(uint8_t dev_addr, const tjuh_remap_profile_t *profile)
+{
+    uint16_t vid;
+    uint16_t pid;
+
+    if (!tjuh_parse_get_vid_pid(dev_addr, &vid, &pid))
+        return false;
+
+    if (profile) {
+        for (uint8_t b = 0; b < TJUH_BUTTON_COUNT; b++) {
+            if (profile->button[b] >= TJUH_BUTTON_COUNT && profile->button[b] != TJUH_BUTTON_NONE)
+                return false;
+        }
+        memcpy(&s_profiles[dev_addr - 1], profile, sizeof(*profile));
+        s_late_axes[dev_addr - 1].axis_rot = profile->swap_sticks ? 16 : 0;
+        s_late_axes[dev_addr - 1].axis_xor = tjuh_axes_invert_mask(profile->axis_invert);
+    }
+
+    s_profile_set[dev_addr - 1] = (profile != NULL);
+    tjuh_parse_rebind_map(dev_addr);
+    return true;
+}
+
+#endif /* TJUH_ENABLE_REMAP */
@@ -0,0 +1,66 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal remap profile interface.
+ */
+
+#ifndef TJUH_REMAP_H
+#define TJUH_REMAP_H
+
+#include "tjuh_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if TJUH_ENABLE_REMAP
+
+/**
+ * Input map for a device parsed with `parser`: the built-in map, or one
+ * compiled from the device's remap profile into a free bank. The bank
+ * the device used before is released, so the caller must replace its
+ * map pointer with the result before the next report is parsed.
+ */
+const tjuh_input_map_t *tjuh_remap_bind(uint8_t dev_addr, uint8_t parser);
+
+/** Forget the device's profile and release its bank. */
+void tjuh_remap_release(uint8_t dev_addr);
+
+/**
+ * The device's profile for a report parsed with the built-in map `base`,
+ * before tables are built for its parser (on probation, or just after a
+ * report committed one): moves the buttons in `st` and returns the map
+ * whose axis transform applies. `base` if the device has no profile.
+ * Only the axis fields of the returned map are meant to be read.
+ */
+const tjuh_input_map_t *tjuh_remap_late(uint8_t dev_addr, const tjuh_input_map_t *base,
+                                        tjuh_gamepad_state_t *st);
+
+#else
+
+static inline const tjuh_input_map_t *tjuh_remap_bind(uint8_t dev_addr, uint8_t parser)
+{
+    (void)dev_addr;
+    return tjuh_input_map_default(parser);
+}
+
+static inline void tjuh_remap_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+static inline const tjuh_input_map_t *tjuh_remap_late(uint8_t dev_addr,
+                                                      const tjuh_input_map_t *base,
+                                                      tjuh_gamepad_state_t *st)
+{
+    (void)dev_addr;
+    (void)st;
+    return base;
+}
+
+#endif /* TJUH_ENABLE_REMAP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_REMAP_H */
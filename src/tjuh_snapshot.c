@@ -0,0 +1,83 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Structure-of-arrays snapshot of all devices.
+ *
+ * The latest state is kept in the same layout the application receives,
+ * with report times where the snapshot has ages. A report stores its
+ * words into the arrays; a snapshot is one struct copy and one
+ * subtraction per slot, whatever the number of devices connected.
+ */
+
+#include "tjuh_snapshot.h"
+#include "tjuh_parse.h"
+#include "tjuh_buttons.h"
+#include "bsp/board.h"
+#include <string.h>
+
+#if TJUH_ENABLE_SNAPSHOT
+
+_Static_assert(TJUH_MAX_DEVICES <= 32, "the connected bitmap holds 32 devices");
+
+#define AXES_CENTERED 0x80808080u
+
+/* age_ms holds the board_millis() of the latest report */
+static tjuh_snapshot_t s_snapshot;
+
+static void neutral(uint8_t i)
+{
+    s_snapshot.buttons[i] = 0;
+    s_snapshot.axes[i]    = AXES_CENTERED;
+    s_snapshot.age_ms[i]  = 0;
+    s_snapshot.hat[i]     = TJUH_HAT_RELEASED;
+}
+
+void tjuh_snapshot_reset(void)
+{
+    s_snapshot.connected = 0;
+    for (uint8_t i = 0; i < TJUH_SNAPSHOT_SLOTS; i++)
+        neutral(i);
+}
+
+void tjuh_snapshot_connect(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    neutral(dev_addr - 1);
+    s_snapshot.age_ms[dev_addr - 1] = board_millis();
+    s_snapshot.connected |= 1u << (dev_addr - 1);
+}
+
+void TJUH_HOT_FUNC(tjuh_snapshot_update)(uint8_t dev_addr, const tjuh_gamepad_state_t *st)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    uint8_t i = dev_addr - 1;
+    s_snapshot.buttons[i] = st->buttons;
+    s_snapshot.axes[i]    = st->axes;
+    s_snapshot.hat[i]     = st->hat;
+    s_snapshot.age_ms[i]  = board_millis();
+}
+
+void tjuh_snapshot_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    neutral(dev_addr - 1);
+    s_snapshot.connected &= ~(1u << (dev_addr - 1));
+}
+
+uint8_t tjuh_get_snapshot(tjuh_snapshot_t *snapshot)
+{
+    uint32_t now = board_millis();
+
+    *snapshot = s_snapshot;
+    for (uint8_t i = 0; i < TJUH_SNAPSHOT_SLOTS; i++)
+        snapshot->age_ms[i] = (snapshot->connected >> i & 1u) ? now - snapshot->age_ms[i] : 0;
+
+    return (uint8_t)__builtin_popcount(snapshot->connected);
+}
+
+#endif /* TJUH_ENABLE_SNAPSHOT */
@@ -0,0 +1,55 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal snapshot interface.
+ */
+
+#ifndef TJUH_SNAPSHOT_H
+#define TJUH_SNAPSHOT_H
+
+#include "tjuh.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if TJUH_ENABLE_SNAPSHOT
+
+/** No devices connected. */
+void tjuh_snapshot_reset(void);
+
+/** The device is connected; its age counts from now until a report. */
+void tjuh_snapshot_connect(uint8_t dev_addr);
+
+/** Store a report as the device's latest state. */
+void tjuh_snapshot_update(uint8_t dev_addr, const tjuh_gamepad_state_t *st);
+
+/** The device is gone; its entries go back to neutral. */
+void tjuh_snapshot_release(uint8_t dev_addr);
+
+#else
+
+static inline void tjuh_snapshot_reset(void) {}
+
+static inline void tjuh_snapshot_connect(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+static inline void tjuh_snapshot_update(uint8_t dev_addr, const tjuh_gamepad_state_t *st)
+{
+    (void)dev_addr;
+    (void)st;
+}
+
+static inline void tjuh_snapshot_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+#endif /* TJUH_ENABLE_SNAPSHOT */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_SNAPSHOT_H */
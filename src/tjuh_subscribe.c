@@ -0,0 +1,157 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Report dispatch to several subscribers.
+ *
+ * Every filter is kept as a subscriber bitmask: the subscribers of each
+ * device, and the subscribers interested in each combination of changed
+ * fields. The pipeline has worked out a report's changed fields, and
+ * one AND of two table entries leaves the subscribers to call; only
+ * those with a rate cap read the clock. The tables are rebuilt on
+ * (un)subscribe, not per report.
+ */
+
+#include "tjuh_subscribe.h"
+#include "tjuh_parse.h"
+#include "bsp/board.h"
+#include <string.h>
+
+#if TJUH_ENABLE_SUBSCRIBE
+
+_Static_assert(TJUH_MAX_DEVICES <= 32, "the device mask holds 32 devices");
+_Static_assert(TJUH_MAX_SUBSCRIBERS <= 32, "subscriber masks hold 32 subscribers");
+
+static tjuh_subscription_t  s_sub[TJUH_MAX_SUBSCRIBERS];
+static uint32_t             s_used;                     /* subscribed slots */
+static uint32_t             s_capped;                   /* slots with a rate cap */
+
+/* Subscribers per device, and per combination of changed fields */
+static uint32_t             s_dev_subs[TJUH_MAX_DEVICES];
+static uint32_t             s_for_changes[TJUH_FIELD_ALL + 1];
+
+/* Per device: subscribers owed a report whatever changed (new, or held back
+ * by their cap), and capped subscribers that have a delivery time */
+static uint32_t             s_pending[TJUH_MAX_DEVICES];
+static uint32_t             s_timed[TJUH_MAX_DEVICES];
+static uint32_t             s_last_ms[TJUH_MAX_SUBSCRIBERS][TJUH_MAX_DEVICES];
+
+static void rebuild(void)
+{
+    memset(s_dev_subs, 0, sizeof(s_dev_subs));
+    memset(s_for_changes, 0, sizeof(s_for_changes));
+    s_capped = 0;
+
+    for (uint8_t n = 0; n < TJUH_MAX_SUBSCRIBERS; n++) {
+        if (!(s_used >> n & 1u))
+            continue;
+
+        uint32_t bit = 1u << n;
+        const tjuh_subscription_t *sub = &s_sub[n];
+
+        for (uint8_t i = 0; i < TJUH_MAX_DEVICES; i++) {
+            if (sub->devices >> i & 1u)
+                s_dev_subs[i] |= bit;
+        }
+        for (uint8_t c = 0; c <= TJUH_FIELD_ALL; c++) {
+            if (sub->fields == 0 || (sub->fields & c))
+                s_for_changes[c] |= bit;
+        }
+        if (sub->min_interval_ms)
+            s_capped |= bit;
+    }
+}
+
+void tjuh_subscribe_reset(void)
+{
+    memset(s_sub, 0, sizeof(s_sub));
+    s_used = 0;
+    for (uint8_t i = 0; i < TJUH_MAX_DEVICES; i++)
+        tjuh_subscribe_release(i + 1);
+    rebuild();
+}
+
+void tjuh_subscribe_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    s_pending[dev_addr - 1] = 0xFFFFFFFFu;
+    s_timed[dev_addr - 1]   = 0;
+}
+
+void TJUH_HOT_FUNC(tjuh_subscribe_dispatch)(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                                            const tjuh_report_delta_t *delta)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    uint8_t  i    = dev_addr - 1;
+    uint32_t call = s_dev_subs[i] & (s_for_changes[delta->fields] | s_pending[i]);
+    if (!call)
+        return;
+
+    /* Hold back capped subscribers still inside their interval */
+    if (call & s_capped) {
+        uint32_t now = board_millis();
+        uint32_t capped = call & s_capped & s_timed[i];
+
+        while (capped) {
+            uint8_t n = (uint8_t)__builtin_ctz(capped);
+            capped &= capped - 1;
+            if (now - s_last_ms[n][i] < s_sub[n].min_interval_ms) {
+                call         &= ~(1u << n);
+                s_pending[i] |= 1u << n;
+            }
+        }
+
+        capped = call & s_capped;
+        s_timed[i] |= capped;
+        while (capped) {
+            uint8_t n = (uint8_t)__builtin_ctz(capped);
+            capped &= capped - 1;
+            s_last_ms[n][i] = now;
+        }
+    }
+
+    s_pending[i] &= ~call;
+    while (call) {
+        uint8_t n = (uint8_t)__builtin_ctz(call);
+        call &= call - 1;
+
+        /* An earlier subscriber may have unsubscribed this one */
+        tjuh_subscriber_cb_t cb = s_sub[n].callback;
+        if (cb)
+            cb(dev_addr, st, s_sub[n].ctx);
+    }
+}
+
+int8_t tjuh_subscribe(const tjuh_subscription_t *subscription)
+{
+    if (!subscription || !subscription->callback || s_used == 0xFFFFFFFFu)
+        return -1;
+
+    uint8_t n = (uint8_t)__builtin_ctz(~s_used);
+    if (n >= TJUH_MAX_SUBSCRIBERS)
+        return -1;
+
+    s_sub[n] = *subscription;
+    s_used  |= 1u << n;
+    for (uint8_t i = 0; i < TJUH_MAX_DEVICES; i++) {
+        s_pending[i] |= 1u << n;
+        s_timed[i]   &= ~(1u << n);
+    }
+    rebuild();
+    return (int8_t)n;
+}
+
+bool tjuh_unsubscribe(int8_t handle)
+{
+    if (handle < 0 || handle >= TJUH_MAX_SUBSCRIBERS || !(s_used >> handle & 1u))
+        return false;
+
+    s_sub[handle].callback = NULL;
+    s_used &= ~(1u << handle);
+    rebuild();
+    return true;
+}
+
+#endif /* TJUH_ENABLE_SUBSCRIBE */
@@ -0,0 +1,51 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal subscription interface.
+ */
+
+#ifndef TJUH_SUBSCRIBE_H
+#define TJUH_SUBSCRIBE_H
+
+#include "tjuh.h"
+#include "tjuh_buttons.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if TJUH_ENABLE_SUBSCRIBE
+
+/** Drop all subscriptions. */
+void tjuh_subscribe_reset(void);
+
+/** Call the subscribers whose filters pass a report. */
+void tjuh_subscribe_dispatch(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                             const tjuh_report_delta_t *delta);
+
+/** The device is gone; its next report counts as a first one. */
+void tjuh_subscribe_release(uint8_t dev_addr);
+
+#else
+
+static inline void tjuh_subscribe_reset(void) {}
+
+static inline void tjuh_subscribe_dispatch(uint8_t dev_addr, const tjuh_gamepad_state_t *st,
+                                           const tjuh_report_delta_t *delta)
+{
+    (void)dev_addr;
+    (void)st;
+    (void)delta;
+}
+
+static inline void tjuh_subscribe_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+#endif /* TJUH_ENABLE_SUBSCRIBE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_SUBSCRIBE_H */
@@ -0,0 +1,137 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Axis kernels on packed words.
+ *
+ * The compact axes are four bytes of one word (tjuh_gamepad_state_t.axes)
+ * and the extended sticks pack into two words of 16-bit lanes, (x, y)
+ * and (z, rz). These kernels work on all lanes of a word at once.
+ *
+ * On cores with the DSP extension (RP2350's Cortex-M33: QSUB16, SMUAD,
+ * SSAT, UXTB16) each kernel is a few instructions. Elsewhere (RP2040's
+ * Cortex-M0+, host builds) the same kernels are plain C on the word,
+ * splitting lanes only where a saturation needs it. Both give identical
+ * results, which bench/bench_swar.c checks against per-axis code.
+ * Little-endian, like the axes union itself.
+ */
+
+#ifndef TJUH_SWAR_H
+#define TJUH_SWAR_H
+
+#include "tjuh.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Use the DSP instructions where the core has them; 0 forces the C kernels */
+#ifndef TJUH_SWAR_DSP
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32 && \
+    defined(__ARM_FEATURE_SAT) && __ARM_FEATURE_SAT
+#define TJUH_SWAR_DSP 1
+#else
+#define TJUH_SWAR_DSP 0
+#endif
+#endif
+
+/*
+ * Callers keep the sticks in words (1) or take them axis by axis (0).
+ * Off the DSP cores the word kernels split their lanes anyway and are
+ * slower than per-axis code (bench_swar), so words follow the DSP
+ * kernels by default; bench_swar builds both ways to check each.
+ */
+#ifndef TJUH_SWAR_WORDS
+#define TJUH_SWAR_WORDS TJUH_SWAR_DSP
+#endif
+
+#if TJUH_SWAR_DSP
+#include <arm_acle.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+_Static_assert(offsetof(tjuh_gamepad_ext_t, y)  == offsetof(tjuh_gamepad_ext_t, x) + 2 &&
+               offsetof(tjuh_gamepad_ext_t, z)  == offsetof(tjuh_gamepad_ext_t, x) + 4 &&
+               offsetof(tjuh_gamepad_ext_t, rz) == offsetof(tjuh_gamepad_ext_t, x) + 6,
+               "extended sticks must be contiguous");
+
+/* Extended sticks as (x, y) and (z, rz) words */
+static inline void tjuh_swar_load_sticks(const tjuh_gamepad_ext_t *ext, uint32_t pair[2])
+{
+    memcpy(pair, (const uint8_t *)ext + offsetof(tjuh_gamepad_ext_t, x), 2 * sizeof(uint32_t));
+}
+
+static inline void tjuh_swar_store_sticks(tjuh_gamepad_ext_t *ext, const uint32_t pair[2])
+{
+    memcpy((uint8_t *)ext + offsetof(tjuh_gamepad_ext_t, x), pair, 2 * sizeof(uint32_t));
+}
+
+/*
+ * Axes-word XOR mask (0xFF per inverted axis) widened to the 16-bit lanes
+ * of stick pair 0 (x, y) or 1 (z, rz).
+ */
+static inline uint32_t tjuh_swar_widen_mask(uint32_t axes_mask, unsigned pair)
+{
+    uint32_t m = (axes_mask >> (16 * pair)) & 0xFFFFu;
+
+    m = (m & 0x00FFu) | ((m & 0xFF00u) << 8);
+    return m | (m << 8);
+}
+
+/* Two values saturated to int16 lanes */
+static inline uint32_t tjuh_swar_pack_sat16(int32_t lo, int32_t hi)
+{
+#if TJUH_SWAR_DSP
+    lo = __ssat(lo, 16);
+    hi = __ssat(hi, 16);
+#else
+    lo = lo < INT16_MIN ? INT16_MIN : lo > INT16_MAX ? INT16_MAX : lo;
+    hi = hi < INT16_MIN ? INT16_MIN : hi > INT16_MAX ? INT16_MAX : hi;
+#endif
+    return ((uint32_t)lo & 0xFFFFu) | ((uint32_t)hi << 16);
+}
+
+/*
+ * Deflection of a stick pair from its centre: (lane - 0x8000 - centre),
+ * saturated to int16, per lane. `center` holds int16 offsets from 0x8000.
+ */
+static inline uint32_t tjuh_swar_deflection(uint32_t pair, uint32_t center)
+{
+#if TJUH_SWAR_DSP
+    return (uint32_t)__qsub16((int32_t)(pair ^ 0x80008000u), (int32_t)center);
+#else
+    return tjuh_swar_pack_sat16((int32_t)(pair & 0xFFFFu) - 0x8000 - (int16_t)center,
+                                (int32_t)(pair >> 16) - 0x8000 - ((int32_t)center >> 16));
+#endif
+}
+
+/* dx² + dy² of an int16 pair; at most 2^31, so unsigned */
+static inline uint32_t tjuh_swar_norm2(uint32_t d)
+{
+#if TJUH_SWAR_DSP
+    /* Only (-0x8000, -0x8000) overflows int32; the bits are still right */
+    return (uint32_t)__smuad((int32_t)d, (int32_t)d);
+#else
+    int32_t lo = (int16_t)d;
+    int32_t hi = (int32_t)d >> 16;
+    return (uint32_t)(lo * lo) + (uint32_t)(hi * hi);
+#endif
+}
+
+/* Compact axes word from the high bytes of the (x, y) and (z, rz) lanes */
+static inline uint32_t tjuh_swar_narrow(uint32_t xy, uint32_t zrz)
+{
+#if TJUH_SWAR_DSP
+    uint32_t xz  = (xy & 0xFFFFu) | (zrz << 16);
+    uint32_t yrz = (xy >> 16) | (zrz & 0xFFFF0000u);
+    return __uxtb16((xz >> 8) | (xz << 24)) | (__uxtb16((yrz >> 8) | (yrz << 24)) << 8);
+#else
+    return ((xy >> 8) & 0x000000FFu) | ((xy >> 16) & 0x0000FF00u) |
+           ((zrz << 8) & 0x00FF0000u) | (zrz & 0xFF000000u);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_SWAR_H */
@@ -0,0 +1,161 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * DS4 / DualSense touchpad contact tracking.
+ *
+ * Both controllers report two contact points of four bytes each: bit 7
+ * of the first byte is set while the finger is *not* touching, bits 0-6
+ * are the tracking id, then 12-bit x and y. The DS4 prefixes them with a
+ * frame count and repeats them for up to three frames per USB report;
+ * the DualSense sends one frame after the IMU block.
+ *
+ * Only changes against the previous frame become events, so an idle pad
+ * costs a compare per finger.
+ */
+
+#include "tjuh_touch.h"
+#include "tjuh_parse.h"
+#include <string.h>
+
+#if TJUH_ENABLE_SONY
+
+/* DS4: frame count, then 9-byte frames (timestamp + two points) */
+#define DS4_TOUCH_COUNT    33
+#define DS4_TOUCH_FRAME    34
+#define DS4_TOUCH_FRAMES   3
+
+/* DualSense: two points */
+#define DUALSENSE_TOUCH    33
+
+typedef struct {
+    bool     down;
+    uint8_t  id;
+    uint16_t x;
+    uint16_t y;
+} touch_contact_t;
+
+typedef struct {
+    uint8_t         parser;     /* parser of the contacts below */
+    touch_contact_t finger[TJUH_TOUCH_FINGERS];
+} touch_device_t;
+
+static touch_device_t s_touch[TJUH_MAX_DEVICES];
+
+static uint8_t emit(tjuh_touch_event_t *out, uint8_t n, uint8_t type, uint8_t finger,
+                    const touch_contact_t *c)
+{
+    out[n].type   = type;
+    out[n].finger = finger;
+    out[n].id     = c->id;
+    out[n].x      = c->x;
+    out[n].y      = c->y;
+    return (uint8_t)(n + 1);
+}
+
+/* One frame: two 4-byte points */
+static uint8_t touch_frame(touch_device_t *d, const uint8_t *p, tjuh_touch_event_t *out,
+                           uint8_t n)
+{
+    for (uint8_t f = 0; f < TJUH_TOUCH_FINGERS; f++, p += 4) {
+        touch_contact_t *c = &d->finger[f];
+        touch_contact_t now = {
+            .down = !(p[0] & 0x80),
+            .id   = p[0] & 0x7F,
+            .x    = (uint16_t)(p[1] | ((p[2] & 0x0F) << 8)),
+            .y    = (uint16_t)((p[2] >> 4) | (p[3] << 4)),
+        };
+
+        if (!now.down) {
+            if (c->down) {
+                n = emit(out, n, TJUH_TOUCH_UP, f, c);
+                c->down = false;
+            }
+            continue;
+        }
+
+        /* A new id in the same slot: the old finger lifted between frames */
+        if (c->down && c->id != now.id)
+            n = emit(out, n, TJUH_TOUCH_UP, f, c);
+
+        if (!c->down || c->id != now.id)
+            n = emit(out, n, TJUH_TOUCH_DOWN, f, &now);
+        else if (c->x != now.x || c->y != now.y)
+            n = emit(out, n, TJUH_TOUCH_MOVE, f, &now);
+
+        *c = now;
+    }
+    return n;
+}
+
+uint8_t tjuh_touch_process(uint8_t dev_addr, uint8_t parser, const uint8_t *data, uint16_t len,
+                           tjuh_touch_event_t out[TJUH_TOUCH_MAX_EVENTS])
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return 0;
+
+    touch_device_t *d = &s_touch[dev_addr - 1];
+    uint8_t n = 0;
+
+    if (parser != d->parser) {
+        memset(d, 0, sizeof(*d));
+        d->parser = parser;
+    }
+
+    switch (parser) {
+        case TJUH_PARSER_DS4: {
+            if (len < DS4_TOUCH_FRAME + 9 || data[0] != 0x01)
+                return 0;
+
+            uint8_t frames = data[DS4_TOUCH_COUNT];
+            if (frames > DS4_TOUCH_FRAMES)
+                frames = DS4_TOUCH_FRAMES;
+
+            for (uint8_t i = 0; i < frames; i++) {
+                uint16_t at = (uint16_t)(DS4_TOUCH_FRAME + 9 * i);
+                if (at + 9 > len)
+                    break;
+                n = touch_frame(d, &data[at + 1], out, n);
+            }
+            break;
+        }
+
+        case TJUH_PARSER_DUALSENSE:
+            if (len < DUALSENSE_TOUCH + 8 || data[0] != 0x01)
+                return 0;
+            n = touch_frame(d, &data[DUALSENSE_TOUCH], out, n);
+            break;
+
+        default:
+            break;
+    }
+    return n;
+}
+
+void tjuh_touch_release(uint8_t dev_addr)
+{
+    if (dev_addr == 0 || dev_addr > TJUH_MAX_DEVICES)
+        return;
+
+    memset(&s_touch[dev_addr - 1], 0, sizeof(s_touch[0]));
+}
+
+#else /* !TJUH_ENABLE_SONY */
+
+/* No controller with a touchpad is compiled in */
+
+uint8_t tjuh_touch_process(uint8_t dev_addr, uint8_t parser, const uint8_t *data, uint16_t len,
+                           tjuh_touch_event_t out[TJUH_TOUCH_MAX_EVENTS])
+{
+    (void)dev_addr;
+    (void)parser;
+    (void)data;
+    (void)len;
+    (void)out;
+    return 0;
+}
+
+void tjuh_touch_release(uint8_t dev_addr)
+{
+    (void)dev_addr;
+}
+
+#endif /* TJUH_ENABLE_SONY */
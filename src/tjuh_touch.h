@@ -0,0 +1,37 @@
+/*
+ * TJUH — Tiny Joystick USB Host
+ * Internal touchpad contact tracking interface.
+ */
+
+#ifndef TJUH_TOUCH_H
+#define TJUH_TOUCH_H
+
+#include "tjuh.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A DS4 USB report carries up to three touch frames; each can lift one
+ * contact and place another per finger.
+ */
+#define TJUH_TOUCH_MAX_EVENTS (3 * TJUH_TOUCH_FINGERS * 2)
+
+/**
+ * Compare the report's touchpad contacts with the previous ones.
+ *
+ * @return the number of events written to out, 0 if nothing changed or
+ *         the parser has no touchpad.
+ */
+uint8_t tjuh_touch_process(uint8_t dev_addr, uint8_t parser, const uint8_t *data, uint16_t len,
+                           tjuh_touch_event_t out[TJUH_TOUCH_MAX_EVENTS]);
+
+/** Forget the device's contacts. */
+void tjuh_touch_release(uint8_t dev_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TJUH_TOUCH_H */
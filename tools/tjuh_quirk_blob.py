@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+TJUH — quirk blob builder
+
+Packs a text list of controller quirks into the binary blob that
+tjuh_quirk_blob_attach() loads from flash (format: src/tjuh_quirks.h).
+
+Input, one entry per line ('#' starts a comment):
+
+    # vid    pid    parser      init        flags            poll_ms
+    0x2DC8   0x6001 ds4         none        invert_y         0
+    0x0F0D   any    switch      switch_usb  set_idle         8
+
+    # HID report descriptor fingerprint, as logged by TJUH at enumeration
+    # fp     hash        desc_len  parser   flags
+    fp       0x1A2B3C4D  137       ds4      0
+
+Usage:
+
+    tjuh_quirk_blob.py quirks.txt quirks.bin     # build
+    tjuh_quirk_blob.py --dump quirks.bin         # inspect
+
+Flash the result to the region given by TJUH_QUIRK_BLOB_ADDR, e.g.
+
+    picotool load -o 0x101FF000 quirks.bin
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = b"TJQB"
+VERSION = 2
+ENTRY = struct.Struct("<HHBBBB")
+FINGERPRINT = struct.Struct("<IHBB")
+HEADER = struct.Struct("<4sBBHII")
+PID_ANY = 0xFFFF
+
+# Must match tjuh_parser_t (src/tjuh_parse.h)
+PARSERS = {
+    "auto": 0,
+    "ds4": 1,
+    "dualsense": 2,
+    "switch": 3,
+    "xbox360": 4,
+    "xbox_one": 5,
+    "generic8": 6,
+    "generic3": 7,
+    "ignore": 8,
+    "dinput": 9,
+}
+
+# Must match tjuh_init_script_t (src/tjuh_quirks.h)
+INITS = {
+    "none": 0,
+    "switch_usb": 1,
+    "xbox_one": 2,
+}
+
+# Must match TJUH_QUIRK_* (src/tjuh_quirks.h)
+FLAGS = {
+    "invert_x": 0x01,
+    "invert_y": 0x02,
+    "invert_z": 0x04,
+    "invert_rz": 0x08,
+    "set_idle": 0x10,
+}
+
+
+def parse_flags(text):
+    if text in ("0", "-", "none"):
+        return 0
+    value = 0
+    for name in text.split("|"):
+        if name not in FLAGS:
+            raise ValueError(f"unknown flag '{name}'")
+        value |= FLAGS[name]
+    return value
+
+
+def parse_line(line):
+    fields = line.split()
+    if len(fields) != 6:
+        raise ValueError("expected: vid pid parser init flags poll_ms")
+
+    vid = int(fields[0], 16)
+    pid = PID_ANY if fields[1] == "any" else int(fields[1], 16)
+    if fields[2] not in PARSERS:
+        raise ValueError(f"unknown parser '{fields[2]}'")
+    if fields[3] not in INITS:
+        raise ValueError(f"unknown init script '{fields[3]}'")
+    poll_ms = int(fields[5], 0)
+    if not 0 <= poll_ms <= 255:
+        raise ValueError("poll_ms must be 0..255")
+
+    return (vid, pid, PARSERS[fields[2]], INITS[fields[3]], parse_flags(fields[4]), poll_ms)
+
+
+def parse_fingerprint(line):
+    fields = line.split()
+    if len(fields) != 5:
+        raise ValueError("expected: fp hash desc_len parser flags")
+
+    fp_hash = int(fields[1], 16)
+    desc_len = int(fields[2], 0)
+    if fields[3] not in PARSERS:
+        raise ValueError(f"unknown parser '{fields[3]}'")
+
+    return (fp_hash, desc_len, PARSERS[fields[3]], parse_flags(fields[4]))
+
+
+def build(src, dst):
+    entries = {}
+    fingerprints = {}
+    with open(src) as f:
+        for n, raw in enumerate(f, 1):
+            line = raw.split("#", 1)[0].strip()
+            if not line:
+                continue
+            try:
+                if line.startswith("fp "):
+                    e = parse_fingerprint(line)
+                    if e[0] in fingerprints:
+                        sys.exit(f"{src}:{n}: duplicate fingerprint {e[0]:08X}")
+                    fingerprints[e[0]] = e
+                    continue
+                e = parse_line(line)
+            except ValueError as err:
+                sys.exit(f"{src}:{n}: {err}")
+            if (e[0], e[1]) in entries:
+                sys.exit(f"{src}:{n}: duplicate entry {e[0]:04X}:{e[1]:04X}")
+            entries[(e[0], e[1])] = e
+
+    payload = b"".join(ENTRY.pack(*entries[k]) for k in sorted(entries))
+    payload += b"".join(FINGERPRINT.pack(*fingerprints[k]) for k in sorted(fingerprints))
+    header = HEADER.pack(MAGIC, VERSION, ENTRY.size, len(fingerprints), len(entries),
+                         zlib.crc32(payload))
+
+    with open(dst, "wb") as f:
+        f.write(header + payload)
+    print(f"{dst}: {len(entries)} entries, {len(fingerprints)} fingerprints, "
+          f"{HEADER.size + len(payload)} bytes")
+
+
+def dump(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    magic, version, entry_size, fp_count, count, crc = HEADER.unpack_from(data)
+    quirk_len = count * entry_size
+    payload = data[HEADER.size:HEADER.size + quirk_len + fp_count * FINGERPRINT.size]
+    ok = magic == MAGIC and entry_size == ENTRY.size and zlib.crc32(payload) == crc
+    print(f"version {version}, {count} entries, {fp_count} fingerprints, "
+          f"crc {crc:08X} {'ok' if ok else 'BAD'}")
+
+    parser_names = {v: k for k, v in PARSERS.items()}
+    init_names = {v: k for k, v in INITS.items()}
+    for vid, pid, parser, init, flags, poll_ms in ENTRY.iter_unpack(payload[:quirk_len]):
+        pid_s = "any " if pid == PID_ANY else f"{pid:04X}"
+        print(f"  {vid:04X}:{pid_s}  {parser_names.get(parser, parser):<10} "
+              f"{init_names.get(init, init):<10} flags 0x{flags:02X}  poll {poll_ms}")
+    for fp_hash, desc_len, parser, flags in FINGERPRINT.iter_unpack(payload[quirk_len:]):
+        print(f"  fp {fp_hash:08X} len {desc_len:<5} {parser_names.get(parser, parser):<10} "
+              f"flags 0x{flags:02X}")
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Build or inspect a TJUH quirk blob")
+    ap.add_argument("--dump", action="store_true", help="print the contents of a blob")
+    ap.add_argument("input")
+    ap.add_argument("output", nargs="?")
+    args = ap.parse_args()
+
+    if args.dump:
+        dump(args.input)
+    elif args.output:
+        build(args.input, args.output)
+    else:
+        ap.error("output file required")
+
+
+if __name__ == "__main__":
+    main()